@@ -4,6 +4,10 @@
 #define PI_OVER_TWO 1.57079632679
 #define PI_INVERSE 0.3183098861837
 
+#define LIGHT_CLUSTER_MAX_PER_CLUSTER   256
+#define LIGHT_TYPE_POINT                0
+#define LIGHT_TYPE_SPOT                 1
+
 // Input from Subpass 1
 layout(input_attachment_index = 0, binding = 0) uniform subpassInput inputColor;        // Color output from Subpass 1
 layout(input_attachment_index = 1, binding = 1) uniform subpassInput inputDepth;        // Depth output from the subpass 1
@@ -18,9 +22,51 @@ layout(set = 0, binding = 8) uniform DeferredShaderData
 {
     vec4 lightProperties;   // RGB - Direction, A - Intensity
     vec3 cameraPosition;
-    int  passID;
+    vec4 iblProperties;     // x - enabled, y - prefiltered max mip, z - intensity
+    mat4 matInverseViewProjection;
 } shaderData;
 
+// Image based lighting, generated once per environment & cached by VulkanTextureCUBE
+layout(set = 0, binding = 9) uniform samplerCube samplerIrradiance;
+layout(set = 0, binding = 10) uniform samplerCube samplerPrefilteredSpecular;
+layout(set = 0, binding = 11) uniform sampler2D samplerBRDFLUT;
+
+// Clustered local lights, binned by LightCluster.comp
+struct Light
+{
+    vec4    positionRange;      // xyz - world position, w - range
+    vec4    colorIntensity;     // rgb - color, a - intensity
+    vec4    directionType;      // xyz - spot direction, w - type
+    vec4    spotCosines;        // x - cos inner, y - cos outer
+};
+
+layout(set = 1, binding = 0) uniform ClusterData
+{
+    mat4    matView;
+    mat4    matInverseProjection;
+    vec4    screenSize;         // xy - size, zw - 1/size
+    vec4    depthParams;        // x - near, y - far, z - slice scale, w - slice bias
+    uvec4   gridSize;           // xyz - cluster grid, w - light count
+} clusterData;
+
+layout(std430, set = 1, binding = 1) readonly buffer Lights
+{
+    Light lights[];
+};
+
+layout(std430, set = 1, binding = 2) readonly buffer LightGrid
+{
+    uint lightCounts[];
+};
+
+layout(std430, set = 1, binding = 3) readonly buffer LightIndices
+{
+    uint lightIndices[];
+};
+
+// Pipeline permutation, 0 - lit result, else G-Buffer channel / light heat map for UIManager pass combo
+layout(constant_id = 0) const int DEBUG_VIEW = 0;
+
 // Final color output!
 layout(location = 0) out vec4 outColor;
 
@@ -68,6 +114,33 @@ vec3 fresnelSchlick(float cosTheta, vec3 F0)
     return F0 + (1.0f - F0) * pow(1.0f - cosTheta, 5.0f);
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+// Roughness aware Fresnel for ambient, rough surfaces shouldn't get full grazing angle reflection
+vec3 fresnelSchlickRoughness(float cosTheta, vec3 F0, float roughness)
+{
+    return F0 + (max(vec3(1.0f - roughness), F0) - F0) * pow(1.0f - cosTheta, 5.0f);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Split sum approximation : diffuse irradiance + prefiltered radiance scaled by BRDF LUT
+vec3 AmbientIBL(vec3 N, vec3 V, vec3 F0, vec3 albedo, float metalness, float roughness)
+{
+    float NdotV     = max(dot(N, V), 0.0f);
+    vec3 R          = reflect(-V, N);
+
+    vec3 kS         = fresnelSchlickRoughness(NdotV, F0, roughness);
+    vec3 kD         = (vec3(1) - kS) * (1.0f - metalness);
+
+    vec3 irradiance = texture(samplerIrradiance, N).rgb;
+    vec3 diffuse    = irradiance * albedo;
+
+    vec3 prefiltered = textureLod(samplerPrefilteredSpecular, R, roughness * shaderData.iblProperties.y).rgb;
+    vec2 envBRDF     = texture(samplerBRDFLUT, vec2(NdotV, roughness)).rg;
+    vec3 specular    = prefiltered * (kS * envBRDF.x + envBRDF.y);
+
+    return (kD * diffuse + specular) * shaderData.iblProperties.z;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 vec3 BRDF(vec3 L, vec3 V, vec3 N, vec3 F, float roughness)
 {
@@ -96,6 +169,52 @@ vec3 BRDF(vec3 L, vec3 V, vec3 N, vec3 F, float roughness)
     return outColor;
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+// Same slicing as LightCluster.comp: screen tile in xy, exponential view depth in z
+uint GetClusterIndex(vec3 worldPosition)
+{
+    float viewDepth = -(clusterData.matView * vec4(worldPosition, 1.0f)).z;
+
+    uvec3 grid = clusterData.gridSize.xyz;
+    uvec2 tile = uvec2(gl_FragCoord.xy * clusterData.screenSize.zw * vec2(grid.xy));
+    uint slice = uint(max(log(viewDepth) * clusterData.depthParams.z - clusterData.depthParams.w, 0.0f));
+
+    tile = min(tile, grid.xy - 1);
+    slice = min(slice, grid.z - 1);
+
+    return tile.x + grid.x * (tile.y + grid.y * slice);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Smooth window so light reaches exactly zero at its range, binning relies on it!
+float RangeAttenuation(float distance, float range)
+{
+    float ratio = distance / range;
+    float window = clamp(1.0f - ratio * ratio * ratio * ratio, 0.0f, 1.0f);
+    return (window * window) / (distance * distance + 1.0f);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+vec3 LocalLight(Light light, vec3 P, vec3 N, vec3 V, vec3 F, vec3 Kd, vec3 albedo, float roughness)
+{
+    vec3 toLight    = light.positionRange.xyz - P;
+    float distance  = length(toLight);
+    vec3 L          = toLight / max(distance, 0.0001f);
+
+    float attenuation = RangeAttenuation(distance, light.positionRange.w);
+
+    if (int(light.directionType.w) == LIGHT_TYPE_SPOT)
+    {
+        float cosAngle = dot(-L, normalize(light.directionType.xyz));
+        attenuation *= smoothstep(light.spotCosines.y, light.spotCosines.x, cosAngle);
+    }
+
+    vec3 radiance   = light.colorIntensity.rgb * light.colorIntensity.a * attenuation;
+    float NdotL     = max(dot(N, L), 0.0f);
+
+    return (Kd * albedo * PI_INVERSE * NdotL + BRDF(L, V, N, F, roughness)) * radiance;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void main()
 {
@@ -143,25 +262,35 @@ void main()
     vec3 Kd = vec3(1) - Ks;
     Kd *= 1.0f - Metalness;
 
-    vec3 Ambient = AlbedoColor.rgb * Occlusion; 
-    vec3 Color = Ambient + (Kd * AlbedoColor.rgb * PI_INVERSE + Ks * Lo) * LightIntensity;                                                                                                                                                                                                                                                                                                               
+    // Uniform toggle, not worth a pipeline variant for benchmarking
+    vec3 Ambient = AlbedoColor.rgb * Occlusion;
+    if (shaderData.iblProperties.x > 0.0f)
+    {
+        Ambient = AmbientIBL(N, Eye, F0, AlbedoColor.rgb, Metalness, Roughness) * Occlusion;
+    }
+
+    vec3 Color = Ambient + (Kd * AlbedoColor.rgb * PI_INVERSE + Ks * Lo) * LightIntensity;
+
+    // Local lights of this pixel's cluster only
+    uint clusterIndex   = GetClusterIndex(PositionColor.rgb);
+    uint clusterLights  = min(lightCounts[clusterIndex], uint(LIGHT_CLUSTER_MAX_PER_CLUSTER));
+    uint firstSlot      = clusterIndex * LIGHT_CLUSTER_MAX_PER_CLUSTER;
+
+    for (uint i = 0; i < clusterLights; ++i)
+    {
+        Light light = lights[lightIndices[firstSlot + i]];
+        Color += LocalLight(light, PositionColor.rgb, N, Eye, F, Kd, AlbedoColor.rgb, Roughness);
+    }                                                                                                                                                                                                                                                                                                               
     
     // Gamma Correction!
     Color = Color / (Color + vec3(1));
     Color = pow(Color, vec3(0.4545f));
     
-    // Composite BackgroundColor (Blue channel of ObjectID) + Final Color 
-    vec4 FinalColor = vec4(0); 
-    vec3 redChannel = vec3(1,0,0);  // STATIC_OPAQUE
-    vec3 blueChannel = vec3(0,0,1); // SKYBOX
-
-    if(dot(redChannel, ObjectIDColor.rgb) == 1)
-        FinalColor = vec4(Color, 1);
-    else if(dot(blueChannel, ObjectIDColor.rgb) == 1)
-        FinalColor = BackgroundColor;
+    // Sky pixels are rejected by depth test & composited by DeferredSky.frag, only geometry gets here!
+    vec4 FinalColor = vec4(Color, 1);
     
-    // DEBUG: Individual Passes!
-    switch(shaderData.passID)
+    // DEBUG: Individual Passes! Specialization constant, production pipeline only keeps case 0
+    switch(DEBUG_VIEW)
     {
         case 0:
         {
@@ -217,6 +346,13 @@ void main()
         {
             outColor = ObjectIDColor;                             
         }   break;
+
+        case 11:
+        {
+            // Lights per cluster heat map, red = 32 or more
+            float heat = clamp(float(clusterLights) / 32.0f, 0.0f, 1.0f);
+            outColor = vec4(heat, 1.0f - abs(heat * 2.0f - 1.0f), 1.0f - heat, 1);
+        }   break;
     }
     
    // outColor = albedoColor + Kd * vec4(vec3(diffuse), 1) + Ks * vec4(vec3(specular), 1.0f);
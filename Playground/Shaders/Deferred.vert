@@ -8,7 +8,12 @@ vec2 positions[3]  = vec2[]
     vec2(-1.0f, 3.0f)
 );
 
+// NDC position, sky reconstructs its view ray from it
+layout(location = 0) out vec2 vs_outNDC;
+
 void main()
 {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0f, 1.0f);
+    // At far plane, depth test against G-Buffer depth picks lit or sky pixels
+    vs_outNDC   = positions[gl_VertexIndex];
+    gl_Position = vec4(positions[gl_VertexIndex], 1.0f, 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#version 450
+
+#define PI 3.14159265358979
+
+// Sky pixels only (depth test EQUAL at far plane), no lighting needed!
+layout(location = 0) in vec2 vs_outNDC;
+
+layout(set = 0, binding = 8) uniform DeferredShaderData
+{
+    vec4 lightProperties;   // RGB - Direction, A - Intensity
+    vec3 cameraPosition;
+    vec4 iblProperties;     // x - enabled, y - prefiltered max mip, z - intensity
+    mat4 matInverseViewProjection;
+} shaderData;
+
+// Same equirect HDRI the IBL maps are generated from
+layout(set = 0, binding = 12) uniform sampler2D samplerHDRI;
+
+// Final color output!
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    // World space view ray through this pixel, any point in front of camera works so use far plane
+    vec4 farPoint   = shaderData.matInverseViewProjection * vec4(vs_outNDC, 1.0f, 1.0f);
+    vec3 dir        = normalize(farPoint.xyz / farPoint.w - shaderData.cameraPosition);
+
+    // Must match mapping in IBLEquirectToCube.comp, HDRI is flipped on load so v grows upwards
+    vec2 equirectUV = vec2(atan(dir.z, dir.x) / (2.0f * PI) + 0.5f, asin(clamp(dir.y, -1.0f, 1.0f)) / PI + 0.5f);
+
+    // Explicit LOD, atan seam would otherwise pick the smallest mip along one column
+    outColor = vec4(textureLod(samplerHDRI, equirectUV, 0.0f).rgb, 1.0f);
+}
@@ -0,0 +1,47 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+// Position only stream, see Mesh::CreatePositionBuffer
+layout(location=0) in vec3 in_Position;
+
+// Per frame globals, must match FrameShaderData
+layout(set = 0, binding = 0) uniform FrameData
+{
+    mat4    matView;
+    mat4    matProjection;
+    mat4    matViewProjection;
+    vec4    cameraPosition;
+    vec4    lightProperties;
+} frameData;
+
+// Per object, must match ObjectShaderData in Mesh.h. Rewritten every frame, so transforms never touch command buffers
+struct ObjectData
+{
+    mat4    matModel;
+    int     objectID;
+    uint    materialIndex;
+    uint    pad0;
+    uint    pad1;
+};
+
+layout(set = 0, binding = 1) readonly buffer Objects
+{
+    ObjectData objects[];
+};
+
+// Per draw, must match PushConstantData in Mesh.h. Slot of the model in objects[], offset by gl_InstanceIndex: CPU
+// recorded draws push the slot & draw one instance, GPU driven draws push 0 & carry the slot in firstInstance
+layout(push_constant) uniform PushObject
+{
+    uint    objectIndex;
+} pushObject;
+
+// Must match GBuffer.vert bit for bit, G-Buffer pass tests depth with EQUAL!
+invariant gl_Position;
+
+void main()
+{
+    ObjectData object = objects[pushObject.objectIndex + gl_InstanceIndex];
+
+    gl_Position     = frameData.matViewProjection * object.matModel * vec4(in_Position, 1.0f);
+}
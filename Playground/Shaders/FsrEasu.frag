@@ -0,0 +1,150 @@
+#version 450
+
+// FSR1 EASU (edge adaptive spatial upsampling), fp32 port of the reference algorithm.
+// Fetches 12 texels around output position, estimates local edge direction & strength from luma and
+// filters with a Lanczos-2 like kernel stretched along that edge.
+//
+//     b c
+//   e f g h
+//   i j k l
+//     n o
+
+// Lit scene, only the top left render extent subrect is valid
+layout(set = 0, binding = 0) uniform sampler2D samplerSceneColor;
+
+layout(push_constant) uniform UpscaleData
+{
+    vec4 uvScaleMax;        // bilinear upscale only
+    vec4 easuScale;         // xy - render extent / output extent, zw - last valid texel of render extent
+    vec4 rcasParams;        // x - sharpness as linear scale
+} pushData;
+
+layout(location = 0) out vec4 outColor;
+
+//---------------------------------------------------------------------------------------------------------------------
+vec3 Fetch(ivec2 texel)
+{
+    return texelFetch(samplerSceneColor, clamp(texel, ivec2(0), ivec2(pushData.easuScale.zw)), 0).rgb;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Cheap luma approximation used by the reference, only relative values matter
+float Luma(vec3 c)
+{
+    return c.b * 0.5f + (c.r * 0.5f + c.g);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Accumulates direction & edge length of one of the 4 bilinear quadrants f, g, j, k
+//    a
+//  b c d
+//    e
+void EasuSet(inout vec2 dir, inout float len, float w, float lA, float lB, float lC, float lD, float lE)
+{
+    float dc = lD - lC;
+    float cb = lC - lB;
+    float lenX = max(abs(dc), abs(cb));
+    lenX = lenX > 0.0f ? 1.0f / lenX : 0.0f;
+    float dirX = lD - lB;
+    dir.x += dirX * w;
+    lenX = clamp(abs(dirX) * lenX, 0.0f, 1.0f);
+    len += lenX * lenX * w;
+
+    float ec = lE - lC;
+    float ca = lC - lA;
+    float lenY = max(abs(ec), abs(ca));
+    lenY = lenY > 0.0f ? 1.0f / lenY : 0.0f;
+    float dirY = lE - lA;
+    dir.y += dirY * w;
+    lenY = clamp(abs(dirY) * lenY, 0.0f, 1.0f);
+    len += lenY * lenY * w;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void EasuTap(inout vec3 aC, inout float aW, vec2 off, vec2 dir, vec2 len, float lob, float clp, vec3 c)
+{
+    // Rotate offset into edge space & anisotropic scale
+    vec2 v = vec2(off.x * dir.x + off.y * dir.y, off.x * -dir.y + off.y * dir.x) * len;
+    float d2 = min(dot(v, v), clp);
+
+    // Polynomial approximation of lanczos2 window * base
+    float wB = 2.0f / 5.0f * d2 - 1.0f;
+    float wA = lob * d2 - 1.0f;
+    wB *= wB;
+    wA *= wA;
+    wB = 25.0f / 16.0f * wB - (25.0f / 16.0f - 1.0f);
+    float w = wB * wA;
+
+    aC += c * w;
+    aW += w;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    // Output pixel center in input texel space
+    vec2 pp = gl_FragCoord.xy * pushData.easuScale.xy - 0.5f;
+    vec2 fp = floor(pp);
+    pp -= fp;
+    ivec2 p = ivec2(fp);
+
+    vec3 b = Fetch(p + ivec2( 0, -1));
+    vec3 c = Fetch(p + ivec2( 1, -1));
+    vec3 e = Fetch(p + ivec2(-1,  0));
+    vec3 f = Fetch(p + ivec2( 0,  0));
+    vec3 g = Fetch(p + ivec2( 1,  0));
+    vec3 h = Fetch(p + ivec2( 2,  0));
+    vec3 i = Fetch(p + ivec2(-1,  1));
+    vec3 j = Fetch(p + ivec2( 0,  1));
+    vec3 k = Fetch(p + ivec2( 1,  1));
+    vec3 l = Fetch(p + ivec2( 2,  1));
+    vec3 n = Fetch(p + ivec2( 0,  2));
+    vec3 o = Fetch(p + ivec2( 1,  2));
+
+    float bL = Luma(b); float cL = Luma(c); float eL = Luma(e); float fL = Luma(f);
+    float gL = Luma(g); float hL = Luma(h); float iL = Luma(i); float jL = Luma(j);
+    float kL = Luma(k); float lL = Luma(l); float nL = Luma(n); float oL = Luma(o);
+
+    //--- Edge direction & length, bilinear weighted over the 4 quadrants
+    vec2 dir = vec2(0.0f);
+    float len = 0.0f;
+    EasuSet(dir, len, (1.0f - pp.x) * (1.0f - pp.y), bL, eL, fL, gL, jL);
+    EasuSet(dir, len, pp.x * (1.0f - pp.y),          cL, fL, gL, hL, kL);
+    EasuSet(dir, len, (1.0f - pp.x) * pp.y,          fL, iL, jL, kL, nL);
+    EasuSet(dir, len, pp.x * pp.y,                   gL, jL, kL, lL, oL);
+
+    // Normalize direction, flat areas fall back to x axis
+    float dirR = dot(dir, dir);
+    bool bZero = dirR < 1.0f / 32768.0f;
+    dir = bZero ? vec2(1.0f, 0.0f) : dir * inversesqrt(dirR);
+
+    // Shape kernel: stretch along edge & make lobe negative only on strong edges
+    len = len * 0.5f;
+    len *= len;
+    float stretch = dot(dir, dir) / max(abs(dir.x), abs(dir.y));
+    vec2 len2 = vec2(1.0f + (stretch - 1.0f) * len, 1.0f - 0.5f * len);
+    float lob = 0.5f + ((1.0f / 4.0f - 0.04f) - 0.5f) * len;
+    float clp = 1.0f / lob;
+
+    //--- Filter
+    vec3 aC = vec3(0.0f);
+    float aW = 0.0f;
+    EasuTap(aC, aW, vec2( 0.0f, -1.0f) - pp, dir, len2, lob, clp, b);
+    EasuTap(aC, aW, vec2( 1.0f, -1.0f) - pp, dir, len2, lob, clp, c);
+    EasuTap(aC, aW, vec2(-1.0f,  1.0f) - pp, dir, len2, lob, clp, i);
+    EasuTap(aC, aW, vec2( 0.0f,  1.0f) - pp, dir, len2, lob, clp, j);
+    EasuTap(aC, aW, vec2( 0.0f,  0.0f) - pp, dir, len2, lob, clp, f);
+    EasuTap(aC, aW, vec2(-1.0f,  0.0f) - pp, dir, len2, lob, clp, e);
+    EasuTap(aC, aW, vec2( 1.0f,  1.0f) - pp, dir, len2, lob, clp, k);
+    EasuTap(aC, aW, vec2( 2.0f,  1.0f) - pp, dir, len2, lob, clp, l);
+    EasuTap(aC, aW, vec2( 2.0f,  0.0f) - pp, dir, len2, lob, clp, h);
+    EasuTap(aC, aW, vec2( 1.0f,  0.0f) - pp, dir, len2, lob, clp, g);
+    EasuTap(aC, aW, vec2( 1.0f,  2.0f) - pp, dir, len2, lob, clp, o);
+    EasuTap(aC, aW, vec2( 0.0f,  2.0f) - pp, dir, len2, lob, clp, n);
+
+    // Deringing, clamp to range of the 4 nearest texels
+    vec3 minC = min(min(f, g), min(j, k));
+    vec3 maxC = max(max(f, g), max(j, k));
+
+    outColor = vec4(clamp(aC / aW, minC, maxC), 1.0f);
+}
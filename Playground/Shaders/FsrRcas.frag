@@ -0,0 +1,49 @@
+#version 450
+
+// FSR1 RCAS (robust contrast adaptive sharpening), fp32 port of the reference algorithm.
+// Sharpens with a 5 tap cross, lobe weight is limited so the result never leaves the local min/max range.
+//
+//   b
+// d e f
+//   h
+
+// EASU output, same size as swapchain image
+layout(set = 0, binding = 0) uniform sampler2D samplerUpscaled;
+
+layout(push_constant) uniform UpscaleData
+{
+    vec4 uvScaleMax;        // bilinear upscale only
+    vec4 easuScale;         // xy - render extent / output extent, zw - last valid texel of render extent
+    vec4 rcasParams;        // x - sharpness as linear scale
+} pushData;
+
+layout(location = 0) out vec4 outColor;
+
+// Limits lobe so sharpening can't blow up on single pixel noise
+const float RCAS_LIMIT = 0.25f - 1.0f / 16.0f;
+
+//---------------------------------------------------------------------------------------------------------------------
+void main()
+{
+    ivec2 p = ivec2(gl_FragCoord.xy);
+    ivec2 maxTexel = textureSize(samplerUpscaled, 0) - 1;
+
+    vec3 b = texelFetch(samplerUpscaled, clamp(p + ivec2( 0, -1), ivec2(0), maxTexel), 0).rgb;
+    vec3 d = texelFetch(samplerUpscaled, clamp(p + ivec2(-1,  0), ivec2(0), maxTexel), 0).rgb;
+    vec3 e = texelFetch(samplerUpscaled, p, 0).rgb;
+    vec3 f = texelFetch(samplerUpscaled, clamp(p + ivec2( 1,  0), ivec2(0), maxTexel), 0).rgb;
+    vec3 h = texelFetch(samplerUpscaled, clamp(p + ivec2( 0,  1), ivec2(0), maxTexel), 0).rgb;
+
+    vec3 mn4 = min(min(b, d), min(f, h));
+    vec3 mx4 = max(max(b, d), max(f, h));
+
+    // Largest negative lobe that keeps output inside [0, 1] for each channel
+    vec3 hitMin = mn4 / max(4.0f * mx4, vec3(1e-5f));
+    vec3 hitMax = (1.0f - mx4) / min(4.0f * mn4 - 4.0f, vec3(-1e-5f));
+    vec3 lobeRGB = max(-hitMin, hitMax);
+    float lobe = max(-RCAS_LIMIT, min(max(lobeRGB.r, max(lobeRGB.g, lobeRGB.b)), 0.0f)) * pushData.rcasParams.x;
+
+    vec3 color = (lobe * (b + d + f + h) + e) / (4.0f * lobe + 1.0f);
+
+    outColor = vec4(color, 1.0f);
+}
@@ -1,5 +1,6 @@
 #version 450
 #extension GL_ARB_separate_shader_objects : enable
+#extension GL_EXT_nonuniform_qualifier : enable
 
 // Input from Vertex Shader
 layout(location = 0) in vec3 vs_outPosition;
@@ -7,31 +8,36 @@ layout(location = 1) in vec3 vs_outNormal;
 layout(location = 2) in vec3 vs_outTangent;
 layout(location = 3) in vec3 vs_outBiNormal;
 layout(location = 4) in vec2 vs_outUV;
+layout(location = 5) flat in uint vs_outMaterialIndex;
+layout(location = 6) flat in int vs_outObjectID;
 
-layout(set = 0, binding = 0) uniform ShaderData
-{
-    mat4    matModel;
-    mat4    matView;
-    mat4    matProjection;
+// Bindless, every material texture in the scene. Must match MaterialRegistry
+layout(set = 1, binding = 0) uniform sampler2D   textures[];
 
+// Must match GPUMaterial, indices into textures[] & constants used when permutation has no such map
+struct Material
+{
+    uvec4   texturesAEN;    // x - Albedo, y - Emissive, z - Normal
+    uvec4   texturesRMO;    // x - Roughness, y - Metalness, z - Occlusion
     vec4    albedoColor;
     vec4    emissiveColor;
-    vec3    hasTextureAEN;
-    vec3    hasTextureRMO;
-
-    float   ao;
-    float   roughness;
-    float   metalness;
-    int     objectID;
-} shaderData;
-
-// Uniform variable
-layout(set = 0, binding = 1) uniform sampler2D   samplerBaseTexture;
-layout(set = 0, binding = 2) uniform sampler2D   samplerMetalnessTexture;
-layout(set = 0, binding = 3) uniform sampler2D   samplerNormalTexture;
-layout(set = 0, binding = 4) uniform sampler2D   samplerRoughnessTexture;
-layout(set = 0, binding = 5) uniform sampler2D   samplerAOTexture;
-layout(set = 0, binding = 6) uniform sampler2D   samplerEmissionTexture;
+    vec4    properties;     // x - AO, y - Roughness, z - Metalness
+};
+
+// Pipeline permutation, must match MaterialFeature in MaterialRegistry.h. Branches below fold away at pipeline creation
+layout(constant_id = 0) const uint MATERIAL_FEATURES = 0x3Fu;
+
+const uint FEATURE_ALBEDO_MAP       = 0x01u;
+const uint FEATURE_EMISSIVE_MAP     = 0x02u;
+const uint FEATURE_NORMAL_MAP       = 0x04u;
+const uint FEATURE_ROUGHNESS_MAP    = 0x08u;
+const uint FEATURE_METALNESS_MAP    = 0x10u;
+const uint FEATURE_OCCLUSION_MAP    = 0x20u;
+
+layout(set = 1, binding = 1) readonly buffer Materials
+{
+    Material materials[];
+};
 
 // output to second subpass!
 layout(location = 0) out vec4 outColor;
@@ -51,23 +57,26 @@ void main()
     vec4 AOColor            = vec4(0.0f);
     vec4 EmissionColor      = vec4(0.0f);
 
+    // Index is per object, one GPU driven draw call covers many objects so texture indices aren't dynamically uniform!
+    Material material       = materials[vs_outMaterialIndex];
+
     //---- Extract Base Color
-    if(shaderData.hasTextureAEN.r == 1)
-        baseColor       = texture(samplerBaseTexture, vs_outUV);
+    if((MATERIAL_FEATURES & FEATURE_ALBEDO_MAP) != 0u)
+        baseColor       = texture(textures[nonuniformEXT(material.texturesAEN.x)], vs_outUV);
     else    
-        baseColor       = shaderData.albedoColor;
+        baseColor       = material.albedoColor;
 
     //---- Extract Emissive Color
-    if(shaderData.hasTextureAEN.g == 1)
-        EmissionColor   = texture(samplerEmissionTexture, vs_outUV);
+    if((MATERIAL_FEATURES & FEATURE_EMISSIVE_MAP) != 0u)
+        EmissionColor   = texture(textures[nonuniformEXT(material.texturesAEN.y)], vs_outUV);
     else
-        EmissionColor   = shaderData.emissiveColor;
+        EmissionColor   = material.emissiveColor;
 
     //---- Extract Normal Color
     vec3 Normal = vec3(0);
-    if(shaderData.hasTextureAEN.b == 1)
+    if((MATERIAL_FEATURES & FEATURE_NORMAL_MAP) != 0u)
     {
-        NormalColor = texture(samplerNormalTexture, vs_outUV);
+        NormalColor = texture(textures[nonuniformEXT(material.texturesAEN.z)], vs_outUV);
           
         // Calculate normal in Tangent space
         vec3 N = normalize(vs_outNormal);
@@ -81,22 +90,22 @@ void main()
         Normal = normalize(((vs_outNormal) + vec3(1)) / 2.0f);
 
     //---- Extract Roughness Color
-    if(shaderData.hasTextureRMO.r == 1)
-        RoughnessColor  = texture(samplerRoughnessTexture, vs_outUV);
+    if((MATERIAL_FEATURES & FEATURE_ROUGHNESS_MAP) != 0u)
+        RoughnessColor  = texture(textures[nonuniformEXT(material.texturesRMO.x)], vs_outUV);
     else    
-        RoughnessColor  = vec4(vec3(shaderData.roughness), 1);
+        RoughnessColor  = vec4(vec3(material.properties.y), 1);
 
     //---- Extract Metalness Color
-    if(shaderData.hasTextureRMO.g == 1)
-        MetalnessColor  = texture(samplerMetalnessTexture, vs_outUV);
+    if((MATERIAL_FEATURES & FEATURE_METALNESS_MAP) != 0u)
+        MetalnessColor  = texture(textures[nonuniformEXT(material.texturesRMO.y)], vs_outUV);
     else    
-        MetalnessColor  = vec4(vec3(shaderData.metalness), 1);
+        MetalnessColor  = vec4(vec3(material.properties.z), 1);
 
     //---- Extract Occlusion Color
-    if(shaderData.hasTextureRMO.b == 1)
-        AOColor         = texture(samplerAOTexture, vs_outUV);
+    if((MATERIAL_FEATURES & FEATURE_OCCLUSION_MAP) != 0u)
+        AOColor         = texture(textures[nonuniformEXT(material.texturesRMO.z)], vs_outUV);
     else    
-        AOColor         = vec4(vec3(shaderData.ao), 1);    
+        AOColor         = vec4(vec3(material.properties.x), 1);    
 
      // Write to Color G-Buffer
     outColor = baseColor;
@@ -114,9 +123,10 @@ void main()
     outEmission = vec4(EmissionColor.rgb, 0.0f);
 
     // Write to ID buffer
-    switch(shaderData.objectID)
+    switch(vs_outObjectID)
     {
         case 1: // STATIC_OPAQUE
+        case 2: // STATIC_OPAQUE_INSTANCED
         {
             outObjID = vec4(1, 0, 0, 1);
             break;
@@ -7,45 +7,65 @@ layout(location=2) in vec3 in_Tangent;
 layout(location=3) in vec3 in_BiNormal;
 layout(location=4) in vec2 in_UV;
 
-layout(set = 0, binding = 0) uniform ShaderData
+// Per frame globals, must match FrameShaderData
+layout(set = 0, binding = 0) uniform FrameData
 {
-    mat4    matModel;
     mat4    matView;
     mat4    matProjection;
+    mat4    matViewProjection;
+    vec4    cameraPosition;
+    vec4    lightProperties;
+} frameData;
 
-    vec4    albedoColor;
-    vec4    emissiveColor;
-    vec3    hasTextureAEN;
-    vec3    hasTextureRMO;
-    float   ao;
-    float   roughness;
-    float   metalness;
+// Per object, must match ObjectShaderData in Mesh.h. Rewritten every frame, so transforms never touch command buffers
+struct ObjectData
+{
+    mat4    matModel;
     int     objectID;
-} shaderData;
+    uint    materialIndex;
+    uint    pad0;
+    uint    pad1;
+};
 
-// NOT IN USE, LEFT FOR REFERENCE
-//layout (push_constant) uniform PushModel
-//{
-//    mat4 matModel;
-//} pushModel;
+layout(set = 0, binding = 1) readonly buffer Objects
+{
+    ObjectData objects[];
+};
+
+// Per draw, must match PushConstantData in Mesh.h. Slot of the model in objects[], offset by gl_InstanceIndex: CPU
+// recorded draws push the slot & draw one instance, GPU driven draws push 0 & carry the slot in firstInstance
+layout(push_constant) uniform PushObject
+{
+    uint    objectIndex;
+} pushObject;
 
 layout(location=0) out vec3 vs_outPosition;
 layout(location=1) out vec3 vs_outNormal;
 layout(location=2) out vec3 vs_outTangent;
 layout(location=3) out vec3 vs_outBiNormal;
 layout(location=4) out vec2 vs_outUV;
+layout(location=5) flat out uint vs_outMaterialIndex;
+layout(location=6) flat out int vs_outObjectID;
+
+// Same transform as DepthPrepass.vert, EQUAL depth test relies on identical results
+invariant gl_Position;
 
 void main()
 {
-    gl_Position     = shaderData.matProjection * shaderData.matView * shaderData.matModel * vec4(in_Position, 1.0f);
+    ObjectData object = objects[pushObject.objectIndex + gl_InstanceIndex];
+
+    gl_Position     = frameData.matViewProjection * object.matModel * vec4(in_Position, 1.0f);
 
     // World Space Position 
-    vs_outPosition  = (shaderData.matModel * vec4(in_Position, 1.0f)).xyz;
+    vs_outPosition  = (object.matModel * vec4(in_Position, 1.0f)).xyz;
 
     // World Space Normal, Tangent & BiNormal
-    vs_outNormal    = normalize(shaderData.matModel * vec4(in_Normal, 0.0f)).xyz;
-    vs_outTangent   = normalize(shaderData.matModel * vec4(in_Tangent, 0.0f)).xyz;
-    vs_outBiNormal  = normalize(shaderData.matModel * vec4(in_BiNormal, 0.0f)).xyz;
+    vs_outNormal    = normalize(object.matModel * vec4(in_Normal, 0.0f)).xyz;
+    vs_outTangent   = normalize(object.matModel * vec4(in_Tangent, 0.0f)).xyz;
+    vs_outBiNormal  = normalize(object.matModel * vec4(in_BiNormal, 0.0f)).xyz;
 
     vs_outUV = in_UV;
+
+    vs_outMaterialIndex = object.materialIndex;
+    vs_outObjectID      = object.objectID;
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#version 450
+#extension GL_ARB_separate_shader_objects : enable
+
+layout(location=0) in vec3 in_Position;
+layout(location=1) in vec3 in_Normal;
+layout(location=2) in vec3 in_Tangent;
+layout(location=3) in vec3 in_BiNormal;
+layout(location=4) in vec2 in_UV;
+
+// Per instance stream, mat4 takes 4 consecutive locations
+layout(location=5) in mat4 in_InstanceTransform;
+
+// Per frame globals, must match FrameShaderData
+layout(set = 0, binding = 0) uniform FrameData
+{
+    mat4    matView;
+    mat4    matProjection;
+    mat4    matViewProjection;
+    vec4    cameraPosition;
+    vec4    lightProperties;
+} frameData;
+
+// Per object, must match ObjectShaderData in Mesh.h. Rewritten every frame, so transforms never touch command buffers
+struct ObjectData
+{
+    mat4    matModel;
+    int     objectID;
+    uint    materialIndex;
+    uint    pad0;
+    uint    pad1;
+};
+
+layout(set = 0, binding = 1) readonly buffer Objects
+{
+    ObjectData objects[];
+};
+
+// Per draw, must match PushConstantData in Mesh.h. Slot of the model in objects[]
+layout(push_constant) uniform PushObject
+{
+    uint    objectIndex;
+} pushObject;
+
+layout(location=0) out vec3 vs_outPosition;
+layout(location=1) out vec3 vs_outNormal;
+layout(location=2) out vec3 vs_outTangent;
+layout(location=3) out vec3 vs_outBiNormal;
+layout(location=4) out vec2 vs_outUV;
+layout(location=5) flat out uint vs_outMaterialIndex;
+layout(location=6) flat out int vs_outObjectID;
+
+void main()
+{
+    ObjectData object = objects[pushObject.objectIndex];
+
+    // Instance transform is relative to the model transform of the group
+    mat4 matWorld   = object.matModel * in_InstanceTransform;
+
+    gl_Position     = frameData.matViewProjection * matWorld * vec4(in_Position, 1.0f);
+
+    // World Space Position 
+    vs_outPosition  = (matWorld * vec4(in_Position, 1.0f)).xyz;
+
+    // World Space Normal, Tangent & BiNormal
+    vs_outNormal    = normalize(matWorld * vec4(in_Normal, 0.0f)).xyz;
+    vs_outTangent   = normalize(matWorld * vec4(in_Tangent, 0.0f)).xyz;
+    vs_outBiNormal  = normalize(matWorld * vec4(in_BiNormal, 0.0f)).xyz;
+
+    vs_outUV = in_UV;
+
+    vs_outMaterialIndex = object.materialIndex;
+    vs_outObjectID      = object.objectID;
+}
\ No newline at end of file
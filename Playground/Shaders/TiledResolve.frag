@@ -0,0 +1,24 @@
+#version 450
+
+// Full screen triangle over scene color, render extent only
+layout(location = 0) in vec2 vs_outNDC;
+
+// Lit HDR output of TiledLighting.comp, alpha 0 marks sky pixels
+layout(set = 0, binding = 0) uniform sampler2D samplerHDR;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    vec4 HDRColor = texelFetch(samplerHDR, ivec2(gl_FragCoord.xy), 0);
+
+    // Sky was already composited by DeferredSky.frag in the main render pass
+    if (HDRColor.a == 0.0f)
+        discard;
+
+    // Same tone mapping & gamma as Deferred.frag so both paths match
+    vec3 Color = HDRColor.rgb / (HDRColor.rgb + vec3(1));
+    Color = pow(Color, vec3(0.4545f));
+
+    outColor = vec4(Color, 1);
+}
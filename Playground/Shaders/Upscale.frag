@@ -0,0 +1,22 @@
+#version 450
+
+// Full screen triangle over swapchain image
+layout(location = 0) in vec2 vs_outNDC;
+
+// Lit scene, only the top left render extent subrect is valid
+layout(set = 0, binding = 0) uniform sampler2D samplerSceneColor;
+
+layout(push_constant) uniform UpscaleData
+{
+    vec4 uvScaleMax;        // xy - render extent / scene color size, zw - max uv keeping taps inside render rect
+    vec4 easuScale;         // FSR1 only
+    vec4 rcasParams;        // FSR1 only
+} pushData;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    vec2 uv  = (vs_outNDC * 0.5f + 0.5f) * pushData.uvScaleMax.xy;
+    outColor = textureLod(samplerSceneColor, min(uv, pushData.uvScaleMax.zw), 0.0f);
+}
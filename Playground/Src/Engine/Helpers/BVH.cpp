@@ -0,0 +1,499 @@
+#include "PlaygroundPCH.h"
+#include "PlaygroundHeaders.h"
+#include "BVH.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+static BoundingBox Combine(const BoundingBox& a, const BoundingBox& b)
+{
+	BoundingBox box;
+	box.vecMin = glm::min(a.vecMin, b.vecMin);
+	box.vecMax = glm::max(a.vecMax, b.vecMax);
+
+	return box;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+static float SurfaceArea(const BoundingBox& box)
+{
+	glm::vec3 d = box.vecMax - box.vecMin;
+	return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+static bool Contains(const BoundingBox& outer, const BoundingBox& inner)
+{
+	return	glm::all(glm::lessThanEqual(outer.vecMin, inner.vecMin)) &&
+			glm::all(glm::greaterThanEqual(outer.vecMax, inner.vecMax));
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+BVH::BVH()
+{
+	m_vecNodes.clear();
+	m_iRoot = -1;
+	m_iFreeList = -1;
+	m_uiProxyCount = 0;
+	m_fMargin = 0.1f;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+BVH::~BVH()
+{
+	m_vecNodes.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::Clear()
+{
+	m_vecNodes.clear();
+	m_iRoot = -1;
+	m_iFreeList = -1;
+	m_uiProxyCount = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int32_t BVH::AllocateNode()
+{
+	// Grow pool & chain new nodes into free list
+	if (m_iFreeList == -1)
+	{
+		int32_t iOldSize = static_cast<int32_t>(m_vecNodes.size());
+		int32_t iNewSize = std::max(16, iOldSize * 2);
+
+		m_vecNodes.resize(iNewSize);
+		for (int32_t i = iOldSize; i < iNewSize; ++i)
+		{
+			m_vecNodes[i].iNext = (i + 1 < iNewSize) ? i + 1 : -1;
+			m_vecNodes[i].iHeight = -1;
+		}
+
+		m_iFreeList = iOldSize;
+	}
+
+	int32_t iNode = m_iFreeList;
+	m_iFreeList = m_vecNodes[iNode].iNext;
+
+	BVHNode& node = m_vecNodes[iNode];
+	node.iParent = -1;
+	node.iChild1 = -1;
+	node.iChild2 = -1;
+	node.iHeight = 0;
+	node.pUserData = nullptr;
+
+	return iNode;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::FreeNode(int32_t iNode)
+{
+	m_vecNodes[iNode].iNext = m_iFreeList;
+	m_vecNodes[iNode].iHeight = -1;
+	m_iFreeList = iNode;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+int32_t BVH::CreateProxy(const BoundingBox& aabb, void* pUserData)
+{
+	int32_t iProxy = AllocateNode();
+
+	m_vecNodes[iProxy].aabb.vecMin = aabb.vecMin - glm::vec3(m_fMargin);
+	m_vecNodes[iProxy].aabb.vecMax = aabb.vecMax + glm::vec3(m_fMargin);
+	m_vecNodes[iProxy].pUserData = pUserData;
+
+	InsertLeaf(iProxy);
+	++m_uiProxyCount;
+
+	return iProxy;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::DestroyProxy(int32_t iProxy)
+{
+	if (iProxy < 0 || iProxy >= static_cast<int32_t>(m_vecNodes.size()) || !m_vecNodes[iProxy].IsLeaf())
+	{
+		LOG_ERROR("Invalid BVH proxy {0}!", iProxy);
+		return;
+	}
+
+	RemoveLeaf(iProxy);
+	FreeNode(iProxy);
+	--m_uiProxyCount;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool BVH::MoveProxy(int32_t iProxy, const BoundingBox& aabb)
+{
+	// Still inside fat box, nothing to do!
+	if (Contains(m_vecNodes[iProxy].aabb, aabb))
+		return false;
+
+	RemoveLeaf(iProxy);
+
+	m_vecNodes[iProxy].aabb.vecMin = aabb.vecMin - glm::vec3(m_fMargin);
+	m_vecNodes[iProxy].aabb.vecMax = aabb.vecMax + glm::vec3(m_fMargin);
+
+	InsertLeaf(iProxy);
+
+	return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::InsertLeaf(int32_t iLeaf)
+{
+	if (m_iRoot == -1)
+	{
+		m_iRoot = iLeaf;
+		m_vecNodes[m_iRoot].iParent = -1;
+		return;
+	}
+
+	// Find best sibling, descend towards child with lowest SAH cost increase
+	BoundingBox leafAABB = m_vecNodes[iLeaf].aabb;
+	int32_t iIndex = m_iRoot;
+
+	while (!m_vecNodes[iIndex].IsLeaf())
+	{
+		int32_t iChild1 = m_vecNodes[iIndex].iChild1;
+		int32_t iChild2 = m_vecNodes[iIndex].iChild2;
+
+		float fArea = SurfaceArea(m_vecNodes[iIndex].aabb);
+		float fCombinedArea = SurfaceArea(Combine(m_vecNodes[iIndex].aabb, leafAABB));
+
+		// cost of creating new parent for this node & the new leaf
+		float fCost = 2.0f * fCombinedArea;
+
+		// minimum cost of pushing the leaf further down the tree
+		float fInheritanceCost = 2.0f * (fCombinedArea - fArea);
+
+		auto ChildCost = [&](int32_t iChild)
+		{
+			BoundingBox combined = Combine(leafAABB, m_vecNodes[iChild].aabb);
+			if (m_vecNodes[iChild].IsLeaf())
+				return SurfaceArea(combined) + fInheritanceCost;
+
+			return (SurfaceArea(combined) - SurfaceArea(m_vecNodes[iChild].aabb)) + fInheritanceCost;
+		};
+
+		float fCost1 = ChildCost(iChild1);
+		float fCost2 = ChildCost(iChild2);
+
+		if (fCost < fCost1 && fCost < fCost2)
+			break;
+
+		iIndex = (fCost1 < fCost2) ? iChild1 : iChild2;
+	}
+
+	int32_t iSibling = iIndex;
+
+	// Create new parent
+	int32_t iOldParent = m_vecNodes[iSibling].iParent;
+	int32_t iNewParent = AllocateNode();
+	m_vecNodes[iNewParent].iParent = iOldParent;
+	m_vecNodes[iNewParent].aabb = Combine(leafAABB, m_vecNodes[iSibling].aabb);
+	m_vecNodes[iNewParent].iHeight = m_vecNodes[iSibling].iHeight + 1;
+	m_vecNodes[iNewParent].iChild1 = iSibling;
+	m_vecNodes[iNewParent].iChild2 = iLeaf;
+	m_vecNodes[iSibling].iParent = iNewParent;
+	m_vecNodes[iLeaf].iParent = iNewParent;
+
+	if (iOldParent != -1)
+	{
+		if (m_vecNodes[iOldParent].iChild1 == iSibling)
+			m_vecNodes[iOldParent].iChild1 = iNewParent;
+		else
+			m_vecNodes[iOldParent].iChild2 = iNewParent;
+	}
+	else
+	{
+		m_iRoot = iNewParent;
+	}
+
+	// Walk back up & fix heights & boxes
+	Refit(m_vecNodes[iLeaf].iParent);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::RemoveLeaf(int32_t iLeaf)
+{
+	if (iLeaf == m_iRoot)
+	{
+		m_iRoot = -1;
+		return;
+	}
+
+	int32_t iParent = m_vecNodes[iLeaf].iParent;
+	int32_t iGrandParent = m_vecNodes[iParent].iParent;
+	int32_t iSibling = (m_vecNodes[iParent].iChild1 == iLeaf) ? m_vecNodes[iParent].iChild2 : m_vecNodes[iParent].iChild1;
+
+	if (iGrandParent != -1)
+	{
+		// Destroy parent & connect sibling to grand parent
+		if (m_vecNodes[iGrandParent].iChild1 == iParent)
+			m_vecNodes[iGrandParent].iChild1 = iSibling;
+		else
+			m_vecNodes[iGrandParent].iChild2 = iSibling;
+
+		m_vecNodes[iSibling].iParent = iGrandParent;
+		FreeNode(iParent);
+
+		Refit(iGrandParent);
+	}
+	else
+	{
+		m_iRoot = iSibling;
+		m_vecNodes[iSibling].iParent = -1;
+		FreeNode(iParent);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Incremental refit, only ancestors of the changed node are touched!
+void BVH::Refit(int32_t iNode)
+{
+	while (iNode != -1)
+	{
+		iNode = Balance(iNode);
+
+		int32_t iChild1 = m_vecNodes[iNode].iChild1;
+		int32_t iChild2 = m_vecNodes[iNode].iChild2;
+
+		m_vecNodes[iNode].iHeight = 1 + std::max(m_vecNodes[iChild1].iHeight, m_vecNodes[iChild2].iHeight);
+		m_vecNodes[iNode].aabb = Combine(m_vecNodes[iChild1].aabb, m_vecNodes[iChild2].aabb);
+
+		iNode = m_vecNodes[iNode].iParent;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Performs left or right rotation if node A is imbalanced. Returns the new root index of this sub tree.
+int32_t BVH::Balance(int32_t iA)
+{
+	BVHNode* A = &m_vecNodes[iA];
+	if (A->IsLeaf() || A->iHeight < 2)
+		return iA;
+
+	int32_t iB = A->iChild1;
+	int32_t iC = A->iChild2;
+	BVHNode* B = &m_vecNodes[iB];
+	BVHNode* C = &m_vecNodes[iC];
+
+	int32_t iBalance = C->iHeight - B->iHeight;
+
+	// Rotate C up, or B up. Both cases are mirrors of each other
+	auto Rotate = [&](int32_t iUp, BVHNode* Up, int32_t iOther, BVHNode* Other, bool bUpIsChild2)
+	{
+		int32_t iF = Up->iChild1;
+		int32_t iG = Up->iChild2;
+		BVHNode* F = &m_vecNodes[iF];
+		BVHNode* G = &m_vecNodes[iG];
+
+		// Swap A & Up
+		Up->iChild1 = iA;
+		Up->iParent = A->iParent;
+		A->iParent = iUp;
+
+		// A's old parent should point to Up
+		if (Up->iParent != -1)
+		{
+			if (m_vecNodes[Up->iParent].iChild1 == iA)
+				m_vecNodes[Up->iParent].iChild1 = iUp;
+			else
+				m_vecNodes[Up->iParent].iChild2 = iUp;
+		}
+		else
+		{
+			m_iRoot = iUp;
+		}
+
+		// Keep taller grand child under Up, move shorter one under A
+		int32_t iKeep = (F->iHeight > G->iHeight) ? iF : iG;
+		int32_t iMove = (F->iHeight > G->iHeight) ? iG : iF;
+
+		Up->iChild2 = iKeep;
+		if (bUpIsChild2)
+			A->iChild2 = iMove;
+		else
+			A->iChild1 = iMove;
+
+		m_vecNodes[iMove].iParent = iA;
+
+		A->aabb = Combine(Other->aabb, m_vecNodes[iMove].aabb);
+		Up->aabb = Combine(A->aabb, m_vecNodes[iKeep].aabb);
+
+		A->iHeight = 1 + std::max(Other->iHeight, m_vecNodes[iMove].iHeight);
+		Up->iHeight = 1 + std::max(A->iHeight, m_vecNodes[iKeep].iHeight);
+	};
+
+	if (iBalance > 1)
+	{
+		Rotate(iC, C, iB, B, true);
+		return iC;
+	}
+
+	if (iBalance < -1)
+	{
+		Rotate(iB, B, iC, C, false);
+		return iB;
+	}
+
+	return iA;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::CollectLeaves(int32_t iNode, std::vector<void*>& vecResult) const
+{
+	std::vector<int32_t> vecStack;
+	vecStack.reserve(64);
+	vecStack.push_back(iNode);
+
+	while (!vecStack.empty())
+	{
+		const BVHNode& node = m_vecNodes[vecStack.back()];
+		vecStack.pop_back();
+
+		if (node.IsLeaf())
+		{
+			vecResult.push_back(node.pUserData);
+		}
+		else
+		{
+			vecStack.push_back(node.iChild1);
+			vecStack.push_back(node.iChild2);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::QueryFrustum(const Frustum& frustum, std::vector<void*>& vecResult) const
+{
+	if (m_iRoot == -1)
+		return;
+
+	std::vector<int32_t> vecStack;
+	vecStack.reserve(64);
+	vecStack.push_back(m_iRoot);
+
+	while (!vecStack.empty())
+	{
+		int32_t iNode = vecStack.back();
+		vecStack.pop_back();
+
+		const BVHNode& node = m_vecNodes[iNode];
+
+		FrustumTest result = frustum.Classify(node.aabb);
+		if (result == FrustumTest::OUTSIDE)
+			continue;
+
+		// Whole sub tree is inside, no more plane tests needed
+		if (result == FrustumTest::INSIDE)
+		{
+			CollectLeaves(iNode, vecResult);
+			continue;
+		}
+
+		if (node.IsLeaf())
+		{
+			vecResult.push_back(node.pUserData);
+		}
+		else
+		{
+			vecStack.push_back(node.iChild1);
+			vecStack.push_back(node.iChild2);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::QuerySphere(const glm::vec3& center, float fRadius, std::vector<void*>& vecResult) const
+{
+	if (m_iRoot == -1)
+		return;
+
+	float fRadiusSq = fRadius * fRadius;
+
+	std::vector<int32_t> vecStack;
+	vecStack.reserve(64);
+	vecStack.push_back(m_iRoot);
+
+	while (!vecStack.empty())
+	{
+		const BVHNode& node = m_vecNodes[vecStack.back()];
+		vecStack.pop_back();
+
+		// squared distance from sphere center to closest point on box
+		glm::vec3 closest = glm::clamp(center, node.aabb.vecMin, node.aabb.vecMax);
+		glm::vec3 delta = closest - center;
+		if (glm::dot(delta, delta) > fRadiusSq)
+			continue;
+
+		if (node.IsLeaf())
+		{
+			vecResult.push_back(node.pUserData);
+		}
+		else
+		{
+			vecStack.push_back(node.iChild1);
+			vecStack.push_back(node.iChild2);
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BVH::QueryRay(const glm::vec3& origin, const glm::vec3& direction, float fMaxDistance, std::vector<void*>& vecResult) const
+{
+	if (m_iRoot == -1)
+		return;
+
+	// Axis parallel components get no reciprocal, 0 * inf on a slab boundary is NaN & would silently drop the node.
+	// Ray never crosses those slabs, so origin has to lie within them instead
+	const float fParallelEpsilon = 1e-8f;
+	glm::bvec3 bParallel = glm::lessThan(glm::abs(direction), glm::vec3(fParallelEpsilon));
+	glm::vec3 invDirection = glm::vec3(0.0f);
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (!bParallel[axis])
+			invDirection[axis] = 1.0f / direction[axis];
+	}
+
+	std::vector<int32_t> vecStack;
+	vecStack.reserve(64);
+	vecStack.push_back(m_iRoot);
+
+	while (!vecStack.empty())
+	{
+		const BVHNode& node = m_vecNodes[vecStack.back()];
+		vecStack.pop_back();
+
+		float fEnter = 0.0f;
+		float fExit = fMaxDistance;
+		bool bMiss = false;
+
+		for (int axis = 0; axis < 3 && !bMiss; ++axis)
+		{
+			if (bParallel[axis])
+			{
+				bMiss = origin[axis] < node.aabb.vecMin[axis] || origin[axis] > node.aabb.vecMax[axis];
+				continue;
+			}
+
+			float t1 = (node.aabb.vecMin[axis] - origin[axis]) * invDirection[axis];
+			float t2 = (node.aabb.vecMax[axis] - origin[axis]) * invDirection[axis];
+
+			fEnter = std::max(fEnter, std::min(t1, t2));
+			fExit = std::min(fExit, std::max(t1, t2));
+		}
+
+		if (bMiss || fEnter > fExit)
+			continue;
+
+		if (node.IsLeaf())
+		{
+			vecResult.push_back(node.pUserData);
+		}
+		else
+		{
+			vecStack.push_back(node.iChild1);
+			vecStack.push_back(node.iChild2);
+		}
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Frustum.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+struct BVHNode
+{
+	inline bool							IsLeaf() const		{ return iChild1 == -1; }
+
+	BoundingBox							aabb;				// fattened for leaves, union of children otherwise
+	void*								pUserData;
+
+	union
+	{
+		int32_t							iParent;
+		int32_t							iNext;				// free list link when node is not in use
+	};
+
+	int32_t								iChild1;
+	int32_t								iChild2;
+	int32_t								iHeight;			// leaf = 0, free = -1
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Dynamic AABB tree. Leaves store fattened boxes so that small movements don't touch the tree, larger ones remove &
+// re-insert the leaf & refit its ancestors only. Insertion uses surface area heuristic, tree is kept balanced with
+// rotations. Proxy IDs are stable for the lifetime of a proxy!
+class BVH
+{
+public:
+	BVH();
+	~BVH();
+
+	int32_t								CreateProxy(const BoundingBox& aabb, void* pUserData);
+	void								DestroyProxy(int32_t iProxy);
+	bool								MoveProxy(int32_t iProxy, const BoundingBox& aabb);		// true if tree was modified
+	void								Clear();
+
+	inline void*						GetUserData(int32_t iProxy) const		{ return m_vecNodes[iProxy].pUserData; }
+	inline const BoundingBox&			GetFatAABB(int32_t iProxy) const		{ return m_vecNodes[iProxy].aabb; }
+	inline uint32_t						GetProxyCount() const					{ return m_uiProxyCount; }
+	inline int32_t						GetHeight() const						{ return (m_iRoot == -1) ? 0 : m_vecNodes[m_iRoot].iHeight; }
+
+	// Queries append user data of every overlapping leaf to vecResult
+	void								QueryFrustum(const Frustum& frustum, std::vector<void*>& vecResult) const;
+	void								QuerySphere(const glm::vec3& center, float fRadius, std::vector<void*>& vecResult) const;
+	void								QueryRay(const glm::vec3& origin, const glm::vec3& direction, float fMaxDistance, std::vector<void*>& vecResult) const;
+
+private:
+	int32_t								AllocateNode();
+	void								FreeNode(int32_t iNode);
+
+	void								InsertLeaf(int32_t iLeaf);
+	void								RemoveLeaf(int32_t iLeaf);
+	int32_t								Balance(int32_t iNode);
+	void								Refit(int32_t iNode);
+
+	void								CollectLeaves(int32_t iNode, std::vector<void*>& vecResult) const;
+
+private:
+	std::vector<BVHNode>				m_vecNodes;
+	int32_t								m_iRoot;
+	int32_t								m_iFreeList;
+	uint32_t							m_uiProxyCount;
+
+public:
+	float								m_fMargin;			// leaf boxes are fattened by this much on each side
+};
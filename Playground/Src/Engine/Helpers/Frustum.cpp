@@ -0,0 +1,179 @@
+#include "PlaygroundPCH.h"
+#include "Frustum.h"
+
+#include <immintrin.h>
+
+//---------------------------------------------------------------------------------------------------------------------
+// Arvo's method, transformed center + extent projected on absolute rotation/scale axes. Stays conservative!
+BoundingBox BoundingBox::Transform(const glm::mat4& matTransform) const
+{
+	glm::vec3 center = glm::vec3(matTransform * glm::vec4(GetCenter(), 1.0f));
+	glm::vec3 extent = GetExtent();
+
+	glm::vec3 newExtent =	glm::abs(glm::vec3(matTransform[0])) * extent.x +
+							glm::abs(glm::vec3(matTransform[1])) * extent.y +
+							glm::abs(glm::vec3(matTransform[2])) * extent.z;
+
+	BoundingBox box;
+	box.vecMin = center - newExtent;
+	box.vecMax = center + newExtent;
+
+	return box;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BoundingBoxStream::Clear()
+{
+	vecCenterX.clear();	vecCenterY.clear();	vecCenterZ.clear();
+	vecExtentX.clear();	vecExtentY.clear();	vecExtentZ.clear();
+	uiCount = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void BoundingBoxStream::Add(const BoundingBox& box)
+{
+	// grow in batches of 4, padding slots are empty boxes at origin which are simply ignored
+	if (uiCount % 4 == 0)
+	{
+		size_t newSize = uiCount + 4;
+		vecCenterX.resize(newSize, 0.0f);	vecCenterY.resize(newSize, 0.0f);	vecCenterZ.resize(newSize, 0.0f);
+		vecExtentX.resize(newSize, 0.0f);	vecExtentY.resize(newSize, 0.0f);	vecExtentZ.resize(newSize, 0.0f);
+	}
+
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extent = box.GetExtent();
+
+	vecCenterX[uiCount] = center.x;	vecCenterY[uiCount] = center.y;	vecCenterZ[uiCount] = center.z;
+	vecExtentX[uiCount] = extent.x;	vecExtentY[uiCount] = extent.y;	vecExtentZ[uiCount] = extent.z;
+
+	++uiCount;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+Frustum::Frustum()
+{
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		m_arrPlanes[i] = glm::vec4(0, 0, 0, 1);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Frustum::ExtractPlanes(const glm::mat4& matViewProjection)
+{
+	// glm is column major, build rows first
+	glm::vec4 row0 = glm::vec4(matViewProjection[0][0], matViewProjection[1][0], matViewProjection[2][0], matViewProjection[3][0]);
+	glm::vec4 row1 = glm::vec4(matViewProjection[0][1], matViewProjection[1][1], matViewProjection[2][1], matViewProjection[3][1]);
+	glm::vec4 row2 = glm::vec4(matViewProjection[0][2], matViewProjection[1][2], matViewProjection[2][2], matViewProjection[3][2]);
+	glm::vec4 row3 = glm::vec4(matViewProjection[0][3], matViewProjection[1][3], matViewProjection[2][3], matViewProjection[3][3]);
+
+	m_arrPlanes[0] = row3 + row0;		// Left
+	m_arrPlanes[1] = row3 - row0;		// Right
+	m_arrPlanes[2] = row3 + row1;		// Bottom
+	m_arrPlanes[3] = row3 - row1;		// Top
+	m_arrPlanes[4] = row3 + row2;		// Near (GL style -w..w depth, conservative for 0..w as well)
+	m_arrPlanes[5] = row3 - row2;		// Far
+
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		m_arrPlanes[i] /= glm::length(glm::vec3(m_arrPlanes[i]));
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool Frustum::IsVisible(const BoundingBox& box) const
+{
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extent = box.GetExtent();
+
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		glm::vec3 normal = glm::vec3(m_arrPlanes[i]);
+
+		float fDistance = glm::dot(normal, center) + m_arrPlanes[i].w;
+		float fRadius = glm::dot(glm::abs(normal), extent);
+
+		if (fDistance + fRadius < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Same as IsVisible but also tells if box is completely inside, lets hierarchies skip testing children!
+FrustumTest Frustum::Classify(const BoundingBox& box) const
+{
+	glm::vec3 center = box.GetCenter();
+	glm::vec3 extent = box.GetExtent();
+
+	FrustumTest result = FrustumTest::INSIDE;
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		glm::vec3 normal = glm::vec3(m_arrPlanes[i]);
+
+		float fDistance = glm::dot(normal, center) + m_arrPlanes[i].w;
+		float fRadius = glm::dot(glm::abs(normal), extent);
+
+		if (fDistance + fRadius < 0.0f)
+			return FrustumTest::OUTSIDE;
+
+		if (fDistance - fRadius < 0.0f)
+			result = FrustumTest::INTERSECT;
+	}
+
+	return result;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Frustum::CullBoxes(const BoundingBoxStream& boxes, uint8_t* pVisible) const
+{
+	// splat plane data once, reused for every batch
+	__m128 planeX[6], planeY[6], planeZ[6], planeW[6];
+	__m128 absX[6], absY[6], absZ[6];
+
+	for (uint32_t p = 0; p < 6; ++p)
+	{
+		planeX[p] = _mm_set1_ps(m_arrPlanes[p].x);
+		planeY[p] = _mm_set1_ps(m_arrPlanes[p].y);
+		planeZ[p] = _mm_set1_ps(m_arrPlanes[p].z);
+		planeW[p] = _mm_set1_ps(m_arrPlanes[p].w);
+
+		absX[p] = _mm_set1_ps(std::abs(m_arrPlanes[p].x));
+		absY[p] = _mm_set1_ps(std::abs(m_arrPlanes[p].y));
+		absZ[p] = _mm_set1_ps(std::abs(m_arrPlanes[p].z));
+	}
+
+	const __m128 zero = _mm_setzero_ps();
+
+	for (uint32_t i = 0; i < boxes.GetCount(); i += 4)
+	{
+		__m128 centerX = _mm_loadu_ps(&boxes.vecCenterX[i]);
+		__m128 centerY = _mm_loadu_ps(&boxes.vecCenterY[i]);
+		__m128 centerZ = _mm_loadu_ps(&boxes.vecCenterZ[i]);
+		__m128 extentX = _mm_loadu_ps(&boxes.vecExtentX[i]);
+		__m128 extentY = _mm_loadu_ps(&boxes.vecExtentY[i]);
+		__m128 extentZ = _mm_loadu_ps(&boxes.vecExtentZ[i]);
+
+		__m128 outside = zero;
+
+		for (uint32_t p = 0; p < 6; ++p)
+		{
+			// distance = n.c + w, radius = |n|.e
+			__m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY)),
+										 _mm_add_ps(_mm_mul_ps(planeZ[p], centerZ), planeW[p]));
+			__m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(absX[p], extentX), _mm_mul_ps(absY[p], extentY)),
+									   _mm_mul_ps(absZ[p], extentZ));
+
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+		}
+
+		int mask = _mm_movemask_ps(outside);
+
+		uint32_t nInBatch = std::min(4u, boxes.GetCount() - i);
+		for (uint32_t j = 0; j < nInBatch; ++j)
+		{
+			pVisible[i + j] = ((mask >> j) & 1) ? 0 : 1;
+		}
+	}
+}
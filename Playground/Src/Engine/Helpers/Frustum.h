@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cfloat>
+#include "glm/glm.hpp"
+
+//---------------------------------------------------------------------------------------------------------------------
+// Axis aligned bounding box
+struct BoundingBox
+{
+	BoundingBox()
+	{
+		vecMin = glm::vec3(FLT_MAX);
+		vecMax = glm::vec3(-FLT_MAX);
+	}
+
+	inline void							Expand(const glm::vec3& point)	{ vecMin = glm::min(vecMin, point); vecMax = glm::max(vecMax, point); }
+	inline glm::vec3					GetCenter() const				{ return (vecMax + vecMin) * 0.5f; }
+	inline glm::vec3					GetExtent() const				{ return (vecMax - vecMin) * 0.5f; }
+	inline float						Distance(const glm::vec3& point) const	{ return glm::length(glm::max(glm::max(vecMin - point, point - vecMax), glm::vec3(0))); }
+
+	BoundingBox							Transform(const glm::mat4& matTransform) const;
+
+	glm::vec3							vecMin;
+	glm::vec3							vecMax;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Boxes laid out as center/extent streams so that 4 of them can be tested at once. Always padded to multiple of 4!
+struct BoundingBoxStream
+{
+	void								Clear();
+	void								Add(const BoundingBox& box);
+	inline uint32_t						GetCount() const				{ return uiCount; }
+
+	std::vector<float>					vecCenterX, vecCenterY, vecCenterZ;
+	std::vector<float>					vecExtentX, vecExtentY, vecExtentZ;
+	uint32_t							uiCount = 0;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+enum class FrustumTest
+{
+	OUTSIDE = 0,
+	INTERSECT,
+	INSIDE
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+class Frustum
+{
+public:
+	Frustum();
+
+	// Gribb-Hartmann plane extraction, planes point inwards & are normalized
+	void								ExtractPlanes(const glm::mat4& matViewProjection);
+
+	bool								IsVisible(const BoundingBox& box) const;
+	FrustumTest							Classify(const BoundingBox& box) const;
+
+	// SSE test over 4 boxes per iteration, writes 1 (visible) or 0 (culled) per box into pVisible
+	void								CullBoxes(const BoundingBoxStream& boxes, uint8_t* pVisible) const;
+
+public:
+	glm::vec4							m_arrPlanes[6];			// Left, Right, Bottom, Top, Near, Far
+};
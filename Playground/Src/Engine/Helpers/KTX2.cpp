@@ -0,0 +1,183 @@
+#include "PlaygroundPCH.h"
+#include "KTX2.h"
+
+#include "Engine/Helpers/Log.h"
+
+#include <numeric>
+
+namespace
+{
+	const uint8_t g_arrIdentifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+	struct Header
+	{
+		uint8_t							arrIdentifier[12];
+		uint32_t						vkFormat;
+		uint32_t						typeSize;
+		uint32_t						pixelWidth;
+		uint32_t						pixelHeight;
+		uint32_t						pixelDepth;
+		uint32_t						layerCount;
+		uint32_t						faceCount;
+		uint32_t						levelCount;
+		uint32_t						supercompressionScheme;
+
+		uint32_t						dfdByteOffset;
+		uint32_t						dfdByteLength;
+		uint32_t						kvdByteOffset;
+		uint32_t						kvdByteLength;
+		uint64_t						sgdByteOffset;
+		uint64_t						sgdByteLength;
+	};
+
+	struct LevelIndex
+	{
+		uint64_t						byteOffset;
+		uint64_t						byteLength;
+		uint64_t						uncompressedByteLength;
+	};
+
+	static_assert(sizeof(Header) == 80, "KTX2 header must be 80 bytes");
+	static_assert(sizeof(LevelIndex) == 24, "KTX2 level index entry must be 24 bytes");
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// Basic data format descriptor (Khronos DF 1.3) for 4 x 16-bit signed float channels, linear BT.709
+	std::vector<uint32_t> BuildDFDRGBA16F()
+	{
+		const uint32_t nSamples = 4;
+		const uint32_t uiBlockSize = 24 + 16 * nSamples;
+		const uint32_t arrChannels[nSamples] = { 0, 1, 2, 15 };			// R, G, B, A
+
+		std::vector<uint32_t> vecDFD;
+		vecDFD.push_back(4 + uiBlockSize);								// dfdTotalSize
+		vecDFD.push_back(0);											// vendorId = Khronos, descriptorType = basic
+		vecDFD.push_back(2 | (uiBlockSize << 16));						// versionNumber, descriptorBlockSize
+		vecDFD.push_back(1 | (1 << 8) | (1 << 16));						// RGBSDA, BT709, linear, straight alpha
+		vecDFD.push_back(0);											// 1x1x1x1 texel block
+		vecDFD.push_back(8);											// bytesPlane0
+		vecDFD.push_back(0);
+
+		for (uint32_t i = 0; i < nSamples; ++i)
+		{
+			vecDFD.push_back((i * 16) | (15 << 16) | ((arrChannels[i] | 0xC0) << 24));	// offset, length - 1, float | signed
+			vecDFD.push_back(0);										// sample position
+			vecDFD.push_back(0xBF800000);								// -1.0f
+			vecDFD.push_back(0x3F800000);								//  1.0f
+		}
+
+		return vecDFD;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	uint64_t AlignUp(uint64_t value, uint64_t alignment)
+	{
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool KTX2::Write(const std::string& filePath, const KTX2Image& image)
+{
+	if (image.vkFormat != VK_FORMAT_R16G16B16A16_SFLOAT || image.vecLevels.empty())
+	{
+		LOG_ERROR("KTX2 writer only supports R16G16B16A16_SFLOAT images! ({0})", filePath);
+		return false;
+	}
+
+	const uint32_t nLevels = static_cast<uint32_t>(image.vecLevels.size());
+	const uint64_t uiMipPadding = std::lcm(8u, 4u);						// lcm(texel size, 4)
+
+	std::vector<uint32_t> vecDFD = BuildDFDRGBA16F();
+
+	Header header = {};
+	memcpy(header.arrIdentifier, g_arrIdentifier, sizeof(g_arrIdentifier));
+	header.vkFormat = image.vkFormat;
+	header.typeSize = 2;
+	header.pixelWidth = image.uiWidth;
+	header.pixelHeight = image.uiHeight;
+	header.faceCount = image.uiFaceCount;
+	header.levelCount = nLevels;
+	header.dfdByteOffset = static_cast<uint32_t>(sizeof(Header) + nLevels * sizeof(LevelIndex));
+	header.dfdByteLength = static_cast<uint32_t>(vecDFD.size() * sizeof(uint32_t));
+
+	// Spec wants mip data ordered from smallest level to base level in the file
+	std::vector<LevelIndex> vecLevelIndex(nLevels);
+	uint64_t uiOffset = header.dfdByteOffset + header.dfdByteLength;
+	for (int32_t i = static_cast<int32_t>(nLevels) - 1; i >= 0; --i)
+	{
+		uiOffset = AlignUp(uiOffset, uiMipPadding);
+		vecLevelIndex[i].byteOffset = uiOffset;
+		vecLevelIndex[i].byteLength = image.vecLevels[i].size();
+		vecLevelIndex[i].uncompressedByteLength = image.vecLevels[i].size();
+		uiOffset += image.vecLevels[i].size();
+	}
+
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG_ERROR("Failed to open {0} for writing!", filePath);
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+	file.write(reinterpret_cast<const char*>(vecLevelIndex.data()), nLevels * sizeof(LevelIndex));
+	file.write(reinterpret_cast<const char*>(vecDFD.data()), header.dfdByteLength);
+
+	const char arrZeros[16] = {};
+	for (int32_t i = static_cast<int32_t>(nLevels) - 1; i >= 0; --i)
+	{
+		uint64_t uiPadding = vecLevelIndex[i].byteOffset - static_cast<uint64_t>(file.tellp());
+		file.write(arrZeros, uiPadding);
+		file.write(reinterpret_cast<const char*>(image.vecLevels[i].data()), image.vecLevels[i].size());
+	}
+
+	return file.good();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool KTX2::Read(const std::string& filePath, KTX2Image& outImage)
+{
+	std::ifstream file(filePath, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+		return false;
+
+	const uint64_t uiFileSize = static_cast<uint64_t>(file.tellg());
+	file.seekg(0);
+
+	Header header = {};
+	if (uiFileSize < sizeof(Header) || !file.read(reinterpret_cast<char*>(&header), sizeof(Header)))
+		return false;
+
+	if (memcmp(header.arrIdentifier, g_arrIdentifier, sizeof(g_arrIdentifier)) != 0 || header.supercompressionScheme != 0 ||
+		header.levelCount == 0 || header.pixelDepth != 0 || header.layerCount != 0)
+	{
+		LOG_WARNING("Unsupported KTX2 file {0}", filePath);
+		return false;
+	}
+
+	std::vector<LevelIndex> vecLevelIndex(header.levelCount);
+	if (!file.read(reinterpret_cast<char*>(vecLevelIndex.data()), header.levelCount * sizeof(LevelIndex)))
+		return false;
+
+	outImage.vkFormat = static_cast<VkFormat>(header.vkFormat);
+	outImage.uiWidth = header.pixelWidth;
+	outImage.uiHeight = header.pixelHeight;
+	outImage.uiFaceCount = header.faceCount;
+	outImage.vecLevels.resize(header.levelCount);
+
+	for (uint32_t i = 0; i < header.levelCount; ++i)
+	{
+		const LevelIndex& level = vecLevelIndex[i];
+		if (level.byteOffset + level.byteLength > uiFileSize)
+		{
+			LOG_WARNING("Truncated KTX2 file {0}", filePath);
+			return false;
+		}
+
+		outImage.vecLevels[i].resize(level.byteLength);
+		file.seekg(level.byteOffset);
+		file.read(reinterpret_cast<char*>(outImage.vecLevels[i].data()), level.byteLength);
+	}
+
+	return file.good();
+}
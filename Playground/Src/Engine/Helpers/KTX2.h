@@ -0,0 +1,24 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+// Uncompressed KTX2 image, levels[0] is the base mip. Each level holds all faces tightly packed (face major), which is
+// exactly the layout vkCmdCopyImageToBuffer/vkCmdCopyBufferToImage use for a 6 layer copy!
+struct KTX2Image
+{
+	VkFormat							vkFormat = VK_FORMAT_UNDEFINED;
+	uint32_t							uiWidth = 0;
+	uint32_t							uiHeight = 0;
+	uint32_t							uiFaceCount = 1;				// 6 for cubemaps
+	std::vector<std::vector<uint8_t>>	vecLevels;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Minimal KTX 2.0 reader/writer for the renderer's own caches. No supercompression, no key/value data & only
+// VK_FORMAT_R16G16B16A16_SFLOAT gets a data format descriptor, anything else is rejected!
+namespace KTX2
+{
+	bool								Write(const std::string& filePath, const KTX2Image& image);
+	bool								Read(const std::string& filePath, KTX2Image& outImage);
+}
@@ -0,0 +1,357 @@
+#include "PlaygroundPCH.h"
+#include "MeshSimplifier.h"
+
+#include <unordered_map>
+#include <cmath>
+
+namespace
+{
+	// A level must drop at least this fraction of triangles of the previous one to be worth an index range
+	const float g_fMinReduction = 0.15f;
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// Symmetric 4x4 plane quadric, upper triangle only. Doubles since sums over many planes cancel badly in float
+	struct Quadric
+	{
+		double							a2 = 0, ab = 0, ac = 0, ad = 0;
+		double							b2 = 0, bc = 0, bd = 0;
+		double							c2 = 0, cd = 0;
+		double							d2 = 0;
+		double							w = 0;							// accumulated plane weight (area)
+
+		void AddPlane(const glm::dvec3& n, double d, double weight)
+		{
+			a2 += n.x * n.x * weight;	ab += n.x * n.y * weight;	ac += n.x * n.z * weight;	ad += n.x * d * weight;
+			b2 += n.y * n.y * weight;	bc += n.y * n.z * weight;	bd += n.y * d * weight;
+			c2 += n.z * n.z * weight;	cd += n.z * d * weight;
+			d2 += d * d * weight;
+			w += weight;
+		}
+
+		void Add(const Quadric& q)
+		{
+			a2 += q.a2;	ab += q.ab;	ac += q.ac;	ad += q.ad;
+			b2 += q.b2;	bc += q.bc;	bd += q.bd;
+			c2 += q.c2;	cd += q.cd;
+			d2 += q.d2;
+			w += q.w;
+		}
+
+		// Area weighted mean squared distance from p to all accumulated planes
+		double Evaluate(const glm::vec3& p) const
+		{
+			double x = p.x, y = p.y, z = p.z;
+
+			double dSum =	a2 * x * x + 2.0 * ab * x * y + 2.0 * ac * x * z + 2.0 * ad * x +
+							b2 * y * y + 2.0 * bc * y * z + 2.0 * bd * y +
+							c2 * z * z + 2.0 * cd * z + d2;
+
+			return (w > 0.0) ? dSum / w : 0.0;
+		}
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	struct Collapse
+	{
+		uint32_t						uiFrom;							// welded vertex that disappears
+		uint32_t						uiTo;							// welded vertex it merges into
+		uint32_t						uiToVertex;						// source vertex of uiTo on uiFrom's side of any seam
+		double							dError;
+	};
+
+	//-----------------------------------------------------------------------------------------------------------------
+	struct PositionKey
+	{
+		uint32_t						x, y, z;
+
+		bool operator==(const PositionKey& other) const					{ return x == other.x && y == other.y && z == other.z; }
+	};
+
+	struct PositionKeyHash
+	{
+		size_t operator()(const PositionKey& key) const					{ return (key.x * 73856093u) ^ (key.y * 19349663u) ^ (key.z * 83492791u); }
+	};
+
+	PositionKey MakeKey(const glm::vec3& p)
+	{
+		PositionKey key;
+		memcpy(&key.x, &p.x, sizeof(float));
+		memcpy(&key.y, &p.y, sizeof(float));
+		memcpy(&key.z, &p.z, sizeof(float));
+
+		return key;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// Welded ids are the first source vertex at a position, so vecPositions can be indexed with either
+	bool IsDegenerate(const std::vector<uint32_t>& vecWeld, uint32_t i0, uint32_t i1, uint32_t i2)
+	{
+		uint32_t w0 = vecWeld[i0], w1 = vecWeld[i1], w2 = vecWeld[i2];
+		return w0 == w1 || w1 == w2 || w0 == w2;
+	}
+
+	//-----------------------------------------------------------------------------------------------------------------
+	// Performs cheapest collapses that don't share a one-ring, so every flip test sees final neighbour positions.
+	// Returns number of collapses, 0 when nothing is left under the error limit.
+	size_t CollapsePass(const std::vector<glm::vec3>& vecPositions, const std::vector<uint32_t>& vecWeld, const std::vector<uint8_t>& vecLocked,
+						std::vector<Quadric>& vecQuadrics, std::vector<uint32_t>& vecTriangles, size_t nTargetTriangles, double dMaxErrorSq,
+						double& dInOutError)
+	{
+		size_t nVertices = vecWeld.size();
+		size_t nTriangles = vecTriangles.size() / 3;
+
+		//--- Welded vertex -> triangles adjacency, CSR
+		std::vector<uint32_t> vecOffsets(nVertices + 1, 0);
+		for (uint32_t uiIndex : vecTriangles)
+		{
+			++vecOffsets[vecWeld[uiIndex] + 1];
+		}
+
+		for (size_t i = 1; i <= nVertices; ++i)
+		{
+			vecOffsets[i] += vecOffsets[i - 1];
+		}
+
+		std::vector<uint32_t> vecAdjacency(vecTriangles.size());
+		std::vector<uint32_t> vecFill(vecOffsets.begin(), vecOffsets.end() - 1);
+		for (uint32_t t = 0; t < nTriangles; ++t)
+		{
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				vecAdjacency[vecFill[vecWeld[vecTriangles[t * 3 + k]]]++] = t;
+			}
+		}
+
+		//--- Candidates, each half edge proposes collapsing its start into its end, so both directions show up once
+		std::vector<Collapse> vecCandidates;
+		vecCandidates.reserve(vecTriangles.size());
+
+		for (uint32_t t = 0; t < nTriangles; ++t)
+		{
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				uint32_t uiFromVertex = vecTriangles[t * 3 + k];
+				uint32_t uiToVertex = vecTriangles[t * 3 + (k + 1) % 3];
+				uint32_t uiFrom = vecWeld[uiFromVertex];
+				uint32_t uiTo = vecWeld[uiToVertex];
+
+				if (vecLocked[uiFrom])
+					continue;
+
+				Quadric q = vecQuadrics[uiFrom];
+				q.Add(vecQuadrics[uiTo]);
+
+				vecCandidates.push_back({ uiFrom, uiTo, uiToVertex, std::max(q.Evaluate(vecPositions[uiTo]), 0.0) });
+			}
+		}
+
+		std::sort(vecCandidates.begin(), vecCandidates.end(), [](const Collapse& a, const Collapse& b) { return a.dError < b.dError; });
+
+		//--- Pick independent collapses, each one removes about 2 triangles
+		size_t nMaxCollapses = (nTriangles - nTargetTriangles) / 2 + 1;
+		size_t nCollapses = 0;
+
+		std::vector<uint8_t> vecTouched(nVertices, 0);
+		std::vector<uint32_t> vecTarget(nVertices, UINT32_MAX);
+
+		for (const Collapse& collapse : vecCandidates)
+		{
+			if (collapse.dError > dMaxErrorSq)
+				break;
+
+			if (vecTouched[collapse.uiFrom] || vecTouched[collapse.uiTo])
+				continue;
+
+			// Reject if any surviving triangle around uiFrom would turn over
+			bool bFlip = false;
+			for (uint32_t a = vecOffsets[collapse.uiFrom]; a < vecOffsets[collapse.uiFrom + 1] && !bFlip; ++a)
+			{
+				const uint32_t* pTriangle = &vecTriangles[vecAdjacency[a] * 3];
+
+				std::array<glm::vec3, 3> arrBefore, arrAfter;
+				bool bCollapses = false;
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					uint32_t w = vecWeld[pTriangle[k]];
+					bCollapses |= (w == collapse.uiTo);
+
+					arrBefore[k] = vecPositions[w];
+					arrAfter[k] = (w == collapse.uiFrom) ? vecPositions[collapse.uiTo] : arrBefore[k];
+				}
+
+				if (bCollapses)
+					continue;
+
+				glm::vec3 n0 = glm::cross(arrBefore[1] - arrBefore[0], arrBefore[2] - arrBefore[0]);
+				glm::vec3 n1 = glm::cross(arrAfter[1] - arrAfter[0], arrAfter[2] - arrAfter[0]);
+				bFlip = glm::dot(n0, n1) <= 0.0f;
+			}
+
+			if (bFlip)
+				continue;
+
+			vecTarget[collapse.uiFrom] = collapse.uiToVertex;
+			vecQuadrics[collapse.uiTo].Add(vecQuadrics[collapse.uiFrom]);
+			dInOutError = std::max(dInOutError, collapse.dError);
+
+			// Lock whole one-ring for this pass
+			vecTouched[collapse.uiFrom] = 1;
+			vecTouched[collapse.uiTo] = 1;
+			for (uint32_t a = vecOffsets[collapse.uiFrom]; a < vecOffsets[collapse.uiFrom + 1]; ++a)
+			{
+				for (uint32_t k = 0; k < 3; ++k)
+				{
+					vecTouched[vecWeld[vecTriangles[vecAdjacency[a] * 3 + k]]] = 1;
+				}
+			}
+
+			if (++nCollapses >= nMaxCollapses)
+				break;
+		}
+
+		if (nCollapses == 0)
+			return 0;
+
+		//--- Remap & drop triangles that lost an edge. Collapsed vertices are never seams, so welded id has one source vertex
+		size_t nWrite = 0;
+		for (size_t t = 0; t < nTriangles; ++t)
+		{
+			uint32_t arrIndices[3];
+			for (uint32_t k = 0; k < 3; ++k)
+			{
+				uint32_t uiIndex = vecTriangles[t * 3 + k];
+				uint32_t uiTarget = vecTarget[vecWeld[uiIndex]];
+				arrIndices[k] = (uiTarget != UINT32_MAX) ? uiTarget : uiIndex;
+			}
+
+			if (IsDegenerate(vecWeld, arrIndices[0], arrIndices[1], arrIndices[2]))
+				continue;
+
+			vecTriangles[nWrite++] = arrIndices[0];
+			vecTriangles[nWrite++] = arrIndices[1];
+			vecTriangles[nWrite++] = arrIndices[2];
+		}
+		vecTriangles.resize(nWrite);
+
+		return nCollapses;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void MeshSimplifier::GenerateLODs(const std::vector<glm::vec3>& vecPositions, const std::vector<uint32_t>& vecIndices,
+								  const std::vector<float>& vecTargetRatios, float fMaxError, std::vector<SimplifiedLOD>& outLODs)
+{
+	outLODs.clear();
+
+	size_t nVertices = vecPositions.size();
+	size_t nSourceTriangles = vecIndices.size() / 3;
+	if (nSourceTriangles == 0 || vecTargetRatios.empty())
+		return;
+
+	//--- Weld vertices sharing a position, split normals & UVs must not look like holes in the topology
+	std::vector<uint8_t> vecReferenced(nVertices, 0);
+	for (uint32_t uiIndex : vecIndices)
+	{
+		vecReferenced[uiIndex] = 1;
+	}
+
+	std::vector<uint32_t> vecWeld(nVertices);
+	std::vector<uint32_t> vecWedgeCount(nVertices, 0);
+	{
+		std::unordered_map<PositionKey, uint32_t, PositionKeyHash> mapPositions;
+		mapPositions.reserve(nVertices);
+
+		for (uint32_t v = 0; v < nVertices; ++v)
+		{
+			vecWeld[v] = mapPositions.emplace(MakeKey(vecPositions[v]), v).first->second;
+			vecWedgeCount[vecWeld[v]] += vecReferenced[v];
+		}
+	}
+
+	//--- Lock attribute seams, open borders & non manifold edges
+	std::vector<uint8_t> vecLocked(nVertices, 0);
+	for (uint32_t v = 0; v < nVertices; ++v)
+	{
+		vecLocked[v] = (vecWedgeCount[v] > 1) ? 1 : 0;
+	}
+
+	std::unordered_map<uint64_t, uint32_t> mapEdgeUse;
+	mapEdgeUse.reserve(vecIndices.size());
+	for (size_t t = 0; t < nSourceTriangles; ++t)
+	{
+		for (uint32_t k = 0; k < 3; ++k)
+		{
+			uint64_t w0 = vecWeld[vecIndices[t * 3 + k]];
+			uint64_t w1 = vecWeld[vecIndices[t * 3 + (k + 1) % 3]];
+			++mapEdgeUse[(std::min(w0, w1) << 32) | std::max(w0, w1)];
+		}
+	}
+
+	for (const auto& edge : mapEdgeUse)
+	{
+		if (edge.second != 2)
+		{
+			vecLocked[static_cast<uint32_t>(edge.first >> 32)] = 1;
+			vecLocked[static_cast<uint32_t>(edge.first & 0xFFFFFFFF)] = 1;
+		}
+	}
+
+	//--- Plane quadrics of adjacent triangles per welded vertex, drop degenerate triangles on the way
+	std::vector<Quadric> vecQuadrics(nVertices);
+	std::vector<uint32_t> vecTriangles;
+	vecTriangles.reserve(vecIndices.size());
+
+	for (size_t t = 0; t < nSourceTriangles; ++t)
+	{
+		uint32_t i0 = vecIndices[t * 3 + 0], i1 = vecIndices[t * 3 + 1], i2 = vecIndices[t * 3 + 2];
+		if (IsDegenerate(vecWeld, i0, i1, i2))
+			continue;
+
+		glm::dvec3 p0 = vecPositions[i0], p1 = vecPositions[i1], p2 = vecPositions[i2];
+		glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+		double dLength = glm::length(n);
+		if (dLength > 0.0)
+		{
+			n /= dLength;
+
+			Quadric q;
+			q.AddPlane(n, -glm::dot(n, p0), dLength * 0.5);
+
+			vecQuadrics[vecWeld[i0]].Add(q);
+			vecQuadrics[vecWeld[i1]].Add(q);
+			vecQuadrics[vecWeld[i2]].Add(q);
+		}
+
+		vecTriangles.push_back(i0);
+		vecTriangles.push_back(i1);
+		vecTriangles.push_back(i2);
+	}
+
+	//--- Simplify progressively, snapshot once each target is reached
+	double dMaxErrorSq = static_cast<double>(fMaxError) * fMaxError;
+	double dError = 0.0;
+	size_t nPreviousTriangles = vecTriangles.size() / 3;
+
+	for (float fRatio : vecTargetRatios)
+	{
+		size_t nTargetTriangles = static_cast<size_t>(nSourceTriangles * fRatio);
+
+		while (vecTriangles.size() / 3 > nTargetTriangles)
+		{
+			if (CollapsePass(vecPositions, vecWeld, vecLocked, vecQuadrics, vecTriangles, nTargetTriangles, dMaxErrorSq, dError) == 0)
+				break;
+		}
+
+		// Error limit or locked vertices reached, coarser targets can't do better
+		size_t nTriangles = vecTriangles.size() / 3;
+		if (nTriangles == 0 || nTriangles > nPreviousTriangles * (1.0f - g_fMinReduction))
+			break;
+
+		SimplifiedLOD lod;
+		lod.vecIndices = vecTriangles;
+		lod.fError = static_cast<float>(std::sqrt(dError));
+		outLODs.push_back(std::move(lod));
+
+		nPreviousTriangles = nTriangles;
+	}
+}
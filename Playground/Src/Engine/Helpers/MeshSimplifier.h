@@ -0,0 +1,23 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+//---------------------------------------------------------------------------------------------------------------------
+// One simplified level, indices reference the vertices of the source mesh
+struct SimplifiedLOD
+{
+	std::vector<uint32_t>				vecIndices;
+	float								fError = 0.0f;					// object space deviation estimate from source mesh
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Quadric error (Garland-Heckbert) edge collapse onto existing vertices, so every level shares the source vertex buffer
+// & only needs its own index range. Vertices on open borders or attribute seams (same position, several vertices) are
+// locked, hence silhouettes & UV seams never tear, but heavily seamed meshes simplify less!
+namespace MeshSimplifier
+{
+	// Progressive, level i continues from level i-1 until triangle count drops to vecTargetRatios[i] * source count.
+	// No collapse may exceed fMaxError. Generation stops at the first level that isn't meaningfully coarser than the last.
+	void								GenerateLODs(const std::vector<glm::vec3>& vecPositions, const std::vector<uint32_t>& vecIndices,
+													 const std::vector<float>& vecTargetRatios, float fMaxError, std::vector<SimplifiedLOD>& outLODs);
+}
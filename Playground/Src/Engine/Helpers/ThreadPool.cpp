@@ -0,0 +1,82 @@
+#include "PlaygroundPCH.h"
+#include "ThreadPool.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+ThreadPool::ThreadPool(uint32_t nThreads)
+{
+	m_uiPendingJobs = 0;
+	m_bStop = false;
+
+	m_vecWorkers.reserve(nThreads);
+	for (uint32_t i = 0; i < nThreads; ++i)
+	{
+		m_vecWorkers.emplace_back(&ThreadPool::WorkerLoop, this);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStop = true;
+	}
+
+	m_cvJobAvailable.notify_all();
+
+	for (std::thread& worker : m_vecWorkers)
+	{
+		if (worker.joinable())
+			worker.join();
+	}
+
+	m_vecWorkers.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ThreadPool::Enqueue(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_queueJobs.push(std::move(job));
+		++m_uiPendingJobs;
+	}
+
+	m_cvJobAvailable.notify_one();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cvJobsDone.wait(lock, [this] { return m_uiPendingJobs == 0; });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ThreadPool::WorkerLoop()
+{
+	while (true)
+	{
+		std::function<void()> job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cvJobAvailable.wait(lock, [this] { return m_bStop || !m_queueJobs.empty(); });
+
+			if (m_bStop && m_queueJobs.empty())
+				return;
+
+			job = std::move(m_queueJobs.front());
+			m_queueJobs.pop();
+		}
+
+		job();
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			--m_uiPendingJobs;
+		}
+
+		m_cvJobsDone.notify_all();
+	}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <queue>
+
+//---------------------------------------------------------------------------------------------------------------------
+// Fixed size pool of worker threads. Jobs are pushed with Enqueue() & Wait() blocks until all pushed jobs are done.
+// Jobs must not share Vulkan command pools, caller hands each job its own pool!
+class ThreadPool
+{
+public:
+	ThreadPool(uint32_t nThreads);
+	~ThreadPool();
+
+	void										Enqueue(std::function<void()> job);
+	void										Wait();
+
+	inline uint32_t								GetThreadCount()		{ return static_cast<uint32_t>(m_vecWorkers.size()); }
+
+private:
+	ThreadPool(const ThreadPool&);
+	void operator=(const ThreadPool&);
+
+	void										WorkerLoop();
+
+private:
+	std::vector<std::thread>					m_vecWorkers;
+	std::queue<std::function<void()>>			m_queueJobs;
+
+	std::mutex									m_mutex;
+	std::condition_variable						m_cvJobAvailable;
+	std::condition_variable						m_cvJobsDone;
+
+	uint32_t									m_uiPendingJobs;
+	bool										m_bStop;
+};
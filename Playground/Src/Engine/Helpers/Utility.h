@@ -17,7 +17,9 @@ namespace Helper
 {
 	namespace App
 	{
-		const uint32_t	MAX_FRAME_DRAWS = 2;
+		const uint32_t	MAX_FRAMES_IN_FLIGHT = 3;
+		const uint32_t	DEFAULT_FRAMES_IN_FLIGHT = 2;
+		const uint32_t	MAX_RECORD_THREADS = 16;
 		const float WINDOW_WIDTH = 960.0f;
 		const float WINDOW_HEIGHT = 540.0f;
 
@@ -1318,5 +1320,25 @@ namespace Helper
 
 			pDevice->EndAndSubmitCommandBuffer(transferCommandBuffer);
 		}
+
+		/////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+		//--- Viewport & scissor are dynamic on all graphics pipelines, render extent can be smaller than the attachments!
+		inline void SetViewportScissor(VkCommandBuffer cmdBuffer, const VkExtent2D& extent)
+		{
+			VkViewport viewport = {};
+			viewport.x = 0.0f;
+			viewport.y = 0.0f;
+			viewport.width = static_cast<float>(extent.width);
+			viewport.height = static_cast<float>(extent.height);
+			viewport.minDepth = 0.0f;
+			viewport.maxDepth = 1.0f;
+
+			VkRect2D scissor = {};
+			scissor.offset = { 0, 0 };
+			scissor.extent = extent;
+
+			vkCmdSetViewport(cmdBuffer, 0, 1, &viewport);
+			vkCmdSetScissor(cmdBuffer, 0, 1, &scissor);
+		}
 	}
 }
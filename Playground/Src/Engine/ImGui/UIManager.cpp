@@ -4,6 +4,10 @@
 #include "Engine/Renderer/VulkanDevice.h"
 #include "Engine/Renderer/VulkanSwapChain.h"
 #include "Engine/Renderer/VulkanFrameBuffer.h"
+#include "Engine/Renderer/ClusteredLighting.h"
+#include "Engine/Renderer/UpscalePass.h"
+#include "Engine/Renderer/VulkanMaterial.h"
+#include "Engine/Helpers/Utility.h"
 #include "Engine/RenderObjects/Model.h"
 #include "PlaygroundHeaders.h"
 #include "Engine/Helpers/Log.h"
@@ -18,6 +22,41 @@
 UIManager::UIManager()
 {
 	m_iPassID = 0;
+
+	m_iRecordThreadCount = 1;
+	m_iMaxRecordThreads = 1;
+	m_bRunRecordBenchmark = false;
+
+	m_iFramesInFlight = static_cast<int>(Helper::App::DEFAULT_FRAMES_IN_FLIGHT);
+
+	m_bGPUDriven = false;
+	m_bGPUDrivenSupported = false;
+
+	m_bOcclusionCulling = true;
+	m_uiOccludedMeshes = 0;
+	m_bLoadOcclusionBenchmark = false;
+
+	m_bDepthPrepass = false;
+	m_bPipelineStatisticsSupported = false;
+	m_uiGBufferFragmentInvocations = 0;
+
+	m_iStressLightCount = 1024;
+
+	m_bImageBasedLighting = true;
+	m_fIBLIntensity = 1.0f;
+	m_bTiledLighting = false;
+	m_fLightingPassMs = 0.0f;
+	m_fLightingPassNsPerPixel = 0.0f;
+
+	m_bDynamicResolution = true;
+	m_fTargetFrameMs = 16.6f;
+	m_fMinRenderScale = 0.5f;
+	m_fRenderScale = 1.0f;
+	m_fGPUFrameMs = 0.0f;
+
+	m_iUpscaleMode = static_cast<int>(UpscaleMode::FSR1);
+	m_iRenderScalePreset = 0;
+	m_fSharpness = 0.2f;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -63,7 +102,7 @@ void UIManager::Initialize(GLFWwindow* pWindow, VkInstance instance, VulkanDevic
 	initInfo.DescriptorPool = m_vkDescriptorPool;
 	initInfo.Allocator = nullptr;
 	initInfo.MinImageCount = pSwapchain->m_uiMinImageCount;
-	initInfo.ImageCount = pSwapchain->m_uiImageCount;
+	initInfo.ImageCount = std::max(pSwapchain->m_uiImageCount, Helper::App::MAX_FRAMES_IN_FLIGHT);	// one vertex buffer set per frame in flight
 	initInfo.CheckVkResultFn = nullptr;
 	ImGui_ImplVulkan_Init(&initInfo, m_vkRenderPass);
 
@@ -124,7 +163,7 @@ void UIManager::InitCommandBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwap
 		LOG_DEBUG("Created GUI Command Pool!");
 
 	// Create Command Buffers!
-	m_vecCommandBuffers.resize(pSwapchain->m_vecSwapchainImages.size());
+	m_vecCommandBuffers.resize(pSwapchain->m_uiFramesInFlight);
 
 	for (uint32_t i = 0 ; i < m_vecCommandBuffers.size() ; i++)
 	{
@@ -240,14 +279,14 @@ void UIManager::BeginRender()
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void UIManager::EndRender(VulkanSwapChain* pSwapchain, uint32_t imageIndex)
+void UIManager::EndRender(VulkanSwapChain* pSwapchain, uint32_t frameIndex, uint32_t imageIndex)
 {
 	ImGui::Render();
 
 	VkCommandBufferBeginInfo commandBufferBeginInfo = {};
 	commandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 	commandBufferBeginInfo.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-	vkBeginCommandBuffer(m_vecCommandBuffers[imageIndex], &commandBufferBeginInfo);
+	vkBeginCommandBuffer(m_vecCommandBuffers[frameIndex], &commandBufferBeginInfo);
 
 	VkRenderPassBeginInfo renderPassBeginInfo = {};
 	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
@@ -262,11 +301,11 @@ void UIManager::EndRender(VulkanSwapChain* pSwapchain, uint32_t imageIndex)
 	clearValue.depthStencil = { 1.0f, 1 };
 	
 	renderPassBeginInfo.pClearValues = &clearValue;
-	vkCmdBeginRenderPass(m_vecCommandBuffers[imageIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBeginRenderPass(m_vecCommandBuffers[frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-	ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), m_vecCommandBuffers[imageIndex]);
-	vkCmdEndRenderPass(m_vecCommandBuffers[imageIndex]);
-	vkEndCommandBuffer(m_vecCommandBuffers[imageIndex]);
+	ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), m_vecCommandBuffers[frameIndex]);
+	vkCmdEndRenderPass(m_vecCommandBuffers[frameIndex]);
+	vkEndCommandBuffer(m_vecCommandBuffers[frameIndex]);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -328,13 +367,17 @@ void UIManager::RenderSceneUI(Scene* pScene)
 				//**** MATERIAL UI
 				if (ImGui::TreeNode("Material"))
 				{
-					ShaderData* data = &(pModel->m_pShaderUniforms->shaderData);
+					// Material constants live in bindless material buffer, push edits there
+					VulkanMaterial* pMaterial = pModel->GetMaterial();
+					GPUMaterial* data = &(pMaterial->m_MaterialData);
+					bool bMaterialChanged = false;
 
 					//-- Albedo Color
 					float albedo[4] = { data->albedoColor.r, data->albedoColor.g, data->albedoColor.b, data->albedoColor.a };
 					if(ImGui::ColorEdit4("Albedo", albedo))
 					{
 						data->albedoColor = glm::vec4(albedo[0], albedo[1], albedo[2], albedo[3]);
+						bMaterialChanged = true;
 					}
 
 					//-- Emission Color
@@ -342,28 +385,35 @@ void UIManager::RenderSceneUI(Scene* pScene)
 					if (ImGui::ColorEdit4("Emission", emission))
 					{
 						data->emissiveColor = glm::vec4(emission[0], emission[1], emission[2], emission[3]);
+						bMaterialChanged = true;
 					}
 
 					//-- Roughness
-					float roughness = data->roughness;
+					float roughness = data->properties.y;
 					if(ImGui::SliderFloat("Roughness", &roughness, 0.001f, 1.0f))
 					{
-						data->roughness = roughness;
+						data->properties.y = roughness;
+						bMaterialChanged = true;
 					}
 
 					//-- Metalness
-					float metalness = data->metalness;
+					float metalness = data->properties.z;
 					if (ImGui::SliderFloat("Metalness", &metalness, 0.001f, 1.0f))
 					{
-						data->metalness = metalness;
+						data->properties.z = metalness;
+						bMaterialChanged = true;
 					}
 
 					//-- Occlusion
-					float occlusion = data->ao;
+					float occlusion = data->properties.x;
 					if (ImGui::SliderFloat("AmbOcclusion", &occlusion, 0.001f, 1.0f))
 					{
-						data->ao = occlusion;
+						data->properties.x = occlusion;
+						bMaterialChanged = true;
 					}
+
+					if (bMaterialChanged)
+						pMaterial->UpdateBindless();
 					
 					ImGui::TreePop();
 				}
@@ -394,7 +444,7 @@ void UIManager::RenderSceneUI(Scene* pScene)
 	//**** Debugging UI
 	if (ImGui::CollapsingHeader("Debug G-Buffer"))	
 	{
-		const char* arr[] = { "FINAL", "ALBEDO", "DEPTH", "POSITION", "NORMAL", "METALNESS", "ROUGHNESS", "AO", "EMISSION", "BACKGROUND", "OBJECTID" };
+		const char* arr[] = { "FINAL", "ALBEDO", "DEPTH", "POSITION", "NORMAL", "METALNESS", "ROUGHNESS", "AO", "EMISSION", "BACKGROUND", "OBJECTID", "LIGHT CLUSTERS" };
 		ImGui::Combo("Channel", &m_iPassID, arr, IM_ARRAYSIZE(arr));
 	}
 	
@@ -402,11 +452,104 @@ void UIManager::RenderSceneUI(Scene* pScene)
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void UIManager::RenderDebugStats()
+void UIManager::RenderDebugStats(Scene* pScene)
 {
 	ImGui::Begin("Debug Statistics");
 	ImGui::Text("FPS: %f", ImGui::GetIO().Framerate);
 	ImGui::Text("ms Per Frame: %f", 1000.0f / ImGui::GetIO().Framerate);
+
+	//**** Frustum culling
+	ImGui::Separator();
+	ImGui::Checkbox("Frustum Culling", &pScene->m_bEnableCulling);
+	ImGui::Text("Visible Meshes: %u", pScene->GetVisibleMeshCount());
+	ImGui::Text("Culled Meshes: %u", pScene->GetCulledMeshCount());
+	ImGui::Text("BVH Proxies: %u, Height: %d", pScene->GetBVH().GetProxyCount(), pScene->GetBVH().GetHeight());
+	if (m_bGPUDrivenSupported)
+	{
+		ImGui::Checkbox("GPU Driven (Indirect Count)", &m_bGPUDriven);
+		if (m_bGPUDriven)
+		{
+			ImGui::Checkbox("Occlusion Culling (Hi-Z)", &m_bOcclusionCulling);
+			ImGui::Text("Occluded Meshes: %u", m_bOcclusionCulling ? m_uiOccludedMeshes : 0);
+		}
+		if (ImGui::Button("Load Occlusion Benchmark"))
+		{
+			m_bLoadOcclusionBenchmark = true;
+		}
+	}
+	if (ImGui::Button("Run BVH Benchmark (100k)"))
+	{
+		pScene->RunBVHBenchmark(100000);
+	}
+
+	//**** Render queue
+	ImGui::Separator();
+	if (ImGui::Checkbox("Sort Draws By State", &pScene->m_bSortDraws))
+	{
+		pScene->MarkDirty();
+	}
+	const RenderQueueStats& renderStats = pScene->GetRenderStats();
+	ImGui::Text("Draws: %u", renderStats.uiDraws);
+	ImGui::Text("Pipeline Binds: %u", renderStats.uiPipelineBinds);
+	ImGui::Text("Push Constants: %u", renderStats.uiPushConstants);
+	ImGui::Text("Geometry Binds: %u", renderStats.uiGeometryBinds);
+	ImGui::Text("Triangles: %u", renderStats.uiTriangles);
+
+	//**** Mesh LODs
+	ImGui::Separator();
+	ImGui::Checkbox("Mesh LODs", &pScene->m_bEnableLOD);
+	ImGui::SliderFloat("LOD Error (px)", &pScene->m_fLODErrorPixels, 0.25f, 8.0f);
+
+	//**** Depth pre-pass
+	ImGui::Separator();
+	ImGui::Checkbox("Depth Pre-Pass", &m_bDepthPrepass);
+	if (m_bPipelineStatisticsSupported)
+	{
+		ImGui::Text("G-Buffer Fragment Invocations: %llu", static_cast<unsigned long long>(m_uiGBufferFragmentInvocations));
+	}
+
+	//**** Clustered lighting
+	ImGui::Separator();
+	ImGui::Text("Local Lights: %u", static_cast<uint32_t>(pScene->GetLights().size()));
+	ImGui::SliderInt("Stress Light Count", &m_iStressLightCount, 0, static_cast<int>(ClusterConfig::MAX_LIGHTS));
+	if (ImGui::Button("Spawn Stress Lights"))
+	{
+		pScene->SpawnStressTestLights(static_cast<uint32_t>(m_iStressLightCount));
+	}
+	ImGui::Checkbox("Animate Lights", &pScene->m_bAnimateLights);
+
+	//**** Image based lighting
+	ImGui::Separator();
+	ImGui::Checkbox("Image Based Lighting", &m_bImageBasedLighting);
+	ImGui::SliderFloat("IBL Intensity", &m_fIBLIntensity, 0.0f, 4.0f);
+	ImGui::Checkbox("Tiled Compute Lighting", &m_bTiledLighting);
+	ImGui::Text("Lighting Pass: %.3f ms (%.2f ns/pixel)", m_fLightingPassMs, m_fLightingPassNsPerPixel);
+
+	//**** Dynamic resolution
+	ImGui::Separator();
+	ImGui::Checkbox("Dynamic Resolution", &m_bDynamicResolution);
+	ImGui::SliderFloat("Target GPU Frame (ms)", &m_fTargetFrameMs, 4.0f, 33.3f);
+	ImGui::SliderFloat("Min Render Scale", &m_fMinRenderScale, 0.25f, 1.0f);
+	ImGui::Text("GPU Frame: %.3f ms, Render Scale: %.2f", m_fGPUFrameMs, m_fRenderScale);
+
+	//**** Upscaling
+	const char* arrUpscalers[] = { "Bilinear", "FSR 1 (EASU + RCAS)" };
+	ImGui::Combo("Upscaler", &m_iUpscaleMode, arrUpscalers, IM_ARRAYSIZE(arrUpscalers));
+	ImGui::Combo("Quality Preset", &m_iRenderScalePreset, UpscaleConfig::RENDER_SCALE_PRESET_NAMES, static_cast<int>(UpscaleConfig::NUM_RENDER_SCALE_PRESETS));
+	if (m_iUpscaleMode == static_cast<int>(UpscaleMode::FSR1))
+	{
+		ImGui::SliderFloat("Sharpness (stops)", &m_fSharpness, 0.0f, 2.0f);
+	}
+
+	//**** Command recording
+	ImGui::Separator();
+	ImGui::SliderInt("Record Threads", &m_iRecordThreadCount, 1, m_iMaxRecordThreads);
+	ImGui::SliderInt("Frames In Flight", &m_iFramesInFlight, 1, static_cast<int>(Helper::App::MAX_FRAMES_IN_FLIGHT));
+	if (ImGui::Button("Run Recording Benchmark"))
+	{
+		m_bRunRecordBenchmark = true;
+	}
+
 	ImGui::End();
 }
 
@@ -26,10 +26,10 @@ public:
 	void							Cleanup(VulkanDevice* pDevice);
 	void							CleanupOnWindowResize(VulkanDevice* pDevice);
 	void							BeginRender();
-	void							EndRender(VulkanSwapChain* pSwapchain, uint32_t imageIndex);
+	void							EndRender(VulkanSwapChain* pSwapchain, uint32_t frameIndex, uint32_t imageIndex);
 
 	void							RenderSceneUI(Scene* pScene);
-	void							RenderDebugStats();
+	void							RenderDebugStats(Scene* pScene);
 
 private:
 	UIManager();
@@ -45,13 +45,57 @@ private:
 	VkDescriptorPool				m_vkDescriptorPool;
 	
 	VkRenderPass					m_vkRenderPass;
-	std::vector<VkFramebuffer>		m_vecFramebuffers;
+	std::vector<VkFramebuffer>		m_vecFramebuffers;					// per swapchain image
 	VkCommandPool					m_vkCommandPool;
 
 public:
-	std::vector<VkCommandBuffer>	m_vecCommandBuffers;
+	std::vector<VkCommandBuffer>	m_vecCommandBuffers;				// per frame in flight, re-recorded every frame
 
 public:
 	int								m_iPassID;
+
+	// Parallel command recording
+	int								m_iRecordThreadCount;
+	int								m_iMaxRecordThreads;
+	bool							m_bRunRecordBenchmark;
+
+	// Frames the CPU may run ahead of the GPU, per frame resources are recreated on change
+	int								m_iFramesInFlight;
+
+	// GPU driven G-Buffer
+	bool							m_bGPUDriven;
+	bool							m_bGPUDrivenSupported;
+
+	// Hi-Z occlusion culling, GPU driven path only
+	bool							m_bOcclusionCulling;
+	uint32_t						m_uiOccludedMeshes;
+	bool							m_bLoadOcclusionBenchmark;
+
+	// Depth pre-pass
+	bool							m_bDepthPrepass;
+	bool							m_bPipelineStatisticsSupported;
+	uint64_t						m_uiGBufferFragmentInvocations;
+
+	// Clustered lighting stress test
+	int								m_iStressLightCount;
+
+	// Image based lighting & deferred lighting pass GPU timing
+	bool							m_bImageBasedLighting;
+	float							m_fIBLIntensity;
+	bool							m_bTiledLighting;					// compute lighting over 8x8 tiles instead of subpass
+	float							m_fLightingPassMs;
+	float							m_fLightingPassNsPerPixel;
+
+	// Dynamic resolution, scale is picked by the renderer from GPU frame time
+	bool							m_bDynamicResolution;
+	float							m_fTargetFrameMs;
+	float							m_fMinRenderScale;
+	float							m_fRenderScale;
+	float							m_fGPUFrameMs;
+
+	// Upscaler, quality preset is the highest render scale dynamic resolution may pick
+	int								m_iUpscaleMode;
+	int								m_iRenderScalePreset;
+	float							m_fSharpness;						// RCAS stops, 0 = sharpest
 };
 
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+//---------------------------------------------------------------------------------------------------------------------
+// Values must match LIGHT_TYPE_* in Deferred.frag
+enum class LightType
+{
+	POINT = 0,
+	SPOT = 1
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Local light, binned into view space clusters every frame. Directional light stays in deferred uniforms!
+struct Light
+{
+	LightType							eType = LightType::POINT;
+
+	glm::vec3							vecPosition = glm::vec3(0);			// world space
+	float								fRange = 5.0f;						// no contribution beyond this distance
+	glm::vec3							vecColor = glm::vec3(1);
+	float								fIntensity = 1.0f;
+
+	// Spot only
+	glm::vec3							vecDirection = glm::vec3(0, -1, 0);
+	float								fInnerConeAngle = 20.0f;			// degrees, full intensity inside
+	float								fOuterConeAngle = 30.0f;			// degrees, zero outside
+
+	// Orbit speed around world Y axis in degrees per second, used by stress test scene
+	float								fOrbitSpeed = 0.0f;
+};
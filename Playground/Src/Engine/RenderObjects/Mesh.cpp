@@ -14,9 +14,8 @@ Mesh::Mesh(VulkanDevice* device,
 	m_uiIndexCount = indices.size();
 
 	CreateVertexBuffer(device, vertices);
+	CreatePositionBuffer(device, vertices);
 	CreateIndexBuffer(device, indices);
-
-	//m_pushConstData.matModel = glm::mat4(1.0f);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -29,14 +28,15 @@ Mesh::Mesh(VulkanDevice* device,
 
 	CreateVertexBuffer(device, vertices);
 	CreateIndexBuffer(device, indices);
-
-	//m_pushConstData.matModel = glm::mat4(1.0f);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void Mesh::SetPushConstantData(glm::mat4 modelMatrix)
+void Mesh::SetLODs(const std::vector<MeshLOD>& vecLODs)
 {
-	//m_pushConstData.matModel = modelMatrix;
+	m_vecLODs = vecLODs;
+
+	if (!m_vecLODs.empty())
+		m_uiIndexCount = m_vecLODs[0].uiIndexCount;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -52,6 +52,9 @@ void Mesh::Cleanup(VulkanDevice* pDevice)
 
 	vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vkIndexBuffer, nullptr);
 	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkIndexBufferMemory, nullptr);
+
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vkPositionBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkPositionBufferMemory, nullptr);
 }
 
 void Mesh::CleanupOnWindowsResize(VulkanDevice* pDevice)
@@ -98,6 +101,45 @@ void Mesh::CreateVertexBuffer(VulkanDevice* pDevice, const std::vector<Helper::A
 	vkFreeMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory, nullptr);
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+// Tightly packed positions for depth only passes, 12 bytes per vertex instead of full vertex fetch!
+void Mesh::CreatePositionBuffer(VulkanDevice* pDevice, const std::vector<Helper::App::VertexPNTBT>& vertices)
+{
+	std::vector<glm::vec3> positions(vertices.size());
+	for (size_t i = 0; i < vertices.size(); ++i)
+	{
+		positions[i] = vertices[i].Position;
+	}
+
+	VkDeviceSize bufferSize = m_uiVertexCount * sizeof(glm::vec3);
+
+	// Temporary buffer to "stage" position data before transferring to GPU
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+
+	pDevice->CreateBuffer(bufferSize,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		&stagingBuffer,
+		&stagingBufferMemory);
+
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
+	memcpy(data, positions.data(), (size_t)bufferSize);
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory);
+
+	pDevice->CreateBuffer(	bufferSize,
+							VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+							VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+							&m_vkPositionBuffer,
+							&m_vkPositionBufferMemory);
+
+	pDevice->CopyBuffer(stagingBuffer, m_vkPositionBuffer, bufferSize);
+
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, stagingBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory, nullptr);
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void Mesh::CreateVertexBuffer(VulkanDevice* pDevice, const std::vector<Helper::App::VertexPNT>& vertices)
 {
@@ -140,8 +182,8 @@ void Mesh::CreateVertexBuffer(VulkanDevice* pDevice, const std::vector<Helper::A
 //---------------------------------------------------------------------------------------------------------------------
 void Mesh::CreateIndexBuffer(VulkanDevice* pDevice, const std::vector<uint32_t>& indices)
 {
-	// Get size of buffer needed for indices
-	VkDeviceSize bufferSize = m_uiIndexCount * sizeof(uint32_t);
+	// Get size of buffer needed for indices, all LODs
+	VkDeviceSize bufferSize = indices.size() * sizeof(uint32_t);
 
 	// Temporary buffer to "stage" index data before transferring to GPU
 	VkBuffer stagingBuffer;
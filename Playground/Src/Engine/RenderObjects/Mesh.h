@@ -4,6 +4,7 @@
 #include "vulkan/vulkan.h"
 
 #include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Frustum.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/type_ptr.hpp"
@@ -11,9 +12,45 @@
 
 class VulkanDevice;
 
+//---------------------------------------------------------------------------------------------------------------------
+// Per model data of scene geometry pipelines, one entry per model in FrameGlobals object buffer. Must match ObjectData in
+// GBuffer.vert, GBufferInstanced.vert & DepthPrepass.vert (std430, 80 bytes)
+struct ObjectShaderData
+{
+	ObjectShaderData()
+	{
+		matModel			= glm::mat4(1);
+		objectID			= 1;
+		materialIndex		= 0;
+		pad[0] = pad[1]		= 0;
+	}
+
+	glm::mat4							matModel;
+	uint32_t							objectID;
+	uint32_t							materialIndex;		// slot in bindless material buffer
+	uint32_t							pad[2];
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Per draw data of scene geometry pipelines, must match PushObject in GBuffer.vert, GBufferInstanced.vert &
+// DepthPrepass.vert. Only the model's slot in object buffer, so pushed value never changes with the transform
 struct PushConstantData
 {
-	glm::mat4 matModel;
+	PushConstantData()
+	{
+		objectIndex			= 0;
+	}
+
+	uint32_t							objectIndex;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Index range of one detail level, all levels share the mesh's vertex buffer
+struct MeshLOD
+{
+	uint32_t					uiFirstIndex = 0;
+	uint32_t					uiIndexCount = 0;
+	float						fError = 0.0f;					// mesh space deviation from full resolution
 };
 
 class Mesh
@@ -32,15 +69,16 @@ public:
 		const std::vector<Helper::App::VertexP>& vertices,
 		const std::vector<uint32_t>& indices);
 
-	void						SetPushConstantData(glm::mat4 modelMatrix);
-	//inline PushConstantData		GetPushConstantData() { return m_pushConstData; }
-
 	inline uint32_t				getVertexCount() const { return m_uiVertexCount; }
 	inline VkBuffer				getVertexBuffer() const { return m_vkVertexBuffer; }
 
 	inline uint32_t				getIndexCount() const { return m_uiIndexCount; }
 	inline VkBuffer				getIndexBuffer() const { return m_vkIndexBuffer; }
 
+	// Index buffer holds full resolution followed by coarser levels, m_uiIndexCount keeps referring to LOD 0
+	void						SetLODs(const std::vector<MeshLOD>& vecLODs);
+	inline uint32_t				GetLODCount() const { return std::max(1u, static_cast<uint32_t>(m_vecLODs.size())); }
+
 	~Mesh();
 
 	void						Cleanup(VulkanDevice* pDevice);
@@ -52,15 +90,23 @@ public:
 
 	VkBuffer					m_vkVertexBuffer;
 	VkBuffer					m_vkIndexBuffer;
+	VkBuffer					m_vkPositionBuffer = VK_NULL_HANDLE;		// position only stream for depth pre-pass
 
-private:
-	//PushConstantData			m_pushConstData;
+	BoundingBox					m_AABB;							// Local space bounds, filled by Model::LoadMesh
+	std::vector<MeshLOD>		m_vecLODs;						// [0] full resolution, empty if mesh has no LODs
+
+	// Location of this mesh inside owning Model's CPU side geometry, used to build merged scene buffers
+	uint32_t					m_uiFirstIndex = 0;
+	int32_t						m_iVertexOffset = 0;
 
+private:
 	VkDeviceMemory				m_vkVertexBufferMemory;
 	VkDeviceMemory				m_vkIndexBufferMemory;
+	VkDeviceMemory				m_vkPositionBufferMemory = VK_NULL_HANDLE;
 
 	void						CreateVertexBuffer(VulkanDevice* device, const std::vector<Helper::App::VertexPNT>& vertices);
 	void						CreateVertexBuffer(VulkanDevice* device, const std::vector<Helper::App::VertexPNTBT>& vertices);
 	void						CreateIndexBuffer(VulkanDevice* device, const std::vector<uint32_t>& indices);
+	void						CreatePositionBuffer(VulkanDevice* device, const std::vector<Helper::App::VertexPNTBT>& vertices);
 };
 
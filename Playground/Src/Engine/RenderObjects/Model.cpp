@@ -1,12 +1,13 @@
 
 #include "PlaygroundPCH.h"
 #include "Engine/Helpers/Utility.h"
-#include "Engine/Helpers/Camera.h"
+#include "Engine/Helpers/MeshSimplifier.h"
 #include "Engine/Renderer/VulkanDevice.h"
 #include "Engine/Renderer/VulkanSwapChain.h"
 #include "Engine/Renderer/VulkanMaterial.h"
 #include "Engine/Renderer/VulkanTexture2D.h"
 #include "Engine/Renderer/VulkanGraphicsPipeline.h"
+#include "Engine/Renderer/FrameGlobals.h"
 
 #include "Engine/ImGui/imgui.h"
 #include "Model.h"
@@ -20,7 +21,9 @@ Model::Model(ModelType typeID)
 
 	m_pMaterial = nullptr;
 
-	m_pShaderUniforms = new ShaderUniforms();
+	m_vecInstances.clear();
+	m_vkInstanceBuffer = VK_NULL_HANDLE;
+	m_vkInstanceBufferMemory = VK_NULL_HANDLE;
 
 	m_vecPosition = glm::vec3(0);
 	m_vecRotationAxis = glm::vec3(0, 1, 0);
@@ -32,9 +35,12 @@ Model::Model(ModelType typeID)
 	
 	m_mapTextures.clear();
 
-	m_vkDescriptorPool = VK_NULL_HANDLE;
-	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
-	m_vecDescriptorSet.clear();
+	m_vecWorldAABB.clear();
+	m_vecMeshVisible.clear();
+	m_vecMeshLOD.clear();
+	m_uiFirstDrawSlot = 0;
+	m_fWorldScale = 1.0f;
+	m_bBoundsDirty = true;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -42,8 +48,14 @@ Model::~Model()
 {
 	m_mapTextures.clear();
 	m_vecMeshes.clear();
+	m_vecWorldAABB.clear();
+	m_vecMeshVisible.clear();
+	m_vecMeshLOD.clear();
+	m_vecMeshProxies.clear();
+	m_vecVertices.clear();
+	m_vecIndices.clear();
+	m_vecInstances.clear();
 
-	SAFE_DELETE(m_pShaderUniforms);
 	SAFE_DELETE(m_pMaterial);
 }
 
@@ -64,16 +76,6 @@ std::vector<Mesh> Model::LoadModel(VulkanDevice* device, const std::string& file
 	return LoadNode(device, scene->mRootNode, scene);
 }
 
-//---------------------------------------------------------------------------------------------------------------------
-void Model::UpdateUniformBuffers(VulkanDevice* pDevice, uint32_t index)
-{
-	// Copy View Projection data
-	void* data;
-	vkMapMemory(pDevice->m_vkLogicalDevice, m_pShaderUniforms->vecMemory[index], 0, sizeof(ShaderData), 0, &data);
-	memcpy(data, &m_pShaderUniforms->shaderData, sizeof(ShaderData));
-	vkUnmapMemory(pDevice->m_vkLogicalDevice, m_pShaderUniforms->vecMemory[index]);
-}
-
 //---------------------------------------------------------------------------------------------------------------------
 std::vector<Mesh> Model::LoadNode(VulkanDevice* device, aiNode* node, const aiScene* scene)
 {
@@ -99,13 +101,13 @@ std::vector<Mesh> Model::LoadNode(VulkanDevice* device, aiNode* node, const aiSc
 void Model::SetDefaultValues(aiTextureType eType)
 {
 	// if some texture is missing, we still allow to load the default texture to maintain proper descriptor bindings
-	// in shader. Else we would need to manage that dynamically. In shader, for now, we are using boolean flag to decide
-	// if we read from texture or use the color from Editor! 
+	// in shader. Else we would need to manage that dynamically. Feature bit picks G-Buffer permutation that either
+	// reads from texture or uses the color from Editor! 
 	switch (eType)
 	{
 		case aiTextureType_BASE_COLOR:
 		{
-			m_pShaderUniforms->shaderData.hasTextureAEN.r = 0.0f;
+			m_pMaterial->m_uiFeatures &= ~MaterialFeature::ALBEDO_MAP;
 			m_mapTextures.emplace("MissingAlbedo.png", TextureType::TEXTURE_ALBEDO);
 			LOG_ERROR("BaseColor texture not found, using default texture!");
 			break;
@@ -113,7 +115,7 @@ void Model::SetDefaultValues(aiTextureType eType)
 		
 		case aiTextureType_EMISSION_COLOR:
 		{
-			m_pShaderUniforms->shaderData.hasTextureAEN.g = 0.0f;
+			m_pMaterial->m_uiFeatures &= ~MaterialFeature::EMISSIVE_MAP;
 			m_mapTextures.emplace("MissingEmissive.png", TextureType::TEXTURE_EMISSIVE);
 			LOG_ERROR("Emissive texture not found, using default texture!");
 			break;
@@ -121,7 +123,7 @@ void Model::SetDefaultValues(aiTextureType eType)
 
 		case aiTextureType_NORMAL_CAMERA:
 		{
-			m_pShaderUniforms->shaderData.hasTextureAEN.b = 0.0f;
+			m_pMaterial->m_uiFeatures &= ~MaterialFeature::NORMAL_MAP;
 			m_mapTextures.emplace("MissingNormal.png", TextureType::TEXTURE_NORMAL);
 			LOG_ERROR("Normal texture not found, using default texture!");
 			break;
@@ -129,7 +131,7 @@ void Model::SetDefaultValues(aiTextureType eType)
 
 		case aiTextureType_DIFFUSE_ROUGHNESS:
 		{
-			m_pShaderUniforms->shaderData.hasTextureRMO.r = 0.0f;
+			m_pMaterial->m_uiFeatures &= ~MaterialFeature::ROUGHNESS_MAP;
 			m_mapTextures.emplace("MissingRoughness.png", TextureType::TEXTURE_ROUGHNESS);
 			LOG_ERROR("Roughness texture not found, using default texture!");
 			break;
@@ -137,7 +139,7 @@ void Model::SetDefaultValues(aiTextureType eType)
 		
 		case aiTextureType_METALNESS:
 		{
-			m_pShaderUniforms->shaderData.hasTextureRMO.g = 0.0f;
+			m_pMaterial->m_uiFeatures &= ~MaterialFeature::METALNESS_MAP;
 			m_mapTextures.emplace("MissingMetalness.png", TextureType::TEXTURE_METALNESS);
 			LOG_ERROR("Metalness texture not found, using default texture!");
 			break;
@@ -145,7 +147,7 @@ void Model::SetDefaultValues(aiTextureType eType)
 		
 		case aiTextureType_AMBIENT_OCCLUSION:
 		{
-			m_pShaderUniforms->shaderData.hasTextureRMO.b = 0.0f;
+			m_pMaterial->m_uiFeatures &= ~MaterialFeature::OCCLUSION_MAP;
 			m_mapTextures.emplace("MissingAO.png", TextureType::TEXTURE_AO);
 			LOG_ERROR("AO texture not found, using default texture!");
 			break;
@@ -174,42 +176,42 @@ void Model::ExtractTextureFromMaterial(aiMaterial* pMaterial, aiTextureType eTyp
 				{
 					case aiTextureType_BASE_COLOR:
 					{
-						m_pShaderUniforms->shaderData.hasTextureAEN.r = 1.0f;
+						m_pMaterial->m_uiFeatures |= MaterialFeature::ALBEDO_MAP;
 						m_mapTextures.emplace(fileName, TextureType::TEXTURE_ALBEDO);
 						break;
 					}
 
 					case aiTextureType_EMISSION_COLOR:
 					{
-						m_pShaderUniforms->shaderData.hasTextureAEN.g = 1.0f;
+						m_pMaterial->m_uiFeatures |= MaterialFeature::EMISSIVE_MAP;
 						m_mapTextures.emplace(fileName, TextureType::TEXTURE_EMISSIVE);
 						break;
 					}
 
 					case aiTextureType_NORMAL_CAMERA:
 					{
-						m_pShaderUniforms->shaderData.hasTextureAEN.b = 1.0f;
+						m_pMaterial->m_uiFeatures |= MaterialFeature::NORMAL_MAP;
 						m_mapTextures.emplace(fileName, TextureType::TEXTURE_NORMAL);
 						break;
 					}
 
 					case aiTextureType_DIFFUSE_ROUGHNESS:
 					{
-						m_pShaderUniforms->shaderData.hasTextureRMO.r = 1.0f;
+						m_pMaterial->m_uiFeatures |= MaterialFeature::ROUGHNESS_MAP;
 						m_mapTextures.emplace(fileName, TextureType::TEXTURE_ROUGHNESS);
 						break;
 					}
 					
 					case aiTextureType_METALNESS:
 					{
-						m_pShaderUniforms->shaderData.hasTextureRMO.g = 1.0f;
+						m_pMaterial->m_uiFeatures |= MaterialFeature::METALNESS_MAP;
 						m_mapTextures.emplace(fileName, TextureType::TEXTURE_METALNESS);
 						break;
 					}
 					
 					case aiTextureType_AMBIENT_OCCLUSION:
 					{
-						m_pShaderUniforms->shaderData.hasTextureRMO.b = 1.0f;
+						m_pMaterial->m_uiFeatures |= MaterialFeature::OCCLUSION_MAP;
 						m_mapTextures.emplace(fileName, TextureType::TEXTURE_AO);
 						break;
 					}
@@ -234,6 +236,9 @@ void Model::ExtractTextureFromMaterial(aiMaterial* pMaterial, aiTextureType eTyp
 //---------------------------------------------------------------------------------------------------------------------
 void Model::LoadMaterials(VulkanDevice* pDevice, const aiScene* scene)
 {
+	// Texture flags are written into material constants while extracting
+	m_pMaterial = new VulkanMaterial();
+
 	// Go through each material and copy its texture file name
 	for (uint32_t i = 0; i < scene->mNumMaterials; i++)
 	{
@@ -249,8 +254,6 @@ void Model::LoadMaterials(VulkanDevice* pDevice, const aiScene* scene)
 		ExtractTextureFromMaterial(material, aiTextureType_AMBIENT_OCCLUSION);
 	}
 
-	m_pMaterial = new VulkanMaterial();
-
 	std::map<std::string, TextureType>::iterator iter = m_mapTextures.begin();
 	for (; iter != m_mapTextures.end(); ++iter)
 	{
@@ -267,11 +270,14 @@ Mesh Model::LoadMesh(VulkanDevice* pDevice, aiMesh* mesh, const aiScene* scene)
 
 	vertices.resize(mesh->mNumVertices);
 
+	BoundingBox aabb;
+
 	// Loop through each vertex...
 	for (uint64_t i = 0; i < mesh->mNumVertices; i++)
 	{
 		// Set position
 		vertices[i].Position = { mesh->mVertices[i].x, mesh->mVertices[i].y,  mesh->mVertices[i].z };
+		aabb.Expand(vertices[i].Position);
 
 		// Set Normals
 		vertices[i].Normal = { mesh->mNormals[i].x, mesh->mNormals[i].y, mesh->mNormals[i].z };
@@ -306,8 +312,51 @@ Mesh Model::LoadMesh(VulkanDevice* pDevice, aiMesh* mesh, const aiScene* scene)
 		}
 	}
 
+	// Coarser levels reuse the vertices, their indices are appended after full resolution ones in the same buffer
+	std::vector<uint32_t> lodIndices = indices;
+	std::vector<MeshLOD> vecLODs(1);
+	vecLODs[0].uiIndexCount = static_cast<uint32_t>(indices.size());
+
+	if (indices.size() / 3 >= MeshLODConfig::MIN_TRIANGLES)
+	{
+		std::vector<glm::vec3> positions(vertices.size());
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			positions[i] = vertices[i].Position;
+		}
+
+		std::vector<float> vecRatios(std::begin(MeshLODConfig::TARGET_RATIOS), std::end(MeshLODConfig::TARGET_RATIOS));
+		float fMaxError = MeshLODConfig::MAX_ERROR * glm::length(aabb.vecMax - aabb.vecMin);
+
+		std::vector<SimplifiedLOD> vecSimplified;
+		MeshSimplifier::GenerateLODs(positions, indices, vecRatios, fMaxError, vecSimplified);
+
+		for (const SimplifiedLOD& simplified : vecSimplified)
+		{
+			MeshLOD lod;
+			lod.uiFirstIndex = static_cast<uint32_t>(lodIndices.size());
+			lod.uiIndexCount = static_cast<uint32_t>(simplified.vecIndices.size());
+			lod.fError = simplified.fError;
+
+			vecLODs.push_back(lod);
+			lodIndices.insert(lodIndices.end(), simplified.vecIndices.begin(), simplified.vecIndices.end());
+		}
+	}
+
+	LOG_DEBUG("Mesh {0}: {1} triangles, {2} LODs down to {3} triangles", mesh->mName.C_Str(), indices.size() / 3, vecLODs.size(),
+			  vecLODs.back().uiIndexCount / 3);
+
 	// Create new mesh with details & return it!
-	Mesh newMesh(pDevice, vertices, indices);
+	Mesh newMesh(pDevice, vertices, lodIndices);
+	newMesh.SetLODs(vecLODs);
+	newMesh.m_AABB = aabb;
+
+	// Keep CPU copy for merged scene geometry (GPU driven path), all LODs so their ranges stay relative to m_uiFirstIndex
+	newMesh.m_uiFirstIndex = static_cast<uint32_t>(m_vecIndices.size());
+	newMesh.m_iVertexOffset = static_cast<int32_t>(m_vecVertices.size());
+	m_vecVertices.insert(m_vecVertices.end(), vertices.begin(), vertices.end());
+	m_vecIndices.insert(m_vecIndices.end(), lodIndices.begin(), lodIndices.end());
+
 	return newMesh;
 }
 
@@ -319,351 +368,257 @@ void Model::Update(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, float dt)
 	{
 		m_fCurrentAngle += dt * m_fAutoRotateSpeed;
 		if (m_fCurrentAngle > 360.0f) { m_fCurrentAngle = 0.0f; }
+
+		m_bBoundsDirty = true;
 	}
 	
 	m_fAngle = m_fCurrentAngle;
 
 	// Update Model matrix!
-	m_pShaderUniforms->shaderData.model = glm::mat4(1);
-	m_pShaderUniforms->shaderData.model = glm::translate(m_pShaderUniforms->shaderData.model, m_vecPosition);
-	m_pShaderUniforms->shaderData.model = glm::rotate(m_pShaderUniforms->shaderData.model, m_fAngle, m_vecRotationAxis);
-	m_pShaderUniforms->shaderData.model = glm::scale(m_pShaderUniforms->shaderData.model, m_vecScale);
-
-	// Fetch View & Projection matrices from the Camera!	
-	m_pShaderUniforms->shaderData.projection = Camera::getInstance().m_matProjection;
-
-	m_pShaderUniforms->shaderData.view = Camera::getInstance().m_matView;
-	m_pShaderUniforms->shaderData.projection[1][1] *= -1.0f;
+	m_ObjectData.matModel = glm::mat4(1);
+	m_ObjectData.matModel = glm::translate(m_ObjectData.matModel, m_vecPosition);
+	m_ObjectData.matModel = glm::rotate(m_ObjectData.matModel, m_fAngle, m_vecRotationAxis);
+	m_ObjectData.matModel = glm::scale(m_ObjectData.matModel, m_vecScale);
 
 	// Update object ID
-	m_pShaderUniforms->shaderData.objectID = static_cast<uint32_t>(m_eType);
+	m_ObjectData.objectID = static_cast<uint32_t>(m_eType);
+
+	// world bounds only change with transform
+	if (m_bBoundsDirty || m_vecWorldAABB.size() != m_vecMeshes.size())
+		UpdateBounds();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void Model::Render (VulkanDevice* pDevice, VulkanGraphicsPipeline* pPipeline, uint32_t index)
+void Model::UpdateBounds()
 {
-	for (int i = 0; i < m_vecMeshes.size(); ++i)
-	{
+	const glm::mat4& matModel = m_ObjectData.matModel;
 
-		VkBuffer vertexBuffers[] = { m_vecMeshes[i].m_vkVertexBuffer };										// Buffers to bind
-		VkBuffer indexBuffer = m_vecMeshes[i].m_vkIndexBuffer;
-		VkDeviceSize offsets[] = { 0 };																			// offsets into buffers being bound
-		vkCmdBindVertexBuffers(pDevice->m_vecCommandBufferGraphics[index], 0, 1, vertexBuffers, offsets);		// Command to bind vertex buffer before drawing with them
-
-		// bind mesh index buffer, with zero offset & using uint32_t type
-		vkCmdBindIndexBuffer(pDevice->m_vecCommandBufferGraphics[index], indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-		// bind descriptor sets
-		vkCmdBindDescriptorSets(pDevice->m_vecCommandBufferGraphics[index],
-								VK_PIPELINE_BIND_POINT_GRAPHICS,
-								pPipeline->m_vkPipelineLayout,
-								0,
-								1,
-								&(m_vecDescriptorSet[index]),
-								0,
-								nullptr);
-
-		// Execute pipeline
-		vkCmdDrawIndexed(pDevice->m_vecCommandBufferGraphics[index], m_vecMeshes[i].m_uiIndexCount, 1, 0, 0, 0);
-	}
-}
+	m_vecWorldAABB.resize(m_vecMeshes.size());
+	m_vecMeshVisible.resize(m_vecMeshes.size(), 1);
+	m_vecMeshLOD.resize(m_vecMeshes.size(), 0);
 
-//---------------------------------------------------------------------------------------------------------------------
-void Model::SetupDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
-{
-	m_pShaderUniforms->CreateBuffers(pDevice, pSwapchain);
+	// Proxies are handed to BVH by address, so only (re)built while none is inserted yet
+	if (m_vecMeshProxies.size() != m_vecMeshes.size())
+	{
+		m_vecMeshProxies.resize(m_vecMeshes.size());
+		for (uint32_t i = 0; i < m_vecMeshes.size(); ++i)
+		{
+			m_vecMeshProxies[i] = { this, i, -1 };
+		}
+	}
 
-	// *** Create Descriptor pool
-	std::array<VkDescriptorPoolSize, 2> arrDescriptorPoolSize = {};
+	// LOD errors are in mesh space, projected error needs the largest stretch applied on top
+	m_fWorldScale = std::max({ glm::length(glm::vec3(matModel[0])), glm::length(glm::vec3(matModel[1])), glm::length(glm::vec3(matModel[2])) });
+	if (IsInstanced())
+	{
+		float fMaxInstanceScale = 0.0f;
+		for (const glm::mat4& matInstance : m_vecInstances)
+		{
+			fMaxInstanceScale = std::max({ fMaxInstanceScale, glm::length(glm::vec3(matInstance[0])), glm::length(glm::vec3(matInstance[1])),
+										   glm::length(glm::vec3(matInstance[2])) });
+		}
 
-	//-- Uniform Buffer
-	arrDescriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	arrDescriptorPoolSize[0].descriptorCount = static_cast<uint32_t>(pSwapchain->m_vecSwapchainImages.size());
+		m_fWorldScale *= fMaxInstanceScale;
+	}
 
-	//-- Texture samplers
-	arrDescriptorPoolSize[1].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorPoolSize[1].descriptorCount = static_cast<uint32_t>(m_mapTextures.size());
+	m_WorldAABB = BoundingBox();
+	for (uint32_t i = 0; i < m_vecMeshes.size(); ++i)
+	{
+		if (IsInstanced())
+		{
+			// Mesh bounds cover every instance, whole group is drawn or culled together
+			m_vecWorldAABB[i] = BoundingBox();
+			for (const glm::mat4& matInstance : m_vecInstances)
+			{
+				BoundingBox box = m_vecMeshes[i].m_AABB.Transform(matModel * matInstance);
+				m_vecWorldAABB[i].Expand(box.vecMin);
+				m_vecWorldAABB[i].Expand(box.vecMax);
+			}
+		}
+		else
+		{
+			m_vecWorldAABB[i] = m_vecMeshes[i].m_AABB.Transform(matModel);
+		}
 
-	VkDescriptorPoolCreateInfo poolCreateInfo = {};
-	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.maxSets = static_cast<uint32_t>(m_mapTextures.size()) + static_cast<uint32_t>(pSwapchain->m_vecSwapchainImages.size());
-	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrDescriptorPoolSize.size());
-	poolCreateInfo.pPoolSizes = arrDescriptorPoolSize.data();
+		m_WorldAABB.Expand(m_vecWorldAABB[i].vecMin);
+		m_WorldAABB.Expand(m_vecWorldAABB[i].vecMax);
+	}
+}
 
-	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vkDescriptorPool) != VK_SUCCESS)
+//---------------------------------------------------------------------------------------------------------------------
+void Model::AddInstance(const glm::mat4& matTransform)
+{
+	if (!IsInstanced())
 	{
-		LOG_ERROR("Failed to create Sampler Descriptor Pool");
+		LOG_ERROR("AddInstance() called on non instanced model!");
+		return;
 	}
-	else
-		LOG_DEBUG("Successfully created Descriptor Pool");
-
-	// *** Create Descriptor Set Layout
-	std::array<VkDescriptorSetLayoutBinding, 7> arrDescriptorSetLayoutBindings = {};
-
-	//-- Uniform Buffer
-	arrDescriptorSetLayoutBindings[0].binding = 0;																// binding point in shader, binding = ?
-	arrDescriptorSetLayoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;						// type of descriptor (uniform, dynamic uniform etc.) 
-	arrDescriptorSetLayoutBindings[0].descriptorCount = 1;														// number of descriptors
-	arrDescriptorSetLayoutBindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;	// Shader stage to bind to
-	arrDescriptorSetLayoutBindings[0].pImmutableSamplers = nullptr;												// For textures!
-
-	//-- BaseColor Texture
-	arrDescriptorSetLayoutBindings[1].binding = 1;
-	arrDescriptorSetLayoutBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;						
-	arrDescriptorSetLayoutBindings[1].descriptorCount = 1;														
-	arrDescriptorSetLayoutBindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;									
-	arrDescriptorSetLayoutBindings[1].pImmutableSamplers = nullptr;
-
-	//-- Metalness Texture
-	arrDescriptorSetLayoutBindings[2].binding = 2;
-	arrDescriptorSetLayoutBindings[2].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorSetLayoutBindings[2].descriptorCount = 1;
-	arrDescriptorSetLayoutBindings[2].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-	arrDescriptorSetLayoutBindings[2].pImmutableSamplers = nullptr;
-
-	//-- Normal Texture
-	arrDescriptorSetLayoutBindings[3].binding = 3;
-	arrDescriptorSetLayoutBindings[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorSetLayoutBindings[3].descriptorCount = 1;
-	arrDescriptorSetLayoutBindings[3].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-	arrDescriptorSetLayoutBindings[3].pImmutableSamplers = nullptr;
-
-	//-- Roughness Texture
-	arrDescriptorSetLayoutBindings[4].binding = 4;
-	arrDescriptorSetLayoutBindings[4].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorSetLayoutBindings[4].descriptorCount = 1;
-	arrDescriptorSetLayoutBindings[4].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-	arrDescriptorSetLayoutBindings[4].pImmutableSamplers = nullptr;
-
-	//-- AO Texture
-	arrDescriptorSetLayoutBindings[5].binding = 5;
-	arrDescriptorSetLayoutBindings[5].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorSetLayoutBindings[5].descriptorCount = 1;
-	arrDescriptorSetLayoutBindings[5].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-	arrDescriptorSetLayoutBindings[5].pImmutableSamplers = nullptr;
-
-	//-- Emission Texture
-	arrDescriptorSetLayoutBindings[6].binding = 6;
-	arrDescriptorSetLayoutBindings[6].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorSetLayoutBindings[6].descriptorCount = 1;
-	arrDescriptorSetLayoutBindings[6].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-	arrDescriptorSetLayoutBindings[6].pImmutableSamplers = nullptr;
-
-	VkDescriptorSetLayoutCreateInfo descSetlayoutCreateInfo = {};
-	descSetlayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	descSetlayoutCreateInfo.bindingCount = arrDescriptorSetLayoutBindings.size();
-	descSetlayoutCreateInfo.pBindings = arrDescriptorSetLayoutBindings.data();
-
-	// Create descriptor set layout
-	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &descSetlayoutCreateInfo, nullptr, &m_vkDescriptorSetLayout) != VK_SUCCESS)
+
+	m_vecInstances.push_back(matTransform);
+	m_bBoundsDirty = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Model::CreateInstanceBuffer(VulkanDevice* pDevice)
+{
+	if (m_vecInstances.empty())
 	{
-		LOG_ERROR("Failed to create a Descriptor set layout");
+		LOG_ERROR("Instanced model has no instances, adding identity!");
+		m_vecInstances.push_back(glm::mat4(1));
 	}
-	else
-		LOG_DEBUG("Successfully created a Descriptor set layout");
 
-	// *** Create Descriptor Set per swapchain image!
-	m_vecDescriptorSet.resize(pSwapchain->m_vecSwapchainImages.size());
+	VkDeviceSize bufferSize = m_vecInstances.size() * sizeof(glm::mat4);
 
-	// we create copies of DescriptorSetLayout per swapchain image
-	std::vector<VkDescriptorSetLayout> descriptorSetLayouts(pSwapchain->m_vecSwapchainImages.size(), m_vkDescriptorSetLayout);
+	// Temporary buffer to "stage" instance data before transferring to GPU
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
 
-	// Descriptor set allocation info 
-	VkDescriptorSetAllocateInfo	setAllocInfo = {};
-	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	setAllocInfo.descriptorPool = m_vkDescriptorPool;													// pool to allocate descriptor set from
-	setAllocInfo.descriptorSetCount = static_cast<uint32_t>(pSwapchain->m_vecSwapchainImages.size());	// number of sets to allocate
-	setAllocInfo.pSetLayouts = descriptorSetLayouts.data();												// layouts to use to allocate sets
+	pDevice->CreateBuffer(bufferSize,
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		&stagingBuffer,
+		&stagingBufferMemory);
 
-	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &setAllocInfo, m_vecDescriptorSet.data()) != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to allocated Descriptor sets");
-	}
-	else
-		LOG_DEBUG("Successfully created Descriptor sets");
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory, 0, bufferSize, 0, &data);
+	memcpy(data, m_vecInstances.data(), (size_t)bufferSize);
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory);
 
+	// Device local buffer read as per instance vertex stream
+	pDevice->CreateBuffer(bufferSize,
+		VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		&m_vkInstanceBuffer,
+		&m_vkInstanceBufferMemory);
 
-	// *** Update all the descriptor set bindings
-	for (uint16_t i = 0; i < pSwapchain->m_vecSwapchainImages.size(); i++)
-	{
-		//-- Uniform Buffer
-		VkDescriptorBufferInfo ubBufferInfo = {};
-		ubBufferInfo.buffer = m_pShaderUniforms->vecBuffer[i];			// buffer to get data from
-		ubBufferInfo.offset = 0;											// position of start of data
-		ubBufferInfo.range = sizeof(ShaderUniforms);						// size of data
-
-		// Data about connection between binding & buffer
-		VkWriteDescriptorSet ubSetWrite = {};
-		ubSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		ubSetWrite.dstSet = m_vecDescriptorSet[i];							// Descriptor set to update
-		ubSetWrite.dstBinding = 0;											// binding to update
-		ubSetWrite.dstArrayElement = 0;										// index in array to update
-		ubSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;		// type of descriptor
-		ubSetWrite.descriptorCount = 1;										// amount to update		
-		ubSetWrite.pBufferInfo = &ubBufferInfo;
-		
-		//-- Base Texture
-		VkDescriptorImageInfo albedoImageInfo = {};
-		albedoImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;											// Image layout when in use
-		albedoImageInfo.imageView = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_ALBEDO)->m_vkTextureImageView;	// image to bind to set
-		albedoImageInfo.sampler = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_ALBEDO)->m_vkTextureSampler;		// sampler to use for the set
-
-		// Descriptor write info
-		VkWriteDescriptorSet albedoSetWrite = {};
-		albedoSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		albedoSetWrite.dstSet = m_vecDescriptorSet[i];
-		albedoSetWrite.dstBinding = 1;
-		albedoSetWrite.dstArrayElement = 0;
-		albedoSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		albedoSetWrite.descriptorCount = 1;
-		albedoSetWrite.pImageInfo = &albedoImageInfo;
-
-		//-- Metalness Texture
-		VkDescriptorImageInfo metalnessImageInfo = {};
-		metalnessImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;											// Image layout when in use
-		metalnessImageInfo.imageView = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_METALNESS)->m_vkTextureImageView;	// image to bind to set
-		metalnessImageInfo.sampler = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_METALNESS)->m_vkTextureSampler;		// sampler to use for the set
-
-		// Descriptor write info
-		VkWriteDescriptorSet metalnessSetWrite = {};
-		metalnessSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		metalnessSetWrite.dstSet = m_vecDescriptorSet[i];
-		metalnessSetWrite.dstBinding = 2;
-		metalnessSetWrite.dstArrayElement = 0;
-		metalnessSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		metalnessSetWrite.descriptorCount = 1;
-		metalnessSetWrite.pImageInfo = &metalnessImageInfo;
-
-		//-- Normal Texture
-		VkDescriptorImageInfo normalImageInfo = {};
-		normalImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;											// Image layout when in use
-		normalImageInfo.imageView = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_NORMAL)->m_vkTextureImageView;	// image to bind to set
-		normalImageInfo.sampler = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_NORMAL)->m_vkTextureSampler;		// sampler to use for the set
-
-		// Descriptor write info
-		VkWriteDescriptorSet normalSetWrite = {};
-		normalSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		normalSetWrite.dstSet = m_vecDescriptorSet[i];
-		normalSetWrite.dstBinding = 3;
-		normalSetWrite.dstArrayElement = 0;
-		normalSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		normalSetWrite.descriptorCount = 1;
-		normalSetWrite.pImageInfo = &normalImageInfo;
-
-		//-- Roughness Texture
-		VkDescriptorImageInfo roughnessImageInfo = {};
-		roughnessImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;											// Image layout when in use
-		roughnessImageInfo.imageView = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_ROUGHNESS)->m_vkTextureImageView;	// image to bind to set
-		roughnessImageInfo.sampler = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_ROUGHNESS)->m_vkTextureSampler;		// sampler to use for the set
-
-		// Descriptor write info
-		VkWriteDescriptorSet roughnessSetWrite = {};
-		roughnessSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		roughnessSetWrite.dstSet = m_vecDescriptorSet[i];
-		roughnessSetWrite.dstBinding = 4;
-		roughnessSetWrite.dstArrayElement = 0;
-		roughnessSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		roughnessSetWrite.descriptorCount = 1;
-		roughnessSetWrite.pImageInfo = &roughnessImageInfo;
-
-		//-- AO Texture
-		VkDescriptorImageInfo AOImageInfo = {};
-		AOImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;											// Image layout when in use
-		AOImageInfo.imageView = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_AO)->m_vkTextureImageView;		// image to bind to set
-		AOImageInfo.sampler = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_AO)->m_vkTextureSampler;			// sampler to use for the set
-
-		// Descriptor write info
-		VkWriteDescriptorSet AOSetWrite = {};
-		AOSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		AOSetWrite.dstSet = m_vecDescriptorSet[i];
-		AOSetWrite.dstBinding = 5;
-		AOSetWrite.dstArrayElement = 0;
-		AOSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		AOSetWrite.descriptorCount = 1;
-		AOSetWrite.pImageInfo = &AOImageInfo;
-
-		//-- Emission Texture
-		VkDescriptorImageInfo emissionImageInfo = {};
-		emissionImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;											// Image layout when in use
-		emissionImageInfo.imageView = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_EMISSIVE)->m_vkTextureImageView;	// image to bind to set
-		emissionImageInfo.sampler = m_pMaterial->m_mapTextures.at(TextureType::TEXTURE_EMISSIVE)->m_vkTextureSampler;		// sampler to use for the set
-
-		// Descriptor write info
-		VkWriteDescriptorSet emissionSetWrite = {};
-		emissionSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		emissionSetWrite.dstSet = m_vecDescriptorSet[i];
-		emissionSetWrite.dstBinding = 6;
-		emissionSetWrite.dstArrayElement = 0;
-		emissionSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-		emissionSetWrite.descriptorCount = 1;
-		emissionSetWrite.pImageInfo = &emissionImageInfo;
-
-		// List of Descriptor set writes
-		std::vector<VkWriteDescriptorSet> setWrites = { ubSetWrite, albedoSetWrite, metalnessSetWrite, normalSetWrite,
-														roughnessSetWrite, AOSetWrite, emissionSetWrite };
-		
-		// Update the descriptor sets with new buffer/binding info
-		vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, static_cast<uint32_t>(setWrites.size()), setWrites.data(), 0, nullptr);
-	}
+	pDevice->CopyBuffer(stagingBuffer, m_vkInstanceBuffer, bufferSize);
+
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, stagingBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory, nullptr);
+
+	LOG_DEBUG("Created instance buffer for {0} instances", m_vecInstances.size());
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void Model::Cleanup(VulkanDevice* pDevice)
+// Culled meshes are still recorded, their draw arguments carry zero instances for the frame
+void Model::Render(VulkanDevice* pDevice, VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline, VkBuffer vkDrawArgs)
 {
-	m_pShaderUniforms->Cleanup(pDevice);
-	m_pMaterial->Cleanup(pDevice);
+	// All meshes share model transform & material, so one permutation for the whole model
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->GetPermutation(GetMaterialFeatures()));
+	PushConstants(cmdBuffer, pPipeline);
 
-	std::vector<Mesh>::iterator iter = m_vecMeshes.begin();
-	for (; iter != m_vecMeshes.end(); iter++)
+	for (uint32_t i = 0; i < m_vecMeshes.size(); ++i)
 	{
-		(*iter).Cleanup(pDevice);
+		BindMeshGeometry(cmdBuffer, i);
+		DrawMesh(cmdBuffer, vkDrawArgs, i);
 	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Only object slot is baked into command buffer, transform & material are read from FrameGlobals object buffer
+void Model::PushConstants(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline)
+{
+	vkCmdPushConstants(cmdBuffer, pPipeline->m_vkPipelineLayout, SceneSetConfig::OBJECT_PUSH_STAGES, 0, sizeof(PushConstantData), &m_PushConstantData);
+}
 
-	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, m_vkDescriptorPool, nullptr);
-	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkDescriptorSetLayout, nullptr);
+//---------------------------------------------------------------------------------------------------------------------
+uint32_t Model::GetMaterialFeatures()
+{
+	return m_pMaterial->m_uiFeatures;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void Model::CleanupOnWindowResize(VulkanDevice* pDevice)
+void Model::BindMeshGeometry(VkCommandBuffer cmdBuffer, uint32_t uiMesh)
 {
+	VkBuffer vertexBuffers[] = { m_vecMeshes[uiMesh].m_vkVertexBuffer, m_vkInstanceBuffer };				// Buffers to bind
+	VkBuffer indexBuffer = m_vecMeshes[uiMesh].m_vkIndexBuffer;
+	VkDeviceSize offsets[] = { 0, 0 };																		// offsets into buffers being bound
+	uint32_t nVertexBuffers = IsInstanced() ? 2 : 1;														// instance stream only for instanced pipeline
+	vkCmdBindVertexBuffers(cmdBuffer, 0, nVertexBuffers, vertexBuffers, offsets);							// Command to bind vertex buffer before drawing with them
+
+	// bind mesh index buffer, with zero offset & using uint32_t type
+	vkCmdBindIndexBuffer(cmdBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+}
 
+//---------------------------------------------------------------------------------------------------------------------
+void Model::BindMeshPositions(VkCommandBuffer cmdBuffer, uint32_t uiMesh)
+{
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &m_vecMeshes[uiMesh].m_vkPositionBuffer, offsets);
+	vkCmdBindIndexBuffer(cmdBuffer, m_vecMeshes[uiMesh].m_vkIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void ShaderUniforms::CreateBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapChain)
+void Model::DrawMesh(VkCommandBuffer cmdBuffer, VkBuffer vkDrawArgs, uint32_t uiMesh)
 {
-	// ViewProjection buffer size
-	VkDeviceSize vpBufferSize = sizeof(ShaderUniforms);
+	uint32_t uiSlot = m_uiFirstDrawSlot + uiMesh;
+	if (uiSlot >= SceneSetConfig::MAX_DRAWS || m_PushConstantData.objectIndex >= SceneSetConfig::MAX_OBJECTS)
+		return;
+
+	// Execute pipeline, index range & instance count are written every frame by Scene::WriteDrawArgs()
+	vkCmdDrawIndexedIndirect(cmdBuffer, vkDrawArgs, uiSlot * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+}
 
-	// one uniform buffer for each image (and by extension command buffer)
-	vecBuffer.resize(pSwapChain->m_vecSwapchainImages.size());
-	vecMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+//---------------------------------------------------------------------------------------------------------------------
+void Model::FillDrawArgs(uint32_t uiMesh, uint32_t uiLOD, bool bVisible, VkDrawIndexedIndirectCommand& outArgs)
+{
+	const Mesh& mesh = m_vecMeshes[uiMesh];
 
-	// create uniform buffers
-	for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+	outArgs.indexCount = mesh.m_uiIndexCount;
+	outArgs.firstIndex = 0;
+	if (uiLOD < mesh.m_vecLODs.size())
 	{
-		pDevice->CreateBuffer(vpBufferSize,
-			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-			&vecBuffer[i],
-			&vecMemory[i]);
+		outArgs.firstIndex = mesh.m_vecLODs[uiLOD].uiFirstIndex;
+		outArgs.indexCount = mesh.m_vecLODs[uiLOD].uiIndexCount;
 	}
+
+	// Culled meshes stay in command buffer as empty draws
+	outArgs.instanceCount = bVisible ? (IsInstanced() ? GetInstanceCount() : 1) : 0;
+	outArgs.vertexOffset = 0;
+	outArgs.firstInstance = 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void ShaderUniforms::Cleanup(VulkanDevice* pDevice)
+uint32_t Model::GetDrawTriangleCount(uint32_t uiMesh, uint32_t uiLOD)
 {
-	for (uint16_t i = 0; i < vecBuffer.size(); ++i)
-	{
-		vkDestroyBuffer(pDevice->m_vkLogicalDevice, vecBuffer[i], nullptr);
-		vkFreeMemory(pDevice->m_vkLogicalDevice, vecMemory[i], nullptr);
-	}
+	const Mesh& mesh = m_vecMeshes[uiMesh];
+	uint32_t uiIndexCount = (uiLOD < mesh.m_vecLODs.size()) ? mesh.m_vecLODs[uiLOD].uiIndexCount : mesh.m_uiIndexCount;
+
+	return (uiIndexCount / 3) * (IsInstanced() ? GetInstanceCount() : 1);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void ShaderUniforms::CleanupOnWindowResize(VulkanDevice* pDevice)
+void Model::SetupDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
 {
+	if (IsInstanced())
+		CreateInstanceBuffer(pDevice);
 
+	// Textures & constants live in global bindless set, draws only push material's slot
+	m_pMaterial->RegisterBindless(pDevice);
+	m_ObjectData.materialIndex = m_pMaterial->m_uiMaterialIndex;
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void Model::Cleanup(VulkanDevice* pDevice)
+{
+	m_pMaterial->Cleanup(pDevice);
 
+	std::vector<Mesh>::iterator iter = m_vecMeshes.begin();
+	for (; iter != m_vecMeshes.end(); iter++)
+	{
+		(*iter).Cleanup(pDevice);
+	}
+
+	if (m_vkInstanceBuffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vkInstanceBuffer, nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkInstanceBufferMemory, nullptr);
+		m_vkInstanceBuffer = VK_NULL_HANDLE;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Model::CleanupOnWindowResize(VulkanDevice* pDevice)
+{
+
+}
@@ -10,69 +10,33 @@ class VulkanSwapChain;
 class VulkanMaterial;
 class VulkanTexture2D;
 class VulkanGraphicsPipeline;
+class Model;
 enum class TextureType;
 
 //---------------------------------------------------------------------------------------------------------------------
-enum class ModelType
+namespace MeshLODConfig
 {
-	STATIC_OPAQUE = 1
-};
+	constexpr uint32_t					MAX_LODS = 5;										// including full resolution
+	constexpr float						TARGET_RATIOS[MAX_LODS - 1] = { 0.5f, 0.25f, 0.12f, 0.06f };	// of LOD 0 triangles
+	constexpr float						MAX_ERROR = 0.05f;									// fraction of mesh bounds diagonal
+	constexpr uint32_t					MIN_TRIANGLES = 256;								// smaller meshes keep LOD 0 only
+	constexpr float						HYSTERESIS = 0.25f;									// finer LOD only once error exceeds threshold by this
+}
 
 //---------------------------------------------------------------------------------------------------------------------
-struct ShaderData
+// BVH leaf user data, Scene indexes every mesh of a model on its own
+struct MeshProxy
 {
-	ShaderData()
-	{
-		model				= glm::mat4(1);
-		view				= glm::mat4(1);
-		projection			= glm::mat4(1);
-		
-
-		albedoColor			= glm::vec4(1.0f);
-		emissiveColor		= glm::vec4(1,1,0,1);
-		hasTextureAEN		= glm::vec3(0, 0, 0);
-		hasTextureRMO		= glm::vec3(0, 0, 0);
-
-		ao					= 0.0f;
-		roughness			= 0.5f;
-		metalness			= 0.5f;
-		objectID			= 1;
-	}
-
-	// Data Specific
-	alignas(64) glm::mat4				model;
-	alignas(64) glm::mat4				view;
-	alignas(64) glm::mat4				projection;
-
-	// Material Properties
-	alignas(16) glm::vec4				albedoColor;
-	alignas(16) glm::vec4				emissiveColor;
-	alignas(16) glm::vec3				hasTextureAEN;		// R-Albedo, G-Emissive, B-Normal
-	alignas(16) glm::vec3				hasTextureRMO;		// R-Roughness, G-Metalness, B-Occlusion
-	alignas(4)  float					ao;
-	alignas(4)	float					roughness;
-	alignas(4)	float					metalness;
-	alignas(4)	uint32_t				objectID;
+	Model*								pModel;
+	uint32_t							uiMesh;
+	int32_t								iProxy;								// -1 until Scene inserts mesh into its BVH
 };
+
 //---------------------------------------------------------------------------------------------------------------------
-struct ShaderUniforms
+enum class ModelType
 {
-	ShaderUniforms()
-	{
-		vecBuffer.clear();
-		vecMemory.clear();
-	}
-
-	void								CreateBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
-
-	void								Cleanup(VulkanDevice* pDevice);
-	void								CleanupOnWindowResize(VulkanDevice* pDevice);
-
-	ShaderData							shaderData;
-
-	// Vulkan Specific
-	std::vector<VkBuffer>				vecBuffer;
-	std::vector<VkDeviceMemory>			vecMemory;
+	STATIC_OPAQUE = 1,
+	STATIC_OPAQUE_INSTANCED = 2			// one mesh & material set, many transforms, drawn with single instanced draw per mesh
 };
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -83,24 +47,42 @@ public:
 	~Model();
 
 	std::vector<Mesh>					LoadModel(VulkanDevice* device, const std::string& filePath);
-	void								UpdateUniformBuffers(VulkanDevice* pDevice, uint32_t index);
 	void								Update(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, float dt);
-	void								Render(VulkanDevice* pDevice, VulkanGraphicsPipeline* pPipeline, uint32_t index);
+	void								Render(VulkanDevice* pDevice, VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline, VkBuffer vkDrawArgs);
+
+	// Render() split into state & draw, lets the render queue skip redundant binds
+	void								PushConstants(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline);
+	void								BindMeshGeometry(VkCommandBuffer cmdBuffer, uint32_t uiMesh);
+	void								BindMeshPositions(VkCommandBuffer cmdBuffer, uint32_t uiMesh);		// depth pre-pass
+	void								DrawMesh(VkCommandBuffer cmdBuffer, VkBuffer vkDrawArgs, uint32_t uiMesh);	// indirect, from mesh's draw slot
+	void								FillDrawArgs(uint32_t uiMesh, uint32_t uiLOD, bool bVisible, VkDrawIndexedIndirectCommand& outArgs);
+	uint32_t							GetDrawTriangleCount(uint32_t uiMesh, uint32_t uiLOD);						// all instances
 	void								SetupDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
 	void								Cleanup(VulkanDevice* pDevice);
 	void								CleanupOnWindowResize(VulkanDevice* pDevice);
 
+	// --- INSTANCING! Transforms are relative to model transform, must be added before SetupDescriptors()
+	void								AddInstance(const glm::mat4& matTransform);
+	inline bool							IsInstanced()							{ return m_eType == ModelType::STATIC_OPAQUE_INSTANCED; }
+	inline uint32_t						GetInstanceCount()						{ return static_cast<uint32_t>(m_vecInstances.size()); }
+
 	// --- SETTERS!
-	inline void							SetPosition(const glm::vec3& _pos)		{ m_vecPosition = _pos; }
-	inline void							SetRotationAxis(const glm::vec3& _axis) { m_vecRotationAxis = _axis; }
-	inline void							SetRotationAngle(float angle)			{ m_fAngle = angle; }
-	inline void							SetScale(const glm::vec3& _scale)		{ m_vecScale = _scale; }
+	inline void							SetPosition(const glm::vec3& _pos)		{ m_vecPosition = _pos; m_bBoundsDirty = true; }
+	inline void							SetRotationAxis(const glm::vec3& _axis) { m_vecRotationAxis = _axis; m_bBoundsDirty = true; }
+	inline void							SetRotationAngle(float angle)			{ m_fAngle = angle; m_bBoundsDirty = true; }
+	inline void							SetScale(const glm::vec3& _scale)		{ m_vecScale = _scale; m_bBoundsDirty = true; }
 
 	// --- GETTERS!
 	inline	glm::vec3					GetPosition()							{ return m_vecPosition; }
 	inline	glm::vec3					GetRotationAxis()						{ return  m_vecRotationAxis; }
 	inline  float						GetRotationAngle()						{ return m_fAngle; }
 	inline	glm::vec3					GetScale()								{ return m_vecScale; }
+	inline	uint32_t					GetMeshCount()							{ return static_cast<uint32_t>(m_vecMeshes.size()); }
+	inline	const BoundingBox&			GetWorldAABB()							{ return m_WorldAABB; }
+	inline	const std::vector<Mesh>&	GetMeshes()								{ return m_vecMeshes; }
+	inline	VulkanMaterial*				GetMaterial()							{ return m_pMaterial; }
+	inline	const glm::mat4&			GetModelMatrix()						{ return m_ObjectData.matModel; }
+	uint32_t							GetMaterialFeatures();												// G-Buffer permutation key
 
 private:
 	std::vector<Mesh>					LoadNode(VulkanDevice* device, aiNode* node, const aiScene* scene);
@@ -109,6 +91,8 @@ private:
 	void								ExtractTextureFromMaterial(aiMaterial* pMaterial, aiTextureType eType);
 	void								LoadMaterials(VulkanDevice* device, const aiScene* scene);
 	Mesh								LoadMesh(VulkanDevice* device, aiMesh* mesh, const aiScene* scene);
+	void								UpdateBounds();
+	void								CreateInstanceBuffer(VulkanDevice* pDevice);
 
 private:
 	std::vector<Mesh>					m_vecMeshes;
@@ -117,12 +101,20 @@ private:
 	ModelType							m_eType;
 	VulkanMaterial*						m_pMaterial;
 
+	// Per instance vertex stream (binding 1), static so shared by all swapchain images
+	std::vector<glm::mat4>				m_vecInstances;
+	VkBuffer							m_vkInstanceBuffer;
+	VkDeviceMemory						m_vkInstanceBufferMemory;
+
 public:
-	VkDescriptorPool					m_vkDescriptorPool;					// Pool for all descriptors.
-	VkDescriptorSetLayout				m_vkDescriptorSetLayout;			// combination of layouts of uniforms & samplers.
-	std::vector<VkDescriptorSet>		m_vecDescriptorSet;					// combination of sets of uniforms & samplers per swapchain image!
+	// Camera & light come from FrameGlobals, material from MaterialRegistry. Object data is copied into FrameGlobals
+	// object buffer every frame, draws only push its slot (assigned by Scene)
+	ObjectShaderData					m_ObjectData;
+	PushConstantData					m_PushConstantData;
 
-	ShaderUniforms*						m_pShaderUniforms;
+	// CPU copy of all meshes' geometry incl. LOD indices, meshes reference it through m_uiFirstIndex/m_iVertexOffset
+	std::vector<Helper::App::VertexPNTBT>	m_vecVertices;
+	std::vector<uint32_t>					m_vecIndices;
 
 private:
 	glm::vec3							m_vecPosition;
@@ -135,5 +127,15 @@ public:
 	bool								m_bAutoRotate;
 	float								m_fAutoRotateSpeed;
 	std::string							m_strName;
+
+	// Culling
+	std::vector<BoundingBox>			m_vecWorldAABB;						// per mesh bounds in world space, refreshed in Update()
+	std::vector<uint8_t>				m_vecMeshVisible;					// per mesh frustum test result, written by Scene
+	std::vector<uint8_t>				m_vecMeshLOD;						// per mesh selected detail level, written by Scene
+	uint32_t							m_uiFirstDrawSlot;					// draw slot of mesh 0 in FrameGlobals draw arguments, assigned by Scene
+	float								m_fWorldScale;						// largest axis scale of model (& instance) transform
+	BoundingBox							m_WorldAABB;						// union of all mesh bounds
+	bool								m_bBoundsDirty;						// transform changed, Scene refits BVH proxies & clears it
+	std::vector<MeshProxy>				m_vecMeshProxies;					// one BVH leaf per mesh, sized along with bounds
 };
 
@@ -0,0 +1,303 @@
+#include "PlaygroundPCH.h"
+#include "ClusteredLighting.h"
+
+#include "VulkanDevice.h"
+#include "VulkanSwapChain.h"
+#include "VulkanComputePipeline.h"
+
+#include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Log.h"
+#include "Engine/Helpers/Camera.h"
+#include "Engine/RenderObjects/Light.h"
+#include "Engine/Scene.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+ClusteredLighting::ClusteredLighting()
+{
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+	m_vecDescriptorSets.clear();
+
+	m_pBinningPipeline = nullptr;
+
+	m_vkExtent = { 0, 0 };
+	m_uiLightCount = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+ClusteredLighting::~ClusteredLighting()
+{
+	SAFE_DELETE(m_pBinningPipeline);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ClusteredLighting::Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	CreateDescriptorSetLayout(pDevice);
+	CreatePerFrameBuffers(pDevice, pSwapchain);
+	CreateDescriptors(pDevice, pSwapchain);
+
+	m_pBinningPipeline = new VulkanComputePipeline("Shaders/LightCluster.comp.spv");
+	m_pBinningPipeline->CreatePipelineLayout(pDevice, { m_vkDescriptorSetLayout }, {});
+	m_pBinningPipeline->CreateComputePipeline(pDevice);
+
+	LOG_DEBUG("Clustered lighting: {0}x{1}x{2} clusters, max {3} lights", ClusterConfig::GRID_X, ClusterConfig::GRID_Y,
+																		  ClusterConfig::GRID_Z, ClusterConfig::MAX_LIGHTS);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ClusteredLighting::CreateDescriptorSetLayout(VulkanDevice* pDevice)
+{
+	// 0 = cluster data, 1 = lights, 2 = light grid, 3 = light indices
+	std::array<VkDescriptorSetLayoutBinding, 4> arrBindings = {};
+	for (uint32_t i = 0; i < arrBindings.size(); ++i)
+	{
+		arrBindings[i].binding = i;
+		arrBindings[i].descriptorType = (i == 0) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		arrBindings[i].descriptorCount = 1;
+		arrBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+		arrBindings[i].pImmutableSamplers = nullptr;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = static_cast<uint32_t>(arrBindings.size());
+	layoutCreateInfo.pBindings = arrBindings.data();
+
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkDescriptorSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Light Cluster Descriptor Set Layout");
+	}
+	else
+		LOG_DEBUG("Created Light Cluster Descriptor Set Layout");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ClusteredLighting::CreatePerFrameBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	size_t nFrames = pSwapchain->m_uiFramesInFlight;
+	m_vkExtent = pSwapchain->m_vkSwapchainExtent;
+
+	m_vecClusterDataBuffer.resize(nFrames);	m_vecClusterDataMemory.resize(nFrames);
+	m_vecLightBuffer.resize(nFrames);		m_vecLightMemory.resize(nFrames);
+	m_vecLightGridBuffer.resize(nFrames);	m_vecLightGridMemory.resize(nFrames);
+	m_vecLightIndexBuffer.resize(nFrames);	m_vecLightIndexMemory.resize(nFrames);
+
+	VkDeviceSize lightSize = ClusterConfig::MAX_LIGHTS * sizeof(GPULight);
+	VkDeviceSize gridSize = ClusterConfig::CLUSTER_COUNT * sizeof(uint32_t);
+	VkDeviceSize indexSize = ClusterConfig::CLUSTER_COUNT * ClusterConfig::MAX_LIGHTS_PER_CLUSTER * sizeof(uint32_t);
+
+	for (size_t i = 0; i < nFrames; ++i)
+	{
+		pDevice->CreateBuffer(	sizeof(GPUClusterData),
+								VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+								&m_vecClusterDataBuffer[i],
+								&m_vecClusterDataMemory[i]);
+
+		pDevice->CreateBuffer(	lightSize,
+								VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+								&m_vecLightBuffer[i],
+								&m_vecLightMemory[i]);
+
+		// Written & read on GPU only
+		pDevice->CreateBuffer(	gridSize,
+								VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+								&m_vecLightGridBuffer[i],
+								&m_vecLightGridMemory[i]);
+
+		pDevice->CreateBuffer(	indexSize,
+								VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+								&m_vecLightIndexBuffer[i],
+								&m_vecLightIndexMemory[i]);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ClusteredLighting::CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	uint32_t nFrames = pSwapchain->m_uiFramesInFlight;
+
+	//--- Pool
+	std::array<VkDescriptorPoolSize, 2> arrPoolSizes = {};
+	arrPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	arrPoolSizes[0].descriptorCount = nFrames;
+	arrPoolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	arrPoolSizes[1].descriptorCount = 3 * nFrames;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = nFrames;
+	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrPoolSizes.size());
+	poolCreateInfo.pPoolSizes = arrPoolSizes.data();
+
+	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vkDescriptorPool) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Light Cluster Descriptor Pool");
+	}
+	else
+		LOG_DEBUG("Created Light Cluster Descriptor Pool");
+
+	//--- Sets
+	m_vecDescriptorSets.resize(nFrames);
+	std::vector<VkDescriptorSetLayout> vecLayouts(nFrames, m_vkDescriptorSetLayout);
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_vkDescriptorPool;
+	allocInfo.descriptorSetCount = nFrames;
+	allocInfo.pSetLayouts = vecLayouts.data();
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, m_vecDescriptorSets.data()) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate Light Cluster Descriptor Sets");
+	}
+
+	for (uint32_t i = 0; i < nFrames; ++i)
+	{
+		std::array<VkDescriptorBufferInfo, 4> arrBufferInfos = {};
+		arrBufferInfos[0] = { m_vecClusterDataBuffer[i],	0, VK_WHOLE_SIZE };
+		arrBufferInfos[1] = { m_vecLightBuffer[i],			0, VK_WHOLE_SIZE };
+		arrBufferInfos[2] = { m_vecLightGridBuffer[i],		0, VK_WHOLE_SIZE };
+		arrBufferInfos[3] = { m_vecLightIndexBuffer[i],		0, VK_WHOLE_SIZE };
+
+		std::array<VkWriteDescriptorSet, 4> arrWrites = {};
+		for (uint32_t b = 0; b < arrWrites.size(); ++b)
+		{
+			arrWrites[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			arrWrites[b].dstSet = m_vecDescriptorSets[i];
+			arrWrites[b].dstBinding = b;
+			arrWrites[b].dstArrayElement = 0;
+			arrWrites[b].descriptorType = (b == 0) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			arrWrites[b].descriptorCount = 1;
+			arrWrites[b].pBufferInfo = &arrBufferInfos[b];
+		}
+
+		vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, static_cast<uint32_t>(arrWrites.size()), arrWrites.data(), 0, nullptr);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Called every frame once the image is free, command buffers stay untouched!
+void ClusteredLighting::Update(VulkanDevice* pDevice, Scene* pScene, uint32_t frameIndex)
+{
+	const std::vector<Light>& vecLights = pScene->GetLights();
+	m_uiLightCount = std::min(static_cast<uint32_t>(vecLights.size()), ClusterConfig::MAX_LIGHTS);
+
+	//--- Lights
+	if (m_uiLightCount > 0)
+	{
+		void* data;
+		vkMapMemory(pDevice->m_vkLogicalDevice, m_vecLightMemory[frameIndex], 0, m_uiLightCount * sizeof(GPULight), 0, &data);
+
+		GPULight* pLights = static_cast<GPULight*>(data);
+		for (uint32_t i = 0; i < m_uiLightCount; ++i)
+		{
+			const Light& light = vecLights[i];
+
+			pLights[i].positionRange = glm::vec4(light.vecPosition, light.fRange);
+			pLights[i].colorIntensity = glm::vec4(light.vecColor, light.fIntensity);
+			pLights[i].directionType = glm::vec4(glm::normalize(light.vecDirection), static_cast<float>(light.eType));
+			pLights[i].spotCosines = glm::vec4(glm::cos(glm::radians(light.fInnerConeAngle)), glm::cos(glm::radians(light.fOuterConeAngle)), 0, 0);
+		}
+
+		vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vecLightMemory[frameIndex]);
+	}
+
+	//--- Cluster grid, exponential depth slices: slice = log(z) * scale - bias
+	const Camera& camera = Camera::getInstance();
+	float fLogFarOverNear = glm::log(camera.m_fFarClip / camera.m_fNearClip);
+
+	GPUClusterData clusterData = {};
+	clusterData.matView = camera.m_matView;
+	clusterData.matInverseProjection = glm::inverse(camera.m_matProjection);
+	clusterData.screenSize = glm::vec4(m_vkExtent.width, m_vkExtent.height, 1.0f / m_vkExtent.width, 1.0f / m_vkExtent.height);
+	clusterData.depthParams = glm::vec4(camera.m_fNearClip,
+										camera.m_fFarClip,
+										ClusterConfig::GRID_Z / fLogFarOverNear,
+										ClusterConfig::GRID_Z * glm::log(camera.m_fNearClip) / fLogFarOverNear);
+	clusterData.gridSize = glm::uvec4(ClusterConfig::GRID_X, ClusterConfig::GRID_Y, ClusterConfig::GRID_Z, m_uiLightCount);
+
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, m_vecClusterDataMemory[frameIndex], 0, sizeof(GPUClusterData), 0, &data);
+	memcpy(data, &clusterData, sizeof(GPUClusterData));
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vecClusterDataMemory[frameIndex]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ClusteredLighting::RecordBinning(VkCommandBuffer cmdBuffer, uint32_t frameIndex)
+{
+	// One invocation per cluster, every cluster writes its own count so no reset needed
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pBinningPipeline->m_vkComputePipeline);
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pBinningPipeline->m_vkPipelineLayout, 0, 1, &m_vecDescriptorSets[frameIndex], 0, nullptr);
+	vkCmdDispatch(cmdBuffer, (ClusterConfig::CLUSTER_COUNT + 63) / 64, 1, 1);
+
+	// Light lists must be written before deferred pass reads them
+	std::array<VkBufferMemoryBarrier, 2> arrBarriers = {};
+	for (uint32_t i = 0; i < arrBarriers.size(); ++i)
+	{
+		arrBarriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		arrBarriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		arrBarriers[i].dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		arrBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		arrBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		arrBarriers[i].offset = 0;
+		arrBarriers[i].size = VK_WHOLE_SIZE;
+	}
+	arrBarriers[0].buffer = m_vecLightGridBuffer[frameIndex];
+	arrBarriers[1].buffer = m_vecLightIndexBuffer[frameIndex];
+
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr,
+						 static_cast<uint32_t>(arrBarriers.size()), arrBarriers.data(), 0, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ClusteredLighting::HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	CreatePerFrameBuffers(pDevice, pSwapchain);
+	CreateDescriptors(pDevice, pSwapchain);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Per image resources only, layout & pipeline survive resize!
+void ClusteredLighting::CleanupOnWindowResize(VulkanDevice* pDevice)
+{
+	for (size_t i = 0; i < m_vecClusterDataBuffer.size(); ++i)
+	{
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecClusterDataBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecClusterDataMemory[i], nullptr);
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecLightBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecLightMemory[i], nullptr);
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecLightGridBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecLightGridMemory[i], nullptr);
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecLightIndexBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecLightIndexMemory[i], nullptr);
+	}
+
+	m_vecClusterDataBuffer.clear();	m_vecClusterDataMemory.clear();
+	m_vecLightBuffer.clear();		m_vecLightMemory.clear();
+	m_vecLightGridBuffer.clear();	m_vecLightGridMemory.clear();
+	m_vecLightIndexBuffer.clear();	m_vecLightIndexMemory.clear();
+
+	// sets are freed along with the pool
+	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, m_vkDescriptorPool, nullptr);
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vecDescriptorSets.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void ClusteredLighting::Cleanup(VulkanDevice* pDevice)
+{
+	CleanupOnWindowResize(pDevice);
+
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkDescriptorSetLayout, nullptr);
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+
+	if (m_pBinningPipeline)
+		m_pBinningPipeline->Cleanup(pDevice);
+
+	SAFE_DELETE(m_pBinningPipeline);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "glm/glm.hpp"
+
+class VulkanDevice;
+class VulkanSwapChain;
+class VulkanComputePipeline;
+class Scene;
+
+//---------------------------------------------------------------------------------------------------------------------
+// Grid comes through ClusterData, per cluster slot count must match LIGHT_CLUSTER_MAX_PER_CLUSTER in shaders
+namespace ClusterConfig
+{
+	constexpr uint32_t					GRID_X = 16;
+	constexpr uint32_t					GRID_Y = 9;
+	constexpr uint32_t					GRID_Z = 24;
+	constexpr uint32_t					CLUSTER_COUNT = GRID_X * GRID_Y * GRID_Z;
+	constexpr uint32_t					MAX_LIGHTS = 4096;
+	constexpr uint32_t					MAX_LIGHTS_PER_CLUSTER = 256;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match Light in LightCluster.comp & Deferred.frag (std430)
+struct GPULight
+{
+	alignas(16) glm::vec4				positionRange;		// xyz - world position, w - range
+	alignas(16) glm::vec4				colorIntensity;		// rgb - color, a - intensity
+	alignas(16) glm::vec4				directionType;		// xyz - spot direction, w - LightType
+	alignas(16) glm::vec4				spotCosines;		// x - cos inner, y - cos outer
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match ClusterData in LightCluster.comp & Deferred.frag (std140)
+struct GPUClusterData
+{
+	alignas(16) glm::mat4				matView;
+	alignas(16) glm::mat4				matInverseProjection;
+	alignas(16) glm::vec4				screenSize;			// xy - size, zw - 1/size
+	alignas(16) glm::vec4				depthParams;		// x - near, y - far, z - slice scale, w - slice bias
+	alignas(16) glm::uvec4				gridSize;			// xyz - cluster grid, w - light count
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Clustered deferred lighting. Local lights are uploaded every frame & a compute pass bins them into a view space
+// froxel grid (screen tiles x exponential depth slices) before the render pass. Deferred pass then only loops over
+// lights of the pixel's cluster, so cost depends on local light density instead of total light count!
+// Cluster bounds come from the camera alone so binning doesn't need G-Buffer depth & the render pass stays intact.
+class ClusteredLighting
+{
+public:
+	ClusteredLighting();
+	~ClusteredLighting();
+
+	void								Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								Update(VulkanDevice* pDevice, Scene* pScene, uint32_t frameIndex);
+
+	// Outside render pass: bins lights, results visible to fragment shaders afterwards
+	void								RecordBinning(VkCommandBuffer cmdBuffer, uint32_t frameIndex);
+
+	inline VkDescriptorSetLayout		GetDescriptorSetLayout()				{ return m_vkDescriptorSetLayout; }
+	inline VkDescriptorSet				GetDescriptorSet(uint32_t frameIndex)	{ return m_vecDescriptorSets[frameIndex]; }
+	inline uint32_t						GetLightCount()							{ return m_uiLightCount; }
+
+	// Screen tiles follow the internal render extent, deferred pass only covers that subrect of the attachments
+	inline void							SetRenderExtent(VkExtent2D extent)		{ m_vkExtent = extent; }
+
+	void								Cleanup(VulkanDevice* pDevice);
+	void								CleanupOnWindowResize(VulkanDevice* pDevice);
+	void								HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+
+private:
+	void								CreateDescriptorSetLayout(VulkanDevice* pDevice);
+	void								CreatePerFrameBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+
+private:
+	// Per frame in flight
+	std::vector<VkBuffer>				m_vecClusterDataBuffer;
+	std::vector<VkDeviceMemory>			m_vecClusterDataMemory;
+	std::vector<VkBuffer>				m_vecLightBuffer;
+	std::vector<VkDeviceMemory>			m_vecLightMemory;
+	std::vector<VkBuffer>				m_vecLightGridBuffer;			// light count per cluster
+	std::vector<VkDeviceMemory>			m_vecLightGridMemory;
+	std::vector<VkBuffer>				m_vecLightIndexBuffer;			// MAX_LIGHTS_PER_CLUSTER slots per cluster
+	std::vector<VkDeviceMemory>			m_vecLightIndexMemory;
+
+	VkDescriptorPool					m_vkDescriptorPool;
+	VkDescriptorSetLayout				m_vkDescriptorSetLayout;		// shared by binning & deferred pass
+	std::vector<VkDescriptorSet>		m_vecDescriptorSets;
+
+	VulkanComputePipeline*				m_pBinningPipeline;
+
+	VkExtent2D							m_vkExtent;
+	uint32_t							m_uiLightCount;
+};
@@ -18,9 +18,10 @@ DeferredFrameBuffer::DeferredFrameBuffer()
 	m_pPBRAttachment		= nullptr;
 	m_pBackgroundAttachment = nullptr;
 	m_pObjectIDAttachment	= nullptr;
+	m_pSceneColorAttachment = nullptr;
 
 	m_vecFramebuffers.clear();
-	m_vecAttachments.resize(8);			// Swapchain Image + 7 Attachments!
+	m_vecAttachments.resize(9);			// Scene Color + 8 Attachments!
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -34,6 +35,7 @@ DeferredFrameBuffer::~DeferredFrameBuffer()
 	SAFE_DELETE(m_pObjectIDAttachment);
 	SAFE_DELETE(m_pEmissionAttachment);
 	SAFE_DELETE(m_pPBRAttachment);
+	SAFE_DELETE(m_pSceneColorAttachment);
 
 	m_vecFramebuffers.clear();
 }
@@ -47,16 +49,16 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 		{
 			m_pAlbedoAttachment = new FramebufferAttachment();
 
-			m_pAlbedoAttachment->vecAttachmentImage.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pAlbedoAttachment->vecAttachmentImageView.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pAlbedoAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+			m_pAlbedoAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pAlbedoAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pAlbedoAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
 
 			std::vector<VkFormat> formats = { VK_FORMAT_B8G8R8A8_UNORM };
 			m_pAlbedoAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL,
 				VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
 
 
-			for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
 			{
 				// Create color buffer image
 				m_pAlbedoAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(	pDevice,
@@ -64,7 +66,7 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 																							pSwapChain->m_vkSwapchainExtent.height,
 																							m_pAlbedoAttachment->attachmentFormat,
 																							VK_IMAGE_TILING_OPTIMAL,
-																							VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+																							VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,	// sampled by tiled lighting
 																							VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 																							&(m_pAlbedoAttachment->vecAttachmentImageMemory[i]));
 
@@ -83,16 +85,16 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 
 			m_pPositionAttachment = new FramebufferAttachment();
 
-			m_pPositionAttachment->vecAttachmentImage.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pPositionAttachment->vecAttachmentImageView.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pPositionAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+			m_pPositionAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pPositionAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pPositionAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
 
 			std::vector<VkFormat> formats = { VK_FORMAT_B8G8R8A8_UNORM };
 			m_pPositionAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL,
 				VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
 
 
-			for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
 			{
 				// Create color buffer image
 				m_pPositionAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(pDevice,
@@ -100,7 +102,7 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 					pSwapChain->m_vkSwapchainExtent.height,
 					m_pPositionAttachment->attachmentFormat,
 					VK_IMAGE_TILING_OPTIMAL,
-					VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+					VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,	// sampled by tiled lighting
 					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 					&(m_pPositionAttachment->vecAttachmentImageMemory[i]));
 
@@ -119,16 +121,16 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 		{
 			m_pNormalAttachment = new FramebufferAttachment();
 
-			m_pNormalAttachment->vecAttachmentImage.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pNormalAttachment->vecAttachmentImageView.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pNormalAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+			m_pNormalAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pNormalAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pNormalAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
 
 			std::vector<VkFormat> formats = { VK_FORMAT_B8G8R8A8_UNORM };
 			m_pNormalAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL,
 				VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
 
 
-			for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
 			{
 				// Create Normal buffer image
 				m_pNormalAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(pDevice,
@@ -136,7 +138,7 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 					pSwapChain->m_vkSwapchainExtent.height,
 					m_pNormalAttachment->attachmentFormat,
 					VK_IMAGE_TILING_OPTIMAL,
-					VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+					VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,	// sampled by tiled lighting
 					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 					&(m_pNormalAttachment->vecAttachmentImageMemory[i]));
 
@@ -154,14 +156,14 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 		{
 			m_pDepthAttachment = new FramebufferAttachment();
 
-			m_pDepthAttachment->vecAttachmentImage.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pDepthAttachment->vecAttachmentImageView.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pDepthAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+			m_pDepthAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pDepthAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pDepthAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
 
 			std::vector<VkFormat> formats = { VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D32_SFLOAT, VK_FORMAT_D24_UNORM_S8_UINT };
 			m_pDepthAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL, VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 
-			for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
 			{
 				// Create color buffer image
 				m_pDepthAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(pDevice,
@@ -169,7 +171,7 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 					pSwapChain->m_vkSwapchainExtent.height,
 					m_pDepthAttachment->attachmentFormat,
 					VK_IMAGE_TILING_OPTIMAL,
-					VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+					VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,	// sampled by Hi-Z build
 					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 					&(m_pDepthAttachment->vecAttachmentImageMemory[i]));
 
@@ -187,16 +189,16 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 		{
 			m_pPBRAttachment = new FramebufferAttachment();
 
-			m_pPBRAttachment->vecAttachmentImage.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pPBRAttachment->vecAttachmentImageView.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pPBRAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+			m_pPBRAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pPBRAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pPBRAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
 
 			std::vector<VkFormat> formats = { VK_FORMAT_B8G8R8A8_UNORM };
 			m_pPBRAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL,
 				VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
 
 
-			for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
 			{
 				// Create Normal buffer image
 				m_pPBRAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(	pDevice,
@@ -204,7 +206,7 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 																						pSwapChain->m_vkSwapchainExtent.height,
 																						m_pPBRAttachment->attachmentFormat,
 																						VK_IMAGE_TILING_OPTIMAL,
-																						VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+																						VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,	// sampled by tiled lighting
 																						VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
 																						&(m_pPBRAttachment->vecAttachmentImageMemory[i]));
 
@@ -222,16 +224,16 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 		{
 			m_pEmissionAttachment = new FramebufferAttachment();
 
-			m_pEmissionAttachment->vecAttachmentImage.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pEmissionAttachment->vecAttachmentImageView.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pEmissionAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+			m_pEmissionAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pEmissionAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pEmissionAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
 
 			std::vector<VkFormat> formats = { VK_FORMAT_B8G8R8A8_UNORM };
 			m_pEmissionAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL,
 				VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
 
 
-			for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
 			{
 				// Create Normal buffer image
 				m_pEmissionAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(	pDevice,
@@ -256,16 +258,16 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 		{
 			m_pBackgroundAttachment = new FramebufferAttachment();
 
-			m_pBackgroundAttachment->vecAttachmentImage.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pBackgroundAttachment->vecAttachmentImageView.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pBackgroundAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+			m_pBackgroundAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pBackgroundAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pBackgroundAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
 
 			std::vector<VkFormat> formats = { VK_FORMAT_B8G8R8A8_UNORM };
 			m_pBackgroundAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL,
 				VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
 
 
-			for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
 			{
 				// Create Normal buffer image
 				m_pBackgroundAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(pDevice,
@@ -290,16 +292,16 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 		{
 			m_pObjectIDAttachment = new FramebufferAttachment();
 
-			m_pObjectIDAttachment->vecAttachmentImage.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pObjectIDAttachment->vecAttachmentImageView.resize(pSwapChain->m_vecSwapchainImages.size());
-			m_pObjectIDAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_vecSwapchainImages.size());
+			m_pObjectIDAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pObjectIDAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pObjectIDAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
 
 			std::vector<VkFormat> formats = { VK_FORMAT_B8G8R8A8_UNORM };
 			m_pObjectIDAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL,
 				VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT);
 
 
-			for (uint16_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); i++)
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
 			{
 				// Create Normal buffer image
 				m_pObjectIDAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(pDevice,
@@ -319,6 +321,40 @@ void DeferredFrameBuffer::CreateAttachment(VulkanDevice* pDevice, VulkanSwapChai
 			}
 			break;
 		}
+
+		case AttachmentType::FB_ATTACHMENT_SCENECOLOR:
+		{
+			m_pSceneColorAttachment = new FramebufferAttachment();
+
+			m_pSceneColorAttachment->vecAttachmentImage.resize(pSwapChain->m_uiFramesInFlight);
+			m_pSceneColorAttachment->vecAttachmentImageView.resize(pSwapChain->m_uiFramesInFlight);
+			m_pSceneColorAttachment->vecAttachmentImageMemory.resize(pSwapChain->m_uiFramesInFlight);
+
+			// Same format as swapchain so upscale pass output matches what deferred pass used to write directly
+			std::vector<VkFormat> formats = { pSwapChain->m_vkSwapchainImageFormat };
+			m_pSceneColorAttachment->attachmentFormat = ChooseSupportedFormats(pDevice, formats, VK_IMAGE_TILING_OPTIMAL,
+				VK_FORMAT_FEATURE_COLOR_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+
+
+			for (uint16_t i = 0; i < pSwapChain->m_uiFramesInFlight; i++)
+			{
+				// Allocated at swapchain size, lower render scales only use the top left subrect!
+				m_pSceneColorAttachment->vecAttachmentImage[i] = Helper::Vulkan::CreateImage(pDevice,
+					pSwapChain->m_vkSwapchainExtent.width,
+					pSwapChain->m_vkSwapchainExtent.height,
+					m_pSceneColorAttachment->attachmentFormat,
+					VK_IMAGE_TILING_OPTIMAL,
+					VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+					&(m_pSceneColorAttachment->vecAttachmentImageMemory[i]));
+
+				m_pSceneColorAttachment->vecAttachmentImageView[i] = Helper::Vulkan::CreateImageView(pDevice,
+					m_pSceneColorAttachment->vecAttachmentImage[i],
+					m_pSceneColorAttachment->attachmentFormat,
+					VK_IMAGE_ASPECT_COLOR_BIT);
+			}
+			break;
+		}
 	}
 	
 }
@@ -355,12 +391,12 @@ void DeferredFrameBuffer::CreateFrameBuffers(VulkanDevice* pDevice, VulkanSwapCh
 		return;
 
 	// resize framebuffer count to equal swap chain image views count
-	m_vecFramebuffers.resize(pSwapChain->m_vecSwapchainImages.size());
+	m_vecFramebuffers.resize(pSwapChain->m_uiFramesInFlight);
 
 	// create framebuffer for each swap chain image view
-	for (uint32_t i = 0; i < pSwapChain->m_vecSwapchainImages.size(); ++i)
+	for (uint32_t i = 0; i < pSwapChain->m_uiFramesInFlight; ++i)
 	{
-		m_vecAttachments = {	pSwapChain->m_vecSwapchainImageViews[i],
+		m_vecAttachments = {	m_pSceneColorAttachment->vecAttachmentImageView[i],
 								m_pAlbedoAttachment->vecAttachmentImageView[i],
 								m_pDepthAttachment->vecAttachmentImageView[i],
 								m_pNormalAttachment->vecAttachmentImageView[i],
@@ -403,6 +439,7 @@ void DeferredFrameBuffer::Cleanup(VulkanDevice* pDevice)
 	m_pEmissionAttachment->Cleanup(pDevice);
 	m_pBackgroundAttachment->Cleanup(pDevice);
 	m_pObjectIDAttachment->Cleanup(pDevice);
+	m_pSceneColorAttachment->Cleanup(pDevice);
 
 	// Destroy frame buffers!
 	for (uint32_t i = 0; i < m_vecFramebuffers.size(); ++i)
@@ -422,6 +459,7 @@ void DeferredFrameBuffer::CleanupOnWindowResize(VulkanDevice* pDevice)
 	m_pEmissionAttachment->CleanupOnWindowResize(pDevice);
 	m_pBackgroundAttachment->CleanupOnWindowResize(pDevice);
 	m_pObjectIDAttachment->CleanupOnWindowResize(pDevice);
+	m_pSceneColorAttachment->CleanupOnWindowResize(pDevice);
 		
 	// Destroy frame buffers!
 	for (uint32_t i = 0; i < m_vecFramebuffers.size(); ++i)
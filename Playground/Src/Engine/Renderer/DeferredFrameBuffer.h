@@ -16,7 +16,8 @@ enum class AttachmentType
 	FB_ATTACHMENT_PBR,				// Metallic, Roughness, AO
 	FB_ATTACHMENT_EMISSION,
 	FB_ATTACHMENT_BACKGROUND,
-	FB_ATTACHMENT_OBJECTID
+	FB_ATTACHMENT_OBJECTID,
+	FB_ATTACHMENT_SCENECOLOR		// Lit output of deferred pass, sampled by upscale pass
 };
 
 // **** Inidvidual Framebuffer attachment
@@ -36,9 +37,9 @@ struct FramebufferAttachment
 	void	CleanupOnWindowResize(VulkanDevice* pDevice);
 	
 	VkFormat						attachmentFormat;
-	std::vector<VkImage>			vecAttachmentImage;					// Size equals to number of swapchain images!
-	std::vector<VkImageView>		vecAttachmentImageView;				// Size equals to number of swapchain images!
-	std::vector<VkDeviceMemory>		vecAttachmentImageMemory;			// Size equals to number of swapchain images!
+	std::vector<VkImage>			vecAttachmentImage;					// Size equals to number of frames in flight!
+	std::vector<VkImageView>		vecAttachmentImageView;				// Size equals to number of frames in flight!
+	std::vector<VkDeviceMemory>		vecAttachmentImageMemory;			// Size equals to number of frames in flight!
 
 	AttachmentType					attachmentType;
 };
@@ -72,7 +73,8 @@ public:
 	FramebufferAttachment*				m_pEmissionAttachment;
 	FramebufferAttachment*				m_pBackgroundAttachment;
 	FramebufferAttachment*				m_pObjectIDAttachment;
+	FramebufferAttachment*				m_pSceneColorAttachment;
 
-	std::vector<VkFramebuffer>			m_vecFramebuffers;				// Size equals to number of swapchain images
+	std::vector<VkFramebuffer>			m_vecFramebuffers;				// Size equals to number of frames in flight
 };
 
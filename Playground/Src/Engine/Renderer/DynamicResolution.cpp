@@ -0,0 +1,71 @@
+#include "PlaygroundPCH.h"
+#include "DynamicResolution.h"
+
+#include "Engine/Helpers/Log.h"
+
+#include <cmath>
+
+//---------------------------------------------------------------------------------------------------------------------
+DynamicResolution::DynamicResolution()
+{
+	m_fScale = 1.0f;
+	m_fSmoothedMs = 0.0f;
+	m_uiSettleFrames = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+DynamicResolution::~DynamicResolution()
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+bool DynamicResolution::Update(float fGPUFrameMs, float fTargetMs, float fMinScale, float fMaxScale, bool bEnabled)
+{
+	fMaxScale = std::clamp(fMaxScale, DynamicResolutionConfig::SCALE_STEP, 1.0f);
+	fMinScale = std::min(fMinScale, fMaxScale);
+
+	float fNewScale = fMaxScale;
+
+	if (bEnabled)
+	{
+		if (m_uiSettleFrames > 0)
+		{
+			--m_uiSettleFrames;
+			return false;
+		}
+
+		if (fGPUFrameMs <= 0.0f || fTargetMs <= 0.0f)
+			return false;
+
+		m_fSmoothedMs = (m_fSmoothedMs > 0.0f) ? m_fSmoothedMs + (fGPUFrameMs - m_fSmoothedMs) * DynamicResolutionConfig::SMOOTHING : fGPUFrameMs;
+
+		float fIdeal = std::clamp(m_fScale * std::sqrt(fTargetMs / m_fSmoothedMs), fMinScale, fMaxScale);
+		fNewScale = std::round(fIdeal / DynamicResolutionConfig::SCALE_STEP) * DynamicResolutionConfig::SCALE_STEP;
+		fNewScale = std::clamp(fNewScale, fMinScale, fMaxScale);
+
+		// Dropping resolution reacts right away, raising it needs headroom unless min scale was raised above it
+		if (fNewScale > m_fScale && m_fScale >= fMinScale && m_fSmoothedMs > fTargetMs * DynamicResolutionConfig::UPSCALE_HEADROOM)
+			fNewScale = m_fScale;
+	}
+
+	if (std::abs(fNewScale - m_fScale) < DynamicResolutionConfig::SCALE_STEP * 0.5f)
+		return false;
+
+	LOG_DEBUG("Render scale {0} -> {1} (GPU {2} ms, target {3} ms)", m_fScale, fNewScale, m_fSmoothedMs, fTargetMs);
+
+	m_fScale = fNewScale;
+	m_fSmoothedMs = 0.0f;
+	m_uiSettleFrames = DynamicResolutionConfig::SETTLE_FRAMES;
+
+	return true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+VkExtent2D DynamicResolution::GetRenderExtent(const VkExtent2D& maxExtent) const
+{
+	VkExtent2D extent;
+	extent.width = std::clamp(static_cast<uint32_t>(maxExtent.width * m_fScale + 0.5f), 1u, maxExtent.width);
+	extent.height = std::clamp(static_cast<uint32_t>(maxExtent.height * m_fScale + 0.5f), 1u, maxExtent.height);
+
+	return extent;
+}
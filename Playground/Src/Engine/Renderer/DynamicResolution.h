@@ -0,0 +1,37 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace DynamicResolutionConfig
+{
+	constexpr float						SCALE_STEP = 0.05f;			// scale changes re-record command buffers, so keep them coarse
+	constexpr float						SMOOTHING = 0.1f;			// exponential moving average weight of newest GPU time
+	constexpr float						UPSCALE_HEADROOM = 0.85f;	// only raise scale when frame is clearly below target
+	constexpr uint32_t					SETTLE_FRAMES = 8;			// frames to ignore after a change, older images still run old scale
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Picks internal render scale from measured GPU frame time. Cost is assumed proportional to pixel count, so the scale
+// that hits the target is current * sqrt(target / measured). Result is quantized & only changes after new timings of
+// the previous scale have come in, hence it doesn't oscillate & command buffers are re-recorded only on real changes!
+// Max scale is the upscaler quality preset, disabled scaling simply holds it.
+class DynamicResolution
+{
+public:
+	DynamicResolution();
+	~DynamicResolution();
+
+	// Returns true when scale changed this frame
+	bool								Update(float fGPUFrameMs, float fTargetMs, float fMinScale, float fMaxScale, bool bEnabled);
+
+	// Top left subrect of attachments allocated at maxExtent
+	VkExtent2D							GetRenderExtent(const VkExtent2D& maxExtent) const;
+
+	inline float						GetScale() const			{ return m_fScale; }
+
+private:
+	float								m_fScale;
+	float								m_fSmoothedMs;
+	uint32_t							m_uiSettleFrames;
+};
@@ -0,0 +1,235 @@
+#include "PlaygroundPCH.h"
+#include "FrameGlobals.h"
+
+#include "VulkanDevice.h"
+#include "VulkanSwapChain.h"
+
+#include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Log.h"
+#include "Engine/Helpers/Camera.h"
+#include "Engine/Scene.h"
+#include "Engine/RenderObjects/Mesh.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+FrameGlobals::FrameGlobals()
+{
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+	m_vecDescriptorSets.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+FrameGlobals::~FrameGlobals()
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FrameGlobals::Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	CreateDescriptorSetLayout(pDevice);
+	CreatePerFrameBuffers(pDevice, pSwapchain);
+	CreateDescriptors(pDevice, pSwapchain);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FrameGlobals::CreateDescriptorSetLayout(VulkanDevice* pDevice)
+{
+	std::array<VkDescriptorSetLayoutBinding, 2> arrBindings = {};
+	arrBindings[0].binding = 0;
+	arrBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	arrBindings[0].descriptorCount = 1;
+	arrBindings[0].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	arrBindings[0].pImmutableSamplers = nullptr;
+
+	// Object transforms & material indices, indexed by pushed object slot
+	arrBindings[1].binding = 1;
+	arrBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	arrBindings[1].descriptorCount = 1;
+	arrBindings[1].stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+	arrBindings[1].pImmutableSamplers = nullptr;
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = static_cast<uint32_t>(arrBindings.size());
+	layoutCreateInfo.pBindings = arrBindings.data();
+
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkDescriptorSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Frame Globals Descriptor Set Layout");
+	}
+	else
+		LOG_DEBUG("Created Frame Globals Descriptor Set Layout");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FrameGlobals::CreatePerFrameBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	size_t nFrames = pSwapchain->m_uiFramesInFlight;
+
+	m_vecFrameBuffer.resize(nFrames);	m_vecFrameMemory.resize(nFrames);
+	m_vecObjectBuffer.resize(nFrames);	m_vecObjectMemory.resize(nFrames);
+	m_vecDrawArgsBuffer.resize(nFrames);	m_vecDrawArgsMemory.resize(nFrames);
+
+	for (size_t i = 0; i < nFrames; ++i)
+	{
+		pDevice->CreateBuffer(	sizeof(FrameShaderData),
+								VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+								&m_vecFrameBuffer[i],
+								&m_vecFrameMemory[i]);
+
+		pDevice->CreateBuffer(	SceneSetConfig::MAX_OBJECTS * sizeof(ObjectShaderData),
+								VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+								&m_vecObjectBuffer[i],
+								&m_vecObjectMemory[i]);
+
+		pDevice->CreateBuffer(	SceneSetConfig::MAX_DRAWS * sizeof(VkDrawIndexedIndirectCommand),
+								VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+								&m_vecDrawArgsBuffer[i],
+								&m_vecDrawArgsMemory[i]);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FrameGlobals::CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	uint32_t nFrames = pSwapchain->m_uiFramesInFlight;
+
+	//--- Pool
+	std::array<VkDescriptorPoolSize, 2> arrPoolSizes = {};
+	arrPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	arrPoolSizes[0].descriptorCount = nFrames;
+	arrPoolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	arrPoolSizes[1].descriptorCount = nFrames;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = nFrames;
+	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrPoolSizes.size());
+	poolCreateInfo.pPoolSizes = arrPoolSizes.data();
+
+	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vkDescriptorPool) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Frame Globals Descriptor Pool");
+	}
+	else
+		LOG_DEBUG("Created Frame Globals Descriptor Pool");
+
+	//--- Sets
+	m_vecDescriptorSets.resize(nFrames);
+	std::vector<VkDescriptorSetLayout> vecLayouts(nFrames, m_vkDescriptorSetLayout);
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_vkDescriptorPool;
+	allocInfo.descriptorSetCount = nFrames;
+	allocInfo.pSetLayouts = vecLayouts.data();
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, m_vecDescriptorSets.data()) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate Frame Globals Descriptor Sets");
+	}
+
+	for (uint32_t i = 0; i < nFrames; ++i)
+	{
+		VkDescriptorBufferInfo frameInfo = { m_vecFrameBuffer[i], 0, sizeof(FrameShaderData) };
+		VkDescriptorBufferInfo objectInfo = { m_vecObjectBuffer[i], 0, VK_WHOLE_SIZE };
+
+		std::array<VkWriteDescriptorSet, 2> arrWrites = {};
+		arrWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		arrWrites[0].dstSet = m_vecDescriptorSets[i];
+		arrWrites[0].dstBinding = 0;
+		arrWrites[0].dstArrayElement = 0;
+		arrWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		arrWrites[0].descriptorCount = 1;
+		arrWrites[0].pBufferInfo = &frameInfo;
+
+		arrWrites[1] = arrWrites[0];
+		arrWrites[1].dstBinding = 1;
+		arrWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		arrWrites[1].pBufferInfo = &objectInfo;
+
+		vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, static_cast<uint32_t>(arrWrites.size()), arrWrites.data(), 0, nullptr);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Called every frame once the image is free, command buffers stay untouched!
+void FrameGlobals::Update(VulkanDevice* pDevice, Scene* pScene, uint32_t frameIndex)
+{
+	const Camera& camera = Camera::getInstance();
+
+	FrameShaderData frameData = {};
+	frameData.matView = camera.m_matView;
+	frameData.matProjection = camera.m_matProjection;
+	frameData.matProjection[1][1] *= -1.0f;
+	frameData.matViewProjection = frameData.matProjection * frameData.matView;
+	frameData.cameraPosition = glm::vec4(camera.m_vecCameraPosition, 1.0f);
+	frameData.lightProperties = glm::vec4(pScene->m_LightDirection, pScene->m_LightIntensity);
+
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, m_vecFrameMemory[frameIndex], 0, sizeof(FrameShaderData), 0, &data);
+	memcpy(data, &frameData, sizeof(FrameShaderData));
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vecFrameMemory[frameIndex]);
+
+	// Transforms & material indices of this frame, recorded draws only push the object slot
+	VkDeviceSize objectSize = SceneSetConfig::MAX_OBJECTS * sizeof(ObjectShaderData);
+	vkMapMemory(pDevice->m_vkLogicalDevice, m_vecObjectMemory[frameIndex], 0, objectSize, 0, &data);
+	pScene->WriteObjectData(static_cast<ObjectShaderData*>(data), SceneSetConfig::MAX_OBJECTS);
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vecObjectMemory[frameIndex]);
+
+	// Visibility & LOD of this frame, recorded draws only reference their slot
+	VkDeviceSize argsSize = SceneSetConfig::MAX_DRAWS * sizeof(VkDrawIndexedIndirectCommand);
+	vkMapMemory(pDevice->m_vkLogicalDevice, m_vecDrawArgsMemory[frameIndex], 0, argsSize, 0, &data);
+	pScene->WriteDrawArgs(static_cast<VkDrawIndexedIndirectCommand*>(data), SceneSetConfig::MAX_DRAWS);
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vecDrawArgsMemory[frameIndex]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FrameGlobals::BindDescriptorSet(VkCommandBuffer cmdBuffer, VkPipelineLayout vkPipelineLayout, uint32_t frameIndex)
+{
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vkPipelineLayout, SceneSetConfig::FRAME_SET, 1,
+							&m_vecDescriptorSets[frameIndex], 0, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FrameGlobals::HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	CreatePerFrameBuffers(pDevice, pSwapchain);
+	CreateDescriptors(pDevice, pSwapchain);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Per image resources only, layout survives resize!
+void FrameGlobals::CleanupOnWindowResize(VulkanDevice* pDevice)
+{
+	for (size_t i = 0; i < m_vecFrameBuffer.size(); ++i)
+	{
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecFrameBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecFrameMemory[i], nullptr);
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecObjectBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecObjectMemory[i], nullptr);
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecDrawArgsBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecDrawArgsMemory[i], nullptr);
+	}
+
+	m_vecFrameBuffer.clear();	m_vecFrameMemory.clear();
+	m_vecObjectBuffer.clear();	m_vecObjectMemory.clear();
+	m_vecDrawArgsBuffer.clear();	m_vecDrawArgsMemory.clear();
+
+	// sets are freed along with the pool
+	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, m_vkDescriptorPool, nullptr);
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vecDescriptorSets.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void FrameGlobals::Cleanup(VulkanDevice* pDevice)
+{
+	CleanupOnWindowResize(pDevice);
+
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkDescriptorSetLayout, nullptr);
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "glm/glm.hpp"
+
+class VulkanDevice;
+class VulkanSwapChain;
+class Scene;
+
+//---------------------------------------------------------------------------------------------------------------------
+// Descriptor set slots shared by every scene geometry pipeline (G-Buffer, depth pre-pass, occluders)
+namespace SceneSetConfig
+{
+	constexpr uint32_t					FRAME_SET = 0;										// FrameGlobals
+	constexpr uint32_t					MATERIAL_SET = 1;									// MaterialRegistry
+	constexpr VkShaderStageFlags		OBJECT_PUSH_STAGES = VK_SHADER_STAGE_VERTEX_BIT;		// PushConstantData
+	constexpr uint32_t					MAX_DRAWS = 16384;									// indirect draw slots, one per mesh of every model
+	constexpr uint32_t					MAX_OBJECTS = 4096;									// object buffer entries, one per model
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match FrameData in GBuffer.vert, GBufferInstanced.vert & DepthPrepass.vert (std140)
+struct FrameShaderData
+{
+	alignas(16) glm::mat4				matView;
+	alignas(16) glm::mat4				matProjection;		// Y flipped for Vulkan clip space
+	alignas(16) glm::mat4				matViewProjection;
+	alignas(16) glm::vec4				cameraPosition;		// xyz - world position
+	alignas(16) glm::vec4				lightProperties;	// RGB - Direction, A - Intensity
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Camera, sun light & every model's transform and material index, written once per frame into set 0. Set is bound
+// once per command buffer, per draw state is left with the pushed object slot only.
+// Also owns per frame indirect draw arguments of CPU recorded meshes, so visibility & LOD change without re-recording.
+class FrameGlobals
+{
+public:
+	FrameGlobals();
+	~FrameGlobals();
+
+	void								Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								Update(VulkanDevice* pDevice, Scene* pScene, uint32_t frameIndex);
+
+	void								BindDescriptorSet(VkCommandBuffer cmdBuffer, VkPipelineLayout vkPipelineLayout, uint32_t frameIndex);
+
+	inline VkDescriptorSetLayout		GetDescriptorSetLayout()				{ return m_vkDescriptorSetLayout; }
+	inline VkBuffer						GetDrawArgsBuffer(uint32_t frameIndex)	{ return m_vecDrawArgsBuffer[frameIndex]; }
+	inline const std::vector<VkBuffer>&	GetObjectBuffers()						{ return m_vecObjectBuffer; }
+
+	void								Cleanup(VulkanDevice* pDevice);
+	void								CleanupOnWindowResize(VulkanDevice* pDevice);
+	void								HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+
+private:
+	void								CreateDescriptorSetLayout(VulkanDevice* pDevice);
+	void								CreatePerFrameBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+
+private:
+	// Per frame in flight
+	std::vector<VkBuffer>				m_vecFrameBuffer;
+	std::vector<VkDeviceMemory>			m_vecFrameMemory;
+	std::vector<VkBuffer>				m_vecObjectBuffer;					// ObjectShaderData per model
+	std::vector<VkDeviceMemory>			m_vecObjectMemory;
+	std::vector<VkBuffer>				m_vecDrawArgsBuffer;				// VkDrawIndexedIndirectCommand per draw slot
+	std::vector<VkDeviceMemory>			m_vecDrawArgsMemory;
+
+	VkDescriptorPool					m_vkDescriptorPool;
+	VkDescriptorSetLayout				m_vkDescriptorSetLayout;			// 0 - frame data, 1 - objects
+	std::vector<VkDescriptorSet>		m_vecDescriptorSets;
+};
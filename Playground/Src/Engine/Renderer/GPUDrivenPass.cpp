@@ -0,0 +1,563 @@
+#include "PlaygroundPCH.h"
+#include "GPUDrivenPass.h"
+
+#include "VulkanDevice.h"
+#include "VulkanSwapChain.h"
+#include "VulkanGraphicsPipeline.h"
+#include "VulkanComputePipeline.h"
+#include "FrameGlobals.h"
+
+#include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Log.h"
+#include "Engine/Helpers/Camera.h"
+#include "Engine/RenderObjects/Model.h"
+#include "Engine/Scene.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+GPUDrivenPass::GPUDrivenPass()
+{
+	m_vkVertexBuffer = VK_NULL_HANDLE;
+	m_vkVertexBufferMemory = VK_NULL_HANDLE;
+	m_vkIndexBuffer = VK_NULL_HANDLE;
+	m_vkIndexBufferMemory = VK_NULL_HANDLE;
+	m_vkMeshBuffer = VK_NULL_HANDLE;
+	m_vkMeshBufferMemory = VK_NULL_HANDLE;
+	m_vkVisibilityBuffer = VK_NULL_HANDLE;
+	m_vkVisibilityBufferMemory = VK_NULL_HANDLE;
+
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+	m_vecDescriptorSets.clear();
+
+	m_pCullPipeline = nullptr;
+
+	m_uiMeshCount = 0;
+	m_uiBucketCount = 0;
+	m_uiSceneVersion = UINT32_MAX;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+GPUDrivenPass::~GPUDrivenPass()
+{
+	SAFE_DELETE(m_pCullPipeline);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void GPUDrivenPass::Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, Scene* pScene, VkDescriptorSetLayout vkHiZSetLayout,
+								const std::vector<VkBuffer>& vecObjectBuffers)
+{
+	CreateGeometry(pDevice, pScene);
+	CreatePerFrameBuffers(pDevice, pSwapchain);
+	CreateDescriptors(pDevice, pSwapchain, vecObjectBuffers);
+
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(GPUCullPushData);
+
+	m_pCullPipeline = new VulkanComputePipeline("Shaders/GBufferCull.comp.spv");
+	m_pCullPipeline->CreatePipelineLayout(pDevice, { m_vkDescriptorSetLayout, vkHiZSetLayout }, { pushConstantRange });
+	m_pCullPipeline->CreateComputePipeline(pDevice);
+
+	m_uiSceneVersion = pScene->GetStructureVersion();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void GPUDrivenPass::CreateDeviceLocalBuffer(VulkanDevice* pDevice, const void* pData, VkDeviceSize size,
+											VkBufferUsageFlags usage, VkBuffer* outBuffer, VkDeviceMemory* outMemory)
+{
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingBufferMemory;
+
+	pDevice->CreateBuffer(	size,
+							VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+							&stagingBuffer,
+							&stagingBufferMemory);
+
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory, 0, size, 0, &data);
+	memcpy(data, pData, (size_t)size);
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory);
+
+	pDevice->CreateBuffer(	size,
+							VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
+							VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+							outBuffer,
+							outMemory);
+
+	pDevice->CopyBuffer(stagingBuffer, *outBuffer, size);
+
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, stagingBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, stagingBufferMemory, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Concatenates geometry of all models into one vertex & index buffer & builds one record per mesh. Meshes are bucketed
+// by their model's G-Buffer permutation, each bucket gets a contiguous command range & its own draw count
+void GPUDrivenPass::CreateGeometry(VulkanDevice* pDevice, Scene* pScene)
+{
+	std::vector<Helper::App::VertexPNTBT>	vecVertices;
+	std::vector<uint32_t>					vecIndices;
+	std::vector<GPUMeshRecord>				vecMeshRecords;
+
+	std::vector<Model*> vecModels = pScene->GetModelList();
+
+	//--- Buckets, in order of first use
+	std::map<uint32_t, uint32_t> mapBuckets;
+	std::vector<uint32_t> vecModelBucket(vecModels.size(), 0);
+
+	m_vecBucketPermutation.clear();
+	m_vecBucketMeshCount.clear();
+
+	for (size_t m = 0; m < vecModels.size(); ++m)
+	{
+		if (vecModels[m] == nullptr)
+			continue;
+
+		uint32_t uiPermutation = vecModels[m]->GetMaterialFeatures();
+		auto it = mapBuckets.find(uiPermutation);
+		if (it == mapBuckets.end())
+		{
+			it = mapBuckets.emplace(uiPermutation, static_cast<uint32_t>(m_vecBucketPermutation.size())).first;
+			m_vecBucketPermutation.push_back(uiPermutation);
+			m_vecBucketMeshCount.push_back(0);
+		}
+
+		vecModelBucket[m] = it->second;
+		m_vecBucketMeshCount[it->second] += vecModels[m]->GetMeshCount();
+	}
+
+	m_uiBucketCount = static_cast<uint32_t>(m_vecBucketPermutation.size());
+	m_vecBucketDrawOffset.assign(m_uiBucketCount, 0);
+	for (uint32_t b = 1; b < m_uiBucketCount; ++b)
+	{
+		m_vecBucketDrawOffset[b] = m_vecBucketDrawOffset[b - 1] + m_vecBucketMeshCount[b - 1];
+	}
+
+	//--- Geometry & mesh records
+	for (size_t m = 0; m < vecModels.size(); ++m)
+	{
+		Model* pModel = vecModels[m];
+		if (pModel == nullptr)
+			continue;
+
+		uint32_t uiBaseVertex = static_cast<uint32_t>(vecVertices.size());
+		uint32_t uiBaseIndex = static_cast<uint32_t>(vecIndices.size());
+
+		vecVertices.insert(vecVertices.end(), pModel->m_vecVertices.begin(), pModel->m_vecVertices.end());
+		vecIndices.insert(vecIndices.end(), pModel->m_vecIndices.begin(), pModel->m_vecIndices.end());
+
+		for (const Mesh& mesh : pModel->GetMeshes())
+		{
+			GPUMeshRecord record = {};
+			record.aabbMin = glm::vec4(mesh.m_AABB.vecMin, 1.0f);
+			record.aabbMax = glm::vec4(mesh.m_AABB.vecMax, 1.0f);
+			record.lods[0].firstIndex = uiBaseIndex + mesh.m_uiFirstIndex;
+			record.lods[0].indexCount = mesh.m_uiIndexCount;
+
+			// LOD ranges are relative to the mesh's first index, model's CPU copy holds all of them
+			uint32_t nLODs = std::min(static_cast<uint32_t>(mesh.m_vecLODs.size()), GPU_MAX_LODS);
+			for (uint32_t l = 0; l < nLODs; ++l)
+			{
+				record.lods[l].firstIndex = uiBaseIndex + mesh.m_uiFirstIndex + mesh.m_vecLODs[l].uiFirstIndex;
+				record.lods[l].indexCount = mesh.m_vecLODs[l].uiIndexCount;
+				record.lods[l].error = mesh.m_vecLODs[l].fError;
+			}
+			record.lodCount = std::max(nLODs, 1u);
+
+			record.vertexOffset = static_cast<int32_t>(uiBaseVertex) + mesh.m_iVertexOffset;
+			record.objectIndex = pModel->m_PushConstantData.objectIndex;
+			record.drawOffset = m_vecBucketDrawOffset[vecModelBucket[m]];
+			record.bucketIndex = vecModelBucket[m];
+
+			vecMeshRecords.push_back(record);
+		}
+	}
+
+	m_uiMeshCount = static_cast<uint32_t>(vecMeshRecords.size());
+
+	if (m_uiMeshCount == 0)
+	{
+		LOG_WARNING("GPU driven pass: scene has no meshes!");
+
+		// keep buffers valid for descriptor writes
+		GPUMeshRecord dummy = {};
+		vecMeshRecords.push_back(dummy);
+		vecVertices.resize(1);
+		vecIndices.resize(1, 0);
+	}
+
+	CreateDeviceLocalBuffer(pDevice, vecVertices.data(), vecVertices.size() * sizeof(Helper::App::VertexPNTBT),
+							VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, &m_vkVertexBuffer, &m_vkVertexBufferMemory);
+
+	CreateDeviceLocalBuffer(pDevice, vecIndices.data(), vecIndices.size() * sizeof(uint32_t),
+							VK_BUFFER_USAGE_INDEX_BUFFER_BIT, &m_vkIndexBuffer, &m_vkIndexBufferMemory);
+
+	CreateDeviceLocalBuffer(pDevice, vecMeshRecords.data(), vecMeshRecords.size() * sizeof(GPUMeshRecord),
+							VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &m_vkMeshBuffer, &m_vkMeshBufferMemory);
+
+	// Everything counts as visible in the first frame, so the first occluder pass draws the whole frustum
+	std::vector<uint32_t> vecVisibility(vecMeshRecords.size(), 1);
+	CreateDeviceLocalBuffer(pDevice, vecVisibility.data(), vecVisibility.size() * sizeof(uint32_t),
+							VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, &m_vkVisibilityBuffer, &m_vkVisibilityBufferMemory);
+
+	LOG_DEBUG("GPU driven pass: {0} models, {1} meshes, {2} permutation buckets, {3} vertices, {4} indices", vecModels.size(), m_uiMeshCount,
+			  m_uiBucketCount, vecVertices.size(), vecIndices.size());
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void GPUDrivenPass::CreatePerFrameBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	size_t nFrames = pSwapchain->m_uiFramesInFlight;
+
+	m_vecCullBuffer.resize(nFrames);	m_vecCullMemory.resize(nFrames);
+	m_vecDrawBuffer.resize(nFrames);	m_vecDrawMemory.resize(nFrames);
+	m_vecCountBuffer.resize(nFrames);	m_vecCountMemory.resize(nFrames);
+
+	VkDeviceSize drawSize = std::max(1u, m_uiMeshCount) * sizeof(VkDrawIndexedIndirectCommand);
+	VkDeviceSize countSize = (m_uiBucketCount + 1) * sizeof(uint32_t);
+
+	for (size_t i = 0; i < nFrames; ++i)
+	{
+		pDevice->CreateBuffer(	sizeof(GPUCullData),
+								VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+								&m_vecCullBuffer[i],
+								&m_vecCullMemory[i]);
+
+		pDevice->CreateBuffer(	drawSize,
+								VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+								VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+								&m_vecDrawBuffer[i],
+								&m_vecDrawMemory[i]);
+
+		// Host visible so that stats can read back visible draw count
+		pDevice->CreateBuffer(	countSize,
+								VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+								VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+								&m_vecCountBuffer[i],
+								&m_vecCountMemory[i]);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void GPUDrivenPass::CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, const std::vector<VkBuffer>& vecObjectBuffers)
+{
+	uint32_t nFrames = pSwapchain->m_uiFramesInFlight;
+
+	//--- Pool
+	std::array<VkDescriptorPoolSize, 2> arrPoolSizes = {};
+	arrPoolSizes[0].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	arrPoolSizes[0].descriptorCount = nFrames;
+	arrPoolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	arrPoolSizes[1].descriptorCount = 5 * nFrames;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = nFrames;
+	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrPoolSizes.size());
+	poolCreateInfo.pPoolSizes = arrPoolSizes.data();
+
+	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vkDescriptorPool) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create GPU Culling Descriptor Pool");
+	}
+	else
+		LOG_DEBUG("Created GPU Culling Descriptor Pool");
+
+	//--- Layout, 0 = cull data, 1 = meshes, 2 = objects, 3 = draws, 4 = counts, 5 = visibility
+	if (m_vkDescriptorSetLayout == VK_NULL_HANDLE)
+	{
+		std::array<VkDescriptorSetLayoutBinding, 6> arrBindings = {};
+		for (uint32_t i = 0; i < arrBindings.size(); ++i)
+		{
+			arrBindings[i].binding = i;
+			arrBindings[i].descriptorType = (i == 0) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			arrBindings[i].descriptorCount = 1;
+			arrBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+			arrBindings[i].pImmutableSamplers = nullptr;
+		}
+
+		VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+		layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		layoutCreateInfo.bindingCount = static_cast<uint32_t>(arrBindings.size());
+		layoutCreateInfo.pBindings = arrBindings.data();
+
+		if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkDescriptorSetLayout) != VK_SUCCESS)
+		{
+			LOG_ERROR("Failed to create GPU Culling Descriptor Set Layout");
+		}
+		else
+			LOG_DEBUG("Created GPU Culling Descriptor Set Layout");
+	}
+
+	//--- Sets
+	m_vecDescriptorSets.resize(nFrames);
+	std::vector<VkDescriptorSetLayout> vecLayouts(nFrames, m_vkDescriptorSetLayout);
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_vkDescriptorPool;
+	allocInfo.descriptorSetCount = nFrames;
+	allocInfo.pSetLayouts = vecLayouts.data();
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, m_vecDescriptorSets.data()) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate GPU Culling Descriptor Sets");
+	}
+
+	for (uint32_t i = 0; i < nFrames; ++i)
+	{
+		std::array<VkDescriptorBufferInfo, 6> arrBufferInfos = {};
+		arrBufferInfos[0] = { m_vecCullBuffer[i],	0, VK_WHOLE_SIZE };
+		arrBufferInfos[1] = { m_vkMeshBuffer,		0, VK_WHOLE_SIZE };
+		arrBufferInfos[2] = { vecObjectBuffers[i],	0, VK_WHOLE_SIZE };
+		arrBufferInfos[3] = { m_vecDrawBuffer[i],	0, VK_WHOLE_SIZE };
+		arrBufferInfos[4] = { m_vecCountBuffer[i],	0, VK_WHOLE_SIZE };
+		arrBufferInfos[5] = { m_vkVisibilityBuffer,	0, VK_WHOLE_SIZE };
+
+		std::array<VkWriteDescriptorSet, 6> arrWrites = {};
+		for (uint32_t b = 0; b < arrWrites.size(); ++b)
+		{
+			arrWrites[b].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			arrWrites[b].dstSet = m_vecDescriptorSets[i];
+			arrWrites[b].dstBinding = b;
+			arrWrites[b].dstArrayElement = 0;
+			arrWrites[b].descriptorType = (b == 0) ? VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+			arrWrites[b].descriptorCount = 1;
+			arrWrites[b].pBufferInfo = &arrBufferInfos[b];
+		}
+
+		vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, static_cast<uint32_t>(arrWrites.size()), arrWrites.data(), 0, nullptr);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Called every frame once the image is free, command buffers stay untouched!
+void GPUDrivenPass::Update(VulkanDevice* pDevice, Scene* pScene, uint32_t frameIndex, const VkExtent2D& renderExtent, uint32_t uiHiZMips)
+{
+	//--- Frustum planes & Hi-Z projection
+	GPUCullData cullData = {};
+	for (uint32_t i = 0; i < 6; ++i)
+	{
+		cullData.planes[i] = pScene->GetFrustum().m_arrPlanes[i];
+	}
+	// Same clip space as model UBO, so projected depth compares directly against depth buffer
+	glm::mat4 matProjection = Camera::getInstance().m_matProjection;
+	matProjection[1][1] *= -1.0f;
+
+	cullData.matViewProj = matProjection * Camera::getInstance().m_matView;
+	cullData.hizParams = glm::vec4(renderExtent.width, renderExtent.height, uiHiZMips, 0.0f);
+
+	// Same inputs as Scene::SelectLODs
+	cullData.cameraPos = glm::vec4(Camera::getInstance().m_vecCameraPosition, 1.0f);
+	cullData.lodParams = glm::vec4(	pScene->m_fLODErrorPixels,
+									MeshLODConfig::HYSTERESIS,
+									pScene->m_bEnableLOD ? pScene->GetLODProjScale() : 0.0f,
+									std::max(Camera::getInstance().m_fNearClip, 0.001f));
+	cullData.meshCount = m_uiMeshCount;
+	cullData.bucketCount = m_uiBucketCount;
+
+	// Model matrices are read from FrameGlobals object buffer
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, m_vecCullMemory[frameIndex], 0, sizeof(GPUCullData), 0, &data);
+	memcpy(data, &cullData, sizeof(GPUCullData));
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vecCullMemory[frameIndex]);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void GPUDrivenPass::RecordCulling(VkCommandBuffer cmdBuffer, uint32_t frameIndex, GPUCullPhase ePhase, VkDescriptorSet vkHiZSet)
+{
+	// Draws of a previous phase must have consumed commands & counts, visibility writes of previous dispatch must land
+	VkMemoryBarrier reuseBarrier = {};
+	reuseBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	reuseBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	reuseBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+						 VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &reuseBarrier, 0, nullptr, 0, nullptr);
+
+	// Reset draw counts
+	vkCmdFillBuffer(cmdBuffer, m_vecCountBuffer[frameIndex], 0, VK_WHOLE_SIZE, 0);
+
+	VkBufferMemoryBarrier fillBarrier = {};
+	fillBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	fillBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	fillBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	fillBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	fillBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	fillBarrier.buffer = m_vecCountBuffer[frameIndex];
+	fillBarrier.offset = 0;
+	fillBarrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 1, &fillBarrier, 0, nullptr);
+
+	// Cull!
+	std::array<VkDescriptorSet, 2> arrSets = { m_vecDescriptorSets[frameIndex], vkHiZSet };
+	GPUCullPushData pushData = { static_cast<uint32_t>(ePhase) };
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pCullPipeline->m_vkComputePipeline);
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pCullPipeline->m_vkPipelineLayout, 0,
+							static_cast<uint32_t>(arrSets.size()), arrSets.data(), 0, nullptr);
+	vkCmdPushConstants(cmdBuffer, m_pCullPipeline->m_vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(GPUCullPushData), &pushData);
+	vkCmdDispatch(cmdBuffer, (m_uiMeshCount + 63) / 64, 1, 1);
+
+	// Commands & counts must be written before indirect stage reads them
+	std::array<VkBufferMemoryBarrier, 2> arrBarriers = {};
+	for (uint32_t i = 0; i < arrBarriers.size(); ++i)
+	{
+		arrBarriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		arrBarriers[i].srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		arrBarriers[i].dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+		arrBarriers[i].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		arrBarriers[i].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		arrBarriers[i].offset = 0;
+		arrBarriers[i].size = VK_WHOLE_SIZE;
+	}
+	arrBarriers[0].buffer = m_vecDrawBuffer[frameIndex];
+	arrBarriers[1].buffer = m_vecCountBuffer[frameIndex];
+
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0, 0, nullptr,
+						 static_cast<uint32_t>(arrBarriers.size()), arrBarriers.data(), 0, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void GPUDrivenPass::RecordDraws(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline, uint32_t frameIndex)
+{
+	if (m_uiMeshCount == 0)
+		return;
+
+	// Scene geometry is bound once
+	VkDeviceSize offsets[] = { 0 };
+	vkCmdBindVertexBuffers(cmdBuffer, 0, 1, &m_vkVertexBuffer, offsets);
+	vkCmdBindIndexBuffer(cmdBuffer, m_vkIndexBuffer, 0, VK_INDEX_TYPE_UINT32);
+
+	// Frame & material sets are bound by caller. Object slot of every command is its firstInstance, so pushed slot is 0
+	PushConstantData pushData;
+	vkCmdPushConstants(cmdBuffer, pPipeline->m_vkPipelineLayout, SceneSetConfig::OBJECT_PUSH_STAGES, 0, sizeof(PushConstantData), &pushData);
+
+	// One draw per permutation bucket, occluders are depth only & keep a single pipeline
+	uint32_t uiBoundPermutation = UINT32_MAX;
+	for (uint32_t b = 0; b < m_uiBucketCount; ++b)
+	{
+		uint32_t uiPermutation = pPipeline->HasPermutations() ? m_vecBucketPermutation[b] : 0;
+		if (uiPermutation != uiBoundPermutation)
+		{
+			vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->GetPermutation(uiPermutation));
+			uiBoundPermutation = uiPermutation;
+		}
+
+		vkCmdDrawIndexedIndirectCount(	cmdBuffer,
+										m_vecDrawBuffer[frameIndex], m_vecBucketDrawOffset[b] * sizeof(VkDrawIndexedIndirectCommand),
+										m_vecCountBuffer[frameIndex], b * sizeof(uint32_t),
+										m_vecBucketMeshCount[b],
+										sizeof(VkDrawIndexedIndirectCommand));
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Host coherent memory still needs the shader writes made available to host, counts are mapped after the fence wait
+void GPUDrivenPass::RecordReadbackBarrier(VkCommandBuffer cmdBuffer, uint32_t frameIndex)
+{
+	VkBufferMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = m_vecCountBuffer[frameIndex];
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+uint32_t GPUDrivenPass::GetVisibleDrawCount(VulkanDevice* pDevice, uint32_t frameIndex)
+{
+	if (m_uiBucketCount == 0)
+		return 0;
+
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, m_vecCountMemory[frameIndex], 0, m_uiBucketCount * sizeof(uint32_t), 0, &data);
+
+	uint32_t uiTotal = 0;
+	const uint32_t* pCounts = static_cast<const uint32_t*>(data);
+	for (uint32_t b = 0; b < m_uiBucketCount; ++b)
+	{
+		uiTotal += pCounts[b];
+	}
+
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vecCountMemory[frameIndex]);
+
+	return std::min(uiTotal, m_uiMeshCount);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Meshes inside frustum but rejected by Hi-Z, written by the occlusion phase only
+uint32_t GPUDrivenPass::GetOccludedCount(VulkanDevice* pDevice, uint32_t frameIndex)
+{
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, m_vecCountMemory[frameIndex], m_uiBucketCount * sizeof(uint32_t), sizeof(uint32_t), 0, &data);
+
+	uint32_t uiOccluded = *static_cast<const uint32_t*>(data);
+
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vecCountMemory[frameIndex]);
+
+	return std::min(uiOccluded, m_uiMeshCount);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void GPUDrivenPass::HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, const std::vector<VkBuffer>& vecObjectBuffers)
+{
+	CreatePerFrameBuffers(pDevice, pSwapchain);
+	CreateDescriptors(pDevice, pSwapchain, vecObjectBuffers);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Per image resources only, geometry & pipeline survive resize!
+void GPUDrivenPass::CleanupOnWindowResize(VulkanDevice* pDevice)
+{
+	for (size_t i = 0; i < m_vecCullBuffer.size(); ++i)
+	{
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecCullBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecCullMemory[i], nullptr);
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecDrawBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecDrawMemory[i], nullptr);
+		vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vecCountBuffer[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecCountMemory[i], nullptr);
+	}
+
+	m_vecCullBuffer.clear();	m_vecCullMemory.clear();
+	m_vecDrawBuffer.clear();	m_vecDrawMemory.clear();
+	m_vecCountBuffer.clear();	m_vecCountMemory.clear();
+
+	// sets are freed along with the pool
+	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, m_vkDescriptorPool, nullptr);
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vecDescriptorSets.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void GPUDrivenPass::Cleanup(VulkanDevice* pDevice)
+{
+	CleanupOnWindowResize(pDevice);
+
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vkVertexBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkVertexBufferMemory, nullptr);
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vkIndexBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkIndexBufferMemory, nullptr);
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vkMeshBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkMeshBufferMemory, nullptr);
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vkVisibilityBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkVisibilityBufferMemory, nullptr);
+
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkDescriptorSetLayout, nullptr);
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+
+	if (m_pCullPipeline)
+		m_pCullPipeline->Cleanup(pDevice);
+
+	SAFE_DELETE(m_pCullPipeline);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "glm/glm.hpp"
+
+class VulkanDevice;
+class VulkanSwapChain;
+class VulkanGraphicsPipeline;
+class VulkanComputePipeline;
+class Scene;
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match MAX_LODS in GBufferCull.comp & MeshLODConfig::MAX_LODS
+constexpr uint32_t						GPU_MAX_LODS = 5;
+
+// Must match MeshLOD in GBufferCull.comp (std430)
+struct GPUMeshLOD
+{
+	uint32_t							firstIndex;				// into merged index buffer
+	uint32_t							indexCount;
+	float								error;					// mesh space, see MeshLOD
+	uint32_t							pad;
+};
+
+// Must match MeshRecord in GBufferCull.comp (std430)
+struct GPUMeshRecord
+{
+	alignas(16) glm::vec4				aabbMin;
+	alignas(16) glm::vec4				aabbMax;
+	GPUMeshLOD							lods[GPU_MAX_LODS];		// [0] full resolution
+	int32_t								vertexOffset;
+	uint32_t							objectIndex;			// slot in FrameGlobals object buffer, becomes firstInstance
+	uint32_t							drawOffset;				// first command slot of the bucket
+	uint32_t							bucketIndex;
+	uint32_t							lodCount;
+	uint32_t							pad[3];
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match CullData in GBufferCull.comp (std140)
+struct GPUCullData
+{
+	alignas(16) glm::vec4				planes[6];
+	alignas(16) glm::mat4				matViewProj;
+	alignas(16) glm::vec4				hizParams;				// xy - render extent, z - Hi-Z level count
+	alignas(16) glm::vec4				cameraPos;
+	alignas(16) glm::vec4				lodParams;				// x - error pixels, y - hysteresis, z - projection scale (0 = LOD off), w - near clip
+	alignas(4)	uint32_t				meshCount;
+	alignas(4)	uint32_t				bucketCount;			// occluded counter lives right after bucket draw counts
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// What a culling dispatch tests & writes, see GBufferCull.comp
+enum class GPUCullPhase
+{
+	FRUSTUM = 0,						// frustum only, records visibility
+	OCCLUDERS,							// frustum & visible last frame, draws become Hi-Z occluders
+	OCCLUSION							// frustum & Hi-Z, records visibility for next frame's occluders
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match push constant block in GBufferCull.comp
+struct GPUCullPushData
+{
+	uint32_t							phase;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// GPU driven G-Buffer path. All scene geometry lives in one vertex & index buffer, a compute pass frustum culls every
+// mesh & writes indexed indirect commands + per bucket draw counts. Meshes are bucketed by G-Buffer permutation &
+// every command's firstInstance is its model's slot in FrameGlobals object buffer, so there is one
+// vkCmdDrawIndexedIndirectCount per permutation, independent of model count, mesh count & visibility!
+// LODs are selected in the same dispatch, see Scene::SelectLODs. Per mesh visibility of the last occlusion test & the
+// selected LOD persist across frames, occluder phase uses the former & LOD hysteresis the latter.
+class GPUDrivenPass
+{
+public:
+	GPUDrivenPass();
+	~GPUDrivenPass();
+
+	// Hi-Z layout becomes set 1 of culling pipeline, object buffers are FrameGlobals' (one per frame in flight)
+	void								Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, Scene* pScene, VkDescriptorSetLayout vkHiZSetLayout,
+												   const std::vector<VkBuffer>& vecObjectBuffers);
+	void								Update(VulkanDevice* pDevice, Scene* pScene, uint32_t frameIndex, const VkExtent2D& renderExtent, uint32_t uiHiZMips);
+
+	// Outside render pass: reset counts & dispatch culling. May be recorded twice per frame, draws of previous phase
+	// must be recorded before the next one
+	void								RecordCulling(VkCommandBuffer cmdBuffer, uint32_t frameIndex, GPUCullPhase ePhase, VkDescriptorSet vkHiZSet);
+
+	// Inside G-Buffer subpass, binds pPipeline (per bucket permutation) itself
+	void								RecordDraws(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline, uint32_t frameIndex);
+
+	// Outside render pass, after last culling dispatch of the frame. Makes counts visible to host reads below
+	void								RecordReadbackBarrier(VkCommandBuffer cmdBuffer, uint32_t frameIndex);
+
+	// Draw count written by last completed frame that used this slot
+	uint32_t							GetVisibleDrawCount(VulkanDevice* pDevice, uint32_t frameIndex);
+	uint32_t							GetOccludedCount(VulkanDevice* pDevice, uint32_t frameIndex);
+
+	inline uint32_t						GetMeshCount()				{ return m_uiMeshCount; }
+	inline bool							NeedsRebuild(uint32_t uiSceneVersion)	{ return uiSceneVersion != m_uiSceneVersion; }
+
+	void								Cleanup(VulkanDevice* pDevice);
+	void								CleanupOnWindowResize(VulkanDevice* pDevice);
+	void								HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, const std::vector<VkBuffer>& vecObjectBuffers);
+
+private:
+	void								CreateGeometry(VulkanDevice* pDevice, Scene* pScene);
+	void								CreatePerFrameBuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, const std::vector<VkBuffer>& vecObjectBuffers);
+	void								CreateDeviceLocalBuffer(VulkanDevice* pDevice, const void* pData, VkDeviceSize size,
+																VkBufferUsageFlags usage, VkBuffer* outBuffer, VkDeviceMemory* outMemory);
+
+private:
+	// Scene geometry, built once per scene structure change
+	VkBuffer							m_vkVertexBuffer;
+	VkDeviceMemory						m_vkVertexBufferMemory;
+	VkBuffer							m_vkIndexBuffer;
+	VkDeviceMemory						m_vkIndexBufferMemory;
+	VkBuffer							m_vkMeshBuffer;
+	VkDeviceMemory						m_vkMeshBufferMemory;
+	VkBuffer							m_vkVisibilityBuffer;		// per mesh, shared by all frames
+	VkDeviceMemory						m_vkVisibilityBufferMemory;
+
+	// Per frame in flight
+	std::vector<VkBuffer>				m_vecCullBuffer;
+	std::vector<VkDeviceMemory>			m_vecCullMemory;
+	std::vector<VkBuffer>				m_vecDrawBuffer;
+	std::vector<VkDeviceMemory>			m_vecDrawMemory;
+	std::vector<VkBuffer>				m_vecCountBuffer;
+	std::vector<VkDeviceMemory>			m_vecCountMemory;
+
+	VkDescriptorPool					m_vkDescriptorPool;
+	VkDescriptorSetLayout				m_vkDescriptorSetLayout;
+	std::vector<VkDescriptorSet>		m_vecDescriptorSets;
+
+	VulkanComputePipeline*				m_pCullPipeline;
+
+	// Per G-Buffer permutation bucket
+	std::vector<uint32_t>				m_vecBucketPermutation;		// MaterialFeature mask
+	std::vector<uint32_t>				m_vecBucketDrawOffset;		// first command slot
+	std::vector<uint32_t>				m_vecBucketMeshCount;		// max draws
+
+	uint32_t							m_uiMeshCount;
+	uint32_t							m_uiBucketCount;
+	uint32_t							m_uiSceneVersion;
+};
@@ -0,0 +1,548 @@
+#include "PlaygroundPCH.h"
+#include "HiZPass.h"
+
+#include "VulkanDevice.h"
+#include "VulkanSwapChain.h"
+#include "VulkanGraphicsPipeline.h"
+#include "VulkanComputePipeline.h"
+#include "DeferredFrameBuffer.h"
+
+#include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Log.h"
+
+#include <cmath>
+
+//---------------------------------------------------------------------------------------------------------------------
+HiZPass::HiZPass()
+{
+	m_vkRenderPass = VK_NULL_HANDLE;
+	m_vecFramebuffers.clear();
+
+	m_vkPyramidImage = VK_NULL_HANDLE;
+	m_vkPyramidMemory = VK_NULL_HANDLE;
+	m_vkPyramidView = VK_NULL_HANDLE;
+	m_vecMipViews.clear();
+
+	m_vkSampler = VK_NULL_HANDLE;
+	m_vkBuildSetLayout = VK_NULL_HANDLE;
+	m_vkCullSetLayout = VK_NULL_HANDLE;
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vecDepthSets.clear();
+	m_vecMipSets.clear();
+	m_vkCullSet = VK_NULL_HANDLE;
+
+	m_pBuildPipeline = nullptr;
+	m_pOccluderPipeline = nullptr;
+	m_vecSceneSetLayouts.clear();
+	m_vecScenePushConstantRanges.clear();
+
+	m_vkExtent = { 0, 0 };
+	m_vkPyramidExtent = { 0, 0 };
+	m_uiMipCount = 0;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+HiZPass::~HiZPass()
+{
+	SAFE_DELETE(m_pBuildPipeline);
+	SAFE_DELETE(m_pOccluderPipeline);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer,
+						 const std::vector<VkDescriptorSetLayout>& vecSceneSetLayouts,
+						 const std::vector<VkPushConstantRange>& vecScenePushConstantRanges)
+{
+	m_vecSceneSetLayouts = vecSceneSetLayouts;
+	m_vecScenePushConstantRanges = vecScenePushConstantRanges;
+
+	CreateSampler(pDevice);
+	CreateDescriptorSetLayouts(pDevice);
+
+	HandleWindowResize(pDevice, pSwapchain, pFrameBuffer);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::CreateRenderPass(VulkanDevice* pDevice, DeferredFrameBuffer* pFrameBuffer)
+{
+	// Main render pass clears depth again, so occluder depth only has to survive until pyramid is built
+	VkAttachmentDescription depthAttachmentDesc = {};
+	depthAttachmentDesc.format			= pFrameBuffer->m_pDepthAttachment->attachmentFormat;
+	depthAttachmentDesc.samples			= VK_SAMPLE_COUNT_1_BIT;
+	depthAttachmentDesc.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR;
+	depthAttachmentDesc.storeOp			= VK_ATTACHMENT_STORE_OP_STORE;
+	depthAttachmentDesc.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	depthAttachmentDesc.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	depthAttachmentDesc.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+	depthAttachmentDesc.finalLayout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+	VkAttachmentReference depthAttachmentRef = {};
+	depthAttachmentRef.attachment		= 0;
+	depthAttachmentRef.layout			= VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint			= VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount		= 0;
+	subpass.pDepthStencilAttachment		= &depthAttachmentRef;
+
+	// Previous depth tests & Hi-Z reads of this attachment must be done before clearing it, then hand depth to Hi-Z build
+	std::array<VkSubpassDependency, 2> arrDependencies = {};
+	arrDependencies[0].srcSubpass		= VK_SUBPASS_EXTERNAL;
+	arrDependencies[0].srcStageMask		= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	arrDependencies[0].srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	arrDependencies[0].dstSubpass		= 0;
+	arrDependencies[0].dstStageMask		= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	arrDependencies[0].dstAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	arrDependencies[1].srcSubpass		= 0;
+	arrDependencies[1].srcStageMask		= VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	arrDependencies[1].srcAccessMask	= VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	arrDependencies[1].dstSubpass		= VK_SUBPASS_EXTERNAL;
+	arrDependencies[1].dstStageMask		= VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	arrDependencies[1].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+
+	VkRenderPassCreateInfo renderPassCreateInfo = {};
+	renderPassCreateInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCreateInfo.attachmentCount	= 1;
+	renderPassCreateInfo.pAttachments		= &depthAttachmentDesc;
+	renderPassCreateInfo.subpassCount		= 1;
+	renderPassCreateInfo.pSubpasses			= &subpass;
+	renderPassCreateInfo.dependencyCount	= static_cast<uint32_t>(arrDependencies.size());
+	renderPassCreateInfo.pDependencies		= arrDependencies.data();
+
+	if (vkCreateRenderPass(pDevice->m_vkLogicalDevice, &renderPassCreateInfo, nullptr, &m_vkRenderPass) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Hi-Z Occluder Render Pass");
+	}
+	else
+		LOG_DEBUG("Created Hi-Z Occluder Render Pass");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::CreateFramebuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer)
+{
+	m_vecFramebuffers.resize(pSwapchain->m_uiFramesInFlight);
+
+	for (uint32_t i = 0; i < m_vecFramebuffers.size(); ++i)
+	{
+		VkFramebufferCreateInfo framebufferCreateInfo = {};
+		framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.renderPass = m_vkRenderPass;
+		framebufferCreateInfo.attachmentCount = 1;
+		framebufferCreateInfo.pAttachments = &pFrameBuffer->m_pDepthAttachment->vecAttachmentImageView[i];
+		framebufferCreateInfo.width = m_vkExtent.width;
+		framebufferCreateInfo.height = m_vkExtent.height;
+		framebufferCreateInfo.layers = 1;
+
+		if (vkCreateFramebuffer(pDevice->m_vkLogicalDevice, &framebufferCreateInfo, nullptr, &m_vecFramebuffers[i]) != VK_SUCCESS)
+		{
+			LOG_ERROR("Failed to create Hi-Z Occluder Framebuffer");
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::CreatePyramid(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	// Sized for full swapchain resolution, lower render scales only use the top left part of every level
+	m_vkPyramidExtent.width = std::max(1u, (m_vkExtent.width + 1) / 2);
+	m_vkPyramidExtent.height = std::max(1u, (m_vkExtent.height + 1) / 2);
+	m_uiMipCount = static_cast<uint32_t>(std::floor(std::log2(std::max(m_vkPyramidExtent.width, m_vkPyramidExtent.height)))) + 1;
+
+	VkImageCreateInfo imageCreateInfo = {};
+	imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageCreateInfo.extent.width = m_vkPyramidExtent.width;
+	imageCreateInfo.extent.height = m_vkPyramidExtent.height;
+	imageCreateInfo.extent.depth = 1;
+	imageCreateInfo.mipLevels = m_uiMipCount;
+	imageCreateInfo.arrayLayers = 1;
+	imageCreateInfo.format = HiZConfig::FORMAT;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateImage(pDevice->m_vkLogicalDevice, &imageCreateInfo, nullptr, &m_vkPyramidImage) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Hi-Z image");
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(pDevice->m_vkLogicalDevice, m_vkPyramidImage, &memoryRequirements);
+
+	VkMemoryAllocateInfo memoryAllocInfo = {};
+	memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocInfo.allocationSize = memoryRequirements.size;
+	memoryAllocInfo.memoryTypeIndex = pDevice->FindMemoryTypeIndex(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	if (vkAllocateMemory(pDevice->m_vkLogicalDevice, &memoryAllocInfo, nullptr, &m_vkPyramidMemory) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate memory for Hi-Z image!");
+	}
+
+	vkBindImageMemory(pDevice->m_vkLogicalDevice, m_vkPyramidImage, m_vkPyramidMemory, 0);
+
+	//--- Views, one over all levels for culling & one per level for the build
+	VkImageViewCreateInfo viewCreateInfo = {};
+	viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCreateInfo.image = m_vkPyramidImage;
+	viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewCreateInfo.format = HiZConfig::FORMAT;
+	viewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewCreateInfo.subresourceRange.baseMipLevel = 0;
+	viewCreateInfo.subresourceRange.levelCount = m_uiMipCount;
+	viewCreateInfo.subresourceRange.baseArrayLayer = 0;
+	viewCreateInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(pDevice->m_vkLogicalDevice, &viewCreateInfo, nullptr, &m_vkPyramidView) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Hi-Z image view!");
+	}
+
+	m_vecMipViews.resize(m_uiMipCount);
+	for (uint32_t m = 0; m < m_uiMipCount; ++m)
+	{
+		viewCreateInfo.subresourceRange.baseMipLevel = m;
+		viewCreateInfo.subresourceRange.levelCount = 1;
+
+		if (vkCreateImageView(pDevice->m_vkLogicalDevice, &viewCreateInfo, nullptr, &m_vecMipViews[m]) != VK_SUCCESS)
+		{
+			LOG_ERROR("Failed to create Hi-Z mip view!");
+		}
+	}
+
+	LOG_DEBUG("Created Hi-Z pyramid {0}x{1}, {2} levels", m_vkPyramidExtent.width, m_vkPyramidExtent.height, m_uiMipCount);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::CreateSampler(VulkanDevice* pDevice)
+{
+	// Shaders only use texelFetch, point & clamp just keeps accidental sampling conservative
+	VkSamplerCreateInfo samplerCreateInfo = {};
+	samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+	samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+	samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+	samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+	samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCreateInfo.mipLodBias = 0.0f;
+	samplerCreateInfo.minLod = 0.0f;
+	samplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+	samplerCreateInfo.anisotropyEnable = VK_FALSE;
+	samplerCreateInfo.maxAnisotropy = 1.0f;
+
+	if (vkCreateSampler(pDevice->m_vkLogicalDevice, &samplerCreateInfo, nullptr, &m_vkSampler) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Hi-Z Sampler");
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::CreateDescriptorSetLayouts(VulkanDevice* pDevice)
+{
+	//--- Build, 0 = source level (or depth), 1 = destination level
+	std::array<VkDescriptorSetLayoutBinding, 2> arrBindings = {};
+	arrBindings[0].binding = 0;
+	arrBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	arrBindings[0].descriptorCount = 1;
+	arrBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	arrBindings[0].pImmutableSamplers = nullptr;
+	arrBindings[1].binding = 1;
+	arrBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	arrBindings[1].descriptorCount = 1;
+	arrBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	arrBindings[1].pImmutableSamplers = nullptr;
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = static_cast<uint32_t>(arrBindings.size());
+	layoutCreateInfo.pBindings = arrBindings.data();
+
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkBuildSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Hi-Z Build Descriptor Set Layout");
+	}
+
+	//--- Cull, 0 = whole pyramid. Bound as set 1 of GPU culling
+	layoutCreateInfo.bindingCount = 1;
+
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkCullSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Hi-Z Cull Descriptor Set Layout");
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer)
+{
+	uint32_t nFrames = pSwapchain->m_uiFramesInFlight;
+	uint32_t nBuildSets = nFrames + m_uiMipCount - 1;
+
+	//--- Pool
+	std::array<VkDescriptorPoolSize, 2> arrPoolSizes = {};
+	arrPoolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	arrPoolSizes[0].descriptorCount = nBuildSets + 1;
+	arrPoolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	arrPoolSizes[1].descriptorCount = nBuildSets;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = nBuildSets + 1;
+	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrPoolSizes.size());
+	poolCreateInfo.pPoolSizes = arrPoolSizes.data();
+
+	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vkDescriptorPool) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Hi-Z Descriptor Pool");
+	}
+
+	//--- Build sets
+	std::vector<VkDescriptorSet> vecBuildSets(nBuildSets);
+	std::vector<VkDescriptorSetLayout> vecLayouts(nBuildSets, m_vkBuildSetLayout);
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_vkDescriptorPool;
+	allocInfo.descriptorSetCount = nBuildSets;
+	allocInfo.pSetLayouts = vecLayouts.data();
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, vecBuildSets.data()) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate Hi-Z Build Descriptor Sets");
+	}
+
+	m_vecDepthSets.assign(vecBuildSets.begin(), vecBuildSets.begin() + nFrames);
+	m_vecMipSets.assign(vecBuildSets.begin() + nFrames, vecBuildSets.end());
+
+	for (uint32_t s = 0; s < nBuildSets; ++s)
+	{
+		// First sets read depth attachment of their frame, rest read previous pyramid level
+		bool bFromDepth = (s < nFrames);
+		uint32_t uiDstLevel = bFromDepth ? 0 : (s - nFrames + 1);
+
+		VkDescriptorImageInfo srcInfo = {};
+		srcInfo.imageLayout = bFromDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_GENERAL;
+		srcInfo.imageView = bFromDepth ? pFrameBuffer->m_pDepthAttachment->vecAttachmentImageView[s] : m_vecMipViews[uiDstLevel - 1];
+		srcInfo.sampler = m_vkSampler;
+
+		VkDescriptorImageInfo dstInfo = {};
+		dstInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		dstInfo.imageView = m_vecMipViews[uiDstLevel];
+
+		std::array<VkWriteDescriptorSet, 2> arrWrites = {};
+		arrWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		arrWrites[0].dstSet = vecBuildSets[s];
+		arrWrites[0].dstBinding = 0;
+		arrWrites[0].descriptorCount = 1;
+		arrWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		arrWrites[0].pImageInfo = &srcInfo;
+		arrWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		arrWrites[1].dstSet = vecBuildSets[s];
+		arrWrites[1].dstBinding = 1;
+		arrWrites[1].descriptorCount = 1;
+		arrWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		arrWrites[1].pImageInfo = &dstInfo;
+
+		vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, static_cast<uint32_t>(arrWrites.size()), arrWrites.data(), 0, nullptr);
+	}
+
+	//--- Cull set
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &m_vkCullSetLayout;
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, &m_vkCullSet) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate Hi-Z Cull Descriptor Set");
+	}
+
+	VkDescriptorImageInfo pyramidInfo = {};
+	pyramidInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	pyramidInfo.imageView = m_vkPyramidView;
+	pyramidInfo.sampler = m_vkSampler;
+
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = m_vkCullSet;
+	write.dstBinding = 0;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &pyramidInfo;
+
+	vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, 1, &write, 0, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::CreatePipelines(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(HiZPushData);
+
+	m_pBuildPipeline = new VulkanComputePipeline("Shaders/HiZBuild.comp.spv");
+	m_pBuildPipeline->CreatePipelineLayout(pDevice, { m_vkBuildSetLayout }, { pushConstantRange });
+	m_pBuildPipeline->CreateComputePipeline(pDevice);
+
+	// Same scene descriptor sets & push constants as G-Buffer, no color outputs
+	m_pOccluderPipeline = new VulkanGraphicsPipeline(PipelineType::DEPTH_OCCLUDERS, pSwapchain);
+	m_pOccluderPipeline->CreatePipelineLayout(pDevice, m_vecSceneSetLayouts, m_vecScenePushConstantRanges);
+	m_pOccluderPipeline->CreateGraphicsPipeline(pDevice, pSwapchain, m_vkRenderPass, 0, 0);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::BeginOccluderPass(VkCommandBuffer cmdBuffer, uint32_t frameIndex, const VkExtent2D& renderExtent)
+{
+	VkClearValue clearValue = {};
+	clearValue.depthStencil.depth = 1.0f;
+
+	VkRenderPassBeginInfo renderPassBeginInfo = {};
+	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassBeginInfo.renderPass = m_vkRenderPass;
+	renderPassBeginInfo.framebuffer = m_vecFramebuffers[frameIndex];
+	renderPassBeginInfo.renderArea.offset = { 0, 0 };
+	renderPassBeginInfo.renderArea.extent = renderExtent;
+	renderPassBeginInfo.clearValueCount = 1;
+	renderPassBeginInfo.pClearValues = &clearValue;
+
+	vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+	Helper::Vulkan::SetViewportScissor(cmdBuffer, renderExtent);
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pOccluderPipeline->m_vkGraphicsPipeline);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::EndOccluderPass(VkCommandBuffer cmdBuffer)
+{
+	vkCmdEndRenderPass(cmdBuffer);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::RecordBuild(VkCommandBuffer cmdBuffer, uint32_t frameIndex, const VkExtent2D& renderExtent)
+{
+	// Old contents are never needed. Barrier also orders us after culling reads of previous frames on this queue
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = m_vkPyramidImage;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = m_uiMipCount;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pBuildPipeline->m_vkComputePipeline);
+
+	// Each level only covers the valid part of the one above, odd sizes round up so the last texel takes the border
+	HiZPushData pushData;
+	pushData.srcSize = glm::ivec2(renderExtent.width, renderExtent.height);
+
+	for (uint32_t m = 0; m < m_uiMipCount; ++m)
+	{
+		pushData.dstSize = glm::max((pushData.srcSize + 1) / 2, glm::ivec2(1));
+
+		VkDescriptorSet vkSet = (m == 0) ? m_vecDepthSets[frameIndex] : m_vecMipSets[m - 1];
+		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pBuildPipeline->m_vkPipelineLayout, 0, 1, &vkSet, 0, nullptr);
+		vkCmdPushConstants(cmdBuffer, m_pBuildPipeline->m_vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(HiZPushData), &pushData);
+		vkCmdDispatch(cmdBuffer, (pushData.dstSize.x + HiZConfig::GROUP_SIZE - 1) / HiZConfig::GROUP_SIZE,
+								 (pushData.dstSize.y + HiZConfig::GROUP_SIZE - 1) / HiZConfig::GROUP_SIZE, 1);
+
+		// Level must be written before next level or culling reads it
+		barrier.oldLayout = VK_IMAGE_LAYOUT_GENERAL;
+		barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		barrier.subresourceRange.baseMipLevel = m;
+		barrier.subresourceRange.levelCount = 1;
+
+		// Main render pass clears depth attachment right after culling, wait for our depth reads too
+		VkPipelineStageFlags dstStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+		if (m == m_uiMipCount - 1)
+			dstStage |= VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+
+		vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+		pushData.srcSize = pushData.dstSize;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer)
+{
+	m_vkExtent = pSwapchain->m_vkSwapchainExtent;
+
+	CreateRenderPass(pDevice, pFrameBuffer);
+	CreateFramebuffers(pDevice, pSwapchain, pFrameBuffer);
+	CreatePyramid(pDevice, pSwapchain);
+	CreateDescriptors(pDevice, pSwapchain, pFrameBuffer);
+	CreatePipelines(pDevice, pSwapchain);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Everything tied to swapchain size, sampler & set layouts survive resize!
+void HiZPass::CleanupOnWindowResize(VulkanDevice* pDevice)
+{
+	if (m_pBuildPipeline)
+		m_pBuildPipeline->Cleanup(pDevice);
+
+	if (m_pOccluderPipeline)
+		m_pOccluderPipeline->CleanupOnWindowResize(pDevice);
+
+	SAFE_DELETE(m_pBuildPipeline);
+	SAFE_DELETE(m_pOccluderPipeline);
+
+	for (VkFramebuffer vkFramebuffer : m_vecFramebuffers)
+	{
+		vkDestroyFramebuffer(pDevice->m_vkLogicalDevice, vkFramebuffer, nullptr);
+	}
+	m_vecFramebuffers.clear();
+
+	for (VkImageView vkView : m_vecMipViews)
+	{
+		vkDestroyImageView(pDevice->m_vkLogicalDevice, vkView, nullptr);
+	}
+	m_vecMipViews.clear();
+
+	vkDestroyImageView(pDevice->m_vkLogicalDevice, m_vkPyramidView, nullptr);
+	vkDestroyImage(pDevice->m_vkLogicalDevice, m_vkPyramidImage, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkPyramidMemory, nullptr);
+	m_vkPyramidView = VK_NULL_HANDLE;
+	m_vkPyramidImage = VK_NULL_HANDLE;
+	m_vkPyramidMemory = VK_NULL_HANDLE;
+
+	vkDestroyRenderPass(pDevice->m_vkLogicalDevice, m_vkRenderPass, nullptr);
+	m_vkRenderPass = VK_NULL_HANDLE;
+
+	// sets are freed along with the pool
+	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, m_vkDescriptorPool, nullptr);
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vecDepthSets.clear();
+	m_vecMipSets.clear();
+	m_vkCullSet = VK_NULL_HANDLE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void HiZPass::Cleanup(VulkanDevice* pDevice)
+{
+	CleanupOnWindowResize(pDevice);
+
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkBuildSetLayout, nullptr);
+	m_vkBuildSetLayout = VK_NULL_HANDLE;
+
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkCullSetLayout, nullptr);
+	m_vkCullSetLayout = VK_NULL_HANDLE;
+
+	vkDestroySampler(pDevice->m_vkLogicalDevice, m_vkSampler, nullptr);
+	m_vkSampler = VK_NULL_HANDLE;
+}
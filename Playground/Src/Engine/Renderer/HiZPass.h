@@ -0,0 +1,95 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "glm/glm.hpp"
+
+class VulkanDevice;
+class VulkanSwapChain;
+class VulkanGraphicsPipeline;
+class VulkanComputePipeline;
+class DeferredFrameBuffer;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace HiZConfig
+{
+	constexpr VkFormat					FORMAT = VK_FORMAT_R32_SFLOAT;
+	constexpr uint32_t					GROUP_SIZE = 8;										// must match HiZBuild.comp
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match push constant block in HiZBuild.comp
+struct HiZPushData
+{
+	alignas(8)	glm::ivec2				srcSize;			// valid texels of source level (render extent for depth)
+	alignas(8)	glm::ivec2				dstSize;			// valid texels of written level
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Hierarchical depth for GPU occlusion culling, two phase:
+//  1. meshes visible last frame are drawn depth only into the depth attachment with this frame's camera (occluders)
+//  2. that depth is reduced into a max depth mip pyramid, every mesh is then tested against it before indirect draws
+// Occluders come from the current view, so meshes getting disoccluded show up in the same frame instead of popping in!
+// Level 0 is half resolution, each texel holds farthest depth of the 2x2 pixels below it. Only the render extent subrect
+// of each level is valid, culling clamps to it.
+class HiZPass
+{
+public:
+	HiZPass();
+	~HiZPass();
+
+	// Scene set layouts (frame, material) & per draw push constants are needed for occluder pipeline, same as G-Buffer
+	void								Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer,
+												   const std::vector<VkDescriptorSetLayout>& vecSceneSetLayouts,
+												   const std::vector<VkPushConstantRange>& vecScenePushConstantRanges);
+
+	// Depth only render pass over depth attachment, caller binds occluder pipeline & records draws in between
+	void								BeginOccluderPass(VkCommandBuffer cmdBuffer, uint32_t frameIndex, const VkExtent2D& renderExtent);
+	void								EndOccluderPass(VkCommandBuffer cmdBuffer);
+
+	// Occluder depth -> pyramid, leaves it visible to compute reads & depth attachment free for main render pass
+	void								RecordBuild(VkCommandBuffer cmdBuffer, uint32_t frameIndex, const VkExtent2D& renderExtent);
+
+	inline VulkanGraphicsPipeline*		GetOccluderPipeline()				{ return m_pOccluderPipeline; }
+	inline VkDescriptorSetLayout		GetCullDescriptorSetLayout()		{ return m_vkCullSetLayout; }
+	inline VkDescriptorSet				GetCullDescriptorSet()				{ return m_vkCullSet; }
+	inline uint32_t						GetMipCount()						{ return m_uiMipCount; }
+
+	void								Cleanup(VulkanDevice* pDevice);
+	void								CleanupOnWindowResize(VulkanDevice* pDevice);
+	void								HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer);
+
+private:
+	void								CreateRenderPass(VulkanDevice* pDevice, DeferredFrameBuffer* pFrameBuffer);
+	void								CreateFramebuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer);
+	void								CreatePyramid(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								CreateSampler(VulkanDevice* pDevice);
+	void								CreateDescriptorSetLayouts(VulkanDevice* pDevice);
+	void								CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer);
+	void								CreatePipelines(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+
+private:
+	VkRenderPass						m_vkRenderPass;					// occluders, depth attachment only
+	std::vector<VkFramebuffer>			m_vecFramebuffers;				// per frame in flight
+
+	VkImage								m_vkPyramidImage;				// shared by all frames, rebuilt every frame before culling
+	VkDeviceMemory						m_vkPyramidMemory;
+	VkImageView							m_vkPyramidView;				// all levels, sampled by culling
+	std::vector<VkImageView>			m_vecMipViews;					// single level, storage target & source of next level
+
+	VkSampler							m_vkSampler;
+	VkDescriptorSetLayout				m_vkBuildSetLayout;				// 0 - source level, 1 - destination level
+	VkDescriptorSetLayout				m_vkCullSetLayout;				// 0 - whole pyramid
+	VkDescriptorPool					m_vkDescriptorPool;
+	std::vector<VkDescriptorSet>		m_vecDepthSets;					// per frame in flight, depth -> level 0
+	std::vector<VkDescriptorSet>		m_vecMipSets;					// level i -> level i + 1
+	VkDescriptorSet						m_vkCullSet;
+
+	VulkanComputePipeline*				m_pBuildPipeline;
+	VulkanGraphicsPipeline*				m_pOccluderPipeline;
+	std::vector<VkDescriptorSetLayout>	m_vecSceneSetLayouts;			// not owned
+	std::vector<VkPushConstantRange>	m_vecScenePushConstantRanges;
+
+	VkExtent2D							m_vkExtent;						// swapchain & depth attachment size
+	VkExtent2D							m_vkPyramidExtent;				// level 0 size
+	uint32_t							m_uiMipCount;
+};
@@ -0,0 +1,266 @@
+#include "PlaygroundPCH.h"
+#include "MaterialRegistry.h"
+
+#include "VulkanDevice.h"
+#include "VulkanTexture2D.h"
+#include "FrameGlobals.h"
+
+#include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Log.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+MaterialRegistry::MaterialRegistry()
+{
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+	m_vkDescriptorSet = VK_NULL_HANDLE;
+
+	m_vkMaterialBuffer = VK_NULL_HANDLE;
+	m_vkMaterialMemory = VK_NULL_HANDLE;
+	m_pMappedMaterials = nullptr;
+
+	m_uiTextureCount = 0;
+	m_uiMaterialCount = 0;
+	m_vecFreeTextures.clear();
+	m_vecFreeMaterials.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+MaterialRegistry::~MaterialRegistry()
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void MaterialRegistry::Initialize(VulkanDevice* pDevice)
+{
+	if (!pDevice->m_bSupportsDescriptorIndexing)
+	{
+		LOG_ERROR("Bindless materials need descriptor indexing, device does not support it!");
+	}
+
+	// Persistently mapped, registration writes straight into it
+	pDevice->CreateBuffer(	BindlessConfig::MAX_MATERIALS * sizeof(GPUMaterial),
+							VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+							&m_vkMaterialBuffer,
+							&m_vkMaterialMemory);
+
+	void* data;
+	vkMapMemory(pDevice->m_vkLogicalDevice, m_vkMaterialMemory, 0, VK_WHOLE_SIZE, 0, &data);
+	m_pMappedMaterials = static_cast<GPUMaterial*>(data);
+
+	CreateDescriptorSetLayout(pDevice);
+	CreateDescriptors(pDevice);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void MaterialRegistry::CreateDescriptorSetLayout(VulkanDevice* pDevice)
+{
+	std::array<VkDescriptorSetLayoutBinding, 2> arrBindings = {};
+
+	// 0 - all material textures, only registered slots are ever written
+	arrBindings[0].binding = 0;
+	arrBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	arrBindings[0].descriptorCount = BindlessConfig::MAX_TEXTURES;
+	arrBindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	arrBindings[0].pImmutableSamplers = nullptr;
+
+	// 1 - materials
+	arrBindings[1].binding = 1;
+	arrBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	arrBindings[1].descriptorCount = 1;
+	arrBindings[1].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	arrBindings[1].pImmutableSamplers = nullptr;
+
+	std::array<VkDescriptorBindingFlags, 2> arrBindingFlags = {};
+	arrBindingFlags[0] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+	arrBindingFlags[1] = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount = static_cast<uint32_t>(arrBindingFlags.size());
+	bindingFlagsInfo.pBindingFlags = arrBindingFlags.data();
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.pNext = &bindingFlagsInfo;
+	layoutCreateInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutCreateInfo.bindingCount = static_cast<uint32_t>(arrBindings.size());
+	layoutCreateInfo.pBindings = arrBindings.data();
+
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkDescriptorSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Bindless Descriptor Set Layout");
+	}
+	else
+		LOG_DEBUG("Created Bindless Descriptor Set Layout");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void MaterialRegistry::CreateDescriptors(VulkanDevice* pDevice)
+{
+	//--- Pool, single set for whole application
+	std::array<VkDescriptorPoolSize, 2> arrPoolSizes = {};
+	arrPoolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	arrPoolSizes[0].descriptorCount = BindlessConfig::MAX_TEXTURES;
+	arrPoolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	arrPoolSizes[1].descriptorCount = 1;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolCreateInfo.maxSets = 1;
+	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrPoolSizes.size());
+	poolCreateInfo.pPoolSizes = arrPoolSizes.data();
+
+	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vkDescriptorPool) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Bindless Descriptor Pool");
+	}
+	else
+		LOG_DEBUG("Created Bindless Descriptor Pool");
+
+	//--- Set
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_vkDescriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &m_vkDescriptorSetLayout;
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, &m_vkDescriptorSet) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate Bindless Descriptor Set");
+	}
+
+	VkDescriptorBufferInfo bufferInfo = { m_vkMaterialBuffer, 0, VK_WHOLE_SIZE };
+
+	VkWriteDescriptorSet materialWrite = {};
+	materialWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	materialWrite.dstSet = m_vkDescriptorSet;
+	materialWrite.dstBinding = 1;
+	materialWrite.dstArrayElement = 0;
+	materialWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	materialWrite.descriptorCount = 1;
+	materialWrite.pBufferInfo = &bufferInfo;
+
+	vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, 1, &materialWrite, 0, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+uint32_t MaterialRegistry::RegisterTexture(VulkanDevice* pDevice, VulkanTexture2D* pTexture)
+{
+	uint32_t uiIndex;
+	if (!m_vecFreeTextures.empty())
+	{
+		uiIndex = m_vecFreeTextures.back();
+		m_vecFreeTextures.pop_back();
+	}
+	else if (m_uiTextureCount < BindlessConfig::MAX_TEXTURES)
+	{
+		uiIndex = m_uiTextureCount++;
+	}
+	else
+	{
+		LOG_ERROR("Bindless texture array full, {0} textures", BindlessConfig::MAX_TEXTURES);
+		return 0;
+	}
+
+	VkDescriptorImageInfo imageInfo = {};
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.imageView = pTexture->m_vkTextureImageView;
+	imageInfo.sampler = pTexture->m_vkTextureSampler;
+
+	VkWriteDescriptorSet textureWrite = {};
+	textureWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	textureWrite.dstSet = m_vkDescriptorSet;
+	textureWrite.dstBinding = 0;
+	textureWrite.dstArrayElement = uiIndex;
+	textureWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	textureWrite.descriptorCount = 1;
+	textureWrite.pImageInfo = &imageInfo;
+
+	vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, 1, &textureWrite, 0, nullptr);
+
+	return uiIndex;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Slot keeps its stale descriptor until reused, partially bound allows that as long as no material points at it
+void MaterialRegistry::ReleaseTexture(uint32_t uiIndex)
+{
+	if (uiIndex < m_uiTextureCount)
+		m_vecFreeTextures.push_back(uiIndex);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+uint32_t MaterialRegistry::RegisterMaterial(const GPUMaterial& material)
+{
+	uint32_t uiIndex;
+	if (!m_vecFreeMaterials.empty())
+	{
+		uiIndex = m_vecFreeMaterials.back();
+		m_vecFreeMaterials.pop_back();
+	}
+	else if (m_uiMaterialCount < BindlessConfig::MAX_MATERIALS)
+	{
+		uiIndex = m_uiMaterialCount++;
+	}
+	else
+	{
+		LOG_ERROR("Bindless material buffer full, {0} materials", BindlessConfig::MAX_MATERIALS);
+		return 0;
+	}
+
+	m_pMappedMaterials[uiIndex] = material;
+
+	return uiIndex;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Single copy shared by all frames in flight, an edit may show up one frame early on images still being rendered.
+// Fine for editor tweaks, not for per frame animation!
+void MaterialRegistry::UpdateMaterial(uint32_t uiIndex, const GPUMaterial& material)
+{
+	if (uiIndex < m_uiMaterialCount)
+		m_pMappedMaterials[uiIndex] = material;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void MaterialRegistry::ReleaseMaterial(uint32_t uiIndex)
+{
+	if (uiIndex < m_uiMaterialCount)
+		m_vecFreeMaterials.push_back(uiIndex);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void MaterialRegistry::BindDescriptorSet(VkCommandBuffer cmdBuffer, VkPipelineLayout vkPipelineLayout)
+{
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vkPipelineLayout, SceneSetConfig::MATERIAL_SET, 1, &m_vkDescriptorSet, 0, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void MaterialRegistry::Cleanup(VulkanDevice* pDevice)
+{
+	if (m_pMappedMaterials)
+		vkUnmapMemory(pDevice->m_vkLogicalDevice, m_vkMaterialMemory);
+
+	m_pMappedMaterials = nullptr;
+
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, m_vkMaterialBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkMaterialMemory, nullptr);
+
+	// set is freed along with the pool
+	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, m_vkDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkDescriptorSetLayout, nullptr);
+
+	m_vkMaterialBuffer = VK_NULL_HANDLE;
+	m_vkMaterialMemory = VK_NULL_HANDLE;
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+	m_vkDescriptorSet = VK_NULL_HANDLE;
+
+	m_uiTextureCount = 0;
+	m_uiMaterialCount = 0;
+	m_vecFreeTextures.clear();
+	m_vecFreeMaterials.clear();
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "glm/glm.hpp"
+
+class VulkanDevice;
+class VulkanTexture2D;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace BindlessConfig
+{
+	constexpr uint32_t					MAX_TEXTURES = 4096;								// must match GBuffer.frag
+	constexpr uint32_t					MAX_MATERIALS = 1024;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Texture maps a material samples, G-Buffer pipeline permutation key. Must match FEATURE_* in GBuffer.frag
+namespace MaterialFeature
+{
+	constexpr uint32_t					ALBEDO_MAP = 1 << 0;
+	constexpr uint32_t					EMISSIVE_MAP = 1 << 1;
+	constexpr uint32_t					NORMAL_MAP = 1 << 2;
+	constexpr uint32_t					ROUGHNESS_MAP = 1 << 3;
+	constexpr uint32_t					METALNESS_MAP = 1 << 4;
+	constexpr uint32_t					OCCLUSION_MAP = 1 << 5;
+	constexpr uint32_t					ALL = (1 << 6) - 1;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match Material in GBuffer.frag (std430). Texture indices point into the global texture array, constants are
+// used where material's permutation has no such map
+struct GPUMaterial
+{
+	GPUMaterial()
+	{
+		texturesAEN			= glm::uvec4(0);
+		texturesRMO			= glm::uvec4(0);
+		albedoColor			= glm::vec4(1.0f);
+		emissiveColor		= glm::vec4(1, 1, 0, 1);
+		properties			= glm::vec4(0.0f, 0.5f, 0.5f, 0.0f);
+	}
+
+	alignas(16) glm::uvec4				texturesAEN;			// x - Albedo, y - Emissive, z - Normal
+	alignas(16) glm::uvec4				texturesRMO;			// x - Roughness, y - Metalness, z - Occlusion
+	alignas(16) glm::vec4				albedoColor;
+	alignas(16) glm::vec4				emissiveColor;
+	alignas(16) glm::vec4				properties;				// x - AO, y - Roughness, z - Metalness
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// One descriptor set for every material texture in the scene (descriptor indexing), plus a storage buffer of materials
+// that reference textures by array index & hold material constants. Set is bound once per command buffer, draws only select a material index, so
+// descriptor memory no longer grows with model count! Freed slots are reused by later registrations.
+class MaterialRegistry
+{
+public:
+	static MaterialRegistry& getInstance()
+	{
+		static MaterialRegistry instance;
+		return instance;
+	}
+
+	~MaterialRegistry();
+
+	void								Initialize(VulkanDevice* pDevice);
+
+	// Update after bind, safe while recorded command buffers still reference the set
+	uint32_t							RegisterTexture(VulkanDevice* pDevice, VulkanTexture2D* pTexture);
+	void								ReleaseTexture(uint32_t uiIndex);
+	uint32_t							RegisterMaterial(const GPUMaterial& material);
+	void								UpdateMaterial(uint32_t uiIndex, const GPUMaterial& material);
+	void								ReleaseMaterial(uint32_t uiIndex);
+
+	void								BindDescriptorSet(VkCommandBuffer cmdBuffer, VkPipelineLayout vkPipelineLayout);
+
+	inline VkDescriptorSetLayout		GetDescriptorSetLayout()	{ return m_vkDescriptorSetLayout; }
+	inline VkDescriptorSet				GetDescriptorSet()			{ return m_vkDescriptorSet; }
+	inline uint32_t						GetTextureCount()			{ return m_uiTextureCount - static_cast<uint32_t>(m_vecFreeTextures.size()); }
+	inline uint32_t						GetMaterialCount()			{ return m_uiMaterialCount - static_cast<uint32_t>(m_vecFreeMaterials.size()); }
+
+	void								Cleanup(VulkanDevice* pDevice);
+
+private:
+	MaterialRegistry();
+
+	void								CreateDescriptorSetLayout(VulkanDevice* pDevice);
+	void								CreateDescriptors(VulkanDevice* pDevice);
+
+private:
+	VkDescriptorPool					m_vkDescriptorPool;
+	VkDescriptorSetLayout				m_vkDescriptorSetLayout;			// 0 - texture array, 1 - materials
+	VkDescriptorSet						m_vkDescriptorSet;
+
+	// Host visible, materials are written at registration & on editor changes
+	VkBuffer							m_vkMaterialBuffer;
+	VkDeviceMemory						m_vkMaterialMemory;
+	GPUMaterial*						m_pMappedMaterials;
+
+	uint32_t							m_uiTextureCount;					// high water mark of used slots
+	uint32_t							m_uiMaterialCount;
+	std::vector<uint32_t>				m_vecFreeTextures;
+	std::vector<uint32_t>				m_vecFreeMaterials;
+};
@@ -0,0 +1,170 @@
+#include "PlaygroundPCH.h"
+#include "RenderQueue.h"
+
+#include "VulkanGraphicsPipeline.h"
+#include "Engine/RenderObjects/Model.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+RenderQueue::RenderQueue()
+{
+	m_vecItems.clear();
+	m_vecScratch.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+RenderQueue::~RenderQueue()
+{
+	m_vecItems.clear();
+	m_vecScratch.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+uint64_t RenderQueue::MakeSortKey(RenderPipelineID ePipeline, uint32_t uiPermutation, uint32_t uiMaterial, float fDepth01,
+								  uint32_t uiGeometry)
+{
+	const uint64_t uiMask20 = (1u << 20) - 1;
+	const uint64_t uiMask14 = (1u << 14) - 1;
+
+	uint64_t uiDepth = static_cast<uint64_t>(std::clamp(fDepth01, 0.0f, 1.0f) * static_cast<float>(uiMask20));
+
+	return	(static_cast<uint64_t>(ePipeline) & 0xF) << 60	|
+			(static_cast<uint64_t>(uiPermutation) & 0x3F) << 54 |
+			(static_cast<uint64_t>(uiMaterial) & uiMask14) << 40 |
+			(uiDepth & uiMask20) << 20 |
+			(static_cast<uint64_t>(uiGeometry) & uiMask20);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void RenderQueue::Clear()
+{
+	m_vecItems.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void RenderQueue::Push(uint64_t uiSortKey, Model* pModel, uint32_t uiMesh)
+{
+	m_vecItems.push_back({ uiSortKey, pModel, uiMesh });
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void RenderQueue::Sort()
+{
+	size_t nItems = m_vecItems.size();
+	if (nItems < 2)
+		return;
+
+	m_vecScratch.resize(nItems);
+
+	RenderItem* pSrc = m_vecItems.data();
+	RenderItem* pDst = m_vecScratch.data();
+
+	for (uint32_t uiShift = 0; uiShift < 64; uiShift += 8)
+	{
+		std::array<uint32_t, 256> arrHistogram = {};
+		for (size_t i = 0; i < nItems; ++i)
+		{
+			++arrHistogram[(pSrc[i].uiSortKey >> uiShift) & 0xFF];
+		}
+
+		// every key has same digit, pass wouldn't change the order
+		if (arrHistogram[(pSrc[0].uiSortKey >> uiShift) & 0xFF] == nItems)
+			continue;
+
+		// exclusive prefix sum gives first output slot per digit
+		uint32_t uiOffset = 0;
+		for (uint32_t& uiCount : arrHistogram)
+		{
+			uint32_t uiDigitCount = uiCount;
+			uiCount = uiOffset;
+			uiOffset += uiDigitCount;
+		}
+
+		// stable scatter
+		for (size_t i = 0; i < nItems; ++i)
+		{
+			pDst[arrHistogram[(pSrc[i].uiSortKey >> uiShift) & 0xFF]++] = pSrc[i];
+		}
+
+		std::swap(pSrc, pDst);
+	}
+
+	// odd number of executed passes leaves sorted data in scratch
+	if (pSrc != m_vecItems.data())
+	{
+		m_vecItems.swap(m_vecScratch);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void RenderQueue::Submit(VkCommandBuffer cmdBuffer, const std::vector<VulkanGraphicsPipeline*>& vecPipelines, VkBuffer vkDrawArgs,
+						 uint32_t uiFirst, uint32_t uiCount, RenderQueueStats& outStats) const
+{
+	uint32_t uiLast = std::min(uiFirst + uiCount, GetCount());
+
+	uint64_t uiBoundState = UINT64_MAX;
+	const Model* pPushedModel = nullptr;
+	const Model* pBoundGeometryModel = nullptr;
+	uint32_t uiBoundMesh = UINT32_MAX;
+
+	for (uint32_t i = uiFirst; i < uiLast; ++i)
+	{
+		const RenderItem& item = m_vecItems[i];
+
+		// pipeline + permutation bits
+		uint64_t uiState = item.uiSortKey >> 54;
+		VulkanGraphicsPipeline* pPipeline = vecPipelines[uiState >> 6];
+
+		if (uiState != uiBoundState)
+		{
+			vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->GetPermutation(static_cast<uint32_t>(uiState & 0x3F)));
+			uiBoundState = uiState;
+			++outStats.uiPipelineBinds;
+
+			// Layouts differ in vertex input only, but be explicit about what survives a pipeline switch
+			pPushedModel = nullptr;
+			pBoundGeometryModel = nullptr;
+		}
+
+		// Object slot is pushed per model, sets stay bound for whole command buffer
+		if (item.pModel != pPushedModel)
+		{
+			item.pModel->PushConstants(cmdBuffer, pPipeline);
+			pPushedModel = item.pModel;
+			++outStats.uiPushConstants;
+		}
+
+		if (item.pModel != pBoundGeometryModel || item.uiMesh != uiBoundMesh)
+		{
+			item.pModel->BindMeshGeometry(cmdBuffer, item.uiMesh);
+			pBoundGeometryModel = item.pModel;
+			uiBoundMesh = item.uiMesh;
+			++outStats.uiGeometryBinds;
+		}
+
+		item.pModel->DrawMesh(cmdBuffer, vkDrawArgs, item.uiMesh);
+		++outStats.uiDraws;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void RenderQueue::SubmitDepthOnly(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline, VkBuffer vkDrawArgs) const
+{
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pPipeline->m_vkGraphicsPipeline);
+
+	const Model* pBoundModel = nullptr;
+	for (const RenderItem& item : m_vecItems)
+	{
+		if ((item.uiSortKey >> 60) != static_cast<uint64_t>(RenderPipelineID::GBUFFER_OPAQUE))
+			continue;
+
+		// Same object slot as G-Buffer pass, only the matrix is read
+		if (item.pModel != pBoundModel)
+		{
+			item.pModel->PushConstants(cmdBuffer, pPipeline);
+			pBoundModel = item.pModel;
+		}
+
+		item.pModel->BindMeshPositions(cmdBuffer, item.uiMesh);
+		item.pModel->DrawMesh(cmdBuffer, vkDrawArgs, item.uiMesh);
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+class Model;
+class VulkanGraphicsPipeline;
+
+//---------------------------------------------------------------------------------------------------------------------
+// Index into pipeline list passed to RenderQueue::Submit, occupies top bits of the sort key
+enum class RenderPipelineID
+{
+	GBUFFER_OPAQUE = 0,
+	GBUFFER_OPAQUE_INSTANCED
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+struct RenderItem
+{
+	uint64_t							uiSortKey;
+	Model*								pModel;
+	uint32_t							uiMesh;
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+struct RenderQueueStats
+{
+	inline void							Reset()									{ uiDraws = uiPipelineBinds = uiPushConstants = uiGeometryBinds = uiTriangles = 0; }
+	inline void							Accumulate(const RenderQueueStats& other)
+	{
+		uiDraws += other.uiDraws;
+		uiPipelineBinds += other.uiPipelineBinds;
+		uiPushConstants += other.uiPushConstants;
+		uiGeometryBinds += other.uiGeometryBinds;
+		uiTriangles += other.uiTriangles;
+	}
+
+	uint32_t							uiDraws = 0;
+	uint32_t							uiPipelineBinds = 0;
+	uint32_t							uiPushConstants = 0;			// object slot
+	uint32_t							uiGeometryBinds = 0;			// vertex + index buffer pair
+	uint32_t							uiTriangles = 0;				// visible meshes after LOD selection, all instances
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Flat list of draws sorted by 64 bit state key, most significant first:
+//		pipeline (4) | permutation (6) | material (14) | view depth (20) | geometry (20)
+// so that equal state ends up adjacent & Submit() only binds what actually changed. Opaque, so depth is front to back.
+// Pipeline & permutation together pick the VkPipeline, permutation is the material's MaterialFeature mask & material its
+// MaterialRegistry index. Depth sits above geometry: every mesh has its own buffers, so grouping by model would only save
+// push constants, while strict front to back order within a material feeds early-Z (depth pre-pass included).
+// Geometry is the owning model & only breaks depth ties.
+class RenderQueue
+{
+public:
+	RenderQueue();
+	~RenderQueue();
+
+	static uint64_t						MakeSortKey(RenderPipelineID ePipeline, uint32_t uiPermutation, uint32_t uiMaterial, float fDepth01,
+													uint32_t uiGeometry);
+
+	void								Clear();
+	void								Push(uint64_t uiSortKey, Model* pModel, uint32_t uiMesh);
+
+	// LSD radix sort, 8 bits per pass, passes where all keys share the digit are skipped
+	void								Sort();
+
+	// Records items [uiFirst, uiFirst + uiCount), bind state is tracked within this call only! Index range & instance count of
+	// every draw are read from the item's slot in vkDrawArgs
+	void								Submit(VkCommandBuffer cmdBuffer, const std::vector<VulkanGraphicsPipeline*>& vecPipelines, VkBuffer vkDrawArgs,
+											   uint32_t uiFirst, uint32_t uiCount, RenderQueueStats& outStats) const;
+
+	// Depth only draws of GBUFFER_OPAQUE items, position stream + index buffer only
+	void								SubmitDepthOnly(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline, VkBuffer vkDrawArgs) const;
+
+	inline uint32_t						GetCount() const						{ return static_cast<uint32_t>(m_vecItems.size()); }
+	inline const std::vector<RenderItem>& GetItems() const					{ return m_vecItems; }
+
+private:
+	std::vector<RenderItem>				m_vecItems;
+	std::vector<RenderItem>				m_vecScratch;
+};
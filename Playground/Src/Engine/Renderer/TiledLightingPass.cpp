@@ -0,0 +1,525 @@
+#include "PlaygroundPCH.h"
+#include "TiledLightingPass.h"
+
+#include "VulkanDevice.h"
+#include "VulkanSwapChain.h"
+#include "VulkanGraphicsPipeline.h"
+#include "VulkanComputePipeline.h"
+#include "VulkanTextureCUBE.h"
+#include "DeferredFrameBuffer.h"
+
+#include "Engine/RenderObjects/HDRISkydome.h"
+#include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Log.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+TiledLightingPass::TiledLightingPass()
+{
+	m_vkRenderPass = VK_NULL_HANDLE;
+	m_vecFramebuffers.clear();
+
+	m_vkHDRImage = VK_NULL_HANDLE;
+	m_vkHDRMemory = VK_NULL_HANDLE;
+	m_vkHDRView = VK_NULL_HANDLE;
+
+	m_vkSampler = VK_NULL_HANDLE;
+	m_vkLightingSetLayout = VK_NULL_HANDLE;
+	m_vkResolveSetLayout = VK_NULL_HANDLE;
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vecLightingSets.clear();
+	m_vkResolveSet = VK_NULL_HANDLE;
+
+	m_pLightingPipeline = nullptr;
+	m_pResolvePipeline = nullptr;
+	m_vkClusterSetLayout = VK_NULL_HANDLE;
+
+	m_vkExtent = { 0, 0 };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+TiledLightingPass::~TiledLightingPass()
+{
+	SAFE_DELETE(m_pLightingPipeline);
+	SAFE_DELETE(m_pResolvePipeline);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer,
+								   VkDescriptorSetLayout vkClusterSetLayout, const std::vector<VkBuffer>& vecDeferredBuffers)
+{
+	m_vkClusterSetLayout = vkClusterSetLayout;
+
+	CreateSampler(pDevice);
+	CreateDescriptorSetLayouts(pDevice);
+
+	HandleWindowResize(pDevice, pSwapchain, pFrameBuffer, vecDeferredBuffers);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::CreateRenderPass(VulkanDevice* pDevice, DeferredFrameBuffer* pFrameBuffer)
+{
+	// Scene color already holds sky from main render pass, resolve only overwrites lit pixels
+	VkAttachmentDescription colorAttachmentDesc = {};
+	colorAttachmentDesc.format			= pFrameBuffer->m_pSceneColorAttachment->attachmentFormat;
+	colorAttachmentDesc.samples			= VK_SAMPLE_COUNT_1_BIT;
+	colorAttachmentDesc.loadOp			= VK_ATTACHMENT_LOAD_OP_LOAD;
+	colorAttachmentDesc.storeOp			= VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachmentDesc.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachmentDesc.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachmentDesc.initialLayout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	colorAttachmentDesc.finalLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkAttachmentReference colorAttachmentRef = {};
+	colorAttachmentRef.attachment		= 0;
+	colorAttachmentRef.layout			= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint			= VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount		= 1;
+	subpass.pColorAttachments			= &colorAttachmentRef;
+
+	// Wait for lighting dispatch & main render pass scene color writes, then hand scene color to upscale pass
+	std::array<VkSubpassDependency, 2> arrDependencies = {};
+	arrDependencies[0].srcSubpass		= VK_SUBPASS_EXTERNAL;
+	arrDependencies[0].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	arrDependencies[0].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	arrDependencies[0].dstSubpass		= 0;
+	arrDependencies[0].dstStageMask		= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	arrDependencies[0].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	arrDependencies[1].srcSubpass		= 0;
+	arrDependencies[1].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	arrDependencies[1].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	arrDependencies[1].dstSubpass		= VK_SUBPASS_EXTERNAL;
+	arrDependencies[1].dstStageMask		= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	arrDependencies[1].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+
+	VkRenderPassCreateInfo renderPassCreateInfo = {};
+	renderPassCreateInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCreateInfo.attachmentCount	= 1;
+	renderPassCreateInfo.pAttachments		= &colorAttachmentDesc;
+	renderPassCreateInfo.subpassCount		= 1;
+	renderPassCreateInfo.pSubpasses			= &subpass;
+	renderPassCreateInfo.dependencyCount	= static_cast<uint32_t>(arrDependencies.size());
+	renderPassCreateInfo.pDependencies		= arrDependencies.data();
+
+	if (vkCreateRenderPass(pDevice->m_vkLogicalDevice, &renderPassCreateInfo, nullptr, &m_vkRenderPass) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Tiled Lighting Resolve Render Pass");
+	}
+	else
+		LOG_DEBUG("Created Tiled Lighting Resolve Render Pass");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::CreateFramebuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer)
+{
+	m_vecFramebuffers.resize(pSwapchain->m_uiFramesInFlight);
+
+	for (uint32_t i = 0; i < m_vecFramebuffers.size(); ++i)
+	{
+		VkFramebufferCreateInfo framebufferCreateInfo = {};
+		framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.renderPass = m_vkRenderPass;
+		framebufferCreateInfo.attachmentCount = 1;
+		framebufferCreateInfo.pAttachments = &pFrameBuffer->m_pSceneColorAttachment->vecAttachmentImageView[i];
+		framebufferCreateInfo.width = m_vkExtent.width;
+		framebufferCreateInfo.height = m_vkExtent.height;
+		framebufferCreateInfo.layers = 1;
+
+		if (vkCreateFramebuffer(pDevice->m_vkLogicalDevice, &framebufferCreateInfo, nullptr, &m_vecFramebuffers[i]) != VK_SUCCESS)
+		{
+			LOG_ERROR("Failed to create Tiled Lighting Resolve Framebuffer");
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::CreateHDRImage(VulkanDevice* pDevice)
+{
+	// Full swapchain size, lower render scales only use the top left part
+	VkImageCreateInfo imageCreateInfo = {};
+	imageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageCreateInfo.extent.width = m_vkExtent.width;
+	imageCreateInfo.extent.height = m_vkExtent.height;
+	imageCreateInfo.extent.depth = 1;
+	imageCreateInfo.mipLevels = 1;
+	imageCreateInfo.arrayLayers = 1;
+	imageCreateInfo.format = TiledLightingConfig::HDR_FORMAT;
+	imageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageCreateInfo.usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateImage(pDevice->m_vkLogicalDevice, &imageCreateInfo, nullptr, &m_vkHDRImage) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Tiled Lighting HDR image");
+	}
+
+	VkMemoryRequirements memoryRequirements;
+	vkGetImageMemoryRequirements(pDevice->m_vkLogicalDevice, m_vkHDRImage, &memoryRequirements);
+
+	VkMemoryAllocateInfo memoryAllocInfo = {};
+	memoryAllocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	memoryAllocInfo.allocationSize = memoryRequirements.size;
+	memoryAllocInfo.memoryTypeIndex = pDevice->FindMemoryTypeIndex(memoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	if (vkAllocateMemory(pDevice->m_vkLogicalDevice, &memoryAllocInfo, nullptr, &m_vkHDRMemory) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate memory for Tiled Lighting HDR image!");
+	}
+
+	vkBindImageMemory(pDevice->m_vkLogicalDevice, m_vkHDRImage, m_vkHDRMemory, 0);
+
+	VkImageViewCreateInfo viewCreateInfo = {};
+	viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCreateInfo.image = m_vkHDRImage;
+	viewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewCreateInfo.format = TiledLightingConfig::HDR_FORMAT;
+	viewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewCreateInfo.subresourceRange.baseMipLevel = 0;
+	viewCreateInfo.subresourceRange.levelCount = 1;
+	viewCreateInfo.subresourceRange.baseArrayLayer = 0;
+	viewCreateInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(pDevice->m_vkLogicalDevice, &viewCreateInfo, nullptr, &m_vkHDRView) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Tiled Lighting HDR image view!");
+	}
+
+	LOG_DEBUG("Created Tiled Lighting HDR image {0}x{1}", m_vkExtent.width, m_vkExtent.height);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::CreateSampler(VulkanDevice* pDevice)
+{
+	// Shaders only use texelFetch on G-Buffer & HDR image
+	VkSamplerCreateInfo samplerCreateInfo = {};
+	samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCreateInfo.magFilter = VK_FILTER_NEAREST;
+	samplerCreateInfo.minFilter = VK_FILTER_NEAREST;
+	samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+	samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+	samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCreateInfo.mipLodBias = 0.0f;
+	samplerCreateInfo.minLod = 0.0f;
+	samplerCreateInfo.maxLod = 0.0f;
+	samplerCreateInfo.anisotropyEnable = VK_FALSE;
+	samplerCreateInfo.maxAnisotropy = 1.0f;
+
+	if (vkCreateSampler(pDevice->m_vkLogicalDevice, &samplerCreateInfo, nullptr, &m_vkSampler) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Tiled Lighting Sampler");
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::CreateDescriptorSetLayouts(VulkanDevice* pDevice)
+{
+	//--- Lighting, 0 - Albedo, 1 - Depth, 2 - Normal, 3 - Position, 4 - PBR, 5 - HDR output, 6 - deferred uniforms,
+	// 7 - Irradiance, 8 - Prefiltered Specular, 9 - BRDF LUT
+	std::array<VkDescriptorSetLayoutBinding, 10> arrBindings = {};
+	for (uint32_t i = 0; i < arrBindings.size(); ++i)
+	{
+		arrBindings[i].binding = i;
+		arrBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		arrBindings[i].descriptorCount = 1;
+		arrBindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+		arrBindings[i].pImmutableSamplers = nullptr;
+	}
+	arrBindings[5].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	arrBindings[6].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = static_cast<uint32_t>(arrBindings.size());
+	layoutCreateInfo.pBindings = arrBindings.data();
+
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkLightingSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Tiled Lighting Descriptor Set Layout");
+	}
+
+	//--- Resolve, 0 - HDR
+	VkDescriptorSetLayoutBinding resolveBinding = {};
+	resolveBinding.binding = 0;
+	resolveBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	resolveBinding.descriptorCount = 1;
+	resolveBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	resolveBinding.pImmutableSamplers = nullptr;
+
+	layoutCreateInfo.bindingCount = 1;
+	layoutCreateInfo.pBindings = &resolveBinding;
+
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkResolveSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Tiled Lighting Resolve Descriptor Set Layout");
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer,
+										  const std::vector<VkBuffer>& vecDeferredBuffers)
+{
+	uint32_t nFrames = pSwapchain->m_uiFramesInFlight;
+
+	//--- Pool
+	std::array<VkDescriptorPoolSize, 3> arrPoolSizes = {};
+	arrPoolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	arrPoolSizes[0].descriptorCount = nFrames * 8 + 1;
+	arrPoolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	arrPoolSizes[1].descriptorCount = nFrames;
+	arrPoolSizes[2].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	arrPoolSizes[2].descriptorCount = nFrames;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = nFrames + 1;
+	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrPoolSizes.size());
+	poolCreateInfo.pPoolSizes = arrPoolSizes.data();
+
+	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vkDescriptorPool) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Tiled Lighting Descriptor Pool");
+	}
+
+	//--- Lighting sets
+	m_vecLightingSets.resize(nFrames);
+	std::vector<VkDescriptorSetLayout> vecLayouts(nFrames, m_vkLightingSetLayout);
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_vkDescriptorPool;
+	allocInfo.descriptorSetCount = nFrames;
+	allocInfo.pSetLayouts = vecLayouts.data();
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, m_vecLightingSets.data()) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate Tiled Lighting Descriptor Sets");
+	}
+
+	VulkanTextureCUBE* pIBL = HDRISkydome::getInstance().m_pIBL;
+
+	for (uint32_t i = 0; i < nFrames; ++i)
+	{
+		// G-Buffer stays in its lighting subpass layout after main render pass, no transition needed
+		std::array<VkDescriptorImageInfo, 5> arrGBufferInfos = {};
+		arrGBufferInfos[0].imageView = pFrameBuffer->m_pAlbedoAttachment->vecAttachmentImageView[i];
+		arrGBufferInfos[1].imageView = pFrameBuffer->m_pDepthAttachment->vecAttachmentImageView[i];
+		arrGBufferInfos[2].imageView = pFrameBuffer->m_pNormalAttachment->vecAttachmentImageView[i];
+		arrGBufferInfos[3].imageView = pFrameBuffer->m_pPositionAttachment->vecAttachmentImageView[i];
+		arrGBufferInfos[4].imageView = pFrameBuffer->m_pPBRAttachment->vecAttachmentImageView[i];
+		for (uint32_t g = 0; g < arrGBufferInfos.size(); ++g)
+		{
+			arrGBufferInfos[g].imageLayout = (g == 1) ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			arrGBufferInfos[g].sampler = m_vkSampler;
+		}
+
+		VkDescriptorImageInfo hdrInfo = {};
+		hdrInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		hdrInfo.imageView = m_vkHDRView;
+
+		VkDescriptorBufferInfo uniformInfo = { vecDeferredBuffers[i], 0, VK_WHOLE_SIZE };
+
+		std::array<VkDescriptorImageInfo, 3> arrIBLInfos = {};
+		arrIBLInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrIBLInfos[0].imageView = pIBL->m_vkImageViewIRRAD;
+		arrIBLInfos[0].sampler = pIBL->m_vkSamplerIRRAD;
+		arrIBLInfos[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrIBLInfos[1].imageView = pIBL->m_vkImageViewPrefilterSpec;
+		arrIBLInfos[1].sampler = pIBL->m_vkSamplerPrefilterSpec;
+		arrIBLInfos[2].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrIBLInfos[2].imageView = pIBL->m_vkImageViewBRDF;
+		arrIBLInfos[2].sampler = pIBL->m_vkSamplerBRDF;
+
+		// Consecutive bindings of same type share one write
+		std::array<VkWriteDescriptorSet, 4> arrWrites = {};
+		for (uint32_t w = 0; w < arrWrites.size(); ++w)
+		{
+			arrWrites[w].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			arrWrites[w].dstSet = m_vecLightingSets[i];
+			arrWrites[w].dstArrayElement = 0;
+		}
+
+		arrWrites[0].dstBinding = 0;
+		arrWrites[0].descriptorCount = static_cast<uint32_t>(arrGBufferInfos.size());
+		arrWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		arrWrites[0].pImageInfo = arrGBufferInfos.data();
+
+		arrWrites[1].dstBinding = 5;
+		arrWrites[1].descriptorCount = 1;
+		arrWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		arrWrites[1].pImageInfo = &hdrInfo;
+
+		arrWrites[2].dstBinding = 6;
+		arrWrites[2].descriptorCount = 1;
+		arrWrites[2].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		arrWrites[2].pBufferInfo = &uniformInfo;
+
+		arrWrites[3].dstBinding = 7;
+		arrWrites[3].descriptorCount = static_cast<uint32_t>(arrIBLInfos.size());
+		arrWrites[3].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		arrWrites[3].pImageInfo = arrIBLInfos.data();
+
+		vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, static_cast<uint32_t>(arrWrites.size()), arrWrites.data(), 0, nullptr);
+	}
+
+	//--- Resolve set
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &m_vkResolveSetLayout;
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, &m_vkResolveSet) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate Tiled Lighting Resolve Descriptor Set");
+	}
+
+	VkDescriptorImageInfo hdrInfo = {};
+	hdrInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+	hdrInfo.imageView = m_vkHDRView;
+	hdrInfo.sampler = m_vkSampler;
+
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = m_vkResolveSet;
+	write.dstBinding = 0;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &hdrInfo;
+
+	vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, 1, &write, 0, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::CreatePipelines(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	// Set 1 is the cluster set, same one deferred fragment shader reads lights from
+	m_pLightingPipeline = new VulkanComputePipeline("Shaders/TiledLighting.comp.spv");
+	m_pLightingPipeline->CreatePipelineLayout(pDevice, { m_vkLightingSetLayout, m_vkClusterSetLayout }, {});
+	m_pLightingPipeline->CreateComputePipeline(pDevice);
+
+	m_pResolvePipeline = new VulkanGraphicsPipeline(PipelineType::TILED_RESOLVE, pSwapchain);
+	m_pResolvePipeline->CreatePipelineLayout(pDevice, { m_vkResolveSetLayout }, {});
+	m_pResolvePipeline->CreateGraphicsPipeline(pDevice, pSwapchain, m_vkRenderPass, 0, 1);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::RecordLighting(VkCommandBuffer cmdBuffer, uint32_t frameIndex, const VkExtent2D& renderExtent,
+									   VkDescriptorSet vkClusterSet)
+{
+	// Old contents are never needed. Barrier also orders us after resolve reads of previous frames on this queue
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = m_vkHDRImage;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+						 0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+	//--- One work group per tile of render extent
+	std::array<VkDescriptorSet, 2> arrSets = { m_vecLightingSets[frameIndex], vkClusterSet };
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pLightingPipeline->m_vkComputePipeline);
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pLightingPipeline->m_vkPipelineLayout, 0,
+							static_cast<uint32_t>(arrSets.size()), arrSets.data(), 0, nullptr);
+	vkCmdDispatch(cmdBuffer, (renderExtent.width + TiledLightingConfig::TILE_SIZE - 1) / TiledLightingConfig::TILE_SIZE,
+							 (renderExtent.height + TiledLightingConfig::TILE_SIZE - 1) / TiledLightingConfig::TILE_SIZE, 1);
+
+	//--- Resolve, render pass dependency makes HDR writes visible to the fragment shader
+	VkRenderPassBeginInfo renderPassBeginInfo = {};
+	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassBeginInfo.renderPass = m_vkRenderPass;
+	renderPassBeginInfo.framebuffer = m_vecFramebuffers[frameIndex];
+	renderPassBeginInfo.renderArea.offset = { 0, 0 };
+	renderPassBeginInfo.renderArea.extent = renderExtent;
+	renderPassBeginInfo.clearValueCount = 0;
+	renderPassBeginInfo.pClearValues = nullptr;
+
+	vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+	Helper::Vulkan::SetViewportScissor(cmdBuffer, renderExtent);
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pResolvePipeline->m_vkGraphicsPipeline);
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pResolvePipeline->m_vkPipelineLayout, 0, 1, &m_vkResolveSet, 0, nullptr);
+	vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
+
+	vkCmdEndRenderPass(cmdBuffer);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer,
+										   const std::vector<VkBuffer>& vecDeferredBuffers)
+{
+	m_vkExtent = pSwapchain->m_vkSwapchainExtent;
+
+	CreateRenderPass(pDevice, pFrameBuffer);
+	CreateFramebuffers(pDevice, pSwapchain, pFrameBuffer);
+	CreateHDRImage(pDevice);
+	CreateDescriptors(pDevice, pSwapchain, pFrameBuffer, vecDeferredBuffers);
+	CreatePipelines(pDevice, pSwapchain);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Everything tied to swapchain size, sampler & set layouts survive resize!
+void TiledLightingPass::CleanupOnWindowResize(VulkanDevice* pDevice)
+{
+	if (m_pLightingPipeline)
+		m_pLightingPipeline->Cleanup(pDevice);
+
+	if (m_pResolvePipeline)
+		m_pResolvePipeline->CleanupOnWindowResize(pDevice);
+
+	SAFE_DELETE(m_pLightingPipeline);
+	SAFE_DELETE(m_pResolvePipeline);
+
+	for (VkFramebuffer vkFramebuffer : m_vecFramebuffers)
+	{
+		vkDestroyFramebuffer(pDevice->m_vkLogicalDevice, vkFramebuffer, nullptr);
+	}
+	m_vecFramebuffers.clear();
+
+	vkDestroyImageView(pDevice->m_vkLogicalDevice, m_vkHDRView, nullptr);
+	vkDestroyImage(pDevice->m_vkLogicalDevice, m_vkHDRImage, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, m_vkHDRMemory, nullptr);
+	m_vkHDRView = VK_NULL_HANDLE;
+	m_vkHDRImage = VK_NULL_HANDLE;
+	m_vkHDRMemory = VK_NULL_HANDLE;
+
+	vkDestroyRenderPass(pDevice->m_vkLogicalDevice, m_vkRenderPass, nullptr);
+	m_vkRenderPass = VK_NULL_HANDLE;
+
+	// sets are freed along with the pool
+	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, m_vkDescriptorPool, nullptr);
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vecLightingSets.clear();
+	m_vkResolveSet = VK_NULL_HANDLE;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void TiledLightingPass::Cleanup(VulkanDevice* pDevice)
+{
+	CleanupOnWindowResize(pDevice);
+
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkLightingSetLayout, nullptr);
+	m_vkLightingSetLayout = VK_NULL_HANDLE;
+
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkResolveSetLayout, nullptr);
+	m_vkResolveSetLayout = VK_NULL_HANDLE;
+
+	vkDestroySampler(pDevice->m_vkLogicalDevice, m_vkSampler, nullptr);
+	m_vkSampler = VK_NULL_HANDLE;
+}
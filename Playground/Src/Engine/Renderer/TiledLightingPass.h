@@ -0,0 +1,73 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+class VulkanDevice;
+class VulkanSwapChain;
+class VulkanGraphicsPipeline;
+class VulkanComputePipeline;
+class DeferredFrameBuffer;
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace TiledLightingConfig
+{
+	constexpr VkFormat					HDR_FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;
+	constexpr uint32_t					TILE_SIZE = 8;										// must match TiledLighting.comp
+	constexpr uint32_t					MAX_LIGHTS_PER_TILE = 256;							// must match TiledLighting.comp
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Compute shader alternative to the deferred lighting subpass, for comparing both on tile based & desktop GPUs.
+// Main render pass then stores G-Buffer & only composites sky in its second subpass. Afterwards every 8x8 pixel tile
+// is one work group that reduces its depth bounds & culls all local lights into a shared light list before shading,
+// lit HDR result goes into a storage image. Resolve pass tone maps it into scene color, skipping sky pixels.
+class TiledLightingPass
+{
+public:
+	TiledLightingPass();
+	~TiledLightingPass();
+
+	// Cluster set provides lights & camera data, deferred uniform buffers are per frame in flight
+	void								Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer,
+												   VkDescriptorSetLayout vkClusterSetLayout, const std::vector<VkBuffer>& vecDeferredBuffers);
+
+	// Outside render pass, after main render pass stored G-Buffer & scene color. Leaves scene color ready for upscale
+	void								RecordLighting(VkCommandBuffer cmdBuffer, uint32_t frameIndex, const VkExtent2D& renderExtent,
+													   VkDescriptorSet vkClusterSet);
+
+	void								Cleanup(VulkanDevice* pDevice);
+	void								CleanupOnWindowResize(VulkanDevice* pDevice);
+	void								HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer,
+														   const std::vector<VkBuffer>& vecDeferredBuffers);
+
+private:
+	void								CreateRenderPass(VulkanDevice* pDevice, DeferredFrameBuffer* pFrameBuffer);
+	void								CreateFramebuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer);
+	void								CreateHDRImage(VulkanDevice* pDevice);
+	void								CreateSampler(VulkanDevice* pDevice);
+	void								CreateDescriptorSetLayouts(VulkanDevice* pDevice);
+	void								CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer,
+														  const std::vector<VkBuffer>& vecDeferredBuffers);
+	void								CreatePipelines(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+
+private:
+	VkRenderPass						m_vkRenderPass;					// resolve, loads scene color
+	std::vector<VkFramebuffer>			m_vecFramebuffers;				// per frame in flight
+
+	VkImage								m_vkHDRImage;					// shared by all frames, rewritten every frame
+	VkDeviceMemory						m_vkHDRMemory;
+	VkImageView							m_vkHDRView;
+
+	VkSampler							m_vkSampler;
+	VkDescriptorSetLayout				m_vkLightingSetLayout;			// 0-4 G-Buffer, 5 - HDR, 6 - deferred uniforms, 7-9 IBL
+	VkDescriptorSetLayout				m_vkResolveSetLayout;			// 0 - HDR
+	VkDescriptorPool					m_vkDescriptorPool;
+	std::vector<VkDescriptorSet>		m_vecLightingSets;				// per frame in flight
+	VkDescriptorSet						m_vkResolveSet;
+
+	VulkanComputePipeline*				m_pLightingPipeline;
+	VulkanGraphicsPipeline*				m_pResolvePipeline;
+	VkDescriptorSetLayout				m_vkClusterSetLayout;			// not owned
+
+	VkExtent2D							m_vkExtent;						// swapchain & attachment size
+};
@@ -0,0 +1,513 @@
+#include "PlaygroundPCH.h"
+#include "UpscalePass.h"
+
+#include "VulkanDevice.h"
+#include "VulkanSwapChain.h"
+#include "VulkanGraphicsPipeline.h"
+#include "DeferredFrameBuffer.h"
+
+#include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Log.h"
+
+#include <cmath>
+
+//---------------------------------------------------------------------------------------------------------------------
+UpscalePass::UpscalePass()
+{
+	m_vkRenderPass = VK_NULL_HANDLE;
+	m_vecFramebuffers.clear();
+
+	m_vkEasuRenderPass = VK_NULL_HANDLE;
+	m_vecEasuFramebuffers.clear();
+
+	m_vecIntermediateImage.clear();
+	m_vecIntermediateImageView.clear();
+	m_vecIntermediateImageMemory.clear();
+
+	m_vkSampler = VK_NULL_HANDLE;
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+	m_vecDescriptorSets.clear();
+	m_vecRcasDescriptorSets.clear();
+
+	m_pPipeline = nullptr;
+	m_pEasuPipeline = nullptr;
+	m_pRcasPipeline = nullptr;
+
+	m_vkExtent = { 0, 0 };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+UpscalePass::~UpscalePass()
+{
+	SAFE_DELETE(m_pPipeline);
+	SAFE_DELETE(m_pEasuPipeline);
+	SAFE_DELETE(m_pRcasPipeline);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer)
+{
+	CreateSampler(pDevice);
+	CreateDescriptorSetLayout(pDevice);
+
+	HandleWindowResize(pDevice, pSwapchain, pFrameBuffer);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::CreateRenderPass(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	// Every pixel gets overwritten, no need to load or clear
+	VkAttachmentDescription colorAttachmentDesc = {};
+	colorAttachmentDesc.format			= pSwapchain->m_vkSwapchainImageFormat;
+	colorAttachmentDesc.samples			= VK_SAMPLE_COUNT_1_BIT;
+	colorAttachmentDesc.loadOp			= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachmentDesc.storeOp			= VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachmentDesc.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachmentDesc.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachmentDesc.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+	colorAttachmentDesc.finalLayout		= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;		// UI gets drawn last!
+
+	VkAttachmentReference colorAttachmentRef = {};
+	colorAttachmentRef.attachment		= 0;
+	colorAttachmentRef.layout			= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint			= VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount		= 1;
+	subpass.pColorAttachments			= &colorAttachmentRef;
+
+	// Swapchain image is acquired at color output stage, scene color reads are covered by main render pass dependency
+	std::array<VkSubpassDependency, 2> arrDependencies = {};
+	arrDependencies[0].srcSubpass		= VK_SUBPASS_EXTERNAL;
+	arrDependencies[0].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	arrDependencies[0].srcAccessMask	= 0;
+	arrDependencies[0].dstSubpass		= 0;
+	arrDependencies[0].dstStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	arrDependencies[0].dstAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	arrDependencies[1].srcSubpass		= 0;
+	arrDependencies[1].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	arrDependencies[1].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	arrDependencies[1].dstSubpass		= VK_SUBPASS_EXTERNAL;
+	arrDependencies[1].dstStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	arrDependencies[1].dstAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	VkRenderPassCreateInfo renderPassCreateInfo = {};
+	renderPassCreateInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCreateInfo.attachmentCount	= 1;
+	renderPassCreateInfo.pAttachments		= &colorAttachmentDesc;
+	renderPassCreateInfo.subpassCount		= 1;
+	renderPassCreateInfo.pSubpasses			= &subpass;
+	renderPassCreateInfo.dependencyCount	= static_cast<uint32_t>(arrDependencies.size());
+	renderPassCreateInfo.pDependencies		= arrDependencies.data();
+
+	if (vkCreateRenderPass(pDevice->m_vkLogicalDevice, &renderPassCreateInfo, nullptr, &m_vkRenderPass) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Upscale Render Pass");
+	}
+	else
+		LOG_DEBUG("Created Upscale Render Pass");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::CreateEasuRenderPass(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	// Every pixel gets overwritten, RCAS samples the result afterwards
+	VkAttachmentDescription colorAttachmentDesc = {};
+	colorAttachmentDesc.format			= pSwapchain->m_vkSwapchainImageFormat;
+	colorAttachmentDesc.samples			= VK_SAMPLE_COUNT_1_BIT;
+	colorAttachmentDesc.loadOp			= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachmentDesc.storeOp			= VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachmentDesc.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+	colorAttachmentDesc.stencilStoreOp	= VK_ATTACHMENT_STORE_OP_DONT_CARE;
+	colorAttachmentDesc.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;
+	colorAttachmentDesc.finalLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+	VkAttachmentReference colorAttachmentRef = {};
+	colorAttachmentRef.attachment		= 0;
+	colorAttachmentRef.layout			= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint			= VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount		= 1;
+	subpass.pColorAttachments			= &colorAttachmentRef;
+
+	// Previous RCAS reads of this intermediate must be done before overwriting it, then make writes visible to RCAS
+	std::array<VkSubpassDependency, 2> arrDependencies = {};
+	arrDependencies[0].srcSubpass		= VK_SUBPASS_EXTERNAL;
+	arrDependencies[0].srcStageMask		= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	arrDependencies[0].srcAccessMask	= 0;
+	arrDependencies[0].dstSubpass		= 0;
+	arrDependencies[0].dstStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	arrDependencies[0].dstAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+	arrDependencies[1].srcSubpass		= 0;
+	arrDependencies[1].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	arrDependencies[1].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	arrDependencies[1].dstSubpass		= VK_SUBPASS_EXTERNAL;
+	arrDependencies[1].dstStageMask		= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	arrDependencies[1].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+
+	VkRenderPassCreateInfo renderPassCreateInfo = {};
+	renderPassCreateInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+	renderPassCreateInfo.attachmentCount	= 1;
+	renderPassCreateInfo.pAttachments		= &colorAttachmentDesc;
+	renderPassCreateInfo.subpassCount		= 1;
+	renderPassCreateInfo.pSubpasses			= &subpass;
+	renderPassCreateInfo.dependencyCount	= static_cast<uint32_t>(arrDependencies.size());
+	renderPassCreateInfo.pDependencies		= arrDependencies.data();
+
+	if (vkCreateRenderPass(pDevice->m_vkLogicalDevice, &renderPassCreateInfo, nullptr, &m_vkEasuRenderPass) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create EASU Render Pass");
+	}
+	else
+		LOG_DEBUG("Created EASU Render Pass");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::CreateIntermediateImages(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	// Same format as scene color & swapchain, so FSR1 output matches bilinear path exactly apart from filtering
+	uint32_t nFrames = pSwapchain->m_uiFramesInFlight;
+
+	m_vecIntermediateImage.resize(nFrames);
+	m_vecIntermediateImageView.resize(nFrames);
+	m_vecIntermediateImageMemory.resize(nFrames);
+
+	for (uint32_t i = 0; i < nFrames; ++i)
+	{
+		m_vecIntermediateImage[i] = Helper::Vulkan::CreateImage(pDevice, m_vkExtent.width, m_vkExtent.height, pSwapchain->m_vkSwapchainImageFormat,
+																VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+																VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vecIntermediateImageMemory[i]);
+
+		m_vecIntermediateImageView[i] = Helper::Vulkan::CreateImageView(pDevice, m_vecIntermediateImage[i], pSwapchain->m_vkSwapchainImageFormat, 
+																		VK_IMAGE_ASPECT_COLOR_BIT);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::CreateFramebuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	m_vecFramebuffers.resize(pSwapchain->m_vecSwapchainImages.size());
+
+	for (uint32_t i = 0; i < m_vecFramebuffers.size(); ++i)
+	{
+		VkFramebufferCreateInfo framebufferCreateInfo = {};
+		framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.renderPass = m_vkRenderPass;
+		framebufferCreateInfo.attachmentCount = 1;
+		framebufferCreateInfo.pAttachments = &pSwapchain->m_vecSwapchainImageViews[i];
+		framebufferCreateInfo.width = m_vkExtent.width;
+		framebufferCreateInfo.height = m_vkExtent.height;
+		framebufferCreateInfo.layers = 1;
+
+		if (vkCreateFramebuffer(pDevice->m_vkLogicalDevice, &framebufferCreateInfo, nullptr, &m_vecFramebuffers[i]) != VK_SUCCESS)
+		{
+			LOG_ERROR("Failed to create Upscale Framebuffer");
+		}
+	}
+
+	m_vecEasuFramebuffers.resize(pSwapchain->m_uiFramesInFlight);
+
+	for (uint32_t i = 0; i < m_vecEasuFramebuffers.size(); ++i)
+	{
+		VkFramebufferCreateInfo framebufferCreateInfo = {};
+		framebufferCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferCreateInfo.renderPass = m_vkEasuRenderPass;
+		framebufferCreateInfo.attachmentCount = 1;
+		framebufferCreateInfo.pAttachments = &m_vecIntermediateImageView[i];
+		framebufferCreateInfo.width = m_vkExtent.width;
+		framebufferCreateInfo.height = m_vkExtent.height;
+		framebufferCreateInfo.layers = 1;
+
+		if (vkCreateFramebuffer(pDevice->m_vkLogicalDevice, &framebufferCreateInfo, nullptr, &m_vecEasuFramebuffers[i]) != VK_SUCCESS)
+		{
+			LOG_ERROR("Failed to create EASU Framebuffer");
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::CreateSampler(VulkanDevice* pDevice)
+{
+	// Bilinear, clamped so edge taps never wrap around. FSR1 shaders use texelFetch & ignore filtering
+	VkSamplerCreateInfo samplerCreateInfo = {};
+	samplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+	samplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+	samplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+	samplerCreateInfo.unnormalizedCoordinates = VK_FALSE;
+	samplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCreateInfo.mipLodBias = 0.0f;
+	samplerCreateInfo.minLod = 0.0f;
+	samplerCreateInfo.maxLod = 0.0f;
+	samplerCreateInfo.anisotropyEnable = VK_FALSE;
+	samplerCreateInfo.maxAnisotropy = 1.0f;
+
+	if (vkCreateSampler(pDevice->m_vkLogicalDevice, &samplerCreateInfo, nullptr, &m_vkSampler) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Upscale Sampler");
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::CreateDescriptorSetLayout(VulkanDevice* pDevice)
+{
+	// 0 = scene color, or intermediate for RCAS
+	VkDescriptorSetLayoutBinding binding = {};
+	binding.binding = 0;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	binding.descriptorCount = 1;
+	binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	binding.pImmutableSamplers = nullptr;
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = 1;
+	layoutCreateInfo.pBindings = &binding;
+
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &m_vkDescriptorSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Upscale Descriptor Set Layout");
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer)
+{
+	uint32_t nFrames = pSwapchain->m_uiFramesInFlight;
+
+	//--- Pool
+	VkDescriptorPoolSize poolSize = {};
+	poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	poolSize.descriptorCount = 2 * nFrames;
+
+	VkDescriptorPoolCreateInfo poolCreateInfo = {};
+	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolCreateInfo.maxSets = 2 * nFrames;
+	poolCreateInfo.poolSizeCount = 1;
+	poolCreateInfo.pPoolSizes = &poolSize;
+
+	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vkDescriptorPool) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Upscale Descriptor Pool");
+	}
+
+	//--- Sets
+	m_vecDescriptorSets.resize(nFrames);
+	m_vecRcasDescriptorSets.resize(nFrames);
+	std::vector<VkDescriptorSetLayout> vecLayouts(nFrames, m_vkDescriptorSetLayout);
+
+	VkDescriptorSetAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = m_vkDescriptorPool;
+	allocInfo.descriptorSetCount = nFrames;
+	allocInfo.pSetLayouts = vecLayouts.data();
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, m_vecDescriptorSets.data()) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate Upscale Descriptor Sets");
+	}
+
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &allocInfo, m_vecRcasDescriptorSets.data()) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to allocate RCAS Descriptor Sets");
+	}
+
+	for (uint32_t i = 0; i < nFrames; ++i)
+	{
+		std::array<VkDescriptorImageInfo, 2> arrImageInfos = {};
+		arrImageInfos[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrImageInfos[0].imageView = pFrameBuffer->m_pSceneColorAttachment->vecAttachmentImageView[i];
+		arrImageInfos[0].sampler = m_vkSampler;
+
+		arrImageInfos[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrImageInfos[1].imageView = m_vecIntermediateImageView[i];
+		arrImageInfos[1].sampler = m_vkSampler;
+
+		std::array<VkWriteDescriptorSet, 2> arrWrites = {};
+		for (uint32_t j = 0; j < arrWrites.size(); ++j)
+		{
+			arrWrites[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			arrWrites[j].dstSet = (j == 0) ? m_vecDescriptorSets[i] : m_vecRcasDescriptorSets[i];
+			arrWrites[j].dstBinding = 0;
+			arrWrites[j].dstArrayElement = 0;
+			arrWrites[j].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+			arrWrites[j].descriptorCount = 1;
+			arrWrites[j].pImageInfo = &arrImageInfos[j];
+		}
+
+		vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, static_cast<uint32_t>(arrWrites.size()), arrWrites.data(), 0, nullptr);
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::CreatePipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	VkPushConstantRange pushConstantRange = {};
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	pushConstantRange.offset = 0;
+	pushConstantRange.size = sizeof(UpscalePushData);
+
+	m_pPipeline = new VulkanGraphicsPipeline(PipelineType::UPSCALE, pSwapchain);
+	m_pPipeline->CreatePipelineLayout(pDevice, { m_vkDescriptorSetLayout }, { pushConstantRange });
+	m_pPipeline->CreateGraphicsPipeline(pDevice, pSwapchain, m_vkRenderPass, 0, 1);
+
+	m_pEasuPipeline = new VulkanGraphicsPipeline(PipelineType::UPSCALE_EASU, pSwapchain);
+	m_pEasuPipeline->CreatePipelineLayout(pDevice, { m_vkDescriptorSetLayout }, { pushConstantRange });
+	m_pEasuPipeline->CreateGraphicsPipeline(pDevice, pSwapchain, m_vkEasuRenderPass, 0, 1);
+
+	m_pRcasPipeline = new VulkanGraphicsPipeline(PipelineType::UPSCALE_RCAS, pSwapchain);
+	m_pRcasPipeline->CreatePipelineLayout(pDevice, { m_vkDescriptorSetLayout }, { pushConstantRange });
+	m_pRcasPipeline->CreateGraphicsPipeline(pDevice, pSwapchain, m_vkRenderPass, 0, 1);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::RecordUpscale(VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t imageIndex, const VkExtent2D& renderExtent,
+							    UpscaleMode eMode, float fSharpness)
+{
+	// Bilinear taps at the subrect border would pull in stale pixels from outside render extent, clamp to last texel center.
+	// EASU fetches texels directly, so it clamps to last texel of render extent instead
+	UpscalePushData pushData;
+	pushData.uvScaleMax = glm::vec4(static_cast<float>(renderExtent.width) / m_vkExtent.width,
+									static_cast<float>(renderExtent.height) / m_vkExtent.height,
+									(renderExtent.width - 0.5f) / m_vkExtent.width,
+									(renderExtent.height - 0.5f) / m_vkExtent.height);
+
+	pushData.easuScale = glm::vec4(	static_cast<float>(renderExtent.width) / m_vkExtent.width,
+									static_cast<float>(renderExtent.height) / m_vkExtent.height,
+									static_cast<float>(renderExtent.width - 1),
+									static_cast<float>(renderExtent.height - 1));
+
+	pushData.rcasParams = glm::vec4(std::exp2(-fSharpness), 0.0f, 0.0f, 0.0f);
+
+	VkRenderPassBeginInfo renderPassBeginInfo = {};
+	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+	renderPassBeginInfo.renderArea.offset = { 0, 0 };
+	renderPassBeginInfo.renderArea.extent = m_vkExtent;
+	renderPassBeginInfo.clearValueCount = 0;
+	renderPassBeginInfo.pClearValues = nullptr;
+
+	VulkanGraphicsPipeline* pFinalPipeline = m_pPipeline;
+	VkDescriptorSet vkFinalDescriptorSet = m_vecDescriptorSets[frameIndex];
+
+	//--- EASU, scene color subrect -> intermediate
+	if (eMode == UpscaleMode::FSR1)
+	{
+		renderPassBeginInfo.renderPass = m_vkEasuRenderPass;
+		renderPassBeginInfo.framebuffer = m_vecEasuFramebuffers[frameIndex];
+
+		vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+		Helper::Vulkan::SetViewportScissor(cmdBuffer, m_vkExtent);
+
+		vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pEasuPipeline->m_vkGraphicsPipeline);
+		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pEasuPipeline->m_vkPipelineLayout, 0, 1, &m_vecDescriptorSets[frameIndex], 0, nullptr);
+		vkCmdPushConstants(cmdBuffer, m_pEasuPipeline->m_vkPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(UpscalePushData), &pushData);
+
+		vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
+
+		vkCmdEndRenderPass(cmdBuffer);
+
+		pFinalPipeline = m_pRcasPipeline;
+		vkFinalDescriptorSet = m_vecRcasDescriptorSets[frameIndex];
+	}
+
+	//--- Bilinear or RCAS -> swapchain image
+	renderPassBeginInfo.renderPass = m_vkRenderPass;
+	renderPassBeginInfo.framebuffer = m_vecFramebuffers[imageIndex];
+
+	vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+	Helper::Vulkan::SetViewportScissor(cmdBuffer, m_vkExtent);
+
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pFinalPipeline->m_vkGraphicsPipeline);
+	vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pFinalPipeline->m_vkPipelineLayout, 0, 1, &vkFinalDescriptorSet, 0, nullptr);
+	vkCmdPushConstants(cmdBuffer, pFinalPipeline->m_vkPipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(UpscalePushData), &pushData);
+
+	vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
+
+	vkCmdEndRenderPass(cmdBuffer);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer)
+{
+	m_vkExtent = pSwapchain->m_vkSwapchainExtent;
+
+	CreateRenderPass(pDevice, pSwapchain);
+	CreateEasuRenderPass(pDevice, pSwapchain);
+	CreateIntermediateImages(pDevice, pSwapchain);
+	CreateFramebuffers(pDevice, pSwapchain);
+	CreateDescriptors(pDevice, pSwapchain, pFrameBuffer);
+	CreatePipeline(pDevice, pSwapchain);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Everything tied to swapchain images or format, sampler & set layout survive resize!
+void UpscalePass::CleanupOnWindowResize(VulkanDevice* pDevice)
+{
+	if (m_pPipeline)
+		m_pPipeline->CleanupOnWindowResize(pDevice);
+
+	if (m_pEasuPipeline)
+		m_pEasuPipeline->CleanupOnWindowResize(pDevice);
+
+	if (m_pRcasPipeline)
+		m_pRcasPipeline->CleanupOnWindowResize(pDevice);
+
+	SAFE_DELETE(m_pPipeline);
+	SAFE_DELETE(m_pEasuPipeline);
+	SAFE_DELETE(m_pRcasPipeline);
+
+	for (VkFramebuffer vkFramebuffer : m_vecFramebuffers)
+	{
+		vkDestroyFramebuffer(pDevice->m_vkLogicalDevice, vkFramebuffer, nullptr);
+	}
+	m_vecFramebuffers.clear();
+
+	for (VkFramebuffer vkFramebuffer : m_vecEasuFramebuffers)
+	{
+		vkDestroyFramebuffer(pDevice->m_vkLogicalDevice, vkFramebuffer, nullptr);
+	}
+	m_vecEasuFramebuffers.clear();
+
+	for (uint32_t i = 0; i < m_vecIntermediateImage.size(); ++i)
+	{
+		vkDestroyImageView(pDevice->m_vkLogicalDevice, m_vecIntermediateImageView[i], nullptr);
+		vkDestroyImage(pDevice->m_vkLogicalDevice, m_vecIntermediateImage[i], nullptr);
+		vkFreeMemory(pDevice->m_vkLogicalDevice, m_vecIntermediateImageMemory[i], nullptr);
+	}
+	m_vecIntermediateImage.clear();
+	m_vecIntermediateImageView.clear();
+	m_vecIntermediateImageMemory.clear();
+
+	vkDestroyRenderPass(pDevice->m_vkLogicalDevice, m_vkRenderPass, nullptr);
+	m_vkRenderPass = VK_NULL_HANDLE;
+
+	vkDestroyRenderPass(pDevice->m_vkLogicalDevice, m_vkEasuRenderPass, nullptr);
+	m_vkEasuRenderPass = VK_NULL_HANDLE;
+
+	// sets are freed along with the pool
+	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, m_vkDescriptorPool, nullptr);
+	m_vkDescriptorPool = VK_NULL_HANDLE;
+	m_vecDescriptorSets.clear();
+	m_vecRcasDescriptorSets.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void UpscalePass::Cleanup(VulkanDevice* pDevice)
+{
+	CleanupOnWindowResize(pDevice);
+
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, m_vkDescriptorSetLayout, nullptr);
+	m_vkDescriptorSetLayout = VK_NULL_HANDLE;
+
+	vkDestroySampler(pDevice->m_vkLogicalDevice, m_vkSampler, nullptr);
+	m_vkSampler = VK_NULL_HANDLE;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+#include "glm/glm.hpp"
+
+class VulkanDevice;
+class VulkanSwapChain;
+class VulkanGraphicsPipeline;
+class DeferredFrameBuffer;
+
+//---------------------------------------------------------------------------------------------------------------------
+// Values match UI combo order
+enum class UpscaleMode
+{
+	BILINEAR = 0,
+	FSR1										// EASU upscale + RCAS sharpen
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+namespace UpscaleConfig
+{
+	// Native & FSR1 quality modes, output / render ratio 1.0, 1.3, 1.5, 1.7, 2.0
+	constexpr uint32_t					NUM_RENDER_SCALE_PRESETS = 5;
+	constexpr float						RENDER_SCALE_PRESETS[NUM_RENDER_SCALE_PRESETS] = { 1.0f, 1.0f / 1.3f, 1.0f / 1.5f, 1.0f / 1.7f, 0.5f };
+	constexpr const char*				RENDER_SCALE_PRESET_NAMES[NUM_RENDER_SCALE_PRESETS] = { "Native", "Ultra Quality", "Quality", "Balanced", "Performance" };
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Must match push constant block in Upscale.frag, FsrEasu.frag & FsrRcas.frag
+struct UpscalePushData
+{
+	UpscalePushData()
+	{
+		uvScaleMax = glm::vec4(1);
+		easuScale = glm::vec4(1);
+		rcasParams = glm::vec4(1);
+	}
+
+	alignas(16) glm::vec4				uvScaleMax;			// xy - render extent / scene color size, zw - max uv keeping taps inside render rect
+	alignas(16) glm::vec4				easuScale;			// xy - render extent / output extent, zw - last valid texel of render extent
+	alignas(16) glm::vec4				rcasParams;			// x - sharpness as linear scale, exp2(-stops)
+};
+
+//---------------------------------------------------------------------------------------------------------------------
+// Scene is rendered into the top left render extent subrect of the scene color attachment. This pass stretches that
+// subrect over the whole swapchain image, ImGui pass then draws on top of the result!
+// BILINEAR : single full screen draw straight into swapchain image.
+// FSR1     : EASU upscales into a full size intermediate, RCAS sharpens that into swapchain image. Sharpening needs
+//            neighbours of the upscaled image so it can't be a subpass, hence two render passes.
+class UpscalePass
+{
+public:
+	UpscalePass();
+	~UpscalePass();
+
+	void								Initialize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer);
+
+	// After main render pass, scene color must already be in SHADER_READ_ONLY_OPTIMAL. Sharpness in stops, 0 = max.
+	// Scene color & intermediate belong to the frame in flight, only the final target is the acquired swapchain image
+	void								RecordUpscale(VkCommandBuffer cmdBuffer, uint32_t frameIndex, uint32_t imageIndex, 
+													const VkExtent2D& renderExtent, UpscaleMode eMode, float fSharpness);
+
+	void								Cleanup(VulkanDevice* pDevice);
+	void								CleanupOnWindowResize(VulkanDevice* pDevice);
+	void								HandleWindowResize(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer);
+
+private:
+	void								CreateRenderPass(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								CreateEasuRenderPass(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								CreateIntermediateImages(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								CreateFramebuffers(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void								CreateSampler(VulkanDevice* pDevice);
+	void								CreateDescriptorSetLayout(VulkanDevice* pDevice);
+	void								CreateDescriptors(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, DeferredFrameBuffer* pFrameBuffer);
+	void								CreatePipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+
+private:
+	VkRenderPass						m_vkRenderPass;					// into swapchain image, bilinear or RCAS
+	std::vector<VkFramebuffer>			m_vecFramebuffers;				// per swapchain image
+
+	VkRenderPass						m_vkEasuRenderPass;				// into intermediate
+	std::vector<VkFramebuffer>			m_vecEasuFramebuffers;			// per frame in flight
+
+	std::vector<VkImage>				m_vecIntermediateImage;			// per frame in flight, EASU output at swapchain size
+	std::vector<VkImageView>			m_vecIntermediateImageView;
+	std::vector<VkDeviceMemory>			m_vecIntermediateImageMemory;
+
+	VkSampler							m_vkSampler;
+	VkDescriptorPool					m_vkDescriptorPool;
+	VkDescriptorSetLayout				m_vkDescriptorSetLayout;
+	std::vector<VkDescriptorSet>		m_vecDescriptorSets;			// per frame in flight, scene color
+	std::vector<VkDescriptorSet>		m_vecRcasDescriptorSets;		// per frame in flight, intermediate
+
+	VulkanGraphicsPipeline*				m_pPipeline;
+	VulkanGraphicsPipeline*				m_pEasuPipeline;
+	VulkanGraphicsPipeline*				m_pRcasPipeline;
+
+	VkExtent2D							m_vkExtent;						// swapchain & scene color size
+};
@@ -0,0 +1,105 @@
+#include "PlaygroundPCH.h"
+#include "VulkanComputePipeline.h"
+
+#include "VulkanDevice.h"
+
+#include "Engine/Helpers/Utility.h"
+#include "Engine/Helpers/Log.h"
+
+//---------------------------------------------------------------------------------------------------------------------
+VulkanComputePipeline::VulkanComputePipeline(const std::string& strComputeShader)
+{
+	m_vkPipelineLayout = VK_NULL_HANDLE;
+	m_vkComputePipeline = VK_NULL_HANDLE;
+
+	m_strComputeShader = strComputeShader;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+VulkanComputePipeline::~VulkanComputePipeline()
+{
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void VulkanComputePipeline::CreatePipelineLayout(VulkanDevice* pDevice, const std::vector<VkDescriptorSetLayout>& layouts,
+													const std::vector<VkPushConstantRange> pushConstantRanges)
+{
+	VkPipelineLayoutCreateInfo pipelineLayoutCreateInfo{};
+	pipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(layouts.size());
+	pipelineLayoutCreateInfo.pSetLayouts = layouts.data();
+	pipelineLayoutCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(pushConstantRanges.size());
+	pipelineLayoutCreateInfo.pPushConstantRanges = pushConstantRanges.data();
+
+	if (vkCreatePipelineLayout(pDevice->m_vkLogicalDevice, &pipelineLayoutCreateInfo, nullptr, &m_vkPipelineLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Compute Pipeline layout!");
+	}
+	else
+		LOG_INFO("Created Compute Pipeline layout");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+VkShaderModule VulkanComputePipeline::CreateShaderModule(VulkanDevice* pDevice, const std::string& fileName)
+{
+	std::ifstream file(fileName, std::ios::ate | std::ios::binary);
+
+	if (!file.is_open())
+		LOG_ERROR("Failed to open Shader file {0}!", fileName);
+
+	size_t fileSize = (size_t)file.tellg();
+	std::vector<char> buffer(fileSize);
+
+	file.seekg(0);
+	file.read(buffer.data(), fileSize);
+	file.close();
+
+	VkShaderModuleCreateInfo shaderModuleInfo;
+	shaderModuleInfo.codeSize = buffer.size();
+	shaderModuleInfo.flags = 0;
+	shaderModuleInfo.pCode = reinterpret_cast<const uint32_t*>(buffer.data());
+	shaderModuleInfo.pNext = nullptr;
+	shaderModuleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+
+	VkShaderModule shaderModule;
+	if (vkCreateShaderModule(pDevice->m_vkLogicalDevice, &shaderModuleInfo, nullptr, &shaderModule) != VK_SUCCESS)
+		LOG_ERROR("Failed to create shader module!");
+
+	return shaderModule;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void VulkanComputePipeline::CreateComputePipeline(VulkanDevice* pDevice, const VkSpecializationInfo* pSpecializationInfo)
+{
+	VkShaderModule compShaderModule = CreateShaderModule(pDevice, m_strComputeShader);
+
+	VkPipelineShaderStageCreateInfo shaderStageInfo = {};
+	shaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	shaderStageInfo.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	shaderStageInfo.module = compShaderModule;
+	shaderStageInfo.pName = "main";
+	shaderStageInfo.pSpecializationInfo = pSpecializationInfo;
+
+	VkComputePipelineCreateInfo pipelineCreateInfo = {};
+	pipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineCreateInfo.stage = shaderStageInfo;
+	pipelineCreateInfo.layout = m_vkPipelineLayout;
+	pipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+	pipelineCreateInfo.basePipelineIndex = -1;
+
+	if (vkCreateComputePipelines(pDevice->m_vkLogicalDevice, VK_NULL_HANDLE, 1, &pipelineCreateInfo, nullptr, &m_vkComputePipeline) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Compute Pipeline {0}!", m_strComputeShader);
+	}
+	else
+		LOG_INFO("Created Compute Pipeline {0}", m_strComputeShader);
+
+	vkDestroyShaderModule(pDevice->m_vkLogicalDevice, compShaderModule, nullptr);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void VulkanComputePipeline::Cleanup(VulkanDevice* pDevice)
+{
+	vkDestroyPipeline(pDevice->m_vkLogicalDevice, m_vkComputePipeline, nullptr);
+	vkDestroyPipelineLayout(pDevice->m_vkLogicalDevice, m_vkPipelineLayout, nullptr);
+}
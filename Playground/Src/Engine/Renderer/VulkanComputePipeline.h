@@ -0,0 +1,29 @@
+#pragma once
+
+#include "vulkan/vulkan.h"
+
+class VulkanDevice;
+
+class VulkanComputePipeline
+{
+public:
+	VulkanComputePipeline(const std::string& strComputeShader);
+	~VulkanComputePipeline();
+
+	void												CreatePipelineLayout(VulkanDevice* pDevice, const std::vector<VkDescriptorSetLayout>& layouts,
+																			const std::vector<VkPushConstantRange> pushConstantRanges);
+
+	void												CreateComputePipeline(VulkanDevice* pDevice, const VkSpecializationInfo* pSpecializationInfo = nullptr);
+
+	void												Cleanup(VulkanDevice* pDevice);
+
+public:
+	VkPipeline											m_vkComputePipeline;
+	VkPipelineLayout									m_vkPipelineLayout;
+
+private:
+	VkShaderModule										CreateShaderModule(VulkanDevice* pDevice, const std::string& fileName);
+
+private:
+	std::string											m_strComputeShader;
+};
@@ -25,6 +25,10 @@ VulkanDevice::VulkanDevice(VkInstance instance, VkSurfaceKHR surface)
 	m_vkLogicalDevice = nullptr;
 	m_vkCommandPoolGraphics = nullptr;
 	m_pQueueFamilyIndices = nullptr;
+
+	m_bSupportsIndirectCount = false;
+	m_bSupportsPipelineStatistics = false;
+	m_bSupportsDescriptorIndexing = false;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -191,10 +195,52 @@ void VulkanDevice::CreateLogicalDevice()
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
+	// Query optional features...
+	VkPhysicalDeviceVulkan12Features features12Available{};
+	features12Available.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+	VkPhysicalDeviceFeatures2 featuresAvailable{};
+	featuresAvailable.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	featuresAvailable.pNext = &features12Available;
+	vkGetPhysicalDeviceFeatures2(m_vkPhysicalDevice, &featuresAvailable);
+
+	m_vkDeviceFeaturesAvailable = featuresAvailable.features;
+	m_bSupportsIndirectCount = featuresAvailable.features.multiDrawIndirect
+							   && featuresAvailable.features.drawIndirectFirstInstance
+							   && features12Available.drawIndirectCount;
+	m_bSupportsPipelineStatistics = featuresAvailable.features.pipelineStatisticsQuery;
+	m_bSupportsDescriptorIndexing = features12Available.descriptorIndexing
+									&& features12Available.runtimeDescriptorArray
+									&& features12Available.descriptorBindingPartiallyBound
+									&& features12Available.descriptorBindingSampledImageUpdateAfterBind
+									&& features12Available.descriptorBindingStorageBufferUpdateAfterBind
+									&& features12Available.shaderSampledImageArrayNonUniformIndexing;
+
 	// Specify used device features...
 	VkPhysicalDeviceFeatures deviceFeatures{};
 	deviceFeatures.samplerAnisotropy = VK_TRUE;		// Enabling anisotropy!
 	deviceFeatures.fillModeNonSolid = VK_TRUE;
+	deviceFeatures.multiDrawIndirect = m_bSupportsIndirectCount ? VK_TRUE : VK_FALSE;
+	deviceFeatures.drawIndirectFirstInstance = m_bSupportsIndirectCount ? VK_TRUE : VK_FALSE;
+	deviceFeatures.pipelineStatisticsQuery = m_bSupportsPipelineStatistics ? VK_TRUE : VK_FALSE;
+
+	VkPhysicalDeviceVulkan12Features features12{};
+	features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.drawIndirectCount = m_bSupportsIndirectCount ? VK_TRUE : VK_FALSE;
+
+	VkBool32 bDescriptorIndexing = m_bSupportsDescriptorIndexing ? VK_TRUE : VK_FALSE;
+	features12.descriptorIndexing = bDescriptorIndexing;
+	features12.runtimeDescriptorArray = bDescriptorIndexing;
+	features12.descriptorBindingPartiallyBound = bDescriptorIndexing;
+	features12.descriptorBindingSampledImageUpdateAfterBind = bDescriptorIndexing;
+	features12.descriptorBindingStorageBufferUpdateAfterBind = bDescriptorIndexing;
+	features12.shaderSampledImageArrayNonUniformIndexing = bDescriptorIndexing;
+
+	m_vkDeviceFeaturesEnabled = deviceFeatures;
+
+	LOG_DEBUG("Indirect count draws supported: {0}", m_bSupportsIndirectCount);
+	LOG_DEBUG("Pipeline statistics queries supported: {0}", m_bSupportsPipelineStatistics);
+	LOG_DEBUG("Descriptor indexing supported: {0}", m_bSupportsDescriptorIndexing);
 
 	// Create logical device...
 	VkDeviceCreateInfo createInfo{};
@@ -206,6 +252,7 @@ void VulkanDevice::CreateLogicalDevice()
 	createInfo.ppEnabledExtensionNames = Helper::Vulkan::g_strDeviceExtensions.data();
 
 	createInfo.pEnabledFeatures = &deviceFeatures;
+	createInfo.pNext = &features12;
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 
 	if (Helper::Vulkan::g_bEnableValidationLayer)
@@ -271,6 +318,14 @@ void VulkanDevice::CreateGraphicsCommandBuffers(uint32_t size)
 	}
 	else
 		LOG_INFO("Created Graphics Command buffers!");
+
+	// Work that touches the swapchain image can't be cached, acquired image changes from frame to frame
+	m_vecCommandBufferPresent.resize(size);
+
+	if (vkAllocateCommandBuffers(m_vkLogicalDevice, &commandBufferAllocInfo, m_vecCommandBufferPresent.data()) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Present Command buffer!");
+	}
 }
 
 /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -398,6 +453,7 @@ void VulkanDevice::Cleanup()
 {
 	// clean-up existing command buffer & reuse existing pool to allocate new command buffers instead of recreating it!
 	vkFreeCommandBuffers(m_vkLogicalDevice, m_vkCommandPoolGraphics, static_cast<uint32_t>(m_vecCommandBufferGraphics.size()), m_vecCommandBufferGraphics.data());
+	vkFreeCommandBuffers(m_vkLogicalDevice, m_vkCommandPoolGraphics, static_cast<uint32_t>(m_vecCommandBufferPresent.size()), m_vecCommandBufferPresent.data());
 
 	// Destroy command pool
 	vkDestroyCommandPool(m_vkLogicalDevice, m_vkCommandPoolGraphics, nullptr);
@@ -410,4 +466,5 @@ void VulkanDevice::CleanupOnWindowResize()
 {
 	// clean-up existing command buffer & reuse existing pool to allocate new command buffers instead of recreating it!
 	vkFreeCommandBuffers(m_vkLogicalDevice, m_vkCommandPoolGraphics, static_cast<uint32_t>(m_vecCommandBufferGraphics.size()), m_vecCommandBufferGraphics.data());
+	vkFreeCommandBuffers(m_vkLogicalDevice, m_vkCommandPoolGraphics, static_cast<uint32_t>(m_vecCommandBufferPresent.size()), m_vecCommandBufferPresent.data());
 }
@@ -70,10 +70,16 @@ public:
 	QueueFamilyIndices*					m_pQueueFamilyIndices;
 
 	VkCommandPool						m_vkCommandPoolGraphics;
-	std::vector<VkCommandBuffer>		m_vecCommandBufferGraphics;
+	std::vector<VkCommandBuffer>		m_vecCommandBufferGraphics;			// per frame in flight, recorded when dirty
+	std::vector<VkCommandBuffer>		m_vecCommandBufferPresent;			// per frame in flight, re-recorded every frame for acquired image
 
 	VkQueue								m_vkQueueGraphics;
 	VkQueue								m_vkQueuePresent;
+
+	// Optional features, enabled only when physical device has them!
+	bool								m_bSupportsIndirectCount;			// multiDrawIndirect + drawIndirectFirstInstance + drawIndirectCount (GPU driven path)
+	bool								m_bSupportsPipelineStatistics;		// pipelineStatisticsQuery (fragment invocation counters)
+	bool								m_bSupportsDescriptorIndexing;		// runtime sized, partially bound texture arrays (bindless materials)
 };
 
 
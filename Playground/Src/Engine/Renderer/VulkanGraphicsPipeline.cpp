@@ -23,6 +23,16 @@ VulkanGraphicsPipeline::VulkanGraphicsPipeline(PipelineType type, VulkanSwapChai
 
 	m_eType = type;
 
+	m_pDevice = nullptr;
+	m_vkRenderPass = VK_NULL_HANDLE;
+	m_uiSubPass = 0;
+	m_nOutputAttachments = 0;
+	m_mapPermutations.clear();
+
+	// Only shaders that declare specialization constant 0
+	m_bPermutations = (type == PipelineType::GBUFFER_OPAQUE || type == PipelineType::GBUFFER_OPAQUE_INSTANCED ||
+					   type == PipelineType::GBUFFER_OPAQUE_DEPTH_EQUAL || type == PipelineType::DEFERRED);
+
 	//--- Input assembly 
 	m_vkInputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 	m_vkInputAssemblyInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;						// primitive type to single list
@@ -153,30 +163,72 @@ VkShaderModule VulkanGraphicsPipeline::CreateShaderModule(VulkanDevice* pDevice,
 
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapChain, 
-													VkRenderPass renderPass, uint32_t subPass, uint32_t nOutputAttachments)
+													VkRenderPass renderPass, uint32_t subPass, uint32_t nOutputAttachments,
+													uint32_t uiPermutation)
 {
+	m_pDevice = pDevice;
+	m_vkRenderPass = renderPass;
+	m_uiSubPass = subPass;
+	m_nOutputAttachments = nOutputAttachments;
+
+	m_vkGraphicsPipeline = GetPermutation(uiPermutation);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+VkPipeline VulkanGraphicsPipeline::GetPermutation(uint32_t uiPermutation)
+{
+	std::lock_guard<std::mutex> lock(m_mutexPermutations);
+
+	std::map<uint32_t, VkPipeline>::iterator iter = m_mapPermutations.find(uiPermutation);
+	if (iter != m_mapPermutations.end())
+		return iter->second;
+
+	VkPipeline vkPipeline = CreatePermutation(uiPermutation);
+	m_mapPermutations[uiPermutation] = vkPipeline;
+
+	return vkPipeline;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Builds full pipeline state from scratch, vertex input descriptions live on the stack of this call!
+VkPipeline VulkanGraphicsPipeline::CreatePermutation(uint32_t uiPermutation)
+{
+	VulkanDevice* pDevice = m_pDevice;
+	uint32_t nOutputAttachments = m_nOutputAttachments;
+
 	VkShaderModule vertShaderModule = VK_NULL_HANDLE;
 	VkShaderModule fragShaderModule = VK_NULL_HANDLE;
 
 	switch (m_eType)
 	{
 		case PipelineType::GBUFFER_OPAQUE:
+		case PipelineType::GBUFFER_OPAQUE_INSTANCED:
+		case PipelineType::GBUFFER_OPAQUE_DEPTH_EQUAL:
 			{
-				m_strVertexShader = "Shaders/GBuffer.vert.spv";
+				bool bInstanced = (m_eType == PipelineType::GBUFFER_OPAQUE_INSTANCED);
+				bool bDepthEqual = (m_eType == PipelineType::GBUFFER_OPAQUE_DEPTH_EQUAL);
+
+				m_strVertexShader = bInstanced ? "Shaders/GBufferInstanced.vert.spv" : "Shaders/GBuffer.vert.spv";
 				m_strFragmentShader = "Shaders/GBuffer.frag.spv";
 
 				vertShaderModule = CreateShaderModule(pDevice, m_strVertexShader);
 				fragShaderModule = CreateShaderModule(pDevice, m_strFragmentShader);
 
 				//--- How the data for the single vertex (including info such as Position, color, texcoords etc.) is as a whole
-				VkVertexInputBindingDescription bindingDescription = {};
-				bindingDescription.binding = 0; // can bind multiple stream of data, this defines which one?
-				bindingDescription.stride = sizeof(Helper::App::VertexPNTBT); // size of single vertex object
-				bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+				std::array<VkVertexInputBindingDescription, 2> bindingDescriptions = {};
+				bindingDescriptions[0].binding = 0; // can bind multiple stream of data, this defines which one?
+				bindingDescriptions[0].stride = sizeof(Helper::App::VertexPNTBT); // size of single vertex object
+				bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 				// How to move between data after each vertex
 				// VK_VERTEX_INPUT_RATE_VERTEX : move on to the next vertex																							// VK_VERTEX_INPUT_RATE_INSTANCE: move on to a vertex of next instance.
+
+				// Instanced: second stream holds one transform per instance
+				bindingDescriptions[1].binding = 1;
+				bindingDescriptions[1].stride = sizeof(glm::mat4);
+				bindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
 				// How the data for an attribute is defined within a vertex
-				std::array<VkVertexInputAttributeDescription, 5> attributeDescriptions;
+				std::array<VkVertexInputAttributeDescription, 9> attributeDescriptions;
 
 				// Position attribute
 				attributeDescriptions[0].binding = 0; // which binding the data is at (should be same as above)
@@ -210,13 +262,22 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 				attributeDescriptions[4].format = VkFormat::VK_FORMAT_R32G32_SFLOAT;
 				attributeDescriptions[4].offset = offsetof(Helper::App::VertexPNTBT, UV);
 
+				// Instance transform, one vec4 column per location
+				for (uint32_t i = 0; i < 4; ++i)
+				{
+					attributeDescriptions[5 + i].binding = 1;
+					attributeDescriptions[5 + i].location = 5 + i;
+					attributeDescriptions[5 + i].format = VkFormat::VK_FORMAT_R32G32B32A32_SFLOAT;
+					attributeDescriptions[5 + i].offset = i * sizeof(glm::vec4);
+				}
+
 				// Vertex Input
 				m_vkVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-				m_vkVertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
+				m_vkVertexInputStateCreateInfo.vertexAttributeDescriptionCount = bInstanced ? 9 : 5;
 				m_vkVertexInputStateCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
 				// List of vertex attribute descriptions (data format & where to bind to - from)
-				m_vkVertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-				m_vkVertexInputStateCreateInfo.pVertexBindingDescriptions = &bindingDescription;
+				m_vkVertexInputStateCreateInfo.vertexBindingDescriptionCount = bInstanced ? 2 : 1;
+				m_vkVertexInputStateCreateInfo.pVertexBindingDescriptions = bindingDescriptions.data();
 				// List of vertex binding descriptions (data spacing/strides info) 
 				m_vkVertexInputStateCreateInfo.flags = 0;
 				m_vkVertexInputStateCreateInfo.pNext = nullptr;
@@ -226,6 +287,13 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 				m_vkDepthStencilCreateInfo.depthWriteEnable = VK_TRUE;						// Enable writing to depth buffer to replace old values
 				m_vkDepthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;				// Comparison opearation that allows an overwrite (is in front)c vb
 
+				// Depth already laid down by pre-pass, only the visible surface survives!
+				if (bDepthEqual)
+				{
+					m_vkDepthStencilCreateInfo.depthWriteEnable = VK_FALSE;
+					m_vkDepthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+				}
+
 #ifdef WIREFRAME_MODE
 				m_vkRasterizerCreateInfo.polygonMode = VK_POLYGON_MODE_LINE;
 				m_vkRasterizerCreateInfo.lineWidth = 1.0f;
@@ -261,66 +329,47 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 				break;
 			}
 
-		case PipelineType::HDRI_SKYDOME:
+		case PipelineType::DEPTH_PREPASS:
+		case PipelineType::DEPTH_OCCLUDERS:
 		{
-			m_strVertexShader = "Shaders/HDRISkydome.vert.spv";
-			m_strFragmentShader = "Shaders/HDRISkydome.frag.spv";
+			m_strVertexShader = "Shaders/DepthPrepass.vert.spv";
 
+			// No fragment shader, depth only!
 			vertShaderModule = CreateShaderModule(pDevice, m_strVertexShader);
-			fragShaderModule = CreateShaderModule(pDevice, m_strFragmentShader);
 
-			//--- How the data for the single vertex (including info such as Position, color, texcoords etc.) is as a whole
+			// Position only stream, occluders read positions straight out of GPU driven pass' merged vertex buffer
+			bool bOccluders = (m_eType == PipelineType::DEPTH_OCCLUDERS);
+
 			VkVertexInputBindingDescription bindingDescription = {};
-			bindingDescription.binding = 0; // can bind multiple stream of data, this defines which one?
-			bindingDescription.stride = sizeof(Helper::App::VertexPNT); // size of single vertex object
+			bindingDescription.binding = 0;
+			bindingDescription.stride = bOccluders ? sizeof(Helper::App::VertexPNTBT) : sizeof(glm::vec3);
 			bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 
-			std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions;
-
-			// Position attribute
-			attributeDescriptions[0].binding = 0; // which binding the data is at (should be same as above)
-			attributeDescriptions[0].location = 0; // location in shader where data will be read from
-			attributeDescriptions[0].format = VkFormat::VK_FORMAT_R32G32B32_SFLOAT;
-			// format the data will take (also helps define size of the data)
-			attributeDescriptions[0].offset = offsetof(Helper::App::VertexPNT, Position);
-			// where this attribute is defined in the data for a single vertex
-
-			// Normal attribute
-			attributeDescriptions[1].binding = 0;
-			attributeDescriptions[1].location = 1;
-			attributeDescriptions[1].format = VkFormat::VK_FORMAT_R32G32B32_SFLOAT;
-			attributeDescriptions[1].offset = offsetof(Helper::App::VertexPNT, Normal);
-
-			// UV attribute
-			attributeDescriptions[2].binding = 0;
-			attributeDescriptions[2].location = 2;
-			attributeDescriptions[2].format = VkFormat::VK_FORMAT_R32G32_SFLOAT;
-			attributeDescriptions[2].offset = offsetof(Helper::App::VertexPNT, UV);
-
-			// Vertex Input
+			VkVertexInputAttributeDescription attributeDescription = {};
+			attributeDescription.binding = 0;
+			attributeDescription.location = 0;
+			attributeDescription.format = VkFormat::VK_FORMAT_R32G32B32_SFLOAT;
+			attributeDescription.offset = bOccluders ? offsetof(Helper::App::VertexPNTBT, Position) : 0;
+
 			m_vkVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-			m_vkVertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size());
-			m_vkVertexInputStateCreateInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
-			// List of vertex attribute descriptions (data format & where to bind to - from)
+			m_vkVertexInputStateCreateInfo.vertexAttributeDescriptionCount = 1;
+			m_vkVertexInputStateCreateInfo.pVertexAttributeDescriptions = &attributeDescription;
 			m_vkVertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
 			m_vkVertexInputStateCreateInfo.pVertexBindingDescriptions = &bindingDescription;
-			// List of vertex binding descriptions (data spacing/strides info) 
 			m_vkVertexInputStateCreateInfo.flags = 0;
 			m_vkVertexInputStateCreateInfo.pNext = nullptr;
 
-#ifdef WIREFRAME_MODE
-			m_vkRasterizerCreateInfo.polygonMode = VK_POLYGON_MODE_LINE;
-			m_vkRasterizerCreateInfo.lineWidth = 1.0f;
-#endif
+			m_vkDepthStencilCreateInfo.depthTestEnable = VK_TRUE;
+			m_vkDepthStencilCreateInfo.depthWriteEnable = VK_TRUE;
+			m_vkDepthStencilCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
 
 			//--- Color blending
-			// We need to explicitly mention the blending setting between all output attachments else default colormask will be 0x0
-			// and nothing will be rendered to the attachment!bv  
+			// Shares subpass with G-Buffer so all its attachments are listed, but nothing is written to them!
 			m_vecColorBlendAttachments.clear();
 			for (int i = 0; i < nOutputAttachments; ++i)
 			{
 				VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
-				colorBlendAttachment.colorWriteMask = 0xf; // All channels
+				colorBlendAttachment.colorWriteMask = 0x0;
 				colorBlendAttachment.blendEnable = VK_FALSE;
 
 				m_vecColorBlendAttachments.push_back(colorBlendAttachment);
@@ -328,7 +377,6 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 
 			m_vkColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
 			m_vkColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-			// alternative to calculations is to use logical operations
 			m_vkColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
 			m_vkColorBlendStateCreateInfo.attachmentCount = m_vecColorBlendAttachments.size();
 			m_vkColorBlendStateCreateInfo.pAttachments = m_vecColorBlendAttachments.data();
@@ -341,11 +389,14 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 
 			break;
 		}
-			
+
 		case PipelineType::DEFERRED:
+		case PipelineType::DEFERRED_SKY:
 		{
+			bool bSky = (m_eType == PipelineType::DEFERRED_SKY);
+
 			m_strVertexShader = "Shaders/Deferred.vert.spv";
-			m_strFragmentShader = "Shaders/Deferred.frag.spv";
+			m_strFragmentShader = bSky ? "Shaders/DeferredSky.frag.spv" : "Shaders/Deferred.frag.spv";
 
 			vertShaderModule = CreateShaderModule(pDevice, m_strVertexShader);
 			fragShaderModule = CreateShaderModule(pDevice, m_strFragmentShader);
@@ -360,6 +411,11 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 			// disable writing to depth buffer
 			m_vkDepthStencilCreateInfo.depthWriteEnable = VK_FALSE;
 
+			// Full screen triangle is at far plane & G-Buffer depth is bound read-only, so the depth test splits
+			// pixels into geometry (stored depth < 1) & sky (stored depth == 1) before any fragment shader runs!
+			m_vkDepthStencilCreateInfo.depthTestEnable = VK_TRUE;
+			m_vkDepthStencilCreateInfo.depthCompareOp = bSky ? VK_COMPARE_OP_EQUAL : VK_COMPARE_OP_GREATER;
+
 			//--- Color blending
 			// We need to explicitly mention the blending setting between all output attachments else default colormask will be 0x0
 			// and nothing will be rendered to the attachment!
@@ -387,6 +443,61 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 
 			break;
 		}
+
+		case PipelineType::UPSCALE:
+		case PipelineType::UPSCALE_EASU:
+		case PipelineType::UPSCALE_RCAS:
+		case PipelineType::TILED_RESOLVE:
+		{
+			// Same full screen triangle as deferred pass
+			m_strVertexShader = "Shaders/Deferred.vert.spv";
+
+			if (m_eType == PipelineType::UPSCALE_EASU)
+				m_strFragmentShader = "Shaders/FsrEasu.frag.spv";
+			else if (m_eType == PipelineType::UPSCALE_RCAS)
+				m_strFragmentShader = "Shaders/FsrRcas.frag.spv";
+			else if (m_eType == PipelineType::TILED_RESOLVE)
+				m_strFragmentShader = "Shaders/TiledResolve.frag.spv";
+			else
+				m_strFragmentShader = "Shaders/Upscale.frag.spv";
+
+			vertShaderModule = CreateShaderModule(pDevice, m_strVertexShader);
+			fragShaderModule = CreateShaderModule(pDevice, m_strFragmentShader);
+
+			m_vkVertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+			m_vkVertexInputStateCreateInfo.vertexBindingDescriptionCount = 0;
+			m_vkVertexInputStateCreateInfo.pVertexBindingDescriptions = nullptr;
+			m_vkVertexInputStateCreateInfo.vertexAttributeDescriptionCount = 0;
+			m_vkVertexInputStateCreateInfo.pVertexAttributeDescriptions = nullptr;
+
+			// No depth attachment in upscale pass
+			m_vkDepthStencilCreateInfo.depthTestEnable = VK_FALSE;
+			m_vkDepthStencilCreateInfo.depthWriteEnable = VK_FALSE;
+
+			m_vecColorBlendAttachments.clear();
+			for (int i = 0; i < nOutputAttachments; ++i)
+			{
+				VkPipelineColorBlendAttachmentState colorBlendAttachment = {};
+				colorBlendAttachment.colorWriteMask = 0xf;							// All channels
+				colorBlendAttachment.blendEnable = VK_FALSE;
+
+				m_vecColorBlendAttachments.push_back(colorBlendAttachment);
+			}
+
+			m_vkColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+			m_vkColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
+			m_vkColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
+			m_vkColorBlendStateCreateInfo.attachmentCount = m_vecColorBlendAttachments.size();
+			m_vkColorBlendStateCreateInfo.pAttachments = m_vecColorBlendAttachments.data();
+			m_vkColorBlendStateCreateInfo.blendConstants[0] = 0.0f;
+			m_vkColorBlendStateCreateInfo.blendConstants[1] = 0.0f;
+			m_vkColorBlendStateCreateInfo.blendConstants[2] = 0.0f;
+			m_vkColorBlendStateCreateInfo.blendConstants[3] = 0.0f;
+			m_vkColorBlendStateCreateInfo.flags = 0;
+			m_vkColorBlendStateCreateInfo.pNext = nullptr;
+
+			break;
+		}
 	}
 	
 	//--- to actually use shaders, we need to assign them to a specific pipeline stage
@@ -408,27 +519,48 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 	fragShaderStageInfo.pNext = nullptr;
 	fragShaderStageInfo.pSpecializationInfo = nullptr;
 
+	// Permutation key goes into specialization constant 0, driver folds it so disabled paths cost nothing
+	VkSpecializationMapEntry specializationEntry = {};
+	specializationEntry.constantID = 0;
+	specializationEntry.offset = 0;
+	specializationEntry.size = sizeof(uint32_t);
+
+	VkSpecializationInfo specializationInfo = {};
+	specializationInfo.mapEntryCount = 1;
+	specializationInfo.pMapEntries = &specializationEntry;
+	specializationInfo.dataSize = sizeof(uint32_t);
+	specializationInfo.pData = &uiPermutation;
+
+	if (m_bPermutations)
+		fragShaderStageInfo.pSpecializationInfo = &specializationInfo;
+
 	VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
 
 
-	// Dynamic state (nullptr for now!)
+	// Dynamic viewport & scissor, G-Buffer & lighting render to a subrect of the attachments at dynamic resolution
+	std::array<VkDynamicState, 2> arrDynamicStates = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+
+	VkPipelineDynamicStateCreateInfo dynamicStateCreateInfo = {};
+	dynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicStateCreateInfo.dynamicStateCount = static_cast<uint32_t>(arrDynamicStates.size());
+	dynamicStateCreateInfo.pDynamicStates = arrDynamicStates.data();
 
 	// Finally, Create Graphics Pipeline!!!
 	VkGraphicsPipelineCreateInfo graphicsPipelineCreateInfo{};
 	graphicsPipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-	graphicsPipelineCreateInfo.stageCount = 2;
+	graphicsPipelineCreateInfo.stageCount = (fragShaderModule != VK_NULL_HANDLE) ? 2 : 1;
 	graphicsPipelineCreateInfo.pStages = shaderStages;
 	graphicsPipelineCreateInfo.pVertexInputState = &m_vkVertexInputStateCreateInfo;
 	graphicsPipelineCreateInfo.pInputAssemblyState = &m_vkInputAssemblyInfo;
 	graphicsPipelineCreateInfo.pViewportState = &m_vkViewportStateInfo;
-	graphicsPipelineCreateInfo.pDynamicState = nullptr;
+	graphicsPipelineCreateInfo.pDynamicState = &dynamicStateCreateInfo;
 	graphicsPipelineCreateInfo.pRasterizationState = &m_vkRasterizerCreateInfo;
 	graphicsPipelineCreateInfo.pMultisampleState = &m_vkMultisamplingCreateInfo;
 	graphicsPipelineCreateInfo.pColorBlendState = &m_vkColorBlendStateCreateInfo;
 	graphicsPipelineCreateInfo.pDepthStencilState = &m_vkDepthStencilCreateInfo;
 	graphicsPipelineCreateInfo.layout = m_vkPipelineLayout;
-	graphicsPipelineCreateInfo.renderPass = renderPass;
-	graphicsPipelineCreateInfo.subpass = subPass;
+	graphicsPipelineCreateInfo.renderPass = m_vkRenderPass;
+	graphicsPipelineCreateInfo.subpass = m_uiSubPass;
 	graphicsPipelineCreateInfo.pNext = nullptr;
 	graphicsPipelineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
 	graphicsPipelineCreateInfo.basePipelineIndex = -1;
@@ -436,29 +568,42 @@ void VulkanGraphicsPipeline::CreateGraphicsPipeline(VulkanDevice* pDevice, Vulka
 	graphicsPipelineCreateInfo.pTessellationState = nullptr;
 
 
-	if (vkCreateGraphicsPipelines(pDevice->m_vkLogicalDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &m_vkGraphicsPipeline) != VK_SUCCESS)
+	VkPipeline vkPipeline = VK_NULL_HANDLE;
+	if (vkCreateGraphicsPipelines(pDevice->m_vkLogicalDevice, VK_NULL_HANDLE, 1, &graphicsPipelineCreateInfo, nullptr, &vkPipeline) != VK_SUCCESS)
 	{
 		LOG_ERROR("Failed to create Graphics Pipeline!");
 	}
+	else if (m_bPermutations)
+		LOG_INFO("Created Graphics Pipeline! Permutation 0x{0:x}", uiPermutation);
 	else
 		LOG_INFO("Created Graphics Pipeline!");
 
 	// Destroy shader modules...
 	vkDestroyShaderModule(pDevice->m_vkLogicalDevice, vertShaderModule, nullptr);
-	vkDestroyShaderModule(pDevice->m_vkLogicalDevice, fragShaderModule, nullptr);
+	if (fragShaderModule != VK_NULL_HANDLE)
+		vkDestroyShaderModule(pDevice->m_vkLogicalDevice, fragShaderModule, nullptr);
+
+	return vkPipeline;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanGraphicsPipeline::Cleanup(VulkanDevice* pDevice)
 {
-	vkDestroyPipeline(pDevice->m_vkLogicalDevice, m_vkGraphicsPipeline, nullptr);
-	vkDestroyPipelineLayout(pDevice->m_vkLogicalDevice, m_vkPipelineLayout, nullptr);
+	CleanupOnWindowResize(pDevice);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanGraphicsPipeline::CleanupOnWindowResize(VulkanDevice* pDevice)
 {
-	vkDestroyPipeline(pDevice->m_vkLogicalDevice, m_vkGraphicsPipeline, nullptr);
+	// m_vkGraphicsPipeline is one of the cached permutations
+	for (std::pair<const uint32_t, VkPipeline>& permutation : m_mapPermutations)
+	{
+		vkDestroyPipeline(pDevice->m_vkLogicalDevice, permutation.second, nullptr);
+	}
+
+	m_mapPermutations.clear();
+	m_vkGraphicsPipeline = VK_NULL_HANDLE;
+
 	vkDestroyPipelineLayout(pDevice->m_vkLogicalDevice, m_vkPipelineLayout, nullptr);
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "vulkan/vulkan.h"
+#include <mutex>
 
 class VulkanDevice;
 class VulkanSwapChain;
@@ -8,10 +9,22 @@ class VulkanSwapChain;
 enum class PipelineType
 {
 	GBUFFER_OPAQUE,
-	HDRI_SKYDOME,
-	DEFERRED
+	GBUFFER_OPAQUE_INSTANCED,
+	GBUFFER_OPAQUE_DEPTH_EQUAL,			// after depth pre-pass: depth EQUAL, no depth writes
+	DEPTH_PREPASS,
+	DEPTH_OCCLUDERS,					// depth only over full vertex stream, Hi-Z occluders of GPU driven path
+	DEFERRED,							// lit pixels only, depth test rejects sky
+	DEFERRED_SKY,						// sky pixels only, view ray into environment map
+	UPSCALE,							// render subrect of scene color to full swapchain image, bilinear
+	UPSCALE_EASU,						// FSR1 edge adaptive upscale of scene color subrect into full size intermediate
+	UPSCALE_RCAS,						// FSR1 contrast adaptive sharpen of upscaled intermediate into swapchain image
+	TILED_RESOLVE						// HDR output of tiled compute lighting into scene color, sky pixels are kept
 };
 
+//---------------------------------------------------------------------------------------------------------------------
+// Permutations are the same pipeline state with a different value for fragment specialization constant 0. G-Buffer
+// pipelines use it as material feature mask (MaterialFeature), deferred pipeline as debug view (0 = lit result).
+// Variants are compiled on first request & cached, m_vkGraphicsPipeline is the one asked for at creation.
 class VulkanGraphicsPipeline
 {
 public:
@@ -22,7 +35,12 @@ public:
 																			const std::vector<VkPushConstantRange> pushConstantRanges);
 														
 	void												CreateGraphicsPipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, 
-																				VkRenderPass renderPass, uint32_t subPass, uint32_t nOutputAttachments);
+																				VkRenderPass renderPass, uint32_t subPass, uint32_t nOutputAttachments,
+																				uint32_t uiPermutation = 0);
+
+	// Thread safe, recording jobs may ask for a variant nobody compiled yet. Warm up with known keys to avoid hitches!
+	VkPipeline											GetPermutation(uint32_t uiPermutation);
+	inline bool											HasPermutations()		{ return m_bPermutations; }
 														
 	void												Cleanup(VulkanDevice* pDevice);
 	void												CleanupOnWindowResize(VulkanDevice* pDevice);
@@ -33,9 +51,20 @@ public:
 														
 private:												
 	VkShaderModule										CreateShaderModule(VulkanDevice* pDevice, const std::string& fileName);
+	VkPipeline											CreatePermutation(uint32_t uiPermutation);
 														
 private:												
 	PipelineType										m_eType;
+	bool												m_bPermutations;
+
+	// Kept from CreateGraphicsPipeline() so variants can be built later
+	VulkanDevice*										m_pDevice;
+	VkRenderPass										m_vkRenderPass;
+	uint32_t											m_uiSubPass;
+	uint32_t											m_nOutputAttachments;
+
+	std::map<uint32_t, VkPipeline>						m_mapPermutations;
+	std::mutex											m_mutexPermutations;
 														
 	std::string											m_strVertexShader;
 	std::string											m_strFragmentShader;
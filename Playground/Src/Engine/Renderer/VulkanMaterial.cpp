@@ -3,6 +3,7 @@
 
 #include "VulkanDevice.h"
 #include "VulkanTexture2D.h"
+#include "MaterialRegistry.h"
 
 #include "PlaygroundHeaders.h"
 
@@ -10,6 +11,10 @@
 VulkanMaterial::VulkanMaterial()
 {
 	m_mapTextures.clear();
+	m_mapTextureIndices.clear();
+	m_uiMaterialIndex = 0;
+	m_uiFeatures = 0;
+	m_bRegistered = false;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -28,9 +33,54 @@ void VulkanMaterial::LoadTexture(VulkanDevice* pDevice, const std::string& fileP
 	m_mapTextures.emplace(type, pTexture);
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void VulkanMaterial::RegisterBindless(VulkanDevice* pDevice)
+{
+	MaterialRegistry& registry = MaterialRegistry::getInstance();
+
+	std::map<TextureType, VulkanTexture2D*>::iterator iter = m_mapTextures.begin();
+	for (; iter != m_mapTextures.end(); ++iter)
+	{
+		m_mapTextureIndices[iter->first] = registry.RegisterTexture(pDevice, iter->second);
+	}
+
+	m_MaterialData.texturesAEN = glm::uvec4(m_mapTextureIndices[TextureType::TEXTURE_ALBEDO],
+											m_mapTextureIndices[TextureType::TEXTURE_EMISSIVE],
+											m_mapTextureIndices[TextureType::TEXTURE_NORMAL], 0);
+	m_MaterialData.texturesRMO = glm::uvec4(m_mapTextureIndices[TextureType::TEXTURE_ROUGHNESS],
+											m_mapTextureIndices[TextureType::TEXTURE_METALNESS],
+											m_mapTextureIndices[TextureType::TEXTURE_AO], 0);
+
+	m_uiMaterialIndex = registry.RegisterMaterial(m_MaterialData);
+	m_bRegistered = true;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void VulkanMaterial::UpdateBindless()
+{
+	if (m_bRegistered)
+		MaterialRegistry::getInstance().UpdateMaterial(m_uiMaterialIndex, m_MaterialData);
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanMaterial::Cleanup(VulkanDevice* pDevice)
 {
+	if (m_bRegistered)
+	{
+		MaterialRegistry& registry = MaterialRegistry::getInstance();
+
+		std::map<TextureType, uint32_t>::iterator indexIter = m_mapTextureIndices.begin();
+		for (; indexIter != m_mapTextureIndices.end(); ++indexIter)
+		{
+			registry.ReleaseTexture(indexIter->second);
+		}
+
+		registry.ReleaseMaterial(m_uiMaterialIndex);
+
+		m_mapTextureIndices.clear();
+		m_bRegistered = false;
+	}
+
 	std::map<TextureType, VulkanTexture2D*>::iterator iter = m_mapTextures.begin();
 	for (; iter != m_mapTextures.end(); ++iter)
 	{
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "vulkan/vulkan.h"
+#include "MaterialRegistry.h"
 
 class VulkanDevice;
 class VulkanTexture2D;
@@ -13,9 +14,20 @@ public:
 	~VulkanMaterial();
 
 	void									LoadTexture(VulkanDevice* pDevice, const std::string& filePath, TextureType type);
+
+	// Adds loaded textures & material to bindless set, shaders then only need m_uiMaterialIndex
+	void									RegisterBindless(VulkanDevice* pDevice);
+
+	// Pushes editor changes of m_MaterialData to bindless material buffer
+	void									UpdateBindless();
 	void									Cleanup(VulkanDevice* pDevice);
 	void									CleanupOnWindowResize(VulkanDevice* pDevice);
 
 	std::map<TextureType, VulkanTexture2D*>	m_mapTextures;
+	std::map<TextureType, uint32_t>			m_mapTextureIndices;			// slots in bindless texture array
+	uint32_t								m_uiMaterialIndex;				// slot in bindless material buffer
+	GPUMaterial								m_MaterialData;					// CPU copy, pushed on editor changes
+	uint32_t								m_uiFeatures;					// MaterialFeature bits set while loading, selects G-Buffer permutation
+	bool									m_bRegistered;
 };
 
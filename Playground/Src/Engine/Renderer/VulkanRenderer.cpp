@@ -15,6 +15,15 @@
 #include "Engine/RenderObjects/Model.h"
 #include "Engine/Helpers/Utility.h"
 #include "Engine/Helpers/Camera.h"
+#include "Engine/Helpers/ThreadPool.h"
+#include "GPUDrivenPass.h"
+#include "HiZPass.h"
+#include "TiledLightingPass.h"
+#include "ClusteredLighting.h"
+#include "DynamicResolution.h"
+#include "UpscalePass.h"
+#include "MaterialRegistry.h"
+#include "FrameGlobals.h"
 #include "Engine/ImGui/UIManager.h"
 #include "Engine/ImGui/imgui.h"
 #include "Engine/ImGui/imgui_impl_glfw.h"
@@ -31,17 +40,47 @@ VulkanRenderer::VulkanRenderer()
 	m_pScene							= nullptr;
 
 	m_pGraphicsPipelineGBuffer			= nullptr;
+	m_pGraphicsPipelineGBufferInstanced	= nullptr;
+	m_pGraphicsPipelineGBufferDepthEqual = nullptr;
+	m_pGraphicsPipelineDepthPrepass		= nullptr;
 	m_pGraphicsPipelineDeferred			= nullptr;
-	m_pGraphicsPipelineSkydome			= nullptr;
+	m_pGraphicsPipelineDeferredSky		= nullptr;
 	
 	m_uiCurrentFrame					= 0;
 	m_bFramebufferResized				= false;
+	m_iRecordedPassID					= -1;
+
+	m_pThreadPool						= nullptr;
+	m_uiRecordThreadCount				= 1;
+	m_vecThreadCommandPools.clear();
+
+	m_pGPUDrivenPass					= nullptr;
+	m_pClusteredLighting				= nullptr;
+	m_pFrameGlobals						= nullptr;
+	m_bGPUDriven						= false;
+	m_pHiZPass							= nullptr;
+	m_bOcclusionCulling					= false;
+	m_pTiledLightingPass				= nullptr;
+	m_bTiledLighting					= false;
+
+	m_bDepthPrepass						= false;
+	m_vecStatisticsQueryPools.clear();
+	m_vecRecordedJobCount.clear();
+	m_vecTimestampQueryPools.clear();
+
+	m_pDynamicResolution				= nullptr;
+	m_pUpscalePass						= nullptr;
+	m_vkRenderExtent					= { 0, 0 };
+	m_iUpscaleMode						= 0;
+	m_fSharpness						= 0.0f;
+	m_vecRecordedRenderExtent.clear();
 
 	m_vkInstance						= VK_NULL_HANDLE;
 	m_vkDebugMessenger					= VK_NULL_HANDLE;
 	m_vkSurface							= VK_NULL_HANDLE;
 
 	m_vkRenderPass						= VK_NULL_HANDLE;
+	m_vkRenderPassTiledLighting			= VK_NULL_HANDLE;
 
 	m_pDeferredUniforms					= nullptr;
 	m_vkDeferredPassDescriptorPool		= VK_NULL_HANDLE;
@@ -51,6 +90,7 @@ VulkanRenderer::VulkanRenderer()
 	m_vecSemaphoreImageAvailable.clear();
 	m_vecSemaphoreRenderFinished.clear();
 	m_vecFencesRender.clear();
+	m_vecCommandBufferDirty.clear();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -60,11 +100,22 @@ VulkanRenderer::~VulkanRenderer()
 	m_vecSemaphoreRenderFinished.clear();
 	m_vecFencesRender.clear();
 
+	SAFE_DELETE(m_pThreadPool);
+	SAFE_DELETE(m_pGPUDrivenPass);
+	SAFE_DELETE(m_pHiZPass);
+	SAFE_DELETE(m_pTiledLightingPass);
+	SAFE_DELETE(m_pClusteredLighting);
+	SAFE_DELETE(m_pFrameGlobals);
+	SAFE_DELETE(m_pDynamicResolution);
+	SAFE_DELETE(m_pUpscalePass);
 	SAFE_DELETE(m_pScene);
 	SAFE_DELETE(m_pDeferredUniforms);
 	SAFE_DELETE(m_pGraphicsPipelineGBuffer);
+	SAFE_DELETE(m_pGraphicsPipelineGBufferInstanced);
+	SAFE_DELETE(m_pGraphicsPipelineGBufferDepthEqual);
+	SAFE_DELETE(m_pGraphicsPipelineDepthPrepass);
 	SAFE_DELETE(m_pGraphicsPipelineDeferred);
-	SAFE_DELETE(m_pGraphicsPipelineSkydome);
+	SAFE_DELETE(m_pGraphicsPipelineDeferredSky);
 	SAFE_DELETE(m_pFrameBuffer);
 	SAFE_DELETE(m_pSwapChain);
 	SAFE_DELETE(m_pDevice);
@@ -112,32 +163,81 @@ int VulkanRenderer::Initialize(GLFWwindow* pWindow)
 		m_pFrameBuffer->CreateAttachment(m_pDevice, m_pSwapChain, AttachmentType::FB_ATTACHMENT_EMISSION);
 		m_pFrameBuffer->CreateAttachment(m_pDevice, m_pSwapChain, AttachmentType::FB_ATTACHMENT_BACKGROUND);
 		m_pFrameBuffer->CreateAttachment(m_pDevice, m_pSwapChain, AttachmentType::FB_ATTACHMENT_OBJECTID);
+		m_pFrameBuffer->CreateAttachment(m_pDevice, m_pSwapChain, AttachmentType::FB_ATTACHMENT_SCENECOLOR);
 
 		CreateRenderPass();
 
 		m_pFrameBuffer->CreateFrameBuffers(m_pDevice, m_pSwapChain, m_vkRenderPass);
 
+		// Full resolution until controller has GPU timings
+		m_pDynamicResolution = new DynamicResolution();
+		m_vkRenderExtent = m_pSwapChain->m_vkSwapchainExtent;
+		m_vecRecordedRenderExtent.assign(m_pSwapChain->m_uiFramesInFlight, m_vkRenderExtent);
+
+		m_pUpscalePass = new UpscalePass();
+		m_pUpscalePass->Initialize(m_pDevice, m_pSwapChain, m_pFrameBuffer);
+
 		// Command pool & Command buffer for Graphics!
 		m_pDevice->CreateGraphicsCommandPool();
-		m_pDevice->CreateGraphicsCommandBuffers(m_pSwapChain->m_vecSwapchainImages.size());
+		m_pDevice->CreateGraphicsCommandBuffers(m_pSwapChain->m_uiFramesInFlight);
+		MarkCommandBuffersDirty();
+
+		// Worker threads & per-thread command pools for parallel G-Buffer recording
+		uint32_t nMaxThreads = std::clamp(std::thread::hardware_concurrency(), 1u, Helper::App::MAX_RECORD_THREADS);
+		m_pThreadPool = new ThreadPool(nMaxThreads);
+		m_uiRecordThreadCount = nMaxThreads;
+		CreateThreadCommandPools();
 
 		HDRISkydome::getInstance().LoadSkydome(m_pDevice, m_pSwapChain);
 
+		// Models register their textures & materials while loading
+		MaterialRegistry::getInstance().Initialize(m_pDevice);
+
 		// Load Scene
 		m_pScene = new Scene();
 		m_pScene->LoadScene(m_pDevice, m_pSwapChain);
+
+		// Deferred pipeline layout needs cluster set layout, G-Buffer layouts need frame set layout
+		m_pClusteredLighting = new ClusteredLighting();
+		m_pClusteredLighting->Initialize(m_pDevice, m_pSwapChain);
+
+		m_pFrameGlobals = new FrameGlobals();
+		m_pFrameGlobals->Initialize(m_pDevice, m_pSwapChain);
 		
 		CreateGraphicsPipeline();
 
+		// GPU driven G-Buffer, needs merged scene geometry so scene must be loaded! Hi-Z occluders draw with scene sets
+		if (m_pDevice->m_bSupportsIndirectCount)
+		{
+			m_pHiZPass = new HiZPass();
+			m_pHiZPass->Initialize(m_pDevice, m_pSwapChain, m_pFrameBuffer, m_vecSceneSetLayouts, m_vecScenePushConstantRanges);
+
+			m_pGPUDrivenPass = new GPUDrivenPass();
+			m_pGPUDrivenPass->Initialize(m_pDevice, m_pSwapChain, m_pScene, m_pHiZPass->GetCullDescriptorSetLayout(), m_pFrameGlobals->GetObjectBuffers());
+		}
+		else
+		{
+			LOG_WARNING("drawIndirectCount not supported, GPU driven path disabled!");
+		}
+
 		//AllocateDynamicBufferTransferSpace();
 
 		CreateDeferredPassDescriptorPool();
 		CreateDeferredPassDescriptorSets();
 
+		// Compute alternative to deferred subpass, reads same uniforms & cluster lights
+		m_pTiledLightingPass = new TiledLightingPass();
+		m_pTiledLightingPass->Initialize(m_pDevice, m_pSwapChain, m_pFrameBuffer, m_pClusteredLighting->GetDescriptorSetLayout(),
+										 m_pDeferredUniforms->vecBuffer);
+
 		CreateSyncObjects();
 
 		// Initialize UI Manager!
 		UIManager::getInstance().Initialize(m_pWindow, m_vkInstance, m_pDevice, m_pSwapChain);
+		UIManager::getInstance().m_iMaxRecordThreads = static_cast<int>(m_pThreadPool->GetThreadCount());
+		UIManager::getInstance().m_iRecordThreadCount = static_cast<int>(m_uiRecordThreadCount);
+		UIManager::getInstance().m_bGPUDrivenSupported = (m_pGPUDrivenPass != nullptr);
+		UIManager::getInstance().m_bPipelineStatisticsSupported = m_pDevice->m_bSupportsPipelineStatistics;
 	}
 	catch (const std::runtime_error& e)
 	{
@@ -155,10 +255,19 @@ void VulkanRenderer::Update(float dt)
 	m_pScene->Update(m_pDevice, m_pSwapChain, dt);
 
 	// Update deferred pass uniform data
-	// Contains : PassID | CameraPosition
+	// Contains : LightProperties | CameraPosition
 	m_pDeferredUniforms->shaderData.cameraPosition = Camera::getInstance().m_vecCameraPosition;
 	m_pDeferredUniforms->shaderData.lightProperties = glm::vec4(m_pScene->m_LightDirection, m_pScene->m_LightIntensity);
-	m_pDeferredUniforms->shaderData.passID = UIManager::getInstance().m_iPassID;	
+
+	// IBL toggle goes through uniforms so switching doesn't re-record command buffers
+	float fMaxMip = static_cast<float>(HDRISkydome::getInstance().m_pIBL->m_uiPrefilterMipCount - 1);
+	m_pDeferredUniforms->shaderData.iblProperties = glm::vec4(UIManager::getInstance().m_bImageBasedLighting ? 1.0f : 0.0f, fMaxMip,
+															  UIManager::getInstance().m_fIBLIntensity, 0.0f);
+
+	// Same Y flip as G-Buffer projection so reconstructed rays match rasterized geometry
+	glm::mat4 matProjection = Camera::getInstance().m_matProjection;
+	matProjection[1][1] *= -1.0f;
+	m_pDeferredUniforms->shaderData.matInverseViewProjection = glm::inverse(matProjection * Camera::getInstance().m_matView);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -167,7 +276,8 @@ void VulkanRenderer::RunShaderCompiler(const std::string& directoryPath)
 	std::string shaderCompiler = "C:/VulkanSDK/1.2.170.0/Bin/glslc.exe";
 	for (const auto& entry : std::filesystem::directory_iterator(directoryPath))
 	{
-		if (entry.is_regular_file() && (entry.path().extension().string() == ".vert" || entry.path().extension().string() == ".frag"))
+		if (entry.is_regular_file() && (entry.path().extension().string() == ".vert" || entry.path().extension().string() == ".frag" || 
+										 entry.path().extension().string() == ".comp"))
 		{
 			std::string cmd = shaderCompiler + " -c" + " " + entry.path().string() + " -o " + entry.path().string() + ".spv";
 			LOG_DEBUG("Compiling shader " + entry.path().filename().string());
@@ -368,6 +478,7 @@ void VulkanRenderer::HandleWindowResize()
 
 	// perform cleanup on old versions
 	CleanupOnWindowResize();
+	CleanupSyncObjects();
 
 	// Recreate...!
 	LOG_DEBUG("Recreating SwapChain Start");
@@ -382,6 +493,7 @@ void VulkanRenderer::HandleWindowResize()
 	m_pFrameBuffer->CreateAttachment(m_pDevice, m_pSwapChain, AttachmentType::FB_ATTACHMENT_EMISSION);
 	m_pFrameBuffer->CreateAttachment(m_pDevice, m_pSwapChain, AttachmentType::FB_ATTACHMENT_BACKGROUND);
 	m_pFrameBuffer->CreateAttachment(m_pDevice, m_pSwapChain, AttachmentType::FB_ATTACHMENT_OBJECTID);
+	m_pFrameBuffer->CreateAttachment(m_pDevice, m_pSwapChain, AttachmentType::FB_ATTACHMENT_SCENECOLOR);
 
 	CreateRenderPass();
 	CreateGraphicsPipeline();
@@ -391,7 +503,31 @@ void VulkanRenderer::HandleWindowResize()
 	CreateDeferredPassDescriptorPool();
 	CreateDeferredPassDescriptorSets();
 
-	m_pDevice->CreateGraphicsCommandBuffers(m_pSwapChain->m_vecSwapchainImages.size());
+	m_pDevice->CreateGraphicsCommandBuffers(m_pSwapChain->m_uiFramesInFlight);
+	CreateThreadCommandPools();
+	MarkCommandBuffersDirty();
+
+	// GPU driven pass reads object buffers of frame globals
+	m_pFrameGlobals->HandleWindowResize(m_pDevice, m_pSwapChain);
+
+	if (m_pGPUDrivenPass)
+		m_pGPUDrivenPass->HandleWindowResize(m_pDevice, m_pSwapChain, m_pFrameGlobals->GetObjectBuffers());
+
+	if (m_pHiZPass)
+		m_pHiZPass->HandleWindowResize(m_pDevice, m_pSwapChain, m_pFrameBuffer);
+
+	m_pTiledLightingPass->HandleWindowResize(m_pDevice, m_pSwapChain, m_pFrameBuffer, m_pDeferredUniforms->vecBuffer);
+
+	m_pClusteredLighting->HandleWindowResize(m_pDevice, m_pSwapChain);
+
+	// Keep current render scale, attachments are reallocated at the new swapchain size
+	m_pUpscalePass->HandleWindowResize(m_pDevice, m_pSwapChain, m_pFrameBuffer);
+	m_vkRenderExtent = m_pDynamicResolution->GetRenderExtent(m_pSwapChain->m_vkSwapchainExtent);
+	m_vecRecordedRenderExtent.assign(m_pSwapChain->m_uiFramesInFlight, m_vkRenderExtent);
+
+	// Image count or frames in flight may have changed, all frames start over idle
+	CreateSyncObjects();
+	m_uiCurrentFrame = 0;
 
 	UIManager::getInstance().HandleWindowResize(m_pWindow, m_vkInstance, m_pDevice, m_pSwapChain);
 
@@ -404,26 +540,76 @@ void VulkanRenderer::CreateGraphicsPipeline()
 	//----- Create GBUFFER_OPAQUE Graphics pipeline!
 	m_pGraphicsPipelineGBuffer = new VulkanGraphicsPipeline(PipelineType::GBUFFER_OPAQUE, m_pSwapChain);
 
-	std::vector<VkDescriptorSetLayout> setLayouts = { m_pScene->GetModelList().at(0)->m_vkDescriptorSetLayout };
-	std::vector<VkPushConstantRange> pushConstantRanges = {};
+	// set 0 - frame globals & objects, set 1 - bindless materials, object slot is a push constant. Shared by
+	// every scene geometry pipeline so sets & pushed values stay valid across pipeline switches
+	m_vecSceneSetLayouts = { m_pFrameGlobals->GetDescriptorSetLayout(),
+							 MaterialRegistry::getInstance().GetDescriptorSetLayout() };
+
+	VkPushConstantRange objectPushRange = {};
+	objectPushRange.stageFlags = SceneSetConfig::OBJECT_PUSH_STAGES;
+	objectPushRange.offset = 0;
+	objectPushRange.size = sizeof(PushConstantData);
+	m_vecScenePushConstantRanges = { objectPushRange };
+
+	const std::vector<VkDescriptorSetLayout>& setLayouts = m_vecSceneSetLayouts;
+	const std::vector<VkPushConstantRange>& pushConstantRanges = m_vecScenePushConstantRanges;
 	m_pGraphicsPipelineGBuffer->CreatePipelineLayout(m_pDevice, setLayouts, pushConstantRanges);
 	m_pGraphicsPipelineGBuffer->CreateGraphicsPipeline(m_pDevice, m_pSwapChain, m_vkRenderPass, 0, 7);
 
-	//---- Create Skydome Graphics Pipeline
-	m_pGraphicsPipelineSkydome = new VulkanGraphicsPipeline(PipelineType::HDRI_SKYDOME, m_pSwapChain);
+	//----- Create GBUFFER_OPAQUE_INSTANCED Graphics pipeline, same descriptor layout + per instance vertex stream!
+	m_pGraphicsPipelineGBufferInstanced = new VulkanGraphicsPipeline(PipelineType::GBUFFER_OPAQUE_INSTANCED, m_pSwapChain);
+	m_pGraphicsPipelineGBufferInstanced->CreatePipelineLayout(m_pDevice, setLayouts, pushConstantRanges);
+	m_pGraphicsPipelineGBufferInstanced->CreateGraphicsPipeline(m_pDevice, m_pSwapChain, m_vkRenderPass, 0, 7);
+
+	//----- Create DEPTH_PREPASS Graphics pipeline, position stream only & no fragment shader!
+	m_pGraphicsPipelineDepthPrepass = new VulkanGraphicsPipeline(PipelineType::DEPTH_PREPASS, m_pSwapChain);
+	m_pGraphicsPipelineDepthPrepass->CreatePipelineLayout(m_pDevice, setLayouts, pushConstantRanges);
+	m_pGraphicsPipelineDepthPrepass->CreateGraphicsPipeline(m_pDevice, m_pSwapChain, m_vkRenderPass, 0, 7);
+
+	//----- Create GBUFFER_OPAQUE_DEPTH_EQUAL Graphics pipeline, used after depth pre-pass!
+	m_pGraphicsPipelineGBufferDepthEqual = new VulkanGraphicsPipeline(PipelineType::GBUFFER_OPAQUE_DEPTH_EQUAL, m_pSwapChain);
+	m_pGraphicsPipelineGBufferDepthEqual->CreatePipelineLayout(m_pDevice, setLayouts, pushConstantRanges);
+	m_pGraphicsPipelineGBufferDepthEqual->CreateGraphicsPipeline(m_pDevice, m_pSwapChain, m_vkRenderPass, 0, 7);
 
-	std::vector<VkDescriptorSetLayout> setLayoutsSkydome = { HDRISkydome::getInstance().m_vkDescriptorSetLayout };
-	m_pGraphicsPipelineSkydome->CreatePipelineLayout(m_pDevice, setLayoutsSkydome, pushConstantRanges);
-	m_pGraphicsPipelineSkydome->CreateGraphicsPipeline(m_pDevice, m_pSwapChain, m_vkRenderPass, 0, 7);
-	
 	//----- Create GBUFFER_BEAUTY Graphics pipeline!
 	m_pGraphicsPipelineDeferred = new VulkanGraphicsPipeline(PipelineType::DEFERRED, m_pSwapChain);
 
 	CreateDeferredPassDescriptorSetLayout();
 
-	std::vector<VkDescriptorSetLayout> deferredSetLayouts = { m_vkDeferredPassDescriptorSetLayout };
-	m_pGraphicsPipelineDeferred->CreatePipelineLayout(m_pDevice, deferredSetLayouts, pushConstantRanges);
+	// set 0 - G-Buffer inputs & deferred uniforms, set 1 - light clusters
+	std::vector<VkDescriptorSetLayout> deferredSetLayouts = { m_vkDeferredPassDescriptorSetLayout, m_pClusteredLighting->GetDescriptorSetLayout() };
+	m_pGraphicsPipelineDeferred->CreatePipelineLayout(m_pDevice, deferredSetLayouts, {});
 	m_pGraphicsPipelineDeferred->CreateGraphicsPipeline(m_pDevice, m_pSwapChain, m_vkRenderPass, 1, 1);
+
+	//----- Create DEFERRED_SKY Graphics pipeline, same descriptors as deferred so set stays bound!
+	m_pGraphicsPipelineDeferredSky = new VulkanGraphicsPipeline(PipelineType::DEFERRED_SKY, m_pSwapChain);
+	m_pGraphicsPipelineDeferredSky->CreatePipelineLayout(m_pDevice, deferredSetLayouts, {});
+	m_pGraphicsPipelineDeferredSky->CreateGraphicsPipeline(m_pDevice, m_pSwapChain, m_vkRenderPass, 1, 1);
+
+	WarmUpPermutations();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Compile every material permutation the loaded scene uses up front, so first frame doesn't hitch on lazy creation
+void VulkanRenderer::WarmUpPermutations()
+{
+	if (!m_pScene)
+		return;
+
+	std::vector<Model*> vecModels = m_pScene->GetModelList();
+	for (uint32_t i = 0; i < vecModels.size(); ++i)
+	{
+		uint32_t uiFeatures = vecModels[i]->GetMaterialFeatures();
+
+		m_pGraphicsPipelineGBuffer->GetPermutation(uiFeatures);
+		m_pGraphicsPipelineGBufferDepthEqual->GetPermutation(uiFeatures);
+	}
+
+	std::vector<Model*> vecInstancedModels = m_pScene->GetInstancedModelList();
+	for (uint32_t i = 0; i < vecInstancedModels.size(); ++i)
+	{
+		m_pGraphicsPipelineGBufferInstanced->GetPermutation(vecInstancedModels[i]->GetMaterialFeatures());
+	}
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -573,28 +759,28 @@ void VulkanRenderer::CreateRenderPass()
 
 
 	//--- SUBPASS 2 ATTACHMENTS
-	// Swap chain Color Attachment (Output from second subpass!)
-	VkAttachmentDescription swapChainColorAttachmentDesc = {};
-	swapChainColorAttachmentDesc.format			= m_pSwapChain->m_vkSwapchainImageFormat;		// format to use for attachment
-	swapChainColorAttachmentDesc.samples		= VK_SAMPLE_COUNT_1_BIT;						// number of samples for multi sampling
-	swapChainColorAttachmentDesc.loadOp			= VK_ATTACHMENT_LOAD_OP_CLEAR;					// describes what to do with attachment before rendering
-	swapChainColorAttachmentDesc.storeOp		= VK_ATTACHMENT_STORE_OP_STORE;					// describes what to do with attachment after rendering
-	swapChainColorAttachmentDesc.stencilLoadOp	= VK_ATTACHMENT_LOAD_OP_DONT_CARE;				// describes what to do with stencil before rendering
-	swapChainColorAttachmentDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;				// describes what to do with stencil after rendering
-	swapChainColorAttachmentDesc.initialLayout	= VK_IMAGE_LAYOUT_UNDEFINED;					// image data layout before render pass starts
-	swapChainColorAttachmentDesc.finalLayout	= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;		//? changed from VK_IMAGE_LAYOUT_PRESENT_SRC_KHR since UI gets drawn last! 					
-
-	// Swap chain Color attachment Reference
-	VkAttachmentReference swapChainColorAttachmentRef = {};
-	swapChainColorAttachmentRef.attachment			  = 0;
-	swapChainColorAttachmentRef.layout				  = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	// Scene Color Attachment (Output from second subpass, upscale pass samples it into the swapchain image!)
+	VkAttachmentDescription sceneColorAttachmentDesc = {};
+	sceneColorAttachmentDesc.format				= m_pFrameBuffer->m_pSceneColorAttachment->attachmentFormat;	// format to use for attachment
+	sceneColorAttachmentDesc.samples			= VK_SAMPLE_COUNT_1_BIT;						// number of samples for multi sampling
+	sceneColorAttachmentDesc.loadOp				= VK_ATTACHMENT_LOAD_OP_CLEAR;					// describes what to do with attachment before rendering
+	sceneColorAttachmentDesc.storeOp			= VK_ATTACHMENT_STORE_OP_STORE;					// describes what to do with attachment after rendering
+	sceneColorAttachmentDesc.stencilLoadOp		= VK_ATTACHMENT_LOAD_OP_DONT_CARE;				// describes what to do with stencil before rendering
+	sceneColorAttachmentDesc.stencilStoreOp		= VK_ATTACHMENT_STORE_OP_DONT_CARE;				// describes what to do with stencil after rendering
+	sceneColorAttachmentDesc.initialLayout		= VK_IMAGE_LAYOUT_UNDEFINED;					// image data layout before render pass starts
+	sceneColorAttachmentDesc.finalLayout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;		// image data layout after render pass
+
+	// Scene Color attachment Reference
+	VkAttachmentReference sceneColorAttachmentRef = {};
+	sceneColorAttachmentRef.attachment			  = 0;
+	sceneColorAttachmentRef.layout				  = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
 	// Input attachments output from first subpass!
 	std::array<VkAttachmentReference, 8> inputReferences;
 	inputReferences[0].attachment	= 1;
 	inputReferences[0].layout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 	inputReferences[1].attachment	= 2;
-	inputReferences[1].layout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	inputReferences[1].layout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;		// also bound for depth test, layouts must match
 	inputReferences[2].attachment	= 3;
 	inputReferences[2].layout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 	inputReferences[3].attachment	= 4;
@@ -608,13 +794,20 @@ void VulkanRenderer::CreateRenderPass()
 	inputReferences[7].attachment	= 8;
 	inputReferences[7].layout		= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 
-	// Set up subpass 2 (Takes in 8 input attachments from subpass 1 & outputs one color output for final present!)
+	// Set up subpass 2 (Takes in 8 input attachments from subpass 1 & outputs scene color for upscale pass!)
 	subpasses[1].pipelineBindPoint		= VK_PIPELINE_BIND_POINT_GRAPHICS;
 	subpasses[1].colorAttachmentCount	= 1;												
-	subpasses[1].pColorAttachments		= &swapChainColorAttachmentRef;
+	subpasses[1].pColorAttachments		= &sceneColorAttachmentRef;
 	subpasses[1].inputAttachmentCount	= static_cast<uint32_t>(inputReferences.size());
 	subpasses[1].pInputAttachments		= inputReferences.data();
 
+	// G-Buffer depth read-only, depth test splits lit & sky pixels without touching the lighting shader!
+	VkAttachmentReference depthReadOnlyAttachmentRef = {};
+	depthReadOnlyAttachmentRef.attachment	= 2;
+	depthReadOnlyAttachmentRef.layout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+	subpasses[1].pDepthStencilAttachment = &depthReadOnlyAttachmentRef;
+
 	// SUBPASS DEPENDENCIES
 	// Need to determine when layout transition occurs using subpass dependencies
 	std::array<VkSubpassDependency, 3> subpassDependencies;
@@ -634,25 +827,25 @@ void VulkanRenderer::CreateRenderPass()
 	// Conversion from VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL & VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL to 
 	// VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
 	subpassDependencies[1].srcSubpass		= 0;
-	subpassDependencies[1].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	subpassDependencies[1].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	subpassDependencies[1].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	subpassDependencies[1].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
 	subpassDependencies[1].dstSubpass		= 1;
-	subpassDependencies[1].dstStageMask		= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-	subpassDependencies[1].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+	subpassDependencies[1].dstStageMask		= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+	subpassDependencies[1].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_INPUT_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
 	subpassDependencies[1].dependencyFlags	= 0;
 
-	// Conversion from VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL to VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-	// Transition must happen after...
+	// Conversion from VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL to VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+	// Transition must happen after lighting writes & before upscale pass samples scene color
 	subpassDependencies[2].srcSubpass		= 1;
 	subpassDependencies[2].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	subpassDependencies[2].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;;
+	subpassDependencies[2].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 	subpassDependencies[2].dstSubpass		= VK_SUBPASS_EXTERNAL;
-	subpassDependencies[2].dstStageMask		= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-	subpassDependencies[2].dstAccessMask	= VK_ACCESS_MEMORY_READ_BIT;
+	subpassDependencies[2].dstStageMask		= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+	subpassDependencies[2].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
 	subpassDependencies[2].dependencyFlags	= 0;
 
 	// Render pass!
-	std::array<VkAttachmentDescription, 9> renderPassAttachments = { swapChainColorAttachmentDesc, 
+	std::array<VkAttachmentDescription, 9> renderPassAttachments = { sceneColorAttachmentDesc, 
 																	 colorAttachmentDesc, 
 																	 depthAttachmentDesc, 
 																	 normalAttachmentDesc, 
@@ -677,10 +870,41 @@ void VulkanRenderer::CreateRenderPass()
 	}
 	else
 		LOG_INFO("Created Render Pass!");
+
+	// Tiled compute lighting variant: G-Buffer is stored & left in its subpass 2 read layouts for the compute pass.
+	// Only load/store ops & layouts differ, so it stays compatible with the same framebuffers & pipelines!
+	for (uint32_t i = 1; i <= 5; ++i)
+	{
+		renderPassAttachments[i].storeOp		= VK_ATTACHMENT_STORE_OP_STORE;
+		renderPassAttachments[i].finalLayout	= VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	}
+	renderPassAttachments[2].finalLayout		= VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+
+	// G-Buffer writes of subpass 1 & sky writes of subpass 2 before tiled lighting reads & resolve writes
+	subpassDependencies[2].srcStageMask		= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT |
+											  VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	subpassDependencies[2].srcAccessMask	= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	subpassDependencies[2].dstStageMask		= VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	subpassDependencies[2].dstAccessMask	= VK_ACCESS_SHADER_READ_BIT;
+
+	if (vkCreateRenderPass(m_pDevice->m_vkLogicalDevice, &renderPassCreateInfo, nullptr, &m_vkRenderPassTiledLighting) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Tiled Lighting Render Pass");
+	}
+	else
+		LOG_INFO("Created Tiled Lighting Render Pass!");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Frame & material sets, once per command buffer. Models then only push their own constants
+void VulkanRenderer::BindSceneDescriptorSets(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline, uint32_t frameIndex)
+{
+	m_pFrameGlobals->BindDescriptorSet(cmdBuffer, pPipeline->m_vkPipelineLayout, frameIndex);
+	MaterialRegistry::getInstance().BindDescriptorSet(cmdBuffer, pPipeline->m_vkPipelineLayout);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void VulkanRenderer::RecordCommands(uint32_t currentImage)
+void VulkanRenderer::RecordCommands(uint32_t frameIndex)
 {
 	// Information about how to begin each command buffer
 	VkCommandBufferBeginInfo bufferBeginInfo = {};
@@ -690,9 +914,12 @@ void VulkanRenderer::RecordCommands(uint32_t currentImage)
 	// Information about how to begin a render pass (only needed for graphical applications) 
 	VkRenderPassBeginInfo renderPassBeginInfo = {};
 	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = m_vkRenderPass;						// Render pass to begin
+	// Debug views keep the subpass path, they are permutations of the deferred fragment shader
+	bool bTiledLighting = m_bTiledLighting && m_iRecordedPassID == 0;
+
+	renderPassBeginInfo.renderPass = bTiledLighting ? m_vkRenderPassTiledLighting : m_vkRenderPass;	// Render pass to begin
 	renderPassBeginInfo.renderArea.offset = { 0,0 };						// start point of render pass in pixels
-	renderPassBeginInfo.renderArea.extent = m_pSwapChain->m_vkSwapchainExtent;			// size of region to run render pass on (starting at offset) 
+	renderPassBeginInfo.renderArea.extent = m_vkRenderExtent;								// size of region to run render pass on (starting at offset) 
 
 	std::array<VkClearValue, 9> clearValues = {};
 
@@ -709,54 +936,467 @@ void VulkanRenderer::RecordCommands(uint32_t currentImage)
 	renderPassBeginInfo.pClearValues = clearValues.data();								// list of clear values
 	renderPassBeginInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
 
-	renderPassBeginInfo.framebuffer = m_pFrameBuffer->m_vecFramebuffers[currentImage];
+	renderPassBeginInfo.framebuffer = m_pFrameBuffer->m_vecFramebuffers[frameIndex];
+
+	// Secondary buffers & timing readback need to know which extent this frame was recorded with
+	m_vecRecordedRenderExtent[frameIndex] = m_vkRenderExtent;
 
 	// start recording commands to command buffer
-	if (vkBeginCommandBuffer(m_pDevice->m_vecCommandBufferGraphics[currentImage], &bufferBeginInfo) != VK_SUCCESS)
+	if (vkBeginCommandBuffer(m_pDevice->m_vecCommandBufferGraphics[frameIndex], &bufferBeginInfo) != VK_SUCCESS)
 	{
 		LOG_ERROR("Failed to begin recording command buffer...");
 	}
 	else
 	{
-		// Begin Render Pass
-		vkCmdBeginRenderPass(m_pDevice->m_vecCommandBufferGraphics[currentImage], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+		// Queries can't be reset inside render pass, frame timestamp starts right after
+		VkQueryPool vkTimestampPool = m_vecTimestampQueryPools.empty() ? VK_NULL_HANDLE : m_vecTimestampQueryPools[frameIndex];
+		if (vkTimestampPool != VK_NULL_HANDLE)
+		{
+			vkCmdResetQueryPool(m_pDevice->m_vecCommandBufferGraphics[frameIndex], vkTimestampPool, 0, 4);
+			vkCmdWriteTimestamp(m_pDevice->m_vecCommandBufferGraphics[frameIndex], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vkTimestampPool, 2);
+		}
+
+		// Bin local lights before render pass, only camera & light list change per frame. Tiled path culls per tile
+		if (!bTiledLighting)
+			m_pClusteredLighting->RecordBinning(m_pDevice->m_vecCommandBufferGraphics[frameIndex], frameIndex);
+
+		if (m_bGPUDriven)
+		{
+			VkCommandBuffer cmdBuffer = m_pDevice->m_vecCommandBufferGraphics[frameIndex];
+
+			// Cull on GPU before render pass, fills indirect commands & counts
+			VkDescriptorSet vkHiZSet = m_pHiZPass->GetCullDescriptorSet();
+			if (m_bOcclusionCulling)
+			{
+				// Last frame's visible set, seen from this frame's camera, becomes depth of the Hi-Z pyramid
+				m_pGPUDrivenPass->RecordCulling(cmdBuffer, frameIndex, GPUCullPhase::OCCLUDERS, vkHiZSet);
+
+				m_pHiZPass->BeginOccluderPass(cmdBuffer, frameIndex, m_vkRenderExtent);
+				BindSceneDescriptorSets(cmdBuffer, m_pHiZPass->GetOccluderPipeline(), frameIndex);
+				m_pGPUDrivenPass->RecordDraws(cmdBuffer, m_pHiZPass->GetOccluderPipeline(), frameIndex);
+				m_pHiZPass->EndOccluderPass(cmdBuffer);
 
-		// Bind Pipeline to be used Skydome!
-		vkCmdBindPipeline(m_pDevice->m_vecCommandBufferGraphics[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineSkydome->m_vkGraphicsPipeline);
-		m_pScene->RenderSkydome(m_pDevice, m_pGraphicsPipelineSkydome, currentImage);
+				m_pHiZPass->RecordBuild(cmdBuffer, frameIndex, m_vkRenderExtent);
 
-		// Bind Pipeline to be used in render pass
-		vkCmdBindPipeline(m_pDevice->m_vecCommandBufferGraphics[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineGBuffer->m_vkGraphicsPipeline);
-		m_pScene->RenderOpaque(m_pDevice, m_pGraphicsPipelineGBuffer, currentImage);
+				m_pGPUDrivenPass->RecordCulling(cmdBuffer, frameIndex, GPUCullPhase::OCCLUSION, vkHiZSet);
+			}
+			else
+			{
+				m_pGPUDrivenPass->RecordCulling(cmdBuffer, frameIndex, GPUCullPhase::FRUSTUM, vkHiZSet);
+			}
+
+			// Few commands only, no need for secondary buffers
+			vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+			Helper::Vulkan::SetViewportScissor(cmdBuffer, m_vkRenderExtent);
+
+			// Frame & material sets stay bound across all permutations of both pipelines, their layouts match
+			BindSceneDescriptorSets(cmdBuffer, m_pGraphicsPipelineGBuffer, frameIndex);
+			m_pGPUDrivenPass->RecordDraws(cmdBuffer, m_pGraphicsPipelineGBuffer, frameIndex);
+			m_pScene->RenderInstanced(m_pDevice, cmdBuffer, m_pGraphicsPipelineGBufferInstanced, m_pFrameGlobals->GetDrawArgsBuffer(frameIndex));
+		}
+		else
+		{
+			// Queries can't be reset inside render pass
+			if (!m_vecStatisticsQueryPools.empty())
+			{
+				VkQueryPool vkQueryPool = m_vecStatisticsQueryPools[frameIndex];
+				vkCmdResetQueryPool(m_pDevice->m_vecCommandBufferGraphics[frameIndex], vkQueryPool, 0, static_cast<uint32_t>(m_vecThreadCommandPools[frameIndex].size()));
+			}
+
+			// Begin Render Pass, first subpass content comes from secondary command buffers!
+			vkCmdBeginRenderPass(m_pDevice->m_vecCommandBufferGraphics[frameIndex], &renderPassBeginInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+
+			// Depth pre-pass + Opaque G-Buffer draws recorded in parallel, stitched back in order
+			std::vector<VkCommandBuffer> vecSecondaryBuffers = RecordGBufferSecondaries(frameIndex, m_uiRecordThreadCount, 1);
+			vkCmdExecuteCommands(m_pDevice->m_vecCommandBufferGraphics[frameIndex], static_cast<uint32_t>(vecSecondaryBuffers.size()), vecSecondaryBuffers.data());
+		}
 		
 		// Start second subpass
-		vkCmdNextSubpass(m_pDevice->m_vecCommandBufferGraphics[currentImage], VK_SUBPASS_CONTENTS_INLINE);
-		vkCmdBindPipeline(m_pDevice->m_vecCommandBufferGraphics[currentImage], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineDeferred->m_vkGraphicsPipeline);
-		vkCmdBindDescriptorSets(m_pDevice->m_vecCommandBufferGraphics[currentImage],
+		vkCmdNextSubpass(m_pDevice->m_vecCommandBufferGraphics[frameIndex], VK_SUBPASS_CONTENTS_INLINE);
+
+		// Dynamic state set by secondary buffers doesn't carry over to primary
+		Helper::Vulkan::SetViewportScissor(m_pDevice->m_vecCommandBufferGraphics[frameIndex], m_vkRenderExtent);
+
+		if (vkTimestampPool != VK_NULL_HANDLE && !bTiledLighting)
+			vkCmdWriteTimestamp(m_pDevice->m_vecCommandBufferGraphics[frameIndex], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vkTimestampPool, 0);
+
+		// Debug views are their own permutations, lit result (0) carries no debug code
+		VkPipeline vkDeferredPipeline = m_pGraphicsPipelineDeferred->GetPermutation(static_cast<uint32_t>(m_iRecordedPassID));
+		vkCmdBindPipeline(m_pDevice->m_vecCommandBufferGraphics[frameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, vkDeferredPipeline);
+		vkCmdBindDescriptorSets(m_pDevice->m_vecCommandBufferGraphics[frameIndex],
 								VK_PIPELINE_BIND_POINT_GRAPHICS,
 								m_pGraphicsPipelineDeferred->m_vkPipelineLayout,
-								0, 1, &m_vecDeferredPassDescriptorSets[currentImage],
+								0, 1, &m_vecDeferredPassDescriptorSets[frameIndex],
 								0, nullptr);
 
-		// Draw full screen triangle
-		vkCmdDraw(m_pDevice->m_vecCommandBufferGraphics[currentImage], 3, 1, 0, 0);
+		VkDescriptorSet vkClusterSet = m_pClusteredLighting->GetDescriptorSet(frameIndex);
+		vkCmdBindDescriptorSets(m_pDevice->m_vecCommandBufferGraphics[frameIndex],
+								VK_PIPELINE_BIND_POINT_GRAPHICS,
+								m_pGraphicsPipelineDeferred->m_vkPipelineLayout,
+								1, 1, &vkClusterSet,
+								0, nullptr);
+
+		// Draw full screen triangle, lights geometry pixels only
+		if (!bTiledLighting)
+			vkCmdDraw(m_pDevice->m_vecCommandBufferGraphics[frameIndex], 3, 1, 0, 0);
+
+		// Composite sky pixels, compatible layout so deferred descriptor set stays bound
+		vkCmdBindPipeline(m_pDevice->m_vecCommandBufferGraphics[frameIndex], VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineDeferredSky->m_vkGraphicsPipeline);
+		vkCmdDraw(m_pDevice->m_vecCommandBufferGraphics[frameIndex], 3, 1, 0, 0);
+
+		if (vkTimestampPool != VK_NULL_HANDLE && !bTiledLighting)
+			vkCmdWriteTimestamp(m_pDevice->m_vecCommandBufferGraphics[frameIndex], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkTimestampPool, 1);
 
 		// End Render Pass
-		vkCmdEndRenderPass(m_pDevice->m_vecCommandBufferGraphics[currentImage]);
+		vkCmdEndRenderPass(m_pDevice->m_vecCommandBufferGraphics[frameIndex]);
+
+		// Draw counts are read back on host once this frame's fence signals
+		if (m_bGPUDriven)
+			m_pGPUDrivenPass->RecordReadbackBarrier(m_pDevice->m_vecCommandBufferGraphics[frameIndex], frameIndex);
+
+		// Light stored G-Buffer in compute, same timestamps as lighting subpass so both paths compare directly
+		if (bTiledLighting)
+		{
+			if (vkTimestampPool != VK_NULL_HANDLE)
+				vkCmdWriteTimestamp(m_pDevice->m_vecCommandBufferGraphics[frameIndex], VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, vkTimestampPool, 0);
+
+			m_pTiledLightingPass->RecordLighting(m_pDevice->m_vecCommandBufferGraphics[frameIndex], frameIndex, m_vkRenderExtent, vkClusterSet);
+
+			if (vkTimestampPool != VK_NULL_HANDLE)
+				vkCmdWriteTimestamp(m_pDevice->m_vecCommandBufferGraphics[frameIndex], VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, vkTimestampPool, 1);
+		}
 	}
 	
 
 	// finish recording to command buffer
-	if (vkEndCommandBuffer(m_pDevice->m_vecCommandBufferGraphics[currentImage]) != VK_SUCCESS)
+	if (vkEndCommandBuffer(m_pDevice->m_vecCommandBufferGraphics[frameIndex]) != VK_SUCCESS)
 		LOG_ERROR("Failed to record command buffer!");
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+// Only work touching the acquired swapchain image, tiny & re-recorded every frame since image index changes.
+// Keeps cached frame command buffers independent of which image they end up presented in!
+void VulkanRenderer::RecordPresent(uint32_t frameIndex, uint32_t imageIndex)
+{
+	VkCommandBuffer cmdBuffer = m_pDevice->m_vecCommandBufferPresent[frameIndex];
+
+	VkCommandBufferBeginInfo bufferBeginInfo = {};
+	bufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	bufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (vkBeginCommandBuffer(cmdBuffer, &bufferBeginInfo) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to begin recording present command buffer...");
+		return;
+	}
+
+	// Render extent subrect of scene color to swapchain image
+	m_pUpscalePass->RecordUpscale(cmdBuffer, frameIndex, imageIndex, m_vecRecordedRenderExtent[frameIndex],
+								  static_cast<UpscaleMode>(m_iUpscaleMode), m_fSharpness);
+
+	// Frame timestamp end, pool was reset by this frame's graphics command buffer submitted just before
+	if (!m_vecTimestampQueryPools.empty())
+		vkCmdWriteTimestamp(cmdBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_vecTimestampQueryPools[frameIndex], 3);
+
+	if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS)
+		LOG_ERROR("Failed to record present command buffer!");
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Command buffers are recorded once & re-submitted every frame, since all per-frame data flows through uniforms.
+// Anything that changes the command stream itself (models added/removed, resize, pass change) must call this!
+void VulkanRenderer::MarkCommandBuffersDirty()
+{
+	m_vecCommandBufferDirty.assign(m_pSwapChain->m_uiFramesInFlight, true);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void VulkanRenderer::CreateThreadCommandPools()
+{
+	// one slot for depth pre-pass + one per worker thread
+	uint32_t nSlots = m_pThreadPool->GetThreadCount() + 1;
+
+	m_vecThreadCommandPools.resize(m_pSwapChain->m_uiFramesInFlight);
+
+	for (uint32_t i = 0; i < m_vecThreadCommandPools.size(); ++i)
+	{
+		m_vecThreadCommandPools[i].resize(nSlots);
+
+		for (uint32_t j = 0; j < nSlots; ++j)
+		{
+			// No RESET_COMMAND_BUFFER_BIT, whole pool is reset at once before re-recording!
+			VkCommandPoolCreateInfo poolCreateInfo = {};
+			poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+			poolCreateInfo.flags = 0;
+			poolCreateInfo.queueFamilyIndex = m_pDevice->m_pQueueFamilyIndices->m_uiGraphicsFamily.value();
+
+			if (vkCreateCommandPool(m_pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &m_vecThreadCommandPools[i][j].vkCommandPool) != VK_SUCCESS)
+			{
+				LOG_ERROR("Failed to create Thread Command Pool!");
+				continue;
+			}
+
+			VkCommandBufferAllocateInfo allocInfo = {};
+			allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			allocInfo.commandPool = m_vecThreadCommandPools[i][j].vkCommandPool;
+			allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;					// executed from primary via vkCmdExecuteCommands
+			allocInfo.commandBufferCount = 1;
+
+			if (vkAllocateCommandBuffers(m_pDevice->m_vkLogicalDevice, &allocInfo, &m_vecThreadCommandPools[i][j].vkCommandBuffer) != VK_SUCCESS)
+			{
+				LOG_ERROR("Failed to allocate secondary Command buffer!");
+			}
+		}
+	}
+
+	LOG_DEBUG("Created {0} Thread Command Pools per frame in flight", nSlots);
+
+	m_vecRecordedJobCount.assign(m_pSwapChain->m_uiFramesInFlight, 0);
+
+	// Fragment shader invocations, one query per job slot since queries can't span vkCmdExecuteCommands
+	if (m_pDevice->m_bSupportsPipelineStatistics)
+	{
+		m_vecStatisticsQueryPools.resize(m_pSwapChain->m_uiFramesInFlight);
+
+		for (uint32_t i = 0; i < m_vecStatisticsQueryPools.size(); ++i)
+		{
+			VkQueryPoolCreateInfo queryPoolInfo = {};
+			queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+			queryPoolInfo.queryCount = nSlots;
+			queryPoolInfo.pipelineStatistics = VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+
+			if (vkCreateQueryPool(m_pDevice->m_vkLogicalDevice, &queryPoolInfo, nullptr, &m_vecStatisticsQueryPools[i]) != VK_SUCCESS)
+			{
+				LOG_ERROR("Failed to create Pipeline Statistics Query Pool!");
+			}
+		}
+	}
+
+	// Deferred lighting pass & whole frame GPU time, frame time drives dynamic resolution
+	if (m_pDevice->m_vkDeviceProperties.limits.timestampComputeAndGraphics)
+	{
+		m_vecTimestampQueryPools.resize(m_pSwapChain->m_uiFramesInFlight);
+
+		for (uint32_t i = 0; i < m_vecTimestampQueryPools.size(); ++i)
+		{
+			VkQueryPoolCreateInfo queryPoolInfo = {};
+			queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+			queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+			queryPoolInfo.queryCount = 4;
+
+			if (vkCreateQueryPool(m_pDevice->m_vkLogicalDevice, &queryPoolInfo, nullptr, &m_vecTimestampQueryPools[i]) != VK_SUCCESS)
+			{
+				LOG_ERROR("Failed to create Timestamp Query Pool!");
+			}
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void VulkanRenderer::CleanupThreadCommandPools()
+{
+	for (uint32_t i = 0; i < m_vecThreadCommandPools.size(); ++i)
+	{
+		for (uint32_t j = 0; j < m_vecThreadCommandPools[i].size(); ++j)
+		{
+			// destroying pool frees its command buffers
+			vkDestroyCommandPool(m_pDevice->m_vkLogicalDevice, m_vecThreadCommandPools[i][j].vkCommandPool, nullptr);
+		}
+	}
+
+	m_vecThreadCommandPools.clear();
+
+	for (VkQueryPool vkQueryPool : m_vecStatisticsQueryPools)
+	{
+		vkDestroyQueryPool(m_pDevice->m_vkLogicalDevice, vkQueryPool, nullptr);
+	}
+
+	m_vecStatisticsQueryPools.clear();
+	m_vecRecordedJobCount.clear();
+
+	for (VkQueryPool vkQueryPool : m_vecTimestampQueryPools)
+	{
+		vkDestroyQueryPool(m_pDevice->m_vkLogicalDevice, vkQueryPool, nullptr);
+	}
+
+	m_vecTimestampQueryPools.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Records first subpass of the render pass into secondary command buffers using nThreads jobs. Job slot 0 records 
+// depth pre-pass of whole queue & remaining jobs get a contiguous range of the sorted render queue each.
+// uiRepeat > 1 records same draws multiple times which is only used to benchmark recording with large draw counts!
+// Returns buffers in execution order.
+std::vector<VkCommandBuffer> VulkanRenderer::RecordGBufferSecondaries(uint32_t frameIndex, uint32_t nThreads, uint32_t uiRepeat)
+{
+	std::vector<ThreadCommandPool>& vecPools = m_vecThreadCommandPools[frameIndex];
+
+	// Sorted once, jobs only read it
+	m_pScene->BuildRenderQueue();
+
+	uint32_t nItems = m_pScene->GetRenderItemCount();
+	uint32_t nJobs = std::clamp(std::min(nThreads, nItems), 1u, static_cast<uint32_t>(vecPools.size() - 1));
+	uint32_t nItemsPerJob = (nItems + nJobs - 1) / nJobs;
+
+	// Index matches RenderPipelineID. Instanced groups aren't part of pre-pass & keep regular depth test!
+	VulkanGraphicsPipeline* pGBufferOpaque = m_bDepthPrepass ? m_pGraphicsPipelineGBufferDepthEqual : m_pGraphicsPipelineGBuffer;
+	std::vector<VulkanGraphicsPipeline*> vecPipelines = { pGBufferOpaque, m_pGraphicsPipelineGBufferInstanced };
+	std::vector<RenderQueueStats> vecJobStats(nJobs);
+
+	VkQueryPool vkQueryPool = m_vecStatisticsQueryPools.empty() ? VK_NULL_HANDLE : m_vecStatisticsQueryPools[frameIndex];
+	m_vecRecordedJobCount[frameIndex] = nJobs;
+
+	// Dynamic state isn't inherited either, every secondary sets its own viewport
+	VkExtent2D renderExtent = m_vkRenderExtent;
+
+	// Culling & LOD reach recorded draws through this frame's indirect arguments
+	VkBuffer vkDrawArgs = m_pFrameGlobals->GetDrawArgsBuffer(frameIndex);
+
+	// All secondary buffers continue the render pass in first subpass
+	VkCommandBufferInheritanceInfo inheritanceInfo = {};
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritanceInfo.renderPass = m_vkRenderPass;
+	inheritanceInfo.subpass = 0;
+	inheritanceInfo.framebuffer = m_pFrameBuffer->m_vecFramebuffers[frameIndex];
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+	// Depth pre-pass, must come before any G-Buffer job. Empty when disabled!
+	m_pThreadPool->Enqueue([=, &vecPools]()
+	{
+		VkCommandBuffer cmdBuffer = vecPools[0].vkCommandBuffer;
+		vkResetCommandPool(m_pDevice->m_vkLogicalDevice, vecPools[0].vkCommandPool, 0);
+		vkBeginCommandBuffer(cmdBuffer, &beginInfo);
+		Helper::Vulkan::SetViewportScissor(cmdBuffer, renderExtent);
+
+		if (m_bDepthPrepass)
+		{
+			BindSceneDescriptorSets(cmdBuffer, m_pGraphicsPipelineDepthPrepass, frameIndex);
+			m_pScene->RenderDepthPrepass(cmdBuffer, m_pGraphicsPipelineDepthPrepass, vkDrawArgs);
+		}
+
+		if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS)
+			LOG_ERROR("Failed to record Depth Pre-Pass secondary command buffer!");
+	});
+
+	// Opaque & instanced models, pipeline state isn't inherited by secondary buffers so each job binds its own!
+	for (uint32_t job = 0; job < nJobs; ++job)
+	{
+		uint32_t uiFirstItem = job * nItemsPerJob;
+		ThreadCommandPool* pPool = &vecPools[job + 1];
+		RenderQueueStats* pStats = &vecJobStats[job];
+
+		m_pThreadPool->Enqueue([=, &vecPipelines]()
+		{
+			VkCommandBuffer cmdBuffer = pPool->vkCommandBuffer;
+			vkResetCommandPool(m_pDevice->m_vkLogicalDevice, pPool->vkCommandPool, 0);
+			vkBeginCommandBuffer(cmdBuffer, &beginInfo);
+			Helper::Vulkan::SetViewportScissor(cmdBuffer, renderExtent);
+
+			if (vkQueryPool != VK_NULL_HANDLE)
+				vkCmdBeginQuery(cmdBuffer, vkQueryPool, job + 1, 0);
+
+			// Once per job, all G-Buffer layouts share frame & material sets so model binds leave them intact
+			BindSceneDescriptorSets(cmdBuffer, m_pGraphicsPipelineGBuffer, frameIndex);
+
+			for (uint32_t r = 0; r < uiRepeat; ++r)
+			{
+				m_pScene->RenderOpaque(cmdBuffer, vecPipelines, vkDrawArgs, uiFirstItem, nItemsPerJob, *pStats);
+			}
+
+			if (vkQueryPool != VK_NULL_HANDLE)
+				vkCmdEndQuery(cmdBuffer, vkQueryPool, job + 1);
+
+			if (vkEndCommandBuffer(cmdBuffer) != VK_SUCCESS)
+				LOG_ERROR("Failed to record G-Buffer secondary command buffer!");
+		});
+	}
+
+	m_pThreadPool->Wait();
+
+	// Benchmark repeats would inflate bind counts
+	if (uiRepeat == 1)
+	{
+		RenderQueueStats stats;
+		for (const RenderQueueStats& jobStats : vecJobStats)
+		{
+			stats.Accumulate(jobStats);
+		}
+
+		m_pScene->SetRenderStats(stats);
+	}
+
+	std::vector<VkCommandBuffer> vecSecondaryBuffers;
+	for (uint32_t i = 0; i <= nJobs; ++i)
+	{
+		vecSecondaryBuffers.push_back(vecPools[i].vkCommandBuffer);
+	}
+
+	return vecSecondaryBuffers;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Records G-Buffer pass with increasing thread counts & logs timings. Scene draws are repeated to reach ~10k draws so
+// that numbers mean something even for small scenes. Device must be idle, all command buffers are dirty afterwards!
+void VulkanRenderer::RunRecordingBenchmark()
+{
+	vkDeviceWaitIdle(m_pDevice->m_vkLogicalDevice);
+
+	uint32_t nDrawsPerScene = 0;
+	for (Model* pModel : m_pScene->GetModelList())
+	{
+		nDrawsPerScene += (pModel != nullptr) ? pModel->GetMeshCount() : 0;
+	}
+
+	const uint32_t nTargetDraws = 10000;
+	const uint32_t nIterations = 20;
+	uint32_t uiRepeat = std::max(1u, nTargetDraws / std::max(1u, nDrawsPerScene));
+
+	// 1, 2, 4, 8 ... & max thread count
+	std::vector<uint32_t> vecThreadCounts;
+	for (uint32_t n = 1; n < m_pThreadPool->GetThreadCount(); n *= 2)
+	{
+		vecThreadCounts.push_back(n);
+	}
+	vecThreadCounts.push_back(m_pThreadPool->GetThreadCount());
+
+	LOG_INFO("---- Command recording benchmark : {0} models, {1} draws per frame ----", m_pScene->GetModelCount(), nDrawsPerScene * uiRepeat);
+
+	float fSingleThreadMs = 0.0f;
+	for (uint32_t nThreads : vecThreadCounts)
+	{
+		// warm up
+		RecordGBufferSecondaries(0, nThreads, uiRepeat);
+
+		auto timeStart = std::chrono::high_resolution_clock::now();
+		for (uint32_t i = 0; i < nIterations; ++i)
+		{
+			RecordGBufferSecondaries(0, nThreads, uiRepeat);
+		}
+		auto timeEnd = std::chrono::high_resolution_clock::now();
+
+		float fMs = std::chrono::duration<float, std::milli>(timeEnd - timeStart).count() / nIterations;
+		if (nThreads == 1)
+			fSingleThreadMs = fMs;
+
+		LOG_INFO("{0:2d} threads : {1:.3f} ms | speedup {2:.2f}x", nThreads, fMs, fSingleThreadMs / fMs);
+	}
+
+	MarkCommandBuffersDirty();
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanRenderer::CreateSyncObjects()
 {
-	m_vecSemaphoreImageAvailable.resize(Helper::App::MAX_FRAME_DRAWS);
-	m_vecSemaphoreRenderFinished.resize(Helper::App::MAX_FRAME_DRAWS);
-	m_vecFencesRender.resize(Helper::App::MAX_FRAME_DRAWS);
+	// Acquire & fence belong to the frame, present waits on whatever rendered into the image it presents
+	m_vecSemaphoreImageAvailable.resize(m_pSwapChain->m_uiFramesInFlight);
+	m_vecSemaphoreRenderFinished.resize(m_pSwapChain->m_vecSwapchainImages.size());
+	m_vecFencesRender.resize(m_pSwapChain->m_uiFramesInFlight);
 
 	// Semaphore create information
 	VkSemaphoreCreateInfo semaphoreCreateInfo{};
@@ -770,17 +1410,41 @@ void VulkanRenderer::CreateSyncObjects()
 	fenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 	fenceCreateInfo.pNext = nullptr;
 
-	for (uint32_t i = 0; i < Helper::App::MAX_FRAME_DRAWS; ++i)
+	for (uint32_t i = 0; i < m_pSwapChain->m_uiFramesInFlight; ++i)
 	{
 		if (vkCreateSemaphore(m_pDevice->m_vkLogicalDevice, &semaphoreCreateInfo, nullptr, &m_vecSemaphoreImageAvailable[i]) != VK_SUCCESS ||
-			vkCreateSemaphore(m_pDevice->m_vkLogicalDevice, &semaphoreCreateInfo, nullptr, &m_vecSemaphoreRenderFinished[i]) != VK_SUCCESS ||
 			vkCreateFence(m_pDevice->m_vkLogicalDevice, &fenceCreateInfo, nullptr, &m_vecFencesRender[i]) != VK_SUCCESS)
 		{
 			LOG_ERROR("Failed to create Semaphores & fences!");
 		}
-		else
-			LOG_INFO("Created Semaphores & fences!");
 	}
+
+	for (uint32_t i = 0; i < m_vecSemaphoreRenderFinished.size(); ++i)
+	{
+		if (vkCreateSemaphore(m_pDevice->m_vkLogicalDevice, &semaphoreCreateInfo, nullptr, &m_vecSemaphoreRenderFinished[i]) != VK_SUCCESS)
+		{
+			LOG_ERROR("Failed to create Semaphores & fences!");
+		}
+	}
+
+	LOG_INFO("Created Semaphores & fences for {0} frames in flight!", m_pSwapChain->m_uiFramesInFlight);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void VulkanRenderer::CleanupSyncObjects()
+{
+	for (VkSemaphore vkSemaphore : m_vecSemaphoreImageAvailable)
+		vkDestroySemaphore(m_pDevice->m_vkLogicalDevice, vkSemaphore, nullptr);
+
+	for (VkSemaphore vkSemaphore : m_vecSemaphoreRenderFinished)
+		vkDestroySemaphore(m_pDevice->m_vkLogicalDevice, vkSemaphore, nullptr);
+
+	for (VkFence vkFence : m_vecFencesRender)
+		vkDestroyFence(m_pDevice->m_vkLogicalDevice, vkFence, nullptr);
+
+	m_vecSemaphoreImageAvailable.clear();
+	m_vecSemaphoreRenderFinished.clear();
+	m_vecFencesRender.clear();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -796,38 +1460,45 @@ void VulkanRenderer::UpdateDeferredUniforms(uint32_t index)
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanRenderer::CreateDeferredPassDescriptorPool()
 {
-	m_pDeferredUniforms = new DeferredPassUniforms();
+	// Created once, resize & frames in flight changes only recreate its buffers (freed in CleanupOnWindowResize)
+	if (m_pDeferredUniforms == nullptr)
+		m_pDeferredUniforms = new DeferredPassUniforms();
+
 	m_pDeferredUniforms->CreateBuffers(m_pDevice, m_pSwapChain);
 	
 	// *** INPUT ATTACHMENT DESCRIPTOR POOL
 	// 8 Attachments : Color + Depth + Normal + Position + PBR + Emissive + Background + ObjectID
-	std::array<VkDescriptorPoolSize, 12> arrDescriptorPoolSize = {};
-	for (int i = 0; i < arrDescriptorPoolSize.size() - 3; ++i)
+	std::array<VkDescriptorPoolSize, 13> arrDescriptorPoolSize = {};
+	for (int i = 0; i < 8; ++i)
 	{
 		arrDescriptorPoolSize[i].type = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
-		arrDescriptorPoolSize[i].descriptorCount = static_cast<uint32_t>(m_pSwapChain->m_vecSwapchainImages.size());
+		arrDescriptorPoolSize[i].descriptorCount = m_pSwapChain->m_uiFramesInFlight;
 	}
 
 	// Uniform Buffer data
 	arrDescriptorPoolSize[8].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-	arrDescriptorPoolSize[8].descriptorCount = static_cast<uint32_t>(m_pSwapChain->m_vecSwapchainImages.size());
+	arrDescriptorPoolSize[8].descriptorCount = m_pSwapChain->m_uiFramesInFlight;
 
 	// Irradiance Map sampler
 	arrDescriptorPoolSize[9].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorPoolSize[9].descriptorCount = 1;
+	arrDescriptorPoolSize[9].descriptorCount = m_pSwapChain->m_uiFramesInFlight;
 
 	// Prefiltered SpecMap sampler
 	arrDescriptorPoolSize[10].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorPoolSize[10].descriptorCount = 1;
+	arrDescriptorPoolSize[10].descriptorCount = m_pSwapChain->m_uiFramesInFlight;
 
 	// BRDF LUT sampler
 	arrDescriptorPoolSize[11].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorPoolSize[11].descriptorCount = 1;
+	arrDescriptorPoolSize[11].descriptorCount = m_pSwapChain->m_uiFramesInFlight;
+
+	// Equirect HDRI sampler for sky
+	arrDescriptorPoolSize[12].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	arrDescriptorPoolSize[12].descriptorCount = m_pSwapChain->m_uiFramesInFlight;
 
 	// Create input attachment pool
 	VkDescriptorPoolCreateInfo inputPoolCreateInfo = {};
 	inputPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	inputPoolCreateInfo.maxSets = m_pSwapChain->m_vecSwapchainImages.size();
+	inputPoolCreateInfo.maxSets = m_pSwapChain->m_uiFramesInFlight;
 	inputPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrDescriptorPoolSize.size());
 	inputPoolCreateInfo.pPoolSizes = arrDescriptorPoolSize.data();
 
@@ -843,7 +1514,7 @@ void VulkanRenderer::CreateDeferredPassDescriptorPool()
 void VulkanRenderer::CreateDeferredPassDescriptorSetLayout()
 {
 	//-- Create Descriptor Set Layout! 
-	std::array<VkDescriptorSetLayoutBinding, 9> arrDescriptorSeLayoutBindings;
+	std::array<VkDescriptorSetLayoutBinding, 13> arrDescriptorSeLayoutBindings;
 
 	// Color input binding 
 	arrDescriptorSeLayoutBindings[0].binding = 0;
@@ -900,6 +1571,17 @@ void VulkanRenderer::CreateDeferredPassDescriptorSetLayout()
 	arrDescriptorSeLayoutBindings[8].stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;	// Shader stage to bind to
 	arrDescriptorSeLayoutBindings[8].pImmutableSamplers = nullptr;
 
+	// IBL samplers, built once per environment by VulkanTextureCUBE : Irradiance, Prefiltered Specular, BRDF LUT.
+	// Last one is equirect HDRI sampled by the sky
+	for (uint32_t i = 9; i < arrDescriptorSeLayoutBindings.size(); ++i)
+	{
+		arrDescriptorSeLayoutBindings[i].binding = i;
+		arrDescriptorSeLayoutBindings[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		arrDescriptorSeLayoutBindings[i].descriptorCount = 1;
+		arrDescriptorSeLayoutBindings[i].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		arrDescriptorSeLayoutBindings[i].pImmutableSamplers = nullptr;
+	}
+
 	VkDescriptorSetLayoutCreateInfo inputLayoutCreateInfo = {};
 	inputLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
 	inputLayoutCreateInfo.bindingCount = arrDescriptorSeLayoutBindings.size();
@@ -918,15 +1600,15 @@ void VulkanRenderer::CreateDeferredPassDescriptorSetLayout()
 void VulkanRenderer::CreateDeferredPassDescriptorSets()
 {
 	// Resize array to hold descriptor set for each swap chain image
-	m_vecDeferredPassDescriptorSets.resize(m_pSwapChain->m_vecSwapchainImages.size());
+	m_vecDeferredPassDescriptorSets.resize(m_pSwapChain->m_uiFramesInFlight);
 
 	// Fill array of layouts ready for set creation
-	std::vector<VkDescriptorSetLayout> setLayouts(m_pSwapChain->m_vecSwapchainImages.size(), m_vkDeferredPassDescriptorSetLayout);
+	std::vector<VkDescriptorSetLayout> setLayouts(m_pSwapChain->m_uiFramesInFlight, m_vkDeferredPassDescriptorSetLayout);
 
 	VkDescriptorSetAllocateInfo setAllocInfo = {};
 	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	setAllocInfo.descriptorPool = m_vkDeferredPassDescriptorPool;
-	setAllocInfo.descriptorSetCount = static_cast<uint32_t>(m_pSwapChain->m_vecSwapchainImages.size());
+	setAllocInfo.descriptorSetCount = m_pSwapChain->m_uiFramesInFlight;
 	setAllocInfo.pSetLayouts = setLayouts.data();
 
 	// Allocate Descriptor Sets
@@ -941,7 +1623,7 @@ void VulkanRenderer::CreateDeferredPassDescriptorSets()
 		LOG_DEBUG("Successfully created Input Descriptor sets");
 
 	// Update each descriptor set with input attachment
-	for (uint32_t i = 0; i < m_pSwapChain->m_vecSwapchainImages.size(); i++)
+	for (uint32_t i = 0; i < m_pSwapChain->m_uiFramesInFlight; i++)
 	{
 		// color attachment descriptor
 		VkDescriptorImageInfo colorAttachmentDescriptor = {};
@@ -961,7 +1643,7 @@ void VulkanRenderer::CreateDeferredPassDescriptorSets()
 
 		// depth attachment descriptor
 		VkDescriptorImageInfo depthAttachmentDescriptor = {};
-		depthAttachmentDescriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		depthAttachmentDescriptor.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;		// matches subpass 2 reference
 		depthAttachmentDescriptor.imageView = m_pFrameBuffer->m_pDepthAttachment->vecAttachmentImageView[i];
 		depthAttachmentDescriptor.sampler = VK_NULL_HANDLE;
 
@@ -1075,7 +1757,7 @@ void VulkanRenderer::CreateDeferredPassDescriptorSets()
 		VkDescriptorBufferInfo ubBufferInfo = {};
 		ubBufferInfo.buffer = m_pDeferredUniforms->vecBuffer[i];			
 		ubBufferInfo.offset = 0;											
-		ubBufferInfo.range = sizeof(DeferredPassUniforms);						
+		ubBufferInfo.range = sizeof(DeferredPassShaderData);						
 
 		// Data about connection between binding & buffer
 		VkWriteDescriptorSet ubSetWrite = {};
@@ -1087,9 +1769,40 @@ void VulkanRenderer::CreateDeferredPassDescriptorSets()
 		ubSetWrite.descriptorCount = 1;										
 		ubSetWrite.pBufferInfo = &ubBufferInfo;
 
+		//-- IBL maps & sky HDRI, same for every frame
+		VulkanTextureCUBE* pIBL = HDRISkydome::getInstance().m_pIBL;
+
+		std::array<VkDescriptorImageInfo, 4> arrIBLDescriptors = {};
+		arrIBLDescriptors[0].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrIBLDescriptors[0].imageView = pIBL->m_vkImageViewIRRAD;
+		arrIBLDescriptors[0].sampler = pIBL->m_vkSamplerIRRAD;
+
+		arrIBLDescriptors[1].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrIBLDescriptors[1].imageView = pIBL->m_vkImageViewPrefilterSpec;
+		arrIBLDescriptors[1].sampler = pIBL->m_vkSamplerPrefilterSpec;
+
+		arrIBLDescriptors[2].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrIBLDescriptors[2].imageView = pIBL->m_vkImageViewBRDF;
+		arrIBLDescriptors[2].sampler = pIBL->m_vkSamplerBRDF;
+
+		VulkanTexture2D* pHDRI = HDRISkydome::getInstance().m_pHDRI;
+		arrIBLDescriptors[3].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		arrIBLDescriptors[3].imageView = pHDRI->m_vkTextureImageView;
+		arrIBLDescriptors[3].sampler = pHDRI->m_vkTextureSampler;
+
+		// Bindings 9 to 12 are consecutive so one write covers all of them
+		VkWriteDescriptorSet iblWrite = {};
+		iblWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		iblWrite.dstSet = m_vecDeferredPassDescriptorSets[i];
+		iblWrite.dstBinding = 9;
+		iblWrite.dstArrayElement = 0;
+		iblWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		iblWrite.descriptorCount = static_cast<uint32_t>(arrIBLDescriptors.size());
+		iblWrite.pImageInfo = arrIBLDescriptors.data();
+
 		// List of input descriptor set writes
 		std::vector<VkWriteDescriptorSet> setWrites = { colorWrite, depthWrite, normalWrite, positionWrite, pbrWrite, 
-														emissionWrite, backgroundWrite, objIDWrite, ubSetWrite };
+														emissionWrite, backgroundWrite, objIDWrite, ubSetWrite, iblWrite };
 
 		// Update descriptor sets
 		vkUpdateDescriptorSets(m_pDevice->m_vkLogicalDevice, static_cast<uint32_t>(setWrites.size()), setWrites.data(), 0, nullptr);
@@ -1118,29 +1831,37 @@ void VulkanRenderer::SetupDebugMessenger()
 // 3. Present image to the screen when it has signaled finished rendering!
 void VulkanRenderer::Render()
 {
+	// Recording benchmark requested from UI?
+	if (UIManager::getInstance().m_bRunRecordBenchmark)
+	{
+		UIManager::getInstance().m_bRunRecordBenchmark = false;
+		RunRecordingBenchmark();
+	}
+
+	// Occlusion benchmark only appends models, GPU driven pass picks them up through scene structure version
+	if (UIManager::getInstance().m_bLoadOcclusionBenchmark)
+	{
+		UIManager::getInstance().m_bLoadOcclusionBenchmark = false;
+		m_pScene->LoadOcclusionBenchmark(m_pDevice, m_pSwapChain);
+	}
+
+	// Frames in flight size every per frame resource, recreate them the same way a resize does
+	uint32_t uiFramesInFlight = std::clamp(static_cast<uint32_t>(UIManager::getInstance().m_iFramesInFlight), 1u, Helper::App::MAX_FRAMES_IN_FLIGHT);
+	if (uiFramesInFlight != m_pSwapChain->m_uiFramesInFlight)
+	{
+		m_pSwapChain->m_uiFramesInFlight = uiFramesInFlight;
+		HandleWindowResize();
+		return;
+	}
+
 	// 1. Acquire next image from the swap chain!
 	// Wait for given fence to signal (open) from last draw call before continuing...
 	vkWaitForFences(m_pDevice->m_vkLogicalDevice, 1, &m_vecFencesRender[m_uiCurrentFrame], VK_TRUE, UINT64_MAX);
 
-	// Manually reset (close) fence!
-	vkResetFences(m_pDevice->m_vkLogicalDevice, 1, &m_vecFencesRender[m_uiCurrentFrame]);
-
 	// Get index of next image to be drawn to & signal semaphore when ready to be drawn to
 	uint32_t imageIndex;
 	VkResult result = vkAcquireNextImageKHR(m_pDevice->m_vkLogicalDevice, m_pSwapChain->m_vkSwapchain, UINT64_MAX, m_vecSemaphoreImageAvailable[m_uiCurrentFrame], VK_NULL_HANDLE, &imageIndex);
 
-	// Record Graphics command
-	RecordCommands(imageIndex);
-
-	// Update Uniforms for Scene!
-	m_pScene->UpdateUniforms(m_pDevice, imageIndex);
-	UpdateDeferredUniforms(imageIndex);
-
-	UIManager::getInstance().BeginRender();
-	UIManager::getInstance().RenderSceneUI(m_pScene);
-	UIManager::getInstance().RenderDebugStats();
-	UIManager::getInstance().EndRender(m_pSwapChain, imageIndex);
-
 	// During any event such as window size change etc. we need to check if swap chain recreation is necessary
 	// Vulkan tells us that swap chain in no longer adequate during presentation
 	// VK_ERROR_OUT_OF_DATE_KHR = swap chain has become incompatible with the surface & can no longer be used for rendering. (window resize)
@@ -1159,32 +1880,183 @@ void VulkanRenderer::Render()
 		return;
 	}
 
+	// Fence wait above means the previous use of this frame slot is done, its command buffers & uniforms are free.
+	// Nothing below but the present recording touches the acquired image!
+
+	// Manually reset (close) fence!
+	vkResetFences(m_pDevice->m_vkLogicalDevice, 1, &m_vecFencesRender[m_uiCurrentFrame]);
+
+	// GPU driven path toggled from UI or scene geometry changed since merged buffers were built?
+	if (m_pGPUDrivenPass)
+	{
+		if (m_bGPUDriven != UIManager::getInstance().m_bGPUDriven)
+		{
+			m_bGPUDriven = UIManager::getInstance().m_bGPUDriven;
+			m_pScene->m_bGPUCulling = m_bGPUDriven;
+			MarkCommandBuffersDirty();
+		}
+
+		if (m_pGPUDrivenPass->NeedsRebuild(m_pScene->GetStructureVersion()))
+		{
+			vkDeviceWaitIdle(m_pDevice->m_vkLogicalDevice);
+			m_pGPUDrivenPass->Cleanup(m_pDevice);
+			m_pGPUDrivenPass->Initialize(m_pDevice, m_pSwapChain, m_pScene, m_pHiZPass->GetCullDescriptorSetLayout(), m_pFrameGlobals->GetObjectBuffers());
+			MarkCommandBuffersDirty();
+		}
+
+		// Occlusion adds occluder pass, Hi-Z build & second culling dispatch
+		if (m_bOcclusionCulling != UIManager::getInstance().m_bOcclusionCulling)
+		{
+			m_bOcclusionCulling = UIManager::getInstance().m_bOcclusionCulling;
+			MarkCommandBuffersDirty();
+		}
+	}
+
+	// Tiled lighting swaps render pass & moves lighting out of it
+	if (m_bTiledLighting != UIManager::getInstance().m_bTiledLighting)
+	{
+		m_bTiledLighting = UIManager::getInstance().m_bTiledLighting;
+		MarkCommandBuffersDirty();
+	}
+
+	// Depth pre-pass changes G-Buffer pipelines & adds draws
+	if (m_bDepthPrepass != UIManager::getInstance().m_bDepthPrepass)
+	{
+		m_bDepthPrepass = UIManager::getInstance().m_bDepthPrepass;
+		MarkCommandBuffersDirty();
+	}
+
+	// Upscaler & sharpness are only used by present recording, which happens every frame anyway
+	m_iUpscaleMode = UIManager::getInstance().m_iUpscaleMode;
+	m_fSharpness = UIManager::getInstance().m_fSharpness;
+
+	// Structural scene edits or pass change invalidate all recorded command buffers
+	if (m_pScene->IsDirty() || m_iRecordedPassID != UIManager::getInstance().m_iPassID ||
+		m_uiRecordThreadCount != static_cast<uint32_t>(UIManager::getInstance().m_iRecordThreadCount))
+	{
+		MarkCommandBuffersDirty();
+
+		m_pScene->ClearDirty();
+		m_iRecordedPassID = UIManager::getInstance().m_iPassID;
+		m_uiRecordThreadCount = static_cast<uint32_t>(UIManager::getInstance().m_iRecordThreadCount);
+	}
+
+	// Fragment invocations of last frame that used this slot, clean buffer means it was submitted & has finished
+	if (!m_bGPUDriven && !m_vecStatisticsQueryPools.empty() && !m_vecCommandBufferDirty[m_uiCurrentFrame])
+	{
+		uint32_t nJobs = m_vecRecordedJobCount[m_uiCurrentFrame];
+		std::vector<uint64_t> vecInvocations(nJobs, 0);
+
+		if (nJobs > 0 && vkGetQueryPoolResults(m_pDevice->m_vkLogicalDevice, m_vecStatisticsQueryPools[m_uiCurrentFrame], 1, nJobs,
+											   nJobs * sizeof(uint64_t), vecInvocations.data(), sizeof(uint64_t),
+											   VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+		{
+			uint64_t uiTotal = 0;
+			for (uint64_t uiInvocations : vecInvocations)
+			{
+				uiTotal += uiInvocations;
+			}
+
+			UIManager::getInstance().m_uiGBufferFragmentInvocations = uiTotal;
+		}
+	}
+
+	// Lighting pass & frame GPU time of last frame that used this slot, same rules as statistics above
+	float fGPUFrameMs = 0.0f;
+	if (!m_vecTimestampQueryPools.empty() && !m_vecCommandBufferDirty[m_uiCurrentFrame])
+	{
+		std::array<uint64_t, 4> arrTimestamps = {};
+
+		if (vkGetQueryPoolResults(m_pDevice->m_vkLogicalDevice, m_vecTimestampQueryPools[m_uiCurrentFrame], 0, 4,
+								  sizeof(arrTimestamps), arrTimestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT) == VK_SUCCESS)
+		{
+			double dPeriod = m_pDevice->m_vkDeviceProperties.limits.timestampPeriod;
+			double dNanoseconds = static_cast<double>(arrTimestamps[1] - arrTimestamps[0]) * dPeriod;
+			double dPixels = static_cast<double>(m_vecRecordedRenderExtent[m_uiCurrentFrame].width) * m_vecRecordedRenderExtent[m_uiCurrentFrame].height;
+
+			UIManager::getInstance().m_fLightingPassMs = static_cast<float>(dNanoseconds * 1e-6);
+			UIManager::getInstance().m_fLightingPassNsPerPixel = static_cast<float>(dNanoseconds / dPixels);
+
+			fGPUFrameMs = static_cast<float>(static_cast<double>(arrTimestamps[3] - arrTimestamps[2]) * dPeriod * 1e-6);
+			UIManager::getInstance().m_fGPUFrameMs = fGPUFrameMs;
+		}
+	}
+
+	// New render scale changes viewport, render area & upscale constants of every command buffer. Quality preset caps it
+	int iPreset = std::clamp(UIManager::getInstance().m_iRenderScalePreset, 0, static_cast<int>(UpscaleConfig::NUM_RENDER_SCALE_PRESETS) - 1);
+	if (m_pDynamicResolution->Update(fGPUFrameMs, UIManager::getInstance().m_fTargetFrameMs, UIManager::getInstance().m_fMinRenderScale,
+									 UpscaleConfig::RENDER_SCALE_PRESETS[iPreset], UIManager::getInstance().m_bDynamicResolution))
+	{
+		m_vkRenderExtent = m_pDynamicResolution->GetRenderExtent(m_pSwapChain->m_vkSwapchainExtent);
+		MarkCommandBuffersDirty();
+	}
+	UIManager::getInstance().m_fRenderScale = m_pDynamicResolution->GetScale();
+
+	// Record Graphics command only if needed, steady state just re-submits!
+	if (m_vecCommandBufferDirty[m_uiCurrentFrame])
+	{
+		RecordCommands(m_uiCurrentFrame);
+		m_vecCommandBufferDirty[m_uiCurrentFrame] = false;
+	}
+
+	// Update Uniforms for Scene! Model transforms go through FrameGlobals object buffer
+	UpdateDeferredUniforms(m_uiCurrentFrame);
+	m_pFrameGlobals->Update(m_pDevice, m_pScene, m_uiCurrentFrame);
+	m_pClusteredLighting->SetRenderExtent(m_vecRecordedRenderExtent[m_uiCurrentFrame]);
+	m_pClusteredLighting->Update(m_pDevice, m_pScene, m_uiCurrentFrame);
+
+	if (m_bGPUDriven)
+	{
+		// Counts are from the last frame that used this slot, it has finished (fence wait above)
+		uint32_t uiVisible = m_pGPUDrivenPass->GetVisibleDrawCount(m_pDevice, m_uiCurrentFrame);
+		m_pScene->SetCullStats(uiVisible, m_pGPUDrivenPass->GetMeshCount() - uiVisible);
+		UIManager::getInstance().m_uiOccludedMeshes = m_pGPUDrivenPass->GetOccludedCount(m_pDevice, m_uiCurrentFrame);
+
+		m_pGPUDrivenPass->Update(m_pDevice, m_pScene, m_uiCurrentFrame, m_vecRecordedRenderExtent[m_uiCurrentFrame], m_pHiZPass->GetMipCount());
+	}
+
+	UIManager::getInstance().BeginRender();
+	UIManager::getInstance().RenderSceneUI(m_pScene);
+	UIManager::getInstance().RenderDebugStats(m_pScene);
+	RecordPresent(m_uiCurrentFrame, imageIndex);
+	UIManager::getInstance().EndRender(m_pSwapChain, m_uiCurrentFrame, imageIndex);
+
 	// 2. Execute the command buffer
 	// Queue submission & synchronization is configured through VkSubmitInfo.
 
 	VkSemaphore waitSemaphores[] = { m_vecSemaphoreImageAvailable[m_uiCurrentFrame] };
-	VkSemaphore signalSemaphores[] = { m_vecSemaphoreRenderFinished[m_uiCurrentFrame] };
+	VkSemaphore signalSemaphores[] = { m_vecSemaphoreRenderFinished[imageIndex] };
+
+	std::array<VkCommandBuffer, 2> presentCommandBuffers = {
+																m_pDevice->m_vecCommandBufferPresent[m_uiCurrentFrame],
+																UIManager::getInstance().m_vecCommandBuffers[m_uiCurrentFrame]
+															};
 
-	std::array<VkCommandBuffer, 2> commandBuffers = {
-														m_pDevice->m_vecCommandBufferGraphics[imageIndex],
-														UIManager::getInstance().m_vecCommandBuffers[imageIndex]
-													};
+	std::array<VkSubmitInfo, 2> submitInfos{};
 
-	VkSubmitInfo submitInfo{};
-	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo.waitSemaphoreCount = 1;														// Number of semaphores to wait on
-	submitInfo.pWaitSemaphores = waitSemaphores;											// List of semaphores to wait on
+	// G-Buffer, lighting & everything else only touching frame resources doesn't wait for acquire
+	submitInfos[0].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfos[0].waitSemaphoreCount = 0;
+	submitInfos[0].commandBufferCount = 1;
+	submitInfos[0].pCommandBuffers = &m_pDevice->m_vecCommandBufferGraphics[m_uiCurrentFrame];
+	submitInfos[0].signalSemaphoreCount = 0;
+	submitInfos[0].pNext = nullptr;
+
+	// Upscale & UI write the acquired image
+	submitInfos[1].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfos[1].waitSemaphoreCount = 1;													// Number of semaphores to wait on
+	submitInfos[1].pWaitSemaphores = waitSemaphores;										// List of semaphores to wait on
 
 	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
-	submitInfo.pWaitDstStageMask = waitStages;												// stages to check semaphores at
+	submitInfos[1].pWaitDstStageMask = waitStages;											// stages to check semaphores at
 
-	submitInfo.commandBufferCount = static_cast<uint32_t>(commandBuffers.size());			// number of command buffers to submit
-	submitInfo.pCommandBuffers = commandBuffers.data();										// command buffers to submit
-	submitInfo.signalSemaphoreCount = 1;													// number of semaphores to signal
-	submitInfo.pSignalSemaphores = signalSemaphores;										// semaphores to signal when command buffer finishes
-	submitInfo.pNext = nullptr;
+	submitInfos[1].commandBufferCount = static_cast<uint32_t>(presentCommandBuffers.size());	// number of command buffers to submit
+	submitInfos[1].pCommandBuffers = presentCommandBuffers.data();							// command buffers to submit
+	submitInfos[1].signalSemaphoreCount = 1;												// number of semaphores to signal
+	submitInfos[1].pSignalSemaphores = signalSemaphores;									// semaphores to signal when command buffer finishes
+	submitInfos[1].pNext = nullptr;
 
-	if (vkQueueSubmit(m_pDevice->m_vkQueueGraphics, 1, &submitInfo, m_vecFencesRender[m_uiCurrentFrame]) != VK_SUCCESS)
+	if (vkQueueSubmit(m_pDevice->m_vkQueueGraphics, static_cast<uint32_t>(submitInfos.size()), submitInfos.data(), m_vecFencesRender[m_uiCurrentFrame]) != VK_SUCCESS)
 	{
 		LOG_ERROR("Failed to submit draw command buffer!");
 	}
@@ -1213,7 +2085,7 @@ void VulkanRenderer::Render()
 	}
 
 	// Get next frame 
-	m_uiCurrentFrame = (m_uiCurrentFrame + 1) % Helper::App::MAX_FRAME_DRAWS;
+	m_uiCurrentFrame = (m_uiCurrentFrame + 1) % m_pSwapChain->m_uiFramesInFlight;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -1232,10 +2104,14 @@ void VulkanRenderer::CleanupOnWindowResize()
 	UIManager::getInstance().CleanupOnWindowResize(m_pDevice);
 	
 	m_pGraphicsPipelineGBuffer->CleanupOnWindowResize(m_pDevice);
-	m_pGraphicsPipelineSkydome->CleanupOnWindowResize(m_pDevice);
+	m_pGraphicsPipelineGBufferInstanced->CleanupOnWindowResize(m_pDevice);
+	m_pGraphicsPipelineGBufferDepthEqual->CleanupOnWindowResize(m_pDevice);
+	m_pGraphicsPipelineDepthPrepass->CleanupOnWindowResize(m_pDevice);
 	m_pGraphicsPipelineDeferred->CleanupOnWindowResize(m_pDevice);
+	m_pGraphicsPipelineDeferredSky->CleanupOnWindowResize(m_pDevice);
 
 	vkDestroyRenderPass(m_pDevice->m_vkLogicalDevice, m_vkRenderPass, nullptr);
+	vkDestroyRenderPass(m_pDevice->m_vkLogicalDevice, m_vkRenderPassTiledLighting, nullptr);
 
 	m_pDeferredUniforms->CleanupOnWindowResize(m_pDevice);
 	vkDestroyDescriptorPool(m_pDevice->m_vkLogicalDevice, m_vkDeferredPassDescriptorPool, nullptr);
@@ -1245,6 +2121,20 @@ void VulkanRenderer::CleanupOnWindowResize()
 	m_pSwapChain->CleanupOnWindowResize(m_pDevice);
 	m_pDevice->CleanupOnWindowResize();
 
+	CleanupThreadCommandPools();
+
+	if (m_pGPUDrivenPass)
+		m_pGPUDrivenPass->CleanupOnWindowResize(m_pDevice);
+
+	if (m_pHiZPass)
+		m_pHiZPass->CleanupOnWindowResize(m_pDevice);
+
+	m_pTiledLightingPass->CleanupOnWindowResize(m_pDevice);
+
+	m_pClusteredLighting->CleanupOnWindowResize(m_pDevice);
+	m_pFrameGlobals->CleanupOnWindowResize(m_pDevice);
+	m_pUpscalePass->CleanupOnWindowResize(m_pDevice);
+
 	LOG_DEBUG("Old SwapChain Cleanup");
 }
 
@@ -1259,10 +2149,14 @@ void VulkanRenderer::Cleanup()
 	m_pFrameBuffer->Cleanup(m_pDevice);
 
 	m_pGraphicsPipelineDeferred->Cleanup(m_pDevice);
-	m_pGraphicsPipelineSkydome->Cleanup(m_pDevice);
+	m_pGraphicsPipelineDeferredSky->Cleanup(m_pDevice);
 	m_pGraphicsPipelineGBuffer->Cleanup(m_pDevice);
+	m_pGraphicsPipelineGBufferInstanced->Cleanup(m_pDevice);
+	m_pGraphicsPipelineGBufferDepthEqual->Cleanup(m_pDevice);
+	m_pGraphicsPipelineDepthPrepass->Cleanup(m_pDevice);
 
 	vkDestroyRenderPass(m_pDevice->m_vkLogicalDevice, m_vkRenderPass, nullptr);
+	vkDestroyRenderPass(m_pDevice->m_vkLogicalDevice, m_vkRenderPassTiledLighting, nullptr);
 
 	m_pDeferredUniforms->Cleanup(m_pDevice);
 	vkDestroyDescriptorPool(m_pDevice->m_vkLogicalDevice, m_vkDeferredPassDescriptorPool, nullptr);
@@ -1270,6 +2164,20 @@ void VulkanRenderer::Cleanup()
 
 	HDRISkydome::getInstance().Cleanup(m_pDevice);
 
+	CleanupThreadCommandPools();
+
+	if (m_pGPUDrivenPass)
+		m_pGPUDrivenPass->Cleanup(m_pDevice);
+
+	if (m_pHiZPass)
+		m_pHiZPass->Cleanup(m_pDevice);
+
+	m_pTiledLightingPass->Cleanup(m_pDevice);
+
+	m_pClusteredLighting->Cleanup(m_pDevice);
+	m_pFrameGlobals->Cleanup(m_pDevice);
+	m_pUpscalePass->Cleanup(m_pDevice);
+
 	for (Model* element : m_pScene->GetModelList())
 	{
 		if(element != nullptr)
@@ -1277,15 +2185,21 @@ void VulkanRenderer::Cleanup()
 			element->Cleanup(m_pDevice);
 		}
 	}
-	
-	// Destroy semaphores
-	for (uint32_t i = 0; i < Helper::App::MAX_FRAME_DRAWS; ++i)
+
+	for (Model* element : m_pScene->GetInstancedModelList())
 	{
-		vkDestroySemaphore(m_pDevice->m_vkLogicalDevice, m_vecSemaphoreImageAvailable[i], nullptr);
-		vkDestroySemaphore(m_pDevice->m_vkLogicalDevice, m_vecSemaphoreRenderFinished[i], nullptr);
-		vkDestroyFence(m_pDevice->m_vkLogicalDevice, m_vecFencesRender[i], nullptr);
+		if (element != nullptr)
+		{
+			element->Cleanup(m_pDevice);
+		}
 	}
 
+	// After models, they release their slots first
+	MaterialRegistry::getInstance().Cleanup(m_pDevice);
+	
+	// Destroy semaphores
+	CleanupSyncObjects();
+
 	m_pSwapChain->Cleanup(m_pDevice);
 	m_pDevice->Cleanup();
 
@@ -1305,11 +2219,11 @@ void DeferredPassUniforms::CreateBuffers(VulkanDevice* pDevice, VulkanSwapChain*
 	VkDeviceSize deferredBufferSize = sizeof(DeferredPassUniforms);
 
 	// one uniform buffer for each image (and by extension command buffer)
-	vecBuffer.resize(pSwapchain->m_vecSwapchainImages.size());
-	vecMemory.resize(pSwapchain->m_vecSwapchainImages.size());
+	vecBuffer.resize(pSwapchain->m_uiFramesInFlight);
+	vecMemory.resize(pSwapchain->m_uiFramesInFlight);
 
 	// create uniform buffers
-	for (uint16_t i = 0; i < pSwapchain->m_vecSwapchainImages.size(); i++)
+	for (uint16_t i = 0; i < pSwapchain->m_uiFramesInFlight; i++)
 	{
 		pDevice->CreateBuffer(deferredBufferSize,
 			VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
@@ -1327,6 +2241,9 @@ void DeferredPassUniforms::Cleanup(VulkanDevice* pDevice)
 		vkDestroyBuffer(pDevice->m_vkLogicalDevice, vecBuffer[i], nullptr);
 		vkFreeMemory(pDevice->m_vkLogicalDevice, vecMemory[i], nullptr);
 	}
+
+	vecBuffer.clear();
+	vecMemory.clear();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -1337,4 +2254,8 @@ void DeferredPassUniforms::CleanupOnWindowResize(VulkanDevice* pDevice)
 		vkDestroyBuffer(pDevice->m_vkLogicalDevice, vecBuffer[i], nullptr);
 		vkFreeMemory(pDevice->m_vkLogicalDevice, vecMemory[i], nullptr);
 	}
+
+	// Frames in flight may change before buffers are recreated
+	vecBuffer.clear();
+	vecMemory.clear();
 }
@@ -23,6 +23,14 @@ class VulkanSwapChain;
 class DeferredFrameBuffer;
 class VulkanGraphicsPipeline;
 class Scene;
+class ThreadPool;
+class GPUDrivenPass;
+class HiZPass;
+class TiledLightingPass;
+class ClusteredLighting;
+class FrameGlobals;
+class UpscalePass;
+class DynamicResolution;
 
 //---------------------------------------------------------------------------------------------------------------------
 struct DeferredPassShaderData
@@ -31,13 +39,15 @@ struct DeferredPassShaderData
 	{
 		lightProperties = glm::vec4(1);
 		cameraPosition = glm::vec3(0);
-		passID = 0;
+		iblProperties = glm::vec4(0);
+		matInverseViewProjection = glm::mat4(1);
 	}
 
 	// Data
 	alignas(16) glm::vec4	lightProperties;	// RGB - Direction, A - Intensity
 	alignas(16) glm::vec3	cameraPosition;
-	alignas(4)	uint32_t	passID;
+	alignas(16) glm::vec4	iblProperties;		// x - enabled, y - prefiltered max mip, z - intensity
+	alignas(16) glm::mat4	matInverseViewProjection;	// sky view rays from full screen triangle
 };
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -61,6 +71,21 @@ struct DeferredPassUniforms
 	std::vector<VkDeviceMemory>		vecMemory;
 };
 
+//---------------------------------------------------------------------------------------------------------------------
+// Command pools can't be used from multiple threads at once, hence every recording job gets its own pool per 
+// frame in flight holding a single secondary command buffer!
+struct ThreadCommandPool
+{
+	ThreadCommandPool()
+	{
+		vkCommandPool = VK_NULL_HANDLE;
+		vkCommandBuffer = VK_NULL_HANDLE;
+	}
+
+	VkCommandPool					vkCommandPool;
+	VkCommandBuffer					vkCommandBuffer;
+};
+
 //---------------------------------------------------------------------------------------------------------------------
 class VulkanRenderer : public IRenderer
 {
@@ -85,15 +110,25 @@ private:
 
 	void							CreateSurface();
 	void							CreateGraphicsPipeline();
+	void							WarmUpPermutations();
 	void							CreateRenderPass();
 	void							CreateSyncObjects();
+	void							CleanupSyncObjects();
 
 	void							UpdateDeferredUniforms(uint32_t index);
 	void							CreateDeferredPassDescriptorPool();
 	void							CreateDeferredPassDescriptorSetLayout();
 	void							CreateDeferredPassDescriptorSets();
 
-	void							RecordCommands(uint32_t currentImage);
+	void							RecordCommands(uint32_t frameIndex);
+	void							RecordPresent(uint32_t frameIndex, uint32_t imageIndex);
+	void							BindSceneDescriptorSets(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipeline, uint32_t frameIndex);
+	void							MarkCommandBuffersDirty();
+
+	void							CreateThreadCommandPools();
+	void							CleanupThreadCommandPools();
+	std::vector<VkCommandBuffer>	RecordGBufferSecondaries(uint32_t frameIndex, uint32_t nThreads, uint32_t uiRepeat);
+	void							RunRecordingBenchmark();
 
 	void							CleanupOnWindowResize();
 
@@ -109,24 +144,74 @@ private:
 	DeferredFrameBuffer*			m_pFrameBuffer;
 
 	VulkanGraphicsPipeline*			m_pGraphicsPipelineGBuffer;
+	VulkanGraphicsPipeline*			m_pGraphicsPipelineGBufferInstanced;
+	VulkanGraphicsPipeline*			m_pGraphicsPipelineGBufferDepthEqual;
+	VulkanGraphicsPipeline*			m_pGraphicsPipelineDepthPrepass;
 	VulkanGraphicsPipeline*			m_pGraphicsPipelineDeferred;
-	VulkanGraphicsPipeline*			m_pGraphicsPipelineSkydome;
+	VulkanGraphicsPipeline*			m_pGraphicsPipelineDeferredSky;
 	
 	VkDebugUtilsMessengerEXT		m_vkDebugMessenger;
 	VkSurfaceKHR					m_vkSurface;
 
 	VkRenderPass					m_vkRenderPass;
+	VkRenderPass					m_vkRenderPassTiledLighting;	// compatible variant, stores G-Buffer for compute lighting
 
 	DeferredPassUniforms*			m_pDeferredUniforms;
 	VkDescriptorPool				m_vkDeferredPassDescriptorPool;
 	VkDescriptorSetLayout			m_vkDeferredPassDescriptorSetLayout;
 	std::vector<VkDescriptorSet>	m_vecDeferredPassDescriptorSets;
 
-	std::vector<VkSemaphore>		m_vecSemaphoreImageAvailable;
-	std::vector<VkSemaphore>		m_vecSemaphoreRenderFinished;
-	std::vector<VkFence>			m_vecFencesRender;
+	// Everything the CPU writes or records for a frame is indexed by m_uiCurrentFrame, fence guards its reuse
+	std::vector<VkSemaphore>		m_vecSemaphoreImageAvailable;		// per frame in flight
+	std::vector<VkSemaphore>		m_vecSemaphoreRenderFinished;		// per swapchain image, held by presentation engine
+	std::vector<VkFence>			m_vecFencesRender;					// per frame in flight
 	uint32_t						m_uiCurrentFrame;
 
+	// Command buffers are re-recorded only when something structural changes!
+	std::vector<bool>				m_vecCommandBufferDirty;			// per frame in flight
+	int								m_iRecordedPassID;
+
+	// Parallel G-Buffer recording. First slot records depth pre-pass, rest split the opaque models!
+	ThreadPool*										m_pThreadPool;
+	std::vector<std::vector<ThreadCommandPool>>		m_vecThreadCommandPools;		// [frame in flight][job slot]
+	uint32_t										m_uiRecordThreadCount;
+
+	// GPU driven G-Buffer path, only available with multiDrawIndirect + drawIndirectCount!
+	GPUDrivenPass*					m_pGPUDrivenPass;
+	bool							m_bGPUDriven;
+
+	// Two phase Hi-Z occlusion culling of GPU driven path, occluders are meshes that survived last frame's test
+	HiZPass*						m_pHiZPass;
+	bool							m_bOcclusionCulling;
+
+	// Compute shader lighting over 8x8 tiles instead of lighting subpass, toggled at runtime for comparison
+	TiledLightingPass*				m_pTiledLightingPass;
+	bool							m_bTiledLighting;
+
+	// Camera & sun light for scene geometry pipelines, set 0 of G-Buffer, depth pre-pass & occluder layouts
+	FrameGlobals*					m_pFrameGlobals;
+	std::vector<VkDescriptorSetLayout>	m_vecSceneSetLayouts;			// frame, material
+	std::vector<VkPushConstantRange>	m_vecScenePushConstantRanges;	// object slot in FrameGlobals object buffer
+
+	// Local lights binned into view space clusters, deferred pass reads them through set 1
+	ClusteredLighting*				m_pClusteredLighting;
+
+	// Depth pre-pass, G-Buffer then only shades visible fragments. Fragment invocations are counted per G-Buffer job!
+	bool							m_bDepthPrepass;
+	std::vector<VkQueryPool>		m_vecStatisticsQueryPools;			// per frame in flight, one query per job slot
+	std::vector<uint32_t>			m_vecRecordedJobCount;				// per frame in flight
+
+	// Per frame in flight: 0, 1 - deferred lighting subpass, 2, 3 - whole frame (excluding UI)
+	std::vector<VkQueryPool>		m_vecTimestampQueryPools;
+
+	// Dynamic resolution, G-Buffer & lighting cover the render extent subrect of swapchain sized attachments
+	DynamicResolution*				m_pDynamicResolution;
+	UpscalePass*					m_pUpscalePass;
+	VkExtent2D						m_vkRenderExtent;
+	int								m_iUpscaleMode;						// UpscaleMode & sharpness, read when recording present
+	float							m_fSharpness;
+	std::vector<VkExtent2D>			m_vecRecordedRenderExtent;			// per frame in flight, extent its command buffer uses
+
 	bool							m_bFramebufferResized;
 
 	// Scene Objects
@@ -13,6 +13,8 @@ VulkanSwapChain::VulkanSwapChain()
 
     m_vecSwapchainImages.clear();
     m_vecSwapchainImageViews.clear();
+
+    m_uiFramesInFlight = Helper::App::DEFAULT_FRAMES_IN_FLIGHT;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -53,5 +53,9 @@ public:
 
 	std::vector<VkImage>			m_vecSwapchainImages;
 	std::vector<VkImageView>		m_vecSwapchainImageViews;
+
+	// Uniforms, descriptor sets, G-Buffer & command buffers are sized by this, never by image count. 
+	// Only resources that reference a swapchain image are per image!
+	uint32_t						m_uiFramesInFlight;
 };
 
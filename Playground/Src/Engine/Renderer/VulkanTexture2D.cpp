@@ -8,6 +8,99 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+#include "glm/gtc/packing.hpp"
+#include "glm/gtc/type_ptr.hpp"
+
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__F16C__)
+#include <cpuid.h>
+#endif
+
+//---------------------------------------------------------------------------------------------------------------------
+// F16C (vcvtps2ph) works on YMM state like AVX, so besides the cpuid bit the OS must have enabled saving of XMM & YMM
+// registers (OSXSAVE + XCR0 bits 1 & 2). Otherwise the instruction faults even though cpuid reports it!
+static bool CpuSupportsF16C()
+{
+	const uint32_t uiOSXSAVE = 1u << 27;
+	const uint32_t uiF16C = 1u << 29;
+	const uint64_t uiYMMState = 0x6;
+
+#if defined(_MSC_VER)
+	int cpuInfo[4];
+	__cpuid(cpuInfo, 1);
+
+	uint32_t ecx = static_cast<uint32_t>(cpuInfo[2]);
+	if ((ecx & uiOSXSAVE) == 0 || (ecx & uiF16C) == 0)
+		return false;
+
+	return (_xgetbv(_XCR_XFEATURE_ENABLED_MASK) & uiYMMState) == uiYMMState;
+#elif defined(__F16C__)
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return false;
+
+	if ((ecx & uiOSXSAVE) == 0 || (ecx & uiF16C) == 0)
+		return false;
+
+	uint32_t xcrLo, xcrHi;
+	__asm__ volatile("xgetbv" : "=a"(xcrLo), "=d"(xcrHi) : "c"(0));
+	return (((static_cast<uint64_t>(xcrHi) << 32) | xcrLo) & uiYMMState) == uiYMMState;
+#else
+	return false;
+#endif
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Half float to unsigned small float (11 bit = 6 mantissa bits, 10 bit = 5 mantissa bits), both keep half's 5 bit
+// exponent. Mantissa is rounded to nearest even instead of truncated, truncation biases every packed value towards 0.
+// Negative values clamp to 0, finite values rounding past the largest representable one clamp to it, Inf/NaN stay.
+static uint32_t HalfToUFloat(uint16_t uiHalf, uint32_t uiDropBits)
+{
+	if (uiHalf & 0x8000)
+		return 0;
+
+	uint32_t uiBits = uiHalf & 0x7FFF;
+	uint32_t uiMantissaBits = 10 - uiDropBits;
+	uint32_t uiInfinity = 0x1Fu << uiMantissaBits;
+
+	if ((uiBits & 0x7C00) == 0x7C00)
+		return uiInfinity | ((uiBits & 0x3FF) ? 1u : 0u);
+
+	// Carry out of mantissa correctly bumps exponent, denormals become normals the same way
+	uint32_t uiLsb = (uiBits >> uiDropBits) & 1u;
+	uint32_t uiRounded = (uiBits + (1u << (uiDropBits - 1)) - 1u + uiLsb) >> uiDropBits;
+
+	return std::min(uiRounded, uiInfinity - 1u);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Convert nPixels RGBA32F pixels to RGBA16F. Two pixels per iteration on SIMD path, glm scalar path for the remainder!
+static void ConvertFloatToHalf(const float* pSrc, uint16_t* pDst, size_t nPixels)
+{
+	size_t i = 0;
+
+#if defined(_MSC_VER) || defined(__F16C__)
+	static const bool bHasF16C = CpuSupportsF16C();
+	if (bHasF16C)
+	{
+		for (; i + 2 <= nPixels; i += 2)
+		{
+			__m128i halfLo = _mm_cvtps_ph(_mm_loadu_ps(pSrc + i * 4), _MM_FROUND_TO_NEAREST_INT);
+			__m128i halfHi = _mm_cvtps_ph(_mm_loadu_ps(pSrc + i * 4 + 4), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i * 4), _mm_unpacklo_epi64(halfLo, halfHi));
+		}
+	}
+#endif
+
+	for (; i < nPixels; ++i)
+	{
+		uint64_t packed = glm::packHalf4x16(glm::make_vec4(pSrc + i * 4));
+		memcpy(pDst + i * 4, &packed, sizeof(uint64_t));
+	}
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 VulkanTexture2D::VulkanTexture2D()
 {
@@ -16,6 +109,7 @@ VulkanTexture2D::VulkanTexture2D()
 	m_vkTextureImageMemory			=	VK_NULL_HANDLE;
 	m_vkTextureDeviceSize			=	VK_NULL_HANDLE;
 	m_vkTextureSampler				=	VK_NULL_HANDLE;
+	m_vkTextureFormat				=	VK_FORMAT_UNDEFINED;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -34,9 +128,11 @@ void VulkanTexture2D::CreateTexture(VulkanDevice* pDevice, std::string fileName,
 	{
 		case TextureType::TEXTURE_ALBEDO:
 		{
+			m_vkTextureFormat = VK_FORMAT_R8G8B8A8_SRGB;
+
 			CreateTextureImage(pDevice, fileName);
 			m_vkTextureImageView = Helper::Vulkan::CreateImageView(	pDevice, m_vkTextureImage,
-																	VK_FORMAT_R8G8B8A8_SRGB,
+																	m_vkTextureFormat,
 																	VK_IMAGE_ASPECT_COLOR_BIT);
 			
 			break;
@@ -49,18 +145,21 @@ void VulkanTexture2D::CreateTexture(VulkanDevice* pDevice, std::string fileName,
 		case TextureType::TEXTURE_ROUGHNESS:
 		case TextureType::TEXTURE_ERROR:
 		{
+			m_vkTextureFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
 			CreateTextureImage(pDevice, fileName);
 			m_vkTextureImageView = Helper::Vulkan::CreateImageView(	pDevice, m_vkTextureImage,
-																	VK_FORMAT_R8G8B8A8_UNORM,
+																	m_vkTextureFormat,
 																	VK_IMAGE_ASPECT_COLOR_BIT);
 			break;
 		}
 
 		case TextureType::TEXTURE_HDRI:
 		{
+			// Format is picked inside based on device support!
 			CreateTextureHDRI(pDevice, fileName);
 			m_vkTextureImageView = Helper::Vulkan::CreateImageView(	pDevice, m_vkTextureImage,
-																	VK_FORMAT_R32G32B32A32_SFLOAT,
+																	m_vkTextureFormat,
 																	VK_IMAGE_ASPECT_COLOR_BIT);
 			break;
 		}
@@ -133,6 +232,94 @@ float* VulkanTexture2D::LoadHDRI(VulkanDevice* pDevice, std::string fileName)
 	return imageData;
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+// Full 32-bit float precision is wasted on HDRI radiance data, prefer packed B10G11R11 (4 bytes/texel) & fall back to
+// RGBA16F (8 bytes/texel) which is mandatory for sampling. RGBA32F is kept only as a last resort!
+VkFormat VulkanTexture2D::SelectHDRIFormat(VulkanDevice* pDevice)
+{
+	const VkFormatFeatureFlags requiredFeatures =	VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | 
+													VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | 
+													VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+
+	std::array<VkFormat, 3> arrCandidates = {	VK_FORMAT_B10G11R11_UFLOAT_PACK32,
+												VK_FORMAT_R16G16B16A16_SFLOAT,
+												VK_FORMAT_R32G32B32A32_SFLOAT };
+
+	for (VkFormat format : arrCandidates)
+	{
+		VkFormatProperties formatProps;
+		vkGetPhysicalDeviceFormatProperties(pDevice->m_vkPhysicalDevice, format, &formatProps);
+
+		if ((formatProps.optimalTilingFeatures & requiredFeatures) == requiredFeatures)
+			return format;
+	}
+
+	LOG_WARNING("No filterable HDRI format found, using RGBA32F!");
+	return VK_FORMAT_R32G32B32A32_SFLOAT;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Converts RGBA32F data returned by stbi_loadf to given format & updates m_vkTextureDeviceSize accordingly. 
+// Caller owns the returned memory!
+uint8_t* VulkanTexture2D::ConvertHDRI(const float* pImageData, VkFormat eFormat)
+{
+	const size_t nPixels = static_cast<size_t>(m_iTextureWidth) * m_iTextureHeight;
+	uint8_t* pConvertedData = nullptr;
+
+	switch (eFormat)
+	{
+		case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+		{
+			m_vkTextureDeviceSize = nPixels * sizeof(uint32_t);
+			pConvertedData = new uint8_t[m_vkTextureDeviceSize];
+
+			// Go through half floats: 11 & 10 bit floats share half's 5-bit exponent & bias, so packing only rounds
+			// the mantissa. Radiance can't be negative, clamp sign bit away. Done per row to keep temp small!
+			std::vector<uint16_t> vecHalfRow(static_cast<size_t>(m_iTextureWidth) * 4);
+			uint32_t* pPacked = reinterpret_cast<uint32_t*>(pConvertedData);
+
+			for (int y = 0; y < m_iTextureHeight; ++y)
+			{
+				const size_t rowOffset = static_cast<size_t>(y) * m_iTextureWidth;
+				ConvertFloatToHalf(pImageData + rowOffset * 4, vecHalfRow.data(), m_iTextureWidth);
+
+				for (int x = 0; x < m_iTextureWidth; ++x)
+				{
+					const uint16_t* rgba = &vecHalfRow[x * 4];
+
+					uint32_t r = HalfToUFloat(rgba[0], 4);
+					uint32_t g = HalfToUFloat(rgba[1], 4);
+					uint32_t b = HalfToUFloat(rgba[2], 5);
+
+					pPacked[rowOffset + x] = r | (g << 11) | (b << 22);
+				}
+			}
+
+			break;
+		}
+
+		case VK_FORMAT_R16G16B16A16_SFLOAT:
+		{
+			m_vkTextureDeviceSize = nPixels * 4 * sizeof(uint16_t);
+			pConvertedData = new uint8_t[m_vkTextureDeviceSize];
+
+			ConvertFloatToHalf(pImageData, reinterpret_cast<uint16_t*>(pConvertedData), nPixels);
+			break;
+		}
+
+		default:
+		{
+			m_vkTextureDeviceSize = nPixels * 4 * sizeof(float);
+			pConvertedData = new uint8_t[m_vkTextureDeviceSize];
+
+			memcpy(pConvertedData, pImageData, static_cast<size_t>(m_vkTextureDeviceSize));
+			break;
+		}
+	}
+
+	return pConvertedData;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanTexture2D::CreateTextureImage(VulkanDevice* pDevice, std::string fileName)
 {
@@ -208,7 +395,21 @@ void VulkanTexture2D::CreateTextureImage(VulkanDevice* pDevice, std::string file
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanTexture2D::CreateTextureHDRI(VulkanDevice* pDevice, std::string fileName)
 {
+	auto timeStart = std::chrono::high_resolution_clock::now();
+
 	float* imageData = LoadHDRI(pDevice, fileName);
+	VkDeviceSize sourceSize = m_vkTextureDeviceSize;
+
+	auto timeLoaded = std::chrono::high_resolution_clock::now();
+
+	// Convert to compact format, m_vkTextureDeviceSize is updated to converted size!
+	m_vkTextureFormat = SelectHDRIFormat(pDevice);
+	uint8_t* convertedData = ConvertHDRI(imageData, m_vkTextureFormat);
+
+	// Free original image data
+	stbi_image_free(imageData);
+
+	auto timeConverted = std::chrono::high_resolution_clock::now();
 	
 	// Create staging buffer to hold loaded data, ready to copy to device
 	VkBuffer		imageStagingBuffer;
@@ -224,31 +425,14 @@ void VulkanTexture2D::CreateTextureHDRI(VulkanDevice* pDevice, std::string fileN
 	// copy image data to staging buffer
 	void* data;
 	vkMapMemory(pDevice->m_vkLogicalDevice, imageStagingBufferMemory, 0, m_vkTextureDeviceSize, 0, &data);
-	memcpy(data, imageData, static_cast<uint32_t>(m_vkTextureDeviceSize));
+	memcpy(data, convertedData, static_cast<size_t>(m_vkTextureDeviceSize));
 	vkUnmapMemory(pDevice->m_vkLogicalDevice, imageStagingBufferMemory);
 	
-	// Free original image data
-	stbi_image_free(imageData);
-
-	//VkImageFormatProperties imgProps = {};
-	//VkImageCreateFlags imgFlags = {};
-	
-	//for (int i = 0; i < VK_FORMAT_MAX_ENUM; i++)
-	//{
-	//	VkFormat format = (VkFormat)i;
-	//
-	//	VkResult result = vkGetPhysicalDeviceImageFormatProperties(pDevice->m_vkPhysicalDevice, format, VK_IMAGE_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
-	//		VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, imgFlags, &imgProps);
-	//
-	//	if (result == VK_ERROR_FORMAT_NOT_SUPPORTED)
-	//	{
-	//		LOG_ERROR("***** {0} Not Supported!", format);
-	//	}
-	//}
+	delete[] convertedData;
 
 	m_vkTextureImage = Helper::Vulkan::CreateImage(	pDevice, m_iTextureWidth, m_iTextureHeight,
-													VK_FORMAT_R32G32B32A32_SFLOAT,
-													VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT |									 VK_IMAGE_USAGE_SAMPLED_BIT,
+													m_vkTextureFormat,
+													VK_IMAGE_TILING_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
 													VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vkTextureImageMemory);
 		
 	// Transition image to be DST for copy operation
@@ -269,6 +453,21 @@ void VulkanTexture2D::CreateTextureHDRI(VulkanDevice* pDevice, std::string fileN
 	// Destroy staging buffers
 	vkDestroyBuffer(pDevice->m_vkLogicalDevice, imageStagingBuffer, nullptr);
 	vkFreeMemory(pDevice->m_vkLogicalDevice, imageStagingBufferMemory, nullptr);
+
+	auto timeUploaded = std::chrono::high_resolution_clock::now();
+
+	// Memory & load time comparison against uploading raw RGBA32F data!
+	const char* strFormat = (m_vkTextureFormat == VK_FORMAT_B10G11R11_UFLOAT_PACK32) ? "B10G11R11_UFLOAT" :
+							(m_vkTextureFormat == VK_FORMAT_R16G16B16A16_SFLOAT) ? "RGBA16F" : "RGBA32F";
+
+	LOG_INFO("HDRI {0} [{1}x{2}] : RGBA32F {3:.2f} MB -> {4} {5:.2f} MB ({6:.1f}x smaller)", fileName, 
+			m_iTextureWidth, m_iTextureHeight, sourceSize / (1024.0f * 1024.0f), strFormat, 
+			m_vkTextureDeviceSize / (1024.0f * 1024.0f), static_cast<float>(sourceSize) / m_vkTextureDeviceSize);
+
+	LOG_INFO("HDRI {0} timings : load {1:.2f} ms | convert {2:.2f} ms | upload {3:.2f} ms", fileName,
+			std::chrono::duration<float, std::milli>(timeLoaded - timeStart).count(),
+			std::chrono::duration<float, std::milli>(timeConverted - timeLoaded).count(),
+			std::chrono::duration<float, std::milli>(timeUploaded - timeConverted).count());
 }
 
 //---------------------------------------------------------------------------------------------------------------------
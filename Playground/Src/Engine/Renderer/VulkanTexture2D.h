@@ -33,10 +33,13 @@ public:
 	VkImageLayout						m_vkTextureImageLayout;
 	VkDeviceMemory						m_vkTextureImageMemory;
 	VkSampler							m_vkTextureSampler;
+	VkFormat							m_vkTextureFormat;
 
 private:
 	unsigned char*						LoadTextureFile(VulkanDevice* pDevice, std::string fileName);
 	float*								LoadHDRI(VulkanDevice* pDevice, std::string fileName);
+	VkFormat							SelectHDRIFormat(VulkanDevice* pDevice);
+	uint8_t*							ConvertHDRI(const float* pImageData, VkFormat eFormat);
 	void								CreateTextureImage(VulkanDevice* pDevice, std::string fileName);
 	void								CreateTextureSampler(VulkanDevice* pDevice);
 
@@ -2,14 +2,46 @@
 #include "VulkanTextureCUBE.h"
 #include "VulkanTexture2D.h"
 #include "Engine/Renderer/VulkanDevice.h"
-#include "Engine/Renderer/VulkanSwapChain.h"
-#include "Engine/Renderer/VulkanGraphicsPipeline.h"
-#include "Engine/RenderObjects/DummySkybox.h"
+#include "Engine/Renderer/VulkanComputePipeline.h"
 #include "Engine/Helpers/Utility.h"
 #include "Engine/Helpers/Log.h"
+#include "Engine/Helpers/KTX2.h"
 
 #include "stb_image.h"
 
+#include <iomanip>
+
+//---------------------------------------------------------------------------------------------------------------------
+// Layout transition for all mips & layers of an image, access & stages given explicitly since compute writes aren't
+// covered by Helper::Vulkan::TransitionImageLayout!
+static void ImageBarrier(VkCommandBuffer cmdBuffer, VkImage image, uint32_t nMipmaps, uint32_t nLayers,
+						 VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccess, VkAccessFlags dstAccess,
+						 VkPipelineStageFlags srcStage, VkPipelineStageFlags dstStage)
+{
+	VkImageMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcAccessMask = srcAccess;
+	barrier.dstAccessMask = dstAccess;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = nMipmaps;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = nLayers;
+
+	vkCmdPipelineBarrier(cmdBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+static uint32_t MipCount(uint32_t dimension)
+{
+	return static_cast<uint32_t>(std::floor(std::log2(dimension))) + 1;
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 VulkanTextureCUBE::VulkanTextureCUBE()
 {
@@ -18,23 +50,27 @@ VulkanTextureCUBE::VulkanTextureCUBE()
 	m_vkImageMemoryCUBE				= VK_NULL_HANDLE;
 	m_vkSamplerCUBE					= VK_NULL_HANDLE;
 
-	m_pTextureHDRI					= nullptr;
-	m_pGraphicsPipelineHDRI2Cube	= nullptr;
-	m_pGraphicsPipelineIrradiance	= nullptr;
-	m_pGraphicsPipelinePrefilterSpec= nullptr;
-	m_pDummySkybox					= nullptr;
+	m_vkImageIRRAD					= VK_NULL_HANDLE;
+	m_vkImageViewIRRAD				= VK_NULL_HANDLE;
+	m_vkImageMemoryIRRAD			= VK_NULL_HANDLE;
+	m_vkSamplerIRRAD				= VK_NULL_HANDLE;
+
+	m_vkImagePrefilterSpec			= VK_NULL_HANDLE;
+	m_vkImageViewPrefilterSpec		= VK_NULL_HANDLE;
+	m_vkImageMemoryPrefilterSpec	= VK_NULL_HANDLE;
+	m_vkSamplerPrefilterSpec		= VK_NULL_HANDLE;
+	m_uiPrefilterMipCount			= 0;
+
+	m_vkImageBRDF					= VK_NULL_HANDLE;
+	m_vkImageViewBRDF				= VK_NULL_HANDLE;
+	m_vkImageMemoryBRDF				= VK_NULL_HANDLE;
+	m_vkSamplerBRDF					= VK_NULL_HANDLE;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 VulkanTextureCUBE::~VulkanTextureCUBE()
 {
-	SAFE_DELETE(m_pTextureHDRI);
-	SAFE_DELETE(m_pGraphicsPipelineHDRI2Cube);
-	SAFE_DELETE(m_pGraphicsPipelineIrradiance);
-	SAFE_DELETE(m_pGraphicsPipelinePrefilterSpec);
-	SAFE_DELETE(m_pDummySkybox);
 }
-
 //---------------------------------------------------------------------------------------------------------------------
 void VulkanTextureCUBE::CreateTextureCUBE(VulkanDevice* pDevice, std::string fileName)
 {
@@ -55,1136 +91,496 @@ void VulkanTextureCUBE::CreateTextureCUBE(VulkanDevice* pDevice, std::string fil
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::CreateTextureCubeFromHDRI(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, std::string fileName)
+void VulkanTextureCUBE::CreateIBLFromHDRI(VulkanDevice* pDevice, VulkanTexture2D* pHDRI, const std::string& fileName)
 {
-	// Load HDRI Map! 
-	m_pTextureHDRI = new VulkanTexture2D();
-	m_pTextureHDRI->CreateTexture(pDevice, fileName, TextureType::TEXTURE_HDRI);
+	auto timeStart = std::chrono::high_resolution_clock::now();
 
-	const VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
+	m_uiPrefilterMipCount = MipCount(IBLConfig::PREFILTER_DIM);
 
-	//*** Create VkImage with 6 array Layers!
-	m_vkImageCUBE = Helper::Vulkan::CreateImageCUBE(pDevice,
-													512,
-													512,
-													format,
-													1,
-													VK_IMAGE_TILING_OPTIMAL,
-													VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vkImageMemoryCUBE);
+	CreateIBLImages(pDevice);
 
-	// Create Image View!
-	m_vkImageViewCUBE = Helper::Vulkan::CreateImageViewCUBE(pDevice,
-															m_vkImageCUBE,
-															format,
-															1,
-															VK_IMAGE_ASPECT_COLOR_BIT);
-
-	// Create Sampler!
-	m_vkSamplerCUBE = CreateTextureSampler(pDevice, 1);
+	std::string cacheKey = GetCacheKey(fileName);
+	bool bCached = LoadFromCache(pDevice, cacheKey);
 
-	// Dummy skybox used for rendering HDRI into a cubemap!
-	m_pDummySkybox = new DummySkybox();
-	m_pDummySkybox->Init(pDevice);
-
-	// Create RenderPass
-	VkRenderPass hdr2CubeRenderPass = CreateOffscreenRenderPass(pDevice, format);
-
-	// Create Off-screen framebuffer! 
-	std::tuple<VkImage, VkImageView, VkDeviceMemory, VkFramebuffer> tupleOffscreen = CreateOffscreenFramebuffer(pDevice, hdr2CubeRenderPass, format, 512);
-
-	// Create Descriptor Set layout & Descriptor Set!
-	std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> tupleDescriptor = CreateHDRI2CubeDescriptorSet(pDevice);
-
-	// Create Graphics Pipeline!
-	CreateHDRI2CubePipeline(pDevice, pSwapchain, std::get<1>(tupleDescriptor), hdr2CubeRenderPass);
-
-	// Render
-	RenderHDRI2CUBE(pDevice, hdr2CubeRenderPass, std::get<3>(tupleOffscreen), m_vkImageCUBE, std::get<0>(tupleOffscreen), std::get<2>(tupleDescriptor), 512);
-
-	// Cleanup!
-	vkDestroyRenderPass(pDevice->m_vkLogicalDevice, hdr2CubeRenderPass, nullptr);
-	vkDestroyFramebuffer(pDevice->m_vkLogicalDevice, std::get<3>(tupleOffscreen), nullptr);
-	vkFreeMemory(pDevice->m_vkLogicalDevice, std::get<2>(tupleOffscreen), nullptr);
-	vkDestroyImageView(pDevice->m_vkLogicalDevice, std::get<1>(tupleOffscreen), nullptr);
-	vkDestroyImage(pDevice->m_vkLogicalDevice, std::get<0>(tupleOffscreen), nullptr);
-	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, std::get<0>(tupleDescriptor), nullptr);
-	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, std::get<1>(tupleDescriptor), nullptr);
-
-	m_pGraphicsPipelineHDRI2Cube->Cleanup(pDevice);
-	m_pDummySkybox->Cleanup(pDevice);
-
-	SAFE_DELETE(m_pGraphicsPipelineHDRI2Cube);
-	SAFE_DELETE(m_pDummySkybox);
-}
-
-//---------------------------------------------------------------------------------------------------------------------
-VkRenderPass VulkanTextureCUBE::CreateOffscreenRenderPass(VulkanDevice* pDevice, VkFormat format)
-{
-	VkRenderPass renderPass;
-
-	VkAttachmentDescription attachDesc = {};
-
-	// Color attachment
-	attachDesc.format						= format;
-	attachDesc.samples						= VK_SAMPLE_COUNT_1_BIT;
-	attachDesc.loadOp						= VK_ATTACHMENT_LOAD_OP_CLEAR;
-	attachDesc.storeOp						= VK_ATTACHMENT_STORE_OP_STORE;
-	attachDesc.stencilLoadOp				= VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	attachDesc.stencilStoreOp				= VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	attachDesc.initialLayout				= VK_IMAGE_LAYOUT_UNDEFINED;
-	attachDesc.finalLayout					= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-	
-	VkAttachmentReference	colorAttachRef	= {};
-	colorAttachRef.attachment				= 0;
-	colorAttachRef.layout					= VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	VkSubpassDescription	subpassDesc		= {};
-	subpassDesc.pipelineBindPoint			= VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpassDesc.colorAttachmentCount		= 1;
-	subpassDesc.pColorAttachments			= &colorAttachRef;
-
-	// Subpass dependencies
-	std::array<VkSubpassDependency, 2> dependencies;
-	dependencies[0].srcSubpass				= VK_SUBPASS_EXTERNAL;
-	dependencies[0].dstSubpass				= 0;
-	dependencies[0].srcStageMask			= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-	dependencies[0].dstStageMask			= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependencies[0].srcAccessMask			= VK_ACCESS_MEMORY_READ_BIT;
-	dependencies[0].dstAccessMask			= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	dependencies[0].dependencyFlags			= VK_DEPENDENCY_BY_REGION_BIT;
-	dependencies[1].srcSubpass				= 0;
-	dependencies[1].dstSubpass				= VK_SUBPASS_EXTERNAL;
-	dependencies[1].srcStageMask			= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependencies[1].dstStageMask			= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-	dependencies[1].srcAccessMask			= VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	dependencies[1].dstAccessMask			= VK_ACCESS_MEMORY_READ_BIT;
-	dependencies[1].dependencyFlags			= VK_DEPENDENCY_BY_REGION_BIT;
-
-	// Renderpass
-	VkRenderPassCreateInfo renderPassCreateInfo = {};
-	renderPassCreateInfo.sType				= VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassCreateInfo.attachmentCount	= 1;
-	renderPassCreateInfo.pAttachments		= &attachDesc;
-	renderPassCreateInfo.subpassCount		= 1;
-	renderPassCreateInfo.pSubpasses			= &subpassDesc;
-	renderPassCreateInfo.dependencyCount	= 2;
-	renderPassCreateInfo.pDependencies		= dependencies.data();
-
-	VkResult result = vkCreateRenderPass(pDevice->m_vkLogicalDevice, &renderPassCreateInfo, nullptr, &renderPass);
-	if (result != VK_SUCCESS)
+	if (!bCached)
 	{
-		LOG_ERROR("Failed to create Renderpass for Irradiance Cubemap creation!");
-		return VK_NULL_HANDLE;
+		GenerateIBL(pDevice, pHDRI);
+		WriteToCache(pDevice, cacheKey);
 	}
 
-	return renderPass;
+	float fMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - timeStart).count();
+	LOG_INFO("IBL maps for {0} {1} in {2:.2f} ms", fileName, bCached ? "loaded from cache" : "generated", fMs);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-std::tuple<VkImage, VkImageView, VkDeviceMemory, VkFramebuffer> VulkanTextureCUBE::CreateOffscreenFramebuffer(VulkanDevice* pDevice, 
-														VkRenderPass renderPass, VkFormat format, uint32_t dimension)
+void VulkanTextureCUBE::CreateIBLImages(VulkanDevice* pDevice)
 {
-	VkImage			offscreenImage;
-	VkImageView		offscreenImageView;
-	VkDeviceMemory	offscreenImageMemory;
-	VkFramebuffer	offscreenFramebuffer;
-
-	// Color attachment
-	offscreenImage = Helper::Vulkan::CreateImage(pDevice, dimension, dimension, format, VK_IMAGE_TILING_OPTIMAL,
-												 VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-												 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &offscreenImageMemory);
-
-	offscreenImageView = Helper::Vulkan::CreateImageView(pDevice, offscreenImage, format, VK_IMAGE_ASPECT_COLOR_BIT);
-
-	// Create Framebuffer
-	VkFramebufferCreateInfo fbCreateInfo = {};
-	fbCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-	fbCreateInfo.renderPass = renderPass;
-	fbCreateInfo.attachmentCount = 1;
-	fbCreateInfo.pAttachments = &offscreenImageView;
-	fbCreateInfo.width = dimension;
-	fbCreateInfo.height = dimension;
-	fbCreateInfo.layers = 1;
-
-	VkResult result = vkCreateFramebuffer(pDevice->m_vkLogicalDevice, &fbCreateInfo, nullptr, &offscreenFramebuffer);
-	if (result != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to create offscreen framebuffer for Irradiance map!");
-	}
+	const VkFormat format = IBLConfig::FORMAT;
+	const VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT | 
+									VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+
+	// Environment cubemap
+	m_vkImageCUBE = Helper::Vulkan::CreateImageCUBE(pDevice, IBLConfig::ENVIRONMENT_DIM, IBLConfig::ENVIRONMENT_DIM, format, 1,
+													VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vkImageMemoryCUBE);
+	m_vkImageViewCUBE = Helper::Vulkan::CreateImageViewCUBE(pDevice, m_vkImageCUBE, format, 1, VK_IMAGE_ASPECT_COLOR_BIT);
+	m_vkSamplerCUBE = CreateTextureSampler(pDevice, 1);
+
+	// Irradiance map
+	m_vkImageIRRAD = Helper::Vulkan::CreateImageCUBE(pDevice, IBLConfig::IRRADIANCE_DIM, IBLConfig::IRRADIANCE_DIM, format, 1,
+													 VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vkImageMemoryIRRAD);
+	m_vkImageViewIRRAD = Helper::Vulkan::CreateImageViewCUBE(pDevice, m_vkImageIRRAD, format, 1, VK_IMAGE_ASPECT_COLOR_BIT);
+	m_vkSamplerIRRAD = CreateTextureSampler(pDevice, 1);
 
-	Helper::Vulkan::TransitionImageLayout(pDevice, offscreenImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	// Prefiltered specular, full mip chain
+	m_vkImagePrefilterSpec = Helper::Vulkan::CreateImageCUBE(pDevice, IBLConfig::PREFILTER_DIM, IBLConfig::PREFILTER_DIM, format, m_uiPrefilterMipCount,
+															 VK_IMAGE_TILING_OPTIMAL, usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vkImageMemoryPrefilterSpec);
+	m_vkImageViewPrefilterSpec = Helper::Vulkan::CreateImageViewCUBE(pDevice, m_vkImagePrefilterSpec, format, m_uiPrefilterMipCount, VK_IMAGE_ASPECT_COLOR_BIT);
+	m_vkSamplerPrefilterSpec = CreateTextureSampler(pDevice, m_uiPrefilterMipCount);
 
-	return std::make_tuple(offscreenImage, offscreenImageView, offscreenImageMemory, offscreenFramebuffer);
+	// BRDF LUT
+	m_vkImageBRDF = Helper::Vulkan::CreateImage(pDevice, IBLConfig::BRDF_LUT_DIM, IBLConfig::BRDF_LUT_DIM, format, VK_IMAGE_TILING_OPTIMAL,
+												usage, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vkImageMemoryBRDF);
+	m_vkImageViewBRDF = Helper::Vulkan::CreateImageView(pDevice, m_vkImageBRDF, format, VK_IMAGE_ASPECT_COLOR_BIT);
+	m_vkSamplerBRDF = CreateTextureSampler(pDevice, 1);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> VulkanTextureCUBE::CreateHDRI2CubeDescriptorSet(VulkanDevice* pDevice)
+VkImageView VulkanTextureCUBE::CreateStorageView(VulkanDevice* pDevice, VkImage image, uint32_t mipLevel, uint32_t nLayers)
 {
-	VkResult result;
-	VkDescriptorPool		descPool;
-	VkDescriptorSetLayout	descSetLayout;
-	VkDescriptorSet			descSet;
-
-	// *** Create Descriptor pool
-	std::array<VkDescriptorPoolSize, 1> arrDescriptorPoolSize = {};
-	arrDescriptorPoolSize[0].descriptorCount = 1;
-	arrDescriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-
-	VkDescriptorPoolCreateInfo poolCreateInfo = {};
-	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.poolSizeCount = arrDescriptorPoolSize.size();
-	poolCreateInfo.pPoolSizes = arrDescriptorPoolSize.data();
-	poolCreateInfo.maxSets = 2;
-
-	result = vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &descPool);
-	if (result != VK_SUCCESS)
+	VkImageViewCreateInfo viewCreateInfo = {};
+	viewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCreateInfo.image = image;
+	viewCreateInfo.viewType = (nLayers > 1) ? VK_IMAGE_VIEW_TYPE_2D_ARRAY : VK_IMAGE_VIEW_TYPE_2D;
+	viewCreateInfo.format = IBLConfig::FORMAT;
+	viewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewCreateInfo.subresourceRange.baseMipLevel = mipLevel;
+	viewCreateInfo.subresourceRange.levelCount = 1;
+	viewCreateInfo.subresourceRange.baseArrayLayer = 0;
+	viewCreateInfo.subresourceRange.layerCount = nLayers;
+
+	VkImageView imageView = VK_NULL_HANDLE;
+	if (vkCreateImageView(pDevice->m_vkLogicalDevice, &viewCreateInfo, nullptr, &imageView) != VK_SUCCESS)
 	{
-		LOG_ERROR("Failed to create Descriptor Pool for HDRI2Cube!");
+		LOG_ERROR("Failed to create IBL storage image view!");
 	}
 
-	// *** Create Descriptor Set Layout
-	std::array<VkDescriptorSetLayoutBinding, 1> arrDescriptorSetLayoutBindings = {};
-	arrDescriptorSetLayoutBindings[0].binding = 0;
-	arrDescriptorSetLayoutBindings[0].descriptorCount = 1;
-	arrDescriptorSetLayoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorSetLayoutBindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-	VkDescriptorSetLayoutCreateInfo descSetlayoutCreateInfo = {};
-	descSetlayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	descSetlayoutCreateInfo.bindingCount = arrDescriptorSetLayoutBindings.size();
-	descSetlayoutCreateInfo.pBindings = arrDescriptorSetLayoutBindings.data();
-
-	result = vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &descSetlayoutCreateInfo, nullptr, &descSetLayout);
-	if (result != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to create Descriptor Set Layout for HDRI2Cube map!");
-	}
-
-	// *** Create Descriptor Set
-	VkDescriptorSetAllocateInfo	setAllocInfo = {};
-	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	setAllocInfo.descriptorPool = descPool;
-	setAllocInfo.descriptorSetCount = 1;
-	setAllocInfo.pSetLayouts = &descSetLayout;
-
-	result = vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &setAllocInfo, &descSet);
-	if (result != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to create Descriptor Set for HDRI2Cube map!");
-	}
-
-	// *** Write Descriptor Sets (HDRI Image goes in as parameter to shader which then gets converted into CubeMap!)
-	VkDescriptorImageInfo hdriImageInfo = {};
-	hdriImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	hdriImageInfo.imageView = m_pTextureHDRI->m_vkTextureImageView;
-	hdriImageInfo.sampler = m_pTextureHDRI->m_vkTextureSampler;
-
-	// Descriptor write info
-	VkWriteDescriptorSet hdriSetWrite = {};
-	hdriSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	hdriSetWrite.dstSet = descSet;
-	hdriSetWrite.dstBinding = 0;
-	hdriSetWrite.dstArrayElement = 0;
-	hdriSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	hdriSetWrite.descriptorCount = 1;
-	hdriSetWrite.pImageInfo = &hdriImageInfo;
-
-	// Update the descriptor sets with new buffer/binding info
-	vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, 1, &hdriSetWrite, 0, nullptr);
-
-	return std::make_tuple(descPool, descSetLayout, descSet);
+	return imageView;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> VulkanTextureCUBE::CreateIrradianceDescriptorSet(VulkanDevice* pDevice)
+// Records writes to every mip of outputImage, all cube faces in a single dispatch (faces in z through a 2D array storage
+// view), leaving it in SHADER_READ_ONLY_OPTIMAL for later dispatches & fragment shaders. Input is optional!
+void VulkanTextureCUBE::RecordIBLCompute(VulkanDevice* pDevice, VkCommandBuffer cmdBuffer, const std::string& computeShader, 
+										 VkImageView inputView, VkSampler inputSampler, VkImage outputImage, uint32_t dimension, 
+										 uint32_t nMipmaps, uint32_t nLayers, const std::vector<IBLComputePushData>& vecPushData, 
+										 IBLComputeJob& outJob)
 {
-	VkResult result;
-	VkDescriptorPool		descPool;
-	VkDescriptorSetLayout	descSetLayout;
-	VkDescriptorSet			descSet;
+	//*** Descriptor layout shared by all IBL shaders: 0 - input sampler, 1 - output storage image
+	std::array<VkDescriptorSetLayoutBinding, 2> arrBindings = {};
+	arrBindings[0].binding = 0;
+	arrBindings[0].descriptorCount = 1;
+	arrBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	arrBindings[0].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	arrBindings[1].binding = 1;
+	arrBindings[1].descriptorCount = 1;
+	arrBindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	arrBindings[1].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+
+	VkDescriptorSetLayoutCreateInfo layoutCreateInfo = {};
+	layoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutCreateInfo.bindingCount = static_cast<uint32_t>(arrBindings.size());
+	layoutCreateInfo.pBindings = arrBindings.data();
+
+	VkDescriptorSetLayout& descSetLayout = outJob.vkDescriptorSetLayout;
+	if (vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &layoutCreateInfo, nullptr, &descSetLayout) != VK_SUCCESS)
+	{
+		LOG_ERROR("Failed to create Descriptor Set Layout for {0}!", computeShader);
+	}
 
-	// *** Create Descriptor pool
-	std::array<VkDescriptorPoolSize, 1> arrDescriptorPoolSize = {};
-	arrDescriptorPoolSize[0].descriptorCount = 1;
-	arrDescriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	//*** One set per output mip
+	std::array<VkDescriptorPoolSize, 2> arrPoolSizes = {};
+	arrPoolSizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	arrPoolSizes[0].descriptorCount = nMipmaps;
+	arrPoolSizes[1].type = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+	arrPoolSizes[1].descriptorCount = nMipmaps;
 
 	VkDescriptorPoolCreateInfo poolCreateInfo = {};
 	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.poolSizeCount = arrDescriptorPoolSize.size();
-	poolCreateInfo.pPoolSizes = arrDescriptorPoolSize.data();
-	poolCreateInfo.maxSets = 2;
+	poolCreateInfo.poolSizeCount = static_cast<uint32_t>(arrPoolSizes.size());
+	poolCreateInfo.pPoolSizes = arrPoolSizes.data();
+	poolCreateInfo.maxSets = nMipmaps;
 
-	result = vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &descPool);
-	if (result != VK_SUCCESS)
+	VkDescriptorPool& descPool = outJob.vkDescriptorPool;
+	if (vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &descPool) != VK_SUCCESS)
 	{
-		LOG_ERROR("Failed to create Descriptor Pool for Irradiance map!");
+		LOG_ERROR("Failed to create Descriptor Pool for {0}!", computeShader);
 	}
 
-	// *** Create Descriptor Set Layout
-	std::array<VkDescriptorSetLayoutBinding, 1> arrDescriptorSetLayoutBindings = {};
-	arrDescriptorSetLayoutBindings[0].binding = 0;
-	arrDescriptorSetLayoutBindings[0].descriptorCount = 1;
-	arrDescriptorSetLayoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorSetLayoutBindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-
-	VkDescriptorSetLayoutCreateInfo descSetlayoutCreateInfo = {};
-	descSetlayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	descSetlayoutCreateInfo.bindingCount = arrDescriptorSetLayoutBindings.size();
-	descSetlayoutCreateInfo.pBindings = arrDescriptorSetLayoutBindings.data();
-	
-	result = vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &descSetlayoutCreateInfo, nullptr, &descSetLayout);
-	if (result != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to create Descriptor Set Layout for Irradiance map!");
-	}
+	std::vector<VkDescriptorSetLayout> vecSetLayouts(nMipmaps, descSetLayout);
+	std::vector<VkDescriptorSet> vecDescSets(nMipmaps);
 
-	// *** Create Descriptor Set
-	VkDescriptorSetAllocateInfo	setAllocInfo = {};
+	VkDescriptorSetAllocateInfo setAllocInfo = {};
 	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
 	setAllocInfo.descriptorPool = descPool;
-	setAllocInfo.descriptorSetCount = 1;
-	setAllocInfo.pSetLayouts = &descSetLayout;
+	setAllocInfo.descriptorSetCount = nMipmaps;
+	setAllocInfo.pSetLayouts = vecSetLayouts.data();
 
-	result = vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &setAllocInfo, &descSet);
-	if (result != VK_SUCCESS)
+	if (vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &setAllocInfo, vecDescSets.data()) != VK_SUCCESS)
 	{
-		LOG_ERROR("Failed to create Descriptor Set for Irradiance map!");
+		LOG_ERROR("Failed to allocate Descriptor Sets for {0}!", computeShader);
 	}
 
-	// *** Write Descriptor Sets (Cubemap Image goes in as parameter to shader which then gets converted into Irrad Map!)
-	VkDescriptorImageInfo cubemapImageInfo = {};
-	cubemapImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;											
-	cubemapImageInfo.imageView = m_vkImageViewCUBE;																	
-	cubemapImageInfo.sampler = m_vkSamplerCUBE;			
-
-	// Descriptor write info
-	VkWriteDescriptorSet cubemapSetWrite = {};
-	cubemapSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	cubemapSetWrite.dstSet = descSet;
-	cubemapSetWrite.dstBinding = 0;
-	cubemapSetWrite.dstArrayElement = 0;
-	cubemapSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	cubemapSetWrite.descriptorCount = 1;
-	cubemapSetWrite.pImageInfo = &cubemapImageInfo;
-
-	// Update the descriptor sets with new buffer/binding info
-	vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, 1, &cubemapSetWrite, 0, nullptr);
-
-	return std::make_tuple(descPool, descSetLayout, descSet);
-}
-
-//---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::CreateHDRI2CubePipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, VkDescriptorSetLayout descSetLayout, VkRenderPass renderPass)
-{
-	m_pGraphicsPipelineHDRI2Cube = new VulkanGraphicsPipeline(PipelineType::HDRI_CUBE, pSwapchain);
-
-	// Descriptor Set layouts!
-	std::vector<VkDescriptorSetLayout> setLayouts = { descSetLayout };
+	std::vector<VkImageView>& vecOutputViews = outJob.vecOutputViews;
+	vecOutputViews.resize(nMipmaps);
+	for (uint32_t m = 0; m < nMipmaps; ++m)
+	{
+		vecOutputViews[m] = CreateStorageView(pDevice, outputImage, m, nLayers);
+
+		VkDescriptorImageInfo inputInfo = {};
+		inputInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		inputInfo.imageView = inputView;
+		inputInfo.sampler = inputSampler;
+
+		VkDescriptorImageInfo outputInfo = {};
+		outputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		outputInfo.imageView = vecOutputViews[m];
+
+		std::array<VkWriteDescriptorSet, 2> arrWrites = {};
+		arrWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		arrWrites[0].dstSet = vecDescSets[m];
+		arrWrites[0].dstBinding = 1;
+		arrWrites[0].descriptorCount = 1;
+		arrWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+		arrWrites[0].pImageInfo = &outputInfo;
+		arrWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		arrWrites[1].dstSet = vecDescSets[m];
+		arrWrites[1].dstBinding = 0;
+		arrWrites[1].descriptorCount = 1;
+		arrWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		arrWrites[1].pImageInfo = &inputInfo;
+
+		// BRDF LUT has no input, binding 0 is left unwritten
+		uint32_t nWrites = (inputView != VK_NULL_HANDLE) ? 2 : 1;
+		vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, nWrites, arrWrites.data(), 0, nullptr);
+	}
 
-	// Push constants!
+	//*** Pipeline
 	VkPushConstantRange pushConstantRange = {};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	pushConstantRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
 	pushConstantRange.offset = 0;
-	pushConstantRange.size = sizeof(HDRIShaderPushData);
+	pushConstantRange.size = sizeof(IBLComputePushData);
 
-	std::vector<VkPushConstantRange> pushConstantRanges = { pushConstantRange };
+	VulkanComputePipeline* pPipeline = new VulkanComputePipeline(computeShader);
+	pPipeline->CreatePipelineLayout(pDevice, { descSetLayout }, { pushConstantRange });
+	pPipeline->CreateComputePipeline(pDevice);
+	outJob.pPipeline = pPipeline;
 
-	m_pGraphicsPipelineHDRI2Cube->CreatePipelineLayout(pDevice, setLayouts, pushConstantRanges);
-	m_pGraphicsPipelineHDRI2Cube->CreateGraphicsPipeline(pDevice, pSwapchain, renderPass, 0, 1);
-}
+	//*** Record
+	ImageBarrier(cmdBuffer, outputImage, nMipmaps, nLayers, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+				 0, VK_ACCESS_SHADER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
 
-//---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::CreateIrradiancePipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, VkDescriptorSetLayout descSetLayout, VkRenderPass renderPass)
-{
-	m_pGraphicsPipelineIrradiance = new VulkanGraphicsPipeline(PipelineType::IRRADIANCE_CUBE, pSwapchain);
-
-	// Descriptor Set layouts!
-	std::vector<VkDescriptorSetLayout> setLayouts = { descSetLayout };
+	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pPipeline->m_vkComputePipeline);
 
-	// Push constants!
-	VkPushConstantRange pushConstantRange = {};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-	pushConstantRange.offset = 0;
-	pushConstantRange.size = sizeof(IrradShaderPushData);
+	for (uint32_t m = 0; m < nMipmaps; ++m)
+	{
+		uint32_t mipDim = std::max(dimension >> m, 1u);
+		IBLComputePushData pushData = (m < vecPushData.size()) ? vecPushData[m] : IBLComputePushData();
 
-	std::vector<VkPushConstantRange> pushConstantRanges = { pushConstantRange };
+		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pPipeline->m_vkPipelineLayout, 0, 1, &vecDescSets[m], 0, nullptr);
+		vkCmdPushConstants(cmdBuffer, pPipeline->m_vkPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(IBLComputePushData), &pushData);
+		vkCmdDispatch(cmdBuffer, (mipDim + 7) / 8, (mipDim + 7) / 8, nLayers);
+	}
 
-	m_pGraphicsPipelineIrradiance->CreatePipelineLayout(pDevice, setLayouts, pushConstantRanges);
-	m_pGraphicsPipelineIrradiance->CreateGraphicsPipeline(pDevice, pSwapchain, renderPass, 0, 1);
+	ImageBarrier(cmdBuffer, outputImage, nMipmaps, nLayers, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				 VK_ACCESS_SHADER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 
+				 VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::RenderIrrandianceCUBE(VulkanDevice* pDevice, VkRenderPass renderPass, VkFramebuffer framebuffer, VkImage irradImage, VkImage offscreenImage, VkDescriptorSet irradDescSet, uint32_t dimension)
+void VulkanTextureCUBE::CleanupIBLComputeJob(VulkanDevice* pDevice, IBLComputeJob& job)
 {
-	std::array<VkClearValue, 1> arrClearValues;
-	arrClearValues[0].color = { {0.8f, 0.8f, 0.8f, 0.0f} };
-
-	VkRenderPassBeginInfo renderPassBeginInfo = {};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = renderPass;
-	renderPassBeginInfo.framebuffer = framebuffer;
-	renderPassBeginInfo.renderArea.extent.width = dimension;
-	renderPassBeginInfo.renderArea.extent.height = dimension;
-	renderPassBeginInfo.clearValueCount = arrClearValues.size();
-	renderPassBeginInfo.pClearValues = arrClearValues.data();
-
-	glm::mat4 captureViews[] =
+	for (VkImageView view : job.vecOutputViews)
 	{
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f,  1.0f), glm::vec3(0.0f, -1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f, -1.0f), glm::vec3(0.0f, -1.0f,  0.0f))
-	};
-
-	VkViewport vp = {};
-	vp.width = (float)dimension;
-	vp.height = (float)dimension;
-	vp.minDepth = 0.0f;
-	vp.maxDepth = 1.0f;
-
-	VkRect2D scissorRect = {};
-	scissorRect.extent.width = dimension;
-	scissorRect.extent.height = dimension;
-	scissorRect.offset.x = 0.0f;
-	scissorRect.offset.y = 0.0f;
-
-	IrradShaderPushData irradPushData;
-
-	// Start recording commands to command buffer!
-	VkCommandBuffer cmdBuffer = pDevice->BeginCommandBuffer();
-
-	vkCmdSetViewport(cmdBuffer, 0, 1, &vp);
-	vkCmdSetScissor(cmdBuffer, 0, 1, &scissorRect);
-
-	VkImageSubresourceRange subresourceRange = {};
-	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	subresourceRange.baseMipLevel = 0;
-	subresourceRange.levelCount = 1;
-	subresourceRange.layerCount = 6;
+		vkDestroyImageView(pDevice->m_vkLogicalDevice, view, nullptr);
+	}
 
-	// Change image layout for all cubemap faces to transfer destination
-	Helper::Vulkan::TransitionImageLayout(pDevice, cmdBuffer, irradImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
+	job.vecOutputViews.clear();
 
-	// 6 faces of irradiance map!
-	for (uint32_t f = 0; f < 6; f++)
+	if (job.pPipeline)
 	{
-		// Render scene from cube face's point of view
-		vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-		irradPushData.mvp = glm::perspective((float)(M_PI_OVER_TWO), 1.0f, 0.1f, 512.0f) * captureViews[f];
-		vkCmdPushConstants(	cmdBuffer,
-							m_pGraphicsPipelineIrradiance->m_vkPipelineLayout,
-							VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-							0, sizeof(IrradShaderPushData),
-							&irradPushData);	
-
-		vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineIrradiance->m_vkGraphicsPipeline);
-		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineIrradiance->m_vkPipelineLayout, 0, 1, &irradDescSet, 0, NULL);
-
-		m_pDummySkybox->Render(pDevice, cmdBuffer);
-
-		vkCmdEndRenderPass(cmdBuffer);
-
-		Helper::Vulkan::TransitionImageLayout(pDevice, cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-
-		// Copy region for transfer from framebuffer to cube face
-		VkImageCopy copyRegion = {};
-
-		copyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		copyRegion.srcSubresource.baseArrayLayer = 0;
-		copyRegion.srcSubresource.mipLevel = 0;
-		copyRegion.srcSubresource.layerCount = 1;
-		copyRegion.srcOffset = { 0, 0, 0 };
-
-		copyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		copyRegion.dstSubresource.baseArrayLayer = f;
-		copyRegion.dstSubresource.mipLevel = 0;
-		copyRegion.dstSubresource.layerCount = 1;
-		copyRegion.dstOffset = { 0, 0, 0 };
-
-		copyRegion.extent.width = static_cast<uint32_t>(vp.width);
-		copyRegion.extent.height = static_cast<uint32_t>(vp.height);
-		copyRegion.extent.depth = 1;
-
-		vkCmdCopyImage(cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, irradImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1,&copyRegion);
-
-		// Transform framebuffer color attachment back
-		Helper::Vulkan::TransitionImageLayout(pDevice, cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		job.pPipeline->Cleanup(pDevice);
+		SAFE_DELETE(job.pPipeline);
 	}
 
-	// Transform Irradiance map to Shader readable optimal format!
-	Helper::Vulkan::TransitionImageLayout(pDevice, cmdBuffer, irradImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange);
-
-	pDevice->EndAndSubmitCommandBuffer(cmdBuffer);
+	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, job.vkDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, job.vkDescriptorSetLayout, nullptr);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> VulkanTextureCUBE::CreatePrefilteredSpecDescriptorSet(VulkanDevice* pDevice)
+// All maps are recorded into one command buffer & submitted once. Barrier at the end of each map makes the environment
+// cubemap readable by irradiance & prefilter dispatches, so there's no queue idle wait in between!
+void VulkanTextureCUBE::GenerateIBL(VulkanDevice* pDevice, VulkanTexture2D* pHDRI)
 {
-	VkResult result;
-	VkDescriptorPool		descPool;
-	VkDescriptorSetLayout	descSetLayout;
-	VkDescriptorSet			descSet;
+	std::array<IBLComputeJob, 4> arrJobs;
 
-	// *** Create Descriptor pool
-	std::array<VkDescriptorPoolSize, 1> arrDescriptorPoolSize = {};
-	arrDescriptorPoolSize[0].descriptorCount = 1;
-	arrDescriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	VkCommandBuffer cmdBuffer = pDevice->BeginCommandBuffer();
 
-	VkDescriptorPoolCreateInfo poolCreateInfo = {};
-	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.poolSizeCount = arrDescriptorPoolSize.size();
-	poolCreateInfo.pPoolSizes = arrDescriptorPoolSize.data();
-	poolCreateInfo.maxSets = 2;
+	// HDRI -> Environment cubemap
+	RecordIBLCompute(pDevice, cmdBuffer, "Shaders/IBLEquirectToCube.comp.spv", pHDRI->m_vkTextureImageView, pHDRI->m_vkTextureSampler,
+					 m_vkImageCUBE, IBLConfig::ENVIRONMENT_DIM, 1, 6, {}, arrJobs[0]);
 
-	result = vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &descPool);
-	if (result != VK_SUCCESS)
+	// Environment -> Irradiance
+	RecordIBLCompute(pDevice, cmdBuffer, "Shaders/IBLIrradiance.comp.spv", m_vkImageViewCUBE, m_vkSamplerCUBE,
+					 m_vkImageIRRAD, IBLConfig::IRRADIANCE_DIM, 1, 6, {}, arrJobs[1]);
+
+	// Environment -> Prefiltered specular, one roughness per mip
+	std::vector<IBLComputePushData> vecPushData(m_uiPrefilterMipCount);
+	for (uint32_t m = 0; m < m_uiPrefilterMipCount; ++m)
 	{
-		LOG_ERROR("Failed to create Descriptor Pool for Irradiance map!");
+		vecPushData[m].roughness = static_cast<float>(m) / static_cast<float>(m_uiPrefilterMipCount - 1);
 	}
 
-	// *** Create Descriptor Set Layout
-	std::array<VkDescriptorSetLayoutBinding, 1> arrDescriptorSetLayoutBindings = {};
-	arrDescriptorSetLayoutBindings[0].binding = 0;
-	arrDescriptorSetLayoutBindings[0].descriptorCount = 1;
-	arrDescriptorSetLayoutBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	arrDescriptorSetLayoutBindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	RecordIBLCompute(pDevice, cmdBuffer, "Shaders/IBLPrefilter.comp.spv", m_vkImageViewCUBE, m_vkSamplerCUBE,
+					 m_vkImagePrefilterSpec, IBLConfig::PREFILTER_DIM, m_uiPrefilterMipCount, 6, vecPushData, arrJobs[2]);
 
-	VkDescriptorSetLayoutCreateInfo descSetlayoutCreateInfo = {};
-	descSetlayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	descSetlayoutCreateInfo.bindingCount = arrDescriptorSetLayoutBindings.size();
-	descSetlayoutCreateInfo.pBindings = arrDescriptorSetLayoutBindings.data();
+	// BRDF LUT, independent of environment
+	RecordIBLCompute(pDevice, cmdBuffer, "Shaders/IBLBrdfLUT.comp.spv", VK_NULL_HANDLE, VK_NULL_HANDLE,
+					 m_vkImageBRDF, IBLConfig::BRDF_LUT_DIM, 1, 1, {}, arrJobs[3]);
 
-	result = vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &descSetlayoutCreateInfo, nullptr, &descSetLayout);
-	if (result != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to create Descriptor Set Layout for Irradiance map!");
-	}
-
-	// *** Create Descriptor Set
-	VkDescriptorSetAllocateInfo	setAllocInfo = {};
-	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	setAllocInfo.descriptorPool = descPool;
-	setAllocInfo.descriptorSetCount = 1;
-	setAllocInfo.pSetLayouts = &descSetLayout;
+	// Waits for queue idle, transient resources are free to go afterwards
+	pDevice->EndAndSubmitCommandBuffer(cmdBuffer);
 
-	result = vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &setAllocInfo, &descSet);
-	if (result != VK_SUCCESS)
+	for (IBLComputeJob& job : arrJobs)
 	{
-		LOG_ERROR("Failed to create Descriptor Set for Irradiance map!");
+		CleanupIBLComputeJob(pDevice, job);
 	}
-
-	// *** Write Descriptor Sets (Cubemap Image goes in as parameter to shader which then gets converted into Prefiltered SpecMap!)
-	VkDescriptorImageInfo cubemapImageInfo = {};
-	cubemapImageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-	cubemapImageInfo.imageView = m_vkImageViewCUBE;
-	cubemapImageInfo.sampler = m_vkSamplerCUBE;
-
-	// Descriptor write info
-	VkWriteDescriptorSet cubemapSetWrite = {};
-	cubemapSetWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-	cubemapSetWrite.dstSet = descSet;
-	cubemapSetWrite.dstBinding = 0;
-	cubemapSetWrite.dstArrayElement = 0;
-	cubemapSetWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-	cubemapSetWrite.descriptorCount = 1;
-	cubemapSetWrite.pImageInfo = &cubemapImageInfo;
-
-	// Update the descriptor sets with new buffer/binding info
-	vkUpdateDescriptorSets(pDevice->m_vkLogicalDevice, 1, &cubemapSetWrite, 0, nullptr);
-
-	return std::make_tuple(descPool, descSetLayout, descSet);
-}
-
-//---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::CreatePrefilteredSpecPipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, VkDescriptorSetLayout descSetLayout, VkRenderPass renderPass)
-{
-	m_pGraphicsPipelinePrefilterSpec = new VulkanGraphicsPipeline(PipelineType::PREFILTER_SPEC, pSwapchain);
-
-	// Descriptor Set layouts!
-	std::vector<VkDescriptorSetLayout> setLayouts = { descSetLayout };
-
-	// Push constants!
-	VkPushConstantRange pushConstantRange = {};
-	pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
-	pushConstantRange.offset = 0;
-	pushConstantRange.size = sizeof(PrefilterShaderPushData);
-
-	std::vector<VkPushConstantRange> pushConstantRanges = { pushConstantRange };
-
-	m_pGraphicsPipelinePrefilterSpec->CreatePipelineLayout(pDevice, setLayouts, pushConstantRanges);
-	m_pGraphicsPipelinePrefilterSpec->CreateGraphicsPipeline(pDevice, pSwapchain, renderPass, 0, 1);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::RenderPrefilteredSpec(VulkanDevice* pDevice, VkRenderPass renderPass, VkFramebuffer framebuffer, VkImage prefilterImage, VkImage offscreenImage, VkDescriptorSet prefilterDescSet, uint32_t dimension, uint32_t nMipmaps)
+// FNV-1a over HDRI file contents + cache version, so both a new HDRI and changed IBL shaders invalidate the cache
+std::string VulkanTextureCUBE::GetCacheKey(const std::string& fileName)
 {
-	std::array<VkClearValue, 1> arrClearValues;
-	arrClearValues[0].color = { {0.8f, 0.8f, 0.8f, 0.0f} };
-
-	VkRenderPassBeginInfo renderPassBeginInfo = {};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = renderPass;
-	renderPassBeginInfo.framebuffer = framebuffer;
-	renderPassBeginInfo.renderArea.extent.width = dimension;
-	renderPassBeginInfo.renderArea.extent.height = dimension;
-	renderPassBeginInfo.clearValueCount = arrClearValues.size();
-	renderPassBeginInfo.pClearValues = arrClearValues.data();
-
-	glm::mat4 captureViews[] =
+	uint64_t hash = 14695981039346656037ull;
+	auto HashBytes = [&hash](const char* pData, size_t size)
 	{
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f,  1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 1.0f,  0.0f,  0.0f), glm::vec3(0.0f,  1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f, -1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f,  1.0f), glm::vec3(0.0f,  1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3( 0.0f,  0.0f, -1.0f), glm::vec3(0.0f,  1.0f,  0.0f))
+		for (size_t i = 0; i < size; ++i)
+		{
+			hash ^= static_cast<uint8_t>(pData[i]);
+			hash *= 1099511628211ull;
+		}
 	};
 
-	VkViewport vp = {};
-	vp.width = (float)dimension;
-	vp.height = (float)dimension;
-	vp.minDepth = 0.0f;
-	vp.maxDepth = 1.0f;
-
-	VkRect2D scissorRect = {};
-	scissorRect.extent.width = dimension;
-	scissorRect.extent.height = dimension;
-	scissorRect.offset.x = 0.0f;
-	scissorRect.offset.y = 0.0f;
-
-	PrefilterShaderPushData prefilterShaderData;
-
-	// Start recording commands to command buffer!
-	VkCommandBuffer cmdBuffer = pDevice->BeginCommandBuffer();
-
-	vkCmdSetViewport(cmdBuffer, 0, 1, &vp);
-	vkCmdSetScissor(cmdBuffer, 0, 1, &scissorRect);
-
-	VkImageSubresourceRange subresourceRange = {};
-	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	subresourceRange.baseMipLevel = 0;
-	subresourceRange.levelCount = nMipmaps;
-	subresourceRange.layerCount = 6;
-
-	// Change image layout for all cubemap faces to transfer destination
-	Helper::Vulkan::TransitionImageLayoutCUBE(pDevice, cmdBuffer, prefilterImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
+	const uint32_t version = IBLConfig::CACHE_VERSION;
+	HashBytes(reinterpret_cast<const char*>(&version), sizeof(version));
 
-	for (uint32_t m = 0; m < nMipmaps; m++) 
+	std::ifstream file("Textures/HDRI/" + fileName, std::ios::binary);
+	std::array<char, 64 * 1024> arrChunk;
+	while (file.read(arrChunk.data(), arrChunk.size()) || file.gcount() > 0)
 	{
-		prefilterShaderData.roughness = (float)m / (float)(nMipmaps - 1);
-
-		for (uint32_t f = 0; f < 6; f++) 
-		{
-			vp.width = static_cast<float>(dimension * std::pow(0.5f, m));
-			vp.height = static_cast<float>(dimension * std::pow(0.5f, m));
-			vkCmdSetViewport(cmdBuffer, 0, 1, &vp);
-
-			// Render scene from cube face's point of view
-			vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-			// Update shader push constant block
-			prefilterShaderData.mvp = glm::perspective((float)(M_PI / 2.0), 1.0f, 0.1f, 512.0f) * captureViews[f];
-
-			vkCmdPushConstants(	cmdBuffer, 
-								m_pGraphicsPipelinePrefilterSpec->m_vkPipelineLayout, 
-								VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 
-								0, 
-								sizeof(PrefilterShaderPushData), &prefilterShaderData);
-
-			vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelinePrefilterSpec->m_vkGraphicsPipeline);
-			vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelinePrefilterSpec->m_vkPipelineLayout, 0, 1, &prefilterDescSet, 0, NULL);
-
-			m_pDummySkybox->Render(pDevice, cmdBuffer);
-
-			vkCmdEndRenderPass(cmdBuffer);
-
-			Helper::Vulkan::TransitionImageLayout(pDevice, cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-
-			// Copy region for transfer from framebuffer to cube face
-			VkImageCopy copyRegion = {};
-
-			copyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			copyRegion.srcSubresource.baseArrayLayer = 0;
-			copyRegion.srcSubresource.mipLevel = 0;
-			copyRegion.srcSubresource.layerCount = 1;
-			copyRegion.srcOffset = { 0, 0, 0 };
-
-			copyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-			copyRegion.dstSubresource.baseArrayLayer = f;
-			copyRegion.dstSubresource.mipLevel = m;
-			copyRegion.dstSubresource.layerCount = 1;
-			copyRegion.dstOffset = { 0, 0, 0 };
-
-			copyRegion.extent.width = static_cast<uint32_t>(vp.width);
-			copyRegion.extent.height = static_cast<uint32_t>(vp.height);
-			copyRegion.extent.depth = 1;
-
-			vkCmdCopyImage(cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, prefilterImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-
-			// Transform framebuffer color attachment back
-			Helper::Vulkan::TransitionImageLayout(pDevice, cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-		}
+		HashBytes(arrChunk.data(), static_cast<size_t>(file.gcount()));
 	}
 
-	// Transform Irradiance map to Shader readable optimal format!
-	Helper::Vulkan::TransitionImageLayoutCUBE(pDevice, cmdBuffer, prefilterImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange);
+	std::stringstream ss;
+	ss << "Cache/IBL/" << std::hex << std::setw(16) << std::setfill('0') << hash;
 
-	pDevice->EndAndSubmitCommandBuffer(cmdBuffer);
+	return ss.str();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> VulkanTextureCUBE::CreateBrdfLUTDescriptorSet(VulkanDevice* pDevice)
+bool VulkanTextureCUBE::LoadFromCache(VulkanDevice* pDevice, const std::string& cacheKey)
 {
-	VkResult result;
-	VkDescriptorPool		descPool;
-	VkDescriptorSetLayout	descSetLayout;
-	VkDescriptorSet			descSet;
+	struct CacheEntry
+	{
+		std::string		suffix;
+		VkImage			image;
+		uint32_t		dimension;
+		uint32_t		nMipmaps;
+		uint32_t		nFaces;
+	};
 
-	// *** Create Descriptor pool
-	std::array<VkDescriptorPoolSize, 1> arrDescriptorPoolSize = {};
-	arrDescriptorPoolSize[0].descriptorCount = 1;
-	arrDescriptorPoolSize[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	std::array<CacheEntry, 4> arrEntries =
+	{ {
+		{ "_environment.ktx2",	m_vkImageCUBE,			IBLConfig::ENVIRONMENT_DIM,	1,						6 },
+		{ "_irradiance.ktx2",	m_vkImageIRRAD,			IBLConfig::IRRADIANCE_DIM,	1,						6 },
+		{ "_prefiltered.ktx2",	m_vkImagePrefilterSpec,	IBLConfig::PREFILTER_DIM,	m_uiPrefilterMipCount,	6 },
+		{ "_brdf.ktx2",			m_vkImageBRDF,			IBLConfig::BRDF_LUT_DIM,	1,						1 }
+	} };
+
+	// Read & validate everything first, partially filled IBL would be worse than regenerating
+	std::array<KTX2Image, 4> arrImages;
+	for (uint32_t i = 0; i < arrEntries.size(); ++i)
+	{
+		const CacheEntry& entry = arrEntries[i];
+		KTX2Image& ktxImage = arrImages[i];
 
-	VkDescriptorPoolCreateInfo poolCreateInfo = {};
-	poolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-	poolCreateInfo.poolSizeCount = arrDescriptorPoolSize.size();
-	poolCreateInfo.pPoolSizes = arrDescriptorPoolSize.data();
-	poolCreateInfo.maxSets = 2;
+		if (!KTX2::Read(cacheKey + entry.suffix, ktxImage))
+			return false;
 
-	result = vkCreateDescriptorPool(pDevice->m_vkLogicalDevice, &poolCreateInfo, nullptr, &descPool);
-	if (result != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to create Descriptor Pool for Irradiance map!");
-	}
+		bool bValid =	ktxImage.vkFormat == IBLConfig::FORMAT && ktxImage.uiWidth == entry.dimension && ktxImage.uiHeight == entry.dimension &&
+						ktxImage.uiFaceCount == entry.nFaces && ktxImage.vecLevels.size() == entry.nMipmaps;
 
-	// *** Create Descriptor Set Layout
-	std::array<VkDescriptorSetLayoutBinding, 1> arrDescriptorSetLayoutBindings = {};
-	
-	VkDescriptorSetLayoutCreateInfo descSetlayoutCreateInfo = {};
-	descSetlayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-	descSetlayoutCreateInfo.bindingCount = arrDescriptorSetLayoutBindings.size();
-	descSetlayoutCreateInfo.pBindings = arrDescriptorSetLayoutBindings.data();
+		for (uint32_t m = 0; bValid && m < entry.nMipmaps; ++m)
+		{
+			uint64_t mipDim = std::max(entry.dimension >> m, 1u);
+			bValid = ktxImage.vecLevels[m].size() == mipDim * mipDim * 8 * entry.nFaces;
+		}
 
-	result = vkCreateDescriptorSetLayout(pDevice->m_vkLogicalDevice, &descSetlayoutCreateInfo, nullptr, &descSetLayout);
-	if (result != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to create Descriptor Set Layout for Irradiance map!");
+		if (!bValid)
+		{
+			LOG_WARNING("Stale IBL cache {0}, regenerating", cacheKey + entry.suffix);
+			return false;
+		}
 	}
 
-	// *** Create Descriptor Set
-	VkDescriptorSetAllocateInfo	setAllocInfo = {};
-	setAllocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-	setAllocInfo.descriptorPool = descPool;
-	setAllocInfo.descriptorSetCount = 1;
-	setAllocInfo.pSetLayouts = &descSetLayout;
-
-	result = vkAllocateDescriptorSets(pDevice->m_vkLogicalDevice, &setAllocInfo, &descSet);
-	if (result != VK_SUCCESS)
+	for (uint32_t i = 0; i < arrEntries.size(); ++i)
 	{
-		LOG_ERROR("Failed to create Descriptor Set for Irradiance map!");
+		UploadImage(pDevice, arrEntries[i].image, arrImages[i]);
 	}
 
-	return std::make_tuple(descPool, descSetLayout, descSet);
+	return true;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::CreateBrdfLUTPipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, VkDescriptorSetLayout descSetLayout, VkRenderPass renderPass)
+void VulkanTextureCUBE::WriteToCache(VulkanDevice* pDevice, const std::string& cacheKey)
 {
-	m_pGraphicsPipelineBrdfLUT = new VulkanGraphicsPipeline(PipelineType::BRDF_LUT, pSwapchain);
+	std::error_code errorCode;
+	std::filesystem::create_directories(std::filesystem::path(cacheKey).parent_path(), errorCode);
 
-	// Descriptor Set layouts!
-	std::vector<VkDescriptorSetLayout> setLayouts = { descSetLayout };
-	std::vector<VkPushConstantRange> pushConstantRanges = { };
+	KTX2Image ktxImage;
 
-	m_pGraphicsPipelineBrdfLUT->CreatePipelineLayout(pDevice, setLayouts, pushConstantRanges);
-	m_pGraphicsPipelineBrdfLUT->CreateGraphicsPipeline(pDevice, pSwapchain, renderPass, 0, 1);
-}
+	ReadbackImage(pDevice, m_vkImageCUBE, IBLConfig::ENVIRONMENT_DIM, 1, 6, ktxImage);
+	KTX2::Write(cacheKey + "_environment.ktx2", ktxImage);
 
-//---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::RenderBrdfLUT(VulkanDevice* pDevice, VkRenderPass renderPass, VkFramebuffer framebuffer, VkDescriptorSet irradDescSet, uint32_t dimension)
-{
-	std::array<VkClearValue, 1> arrClearValues;
-	arrClearValues[0].color = { {0.8f, 0.8f, 0.8f, 0.0f} };
-
-	VkRenderPassBeginInfo renderPassBeginInfo = {};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = renderPass;
-	renderPassBeginInfo.framebuffer = framebuffer;
-	renderPassBeginInfo.renderArea.extent.width = dimension;
-	renderPassBeginInfo.renderArea.extent.height = dimension;
-	renderPassBeginInfo.clearValueCount = arrClearValues.size();
-	renderPassBeginInfo.pClearValues = arrClearValues.data();
-
-	VkViewport vp = {};
-	vp.width = (float)dimension;
-	vp.height = (float)dimension;
-	vp.minDepth = 0.0f;
-	vp.maxDepth = 1.0f;
-
-	VkRect2D scissorRect = {};
-	scissorRect.extent.width = dimension;
-	scissorRect.extent.height = dimension;
-	scissorRect.offset.x = 0.0f;
-	scissorRect.offset.y = 0.0f;
-
-	// Start recording commands to command buffer!
-	VkCommandBuffer cmdBuffer = pDevice->BeginCommandBuffer();
-
-	// Render scene from cube face's point of view
-	vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-	vkCmdSetViewport(cmdBuffer, 0, 1, &vp);
-	vkCmdSetScissor(cmdBuffer, 0, 1, &scissorRect);
-
-	vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineBrdfLUT->m_vkGraphicsPipeline);
-	vkCmdDraw(cmdBuffer, 3, 1, 0, 0);
+	ReadbackImage(pDevice, m_vkImageIRRAD, IBLConfig::IRRADIANCE_DIM, 1, 6, ktxImage);
+	KTX2::Write(cacheKey + "_irradiance.ktx2", ktxImage);
 
-	vkCmdEndRenderPass(cmdBuffer);
+	ReadbackImage(pDevice, m_vkImagePrefilterSpec, IBLConfig::PREFILTER_DIM, m_uiPrefilterMipCount, 6, ktxImage);
+	KTX2::Write(cacheKey + "_prefiltered.ktx2", ktxImage);
 
-	pDevice->EndAndSubmitCommandBuffer(cmdBuffer);
+	ReadbackImage(pDevice, m_vkImageBRDF, IBLConfig::BRDF_LUT_DIM, 1, 1, ktxImage);
+	KTX2::Write(cacheKey + "_brdf.ktx2", ktxImage);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::RenderHDRI2CUBE(VulkanDevice* pDevice, VkRenderPass renderPass, VkFramebuffer framebuffer, VkImage cubeImage, VkImage offscreenImage, VkDescriptorSet cubeDescSet, uint32_t dimension)
+// Levels are packed back to back in a single staging buffer, image ends up in SHADER_READ_ONLY_OPTIMAL
+void VulkanTextureCUBE::UploadImage(VulkanDevice* pDevice, VkImage image, const KTX2Image& ktxImage)
 {
-	std::array<VkClearValue, 1> arrClearValues;
-	arrClearValues[0].color = { {0.8f, 0.8f, 0.8f, 0.0f} };
-
-	VkRenderPassBeginInfo renderPassBeginInfo = {};
-	renderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassBeginInfo.renderPass = renderPass;
-	renderPassBeginInfo.framebuffer = framebuffer;
-	renderPassBeginInfo.renderArea.extent.width = dimension;
-	renderPassBeginInfo.renderArea.extent.height = dimension;
-	renderPassBeginInfo.clearValueCount = arrClearValues.size();
-	renderPassBeginInfo.pClearValues = arrClearValues.data();
-
-	glm::mat4 captureViews[] =
-	{
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(-1.0f,  0.0f,  0.0f), glm::vec3(0.0f, 1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f,  0.0f,  0.0f), glm::vec3(0.0f, 1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  -1.0f,  0.0f), glm::vec3(0.0f,  0.0f,  1.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f,  0.0f), glm::vec3(0.0f,  0.0f, -1.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f,  1.0f), glm::vec3(0.0f, 1.0f,  0.0f)),
-	   glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f,  0.0f, -1.0f), glm::vec3(0.0f, 1.0f,  0.0f))
-	};
-
-	VkViewport vp = {};
-	vp.width = (float)dimension;
-	vp.height = (float)dimension;
-	vp.minDepth = 0.0f;
-	vp.maxDepth = 1.0f;
-
-	VkRect2D scissorRect = {};
-	scissorRect.extent.width = dimension;
-	scissorRect.extent.height = dimension;
-	scissorRect.offset.x = 0.0f;
-	scissorRect.offset.y = 0.0f;
-
-	HDRIShaderPushData hdriShaderData;
-
-	// Start recording commands to command buffer!
-	VkCommandBuffer cmdBuffer = pDevice->BeginCommandBuffer();
-
-	vkCmdSetViewport(cmdBuffer, 0, 1, &vp);
-	vkCmdSetScissor(cmdBuffer, 0, 1, &scissorRect);
-
-	VkImageSubresourceRange subresourceRange = {};
-	subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-	subresourceRange.baseMipLevel = 0;
-	subresourceRange.levelCount = 1;
-	subresourceRange.layerCount = 6;
+	const uint32_t nMipmaps = static_cast<uint32_t>(ktxImage.vecLevels.size());
 
-	// Change image layout for all cubemap faces to transfer destination
-	Helper::Vulkan::TransitionImageLayoutCUBE(pDevice, cmdBuffer, cubeImage, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, subresourceRange);
-
-	// 6 faces of irradiance map!
-	for (uint32_t f = 0; f < 6; f++)
+	VkDeviceSize totalSize = 0;
+	for (const std::vector<uint8_t>& level : ktxImage.vecLevels)
 	{
-		// Render scene from cube face's point of view
-		vkCmdBeginRenderPass(cmdBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-
-		glm::mat4 projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 10.0f);
-		//projection[1][1] *= -1.0f;
-		hdriShaderData.mvp =  projection * captureViews[f];
-
-		vkCmdPushConstants(cmdBuffer,
-			m_pGraphicsPipelineHDRI2Cube->m_vkPipelineLayout,
-			VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-			0, sizeof(HDRIShaderPushData),
-			&hdriShaderData);
-
-		vkCmdBindPipeline(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineHDRI2Cube->m_vkGraphicsPipeline);
-		vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pGraphicsPipelineHDRI2Cube->m_vkPipelineLayout, 0, 1, &cubeDescSet, 0, NULL);
-
-		m_pDummySkybox->Render(pDevice, cmdBuffer);
-
-		vkCmdEndRenderPass(cmdBuffer);
-
-		Helper::Vulkan::TransitionImageLayout(pDevice, cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-
-		// Copy region for transfer from framebuffer to cube face
-		VkImageCopy copyRegion = {};
-
-		copyRegion.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		copyRegion.srcSubresource.baseArrayLayer = 0;
-		copyRegion.srcSubresource.mipLevel = 0;
-		copyRegion.srcSubresource.layerCount = 1;
-		copyRegion.srcOffset = { 0, 0, 0 };
-
-		copyRegion.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-		copyRegion.dstSubresource.baseArrayLayer = f;
-		copyRegion.dstSubresource.mipLevel = 0;
-		copyRegion.dstSubresource.layerCount = 1;
-		copyRegion.dstOffset = { 0, 0, 0 };
-
-		copyRegion.extent.width =  static_cast<uint32_t>(vp.width);
-		copyRegion.extent.height = static_cast<uint32_t>(vp.height);
-		copyRegion.extent.depth = 1;
-
-		vkCmdCopyImage(cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, cubeImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-
-		// Transform framebuffer color attachment back
-		Helper::Vulkan::TransitionImageLayout(pDevice, cmdBuffer, offscreenImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		totalSize += level.size();
 	}
 
-	// Transform Irradiance map to Shader readable optimal format!
-	Helper::Vulkan::TransitionImageLayoutCUBE(pDevice, cmdBuffer, cubeImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, subresourceRange);
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingMemory;
+	pDevice->CreateBuffer(	totalSize,
+							VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+							&stagingBuffer,
+							&stagingMemory);
 
-	pDevice->EndAndSubmitCommandBuffer(cmdBuffer);
-}
+	std::vector<VkBufferImageCopy> vecRegions(nMipmaps);
 
-//---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::CreateIrradianceCUBE(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, uint32_t dimension)
-{
-	m_pDummySkybox = new DummySkybox();
-	m_pDummySkybox->Init(pDevice);
-
-	const VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
-
-	//*** Create VkImage with 6 array Layers!
-	m_vkImageIRRAD = Helper::Vulkan::CreateImageCUBE(pDevice,
-													dimension,
-													dimension,
-													format, 
-													1,
-													VK_IMAGE_TILING_OPTIMAL,
-													VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &m_vkImageMemoryIRRAD);
-
-	// Create Image View!
-	m_vkImageViewIRRAD = Helper::Vulkan::CreateImageViewCUBE(pDevice,
-															m_vkImageIRRAD,
-															format,
-															1,
-															VK_IMAGE_ASPECT_COLOR_BIT);
+	void* pData;
+	vkMapMemory(pDevice->m_vkLogicalDevice, stagingMemory, 0, totalSize, 0, &pData);
 
-	// Create Sampler!
-	m_vkSamplerIRRAD = CreateTextureSampler(pDevice, 1);
-
-	// Create RenderPass
-	VkRenderPass irradRenderPass = CreateOffscreenRenderPass(pDevice, format);
+	VkDeviceSize offset = 0;
+	for (uint32_t m = 0; m < nMipmaps; ++m)
+	{
+		memcpy(static_cast<uint8_t*>(pData) + offset, ktxImage.vecLevels[m].data(), ktxImage.vecLevels[m].size());
+
+		uint32_t mipDim = std::max(ktxImage.uiWidth >> m, 1u);
+		vecRegions[m] = {};
+		vecRegions[m].bufferOffset = offset;
+		vecRegions[m].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		vecRegions[m].imageSubresource.mipLevel = m;
+		vecRegions[m].imageSubresource.baseArrayLayer = 0;
+		vecRegions[m].imageSubresource.layerCount = ktxImage.uiFaceCount;
+		vecRegions[m].imageExtent = { mipDim, mipDim, 1 };
+
+		offset += ktxImage.vecLevels[m].size();
+	}
 
-	// Create Off-screen framebuffer! 
-	std::tuple<VkImage, VkImageView, VkDeviceMemory, VkFramebuffer> tupleOffscreen = CreateOffscreenFramebuffer(pDevice, irradRenderPass, format, dimension);
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, stagingMemory);
 
-	// Create Descriptor Set layout & Descriptor Set!
-	std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> tupleDescriptor = CreateIrradianceDescriptorSet(pDevice);
+	VkCommandBuffer cmdBuffer = pDevice->BeginCommandBuffer();
 
-	// Create Graphics Pipeline!
-	CreateIrradiancePipeline(pDevice, pSwapchain, std::get<1>(tupleDescriptor), irradRenderPass);
+	ImageBarrier(cmdBuffer, image, nMipmaps, ktxImage.uiFaceCount, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				 0, VK_ACCESS_TRANSFER_WRITE_BIT, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-	// Render
-	RenderIrrandianceCUBE(pDevice, irradRenderPass, std::get<3>(tupleOffscreen), m_vkImageIRRAD, std::get<0>(tupleOffscreen), std::get<2>(tupleDescriptor), dimension);
+	vkCmdCopyBufferToImage(cmdBuffer, stagingBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, nMipmaps, vecRegions.data());
 
-	// Cleanup!
-	vkDestroyRenderPass(pDevice->m_vkLogicalDevice, irradRenderPass, nullptr);
-	vkDestroyFramebuffer(pDevice->m_vkLogicalDevice, std::get<3>(tupleOffscreen), nullptr);
-	vkFreeMemory(pDevice->m_vkLogicalDevice, std::get<2>(tupleOffscreen), nullptr);
-	vkDestroyImageView(pDevice->m_vkLogicalDevice, std::get<1>(tupleOffscreen), nullptr);
-	vkDestroyImage(pDevice->m_vkLogicalDevice, std::get<0>(tupleOffscreen), nullptr);
-	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, std::get<0>(tupleDescriptor), nullptr);
-	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, std::get<1>(tupleDescriptor), nullptr);
+	ImageBarrier(cmdBuffer, image, nMipmaps, ktxImage.uiFaceCount, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				 VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
-	m_pGraphicsPipelineIrradiance->Cleanup(pDevice);
-	m_pDummySkybox->Cleanup(pDevice);
+	pDevice->EndAndSubmitCommandBuffer(cmdBuffer);
 
-	SAFE_DELETE(m_pGraphicsPipelineIrradiance);
-	SAFE_DELETE(m_pDummySkybox);
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, stagingBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, stagingMemory, nullptr);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::CreatePrefilteredSpecMap(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, uint32_t dimension)
+void VulkanTextureCUBE::ReadbackImage(VulkanDevice* pDevice, VkImage image, uint32_t dimension, uint32_t nMipmaps, uint32_t nLayers, KTX2Image& outImage)
 {
-	const VkFormat format = VK_FORMAT_R32G32B32A32_SFLOAT;
-	const uint32_t dim = dimension;
-	const uint32_t numMips = static_cast<uint32_t>(floor(log2(dim))) + 1;
+	outImage.vkFormat = IBLConfig::FORMAT;
+	outImage.uiWidth = dimension;
+	outImage.uiHeight = dimension;
+	outImage.uiFaceCount = nLayers;
+	outImage.vecLevels.resize(nMipmaps);
 
-	// Create 6 faced cubemap image
-	m_vkImagePrefilterSpec = Helper::Vulkan::CreateImageCUBE(pDevice, 
-															 dim, dim, format, numMips,
-															 VK_IMAGE_TILING_OPTIMAL, 
-															 VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT,
-															 VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-															 &m_vkImageMemoryPrefilterSpec);
+	std::vector<VkBufferImageCopy> vecRegions(nMipmaps);
 
-	// Create ImageView
-	m_vkImageViewPrefilterSpec = Helper::Vulkan::CreateImageViewCUBE(pDevice, m_vkImagePrefilterSpec, format, numMips, VK_IMAGE_ASPECT_COLOR_BIT);
-
-	// Create Sampler
-	m_vkSamplerPrefilterSpec = CreateTextureSampler(pDevice, numMips);
-
-	// Dummy skybox used for rendering HDRI into a cubemap!
-	m_pDummySkybox = new DummySkybox();
-	m_pDummySkybox->Init(pDevice);
-
-	// Create offscreen Renderpass
-	VkRenderPass prefilterRenderPass = CreateOffscreenRenderPass(pDevice, format);
-
-	// Create offscreen framebuffer
-	std::tuple<VkImage, VkImageView, VkDeviceMemory, VkFramebuffer> tupleOffscreen = CreateOffscreenFramebuffer(pDevice, prefilterRenderPass, format, dimension);
-
-	// Create Descriptor Set layout & Descriptor Set!
-	std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> tupleDescriptor = CreatePrefilteredSpecDescriptorSet(pDevice);
-
-	// Create Graphics Pipeline!
-	CreatePrefilteredSpecPipeline(pDevice, pSwapchain, std::get<1>(tupleDescriptor), prefilterRenderPass);
-
-	// Render
-	RenderPrefilteredSpec(pDevice, prefilterRenderPass, std::get<3>(tupleOffscreen), m_vkImagePrefilterSpec, std::get<0>(tupleOffscreen), std::get<2>(tupleDescriptor), dim, numMips);
-
-	// Cleanup!
-	vkDestroyRenderPass(pDevice->m_vkLogicalDevice, prefilterRenderPass, nullptr);
-	vkDestroyFramebuffer(pDevice->m_vkLogicalDevice, std::get<3>(tupleOffscreen), nullptr);
-	vkFreeMemory(pDevice->m_vkLogicalDevice, std::get<2>(tupleOffscreen), nullptr);
-	vkDestroyImageView(pDevice->m_vkLogicalDevice, std::get<1>(tupleOffscreen), nullptr);
-	vkDestroyImage(pDevice->m_vkLogicalDevice, std::get<0>(tupleOffscreen), nullptr);
-	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, std::get<0>(tupleDescriptor), nullptr);
-	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, std::get<1>(tupleDescriptor), nullptr);
-
-	m_pGraphicsPipelinePrefilterSpec->Cleanup(pDevice);
-	m_pDummySkybox->Cleanup(pDevice);
-
-	SAFE_DELETE(m_pGraphicsPipelinePrefilterSpec);
-	SAFE_DELETE(m_pDummySkybox);
-}
+	VkDeviceSize totalSize = 0;
+	for (uint32_t m = 0; m < nMipmaps; ++m)
+	{
+		uint32_t mipDim = std::max(dimension >> m, 1u);
+		outImage.vecLevels[m].resize(static_cast<size_t>(mipDim) * mipDim * 8 * nLayers);
+
+		vecRegions[m] = {};
+		vecRegions[m].bufferOffset = totalSize;
+		vecRegions[m].imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		vecRegions[m].imageSubresource.mipLevel = m;
+		vecRegions[m].imageSubresource.baseArrayLayer = 0;
+		vecRegions[m].imageSubresource.layerCount = nLayers;
+		vecRegions[m].imageExtent = { mipDim, mipDim, 1 };
+
+		totalSize += outImage.vecLevels[m].size();
+	}
 
-//---------------------------------------------------------------------------------------------------------------------
-void VulkanTextureCUBE::CreateBrdfLUTMap(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, uint32_t dimension)
-{
-	const VkFormat format = VK_FORMAT_R32G32_SFLOAT;
-	const uint32_t dim = dimension;
+	VkBuffer stagingBuffer;
+	VkDeviceMemory stagingMemory;
+	pDevice->CreateBuffer(	totalSize,
+							VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+							VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+							&stagingBuffer,
+							&stagingMemory);
 
-	// Create LUT image
-	m_vkImageBRDF = Helper::Vulkan::CreateImage(pDevice, dim, dim, format, 
-												VK_IMAGE_TILING_OPTIMAL, 
-												VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, 
-												VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, 
-												&m_vkImageMemoryBRDF);
+	VkCommandBuffer cmdBuffer = pDevice->BeginCommandBuffer();
 
-	// Create LUT Image View
-	m_vkImageViewBRDF = Helper::Vulkan::CreateImageView(pDevice, m_vkImageBRDF, format, VK_IMAGE_ASPECT_COLOR_BIT);
+	ImageBarrier(cmdBuffer, image, nMipmaps, nLayers, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+				 VK_ACCESS_SHADER_READ_BIT, VK_ACCESS_TRANSFER_READ_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
 
-	// Create Sampler
-	m_vkSamplerBRDF = CreateTextureSampler(pDevice, 1);
+	vkCmdCopyImageToBuffer(cmdBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, stagingBuffer, nMipmaps, vecRegions.data());
 
-	// Create Renderpass
-	VkRenderPass brdfLUTRenderPass;
-
-	VkAttachmentDescription attachDesc = {};
-
-	// Color attachment
-	attachDesc.format = format;
-	attachDesc.samples = VK_SAMPLE_COUNT_1_BIT;
-	attachDesc.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
-	attachDesc.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
-	attachDesc.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-	attachDesc.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-	attachDesc.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-	attachDesc.finalLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;		// Notice the main difference is here, instead of DST_OPTIMAL, it's SHADER_OPTIMAL
-
-	VkAttachmentReference	colorAttachRef = {};
-	colorAttachRef.attachment = 0;
-	colorAttachRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-
-	VkSubpassDescription	subpassDesc = {};
-	subpassDesc.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-	subpassDesc.colorAttachmentCount = 1;
-	subpassDesc.pColorAttachments = &colorAttachRef;
-
-	// Subpass dependencies
-	std::array<VkSubpassDependency, 2> dependencies;
-	dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
-	dependencies[0].dstSubpass = 0;
-	dependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-	dependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-	dependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	dependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-	dependencies[1].srcSubpass = 0;
-	dependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
-	dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	dependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
-	dependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-	dependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
-	dependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
-
-	// Renderpass
-	VkRenderPassCreateInfo renderPassCreateInfo = {};
-	renderPassCreateInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
-	renderPassCreateInfo.attachmentCount = 1;
-	renderPassCreateInfo.pAttachments = &attachDesc;
-	renderPassCreateInfo.subpassCount = 1;
-	renderPassCreateInfo.pSubpasses = &subpassDesc;
-	renderPassCreateInfo.dependencyCount = 2;
-	renderPassCreateInfo.pDependencies = dependencies.data();
-
-	VkResult result = vkCreateRenderPass(pDevice->m_vkLogicalDevice, &renderPassCreateInfo, nullptr, &brdfLUTRenderPass);
-	if (result != VK_SUCCESS)
-	{
-		LOG_ERROR("Failed to create Renderpass for BRDF LUT creation!");
-		return;
-	}
+	ImageBarrier(cmdBuffer, image, nMipmaps, nLayers, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+				 VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
 
-	// Create framebuffer
-	VkFramebuffer brdfLUTFramebuffer;
+	pDevice->EndAndSubmitCommandBuffer(cmdBuffer);
 
-	VkFramebufferCreateInfo fbCreateInfo = {};
-	fbCreateInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
-	fbCreateInfo.renderPass = brdfLUTRenderPass;
-	fbCreateInfo.attachmentCount = 1;
-	fbCreateInfo.pAttachments = &m_vkImageViewBRDF;
-	fbCreateInfo.width = dimension;
-	fbCreateInfo.height = dimension;
-	fbCreateInfo.layers = 1;
+	void* pData;
+	vkMapMemory(pDevice->m_vkLogicalDevice, stagingMemory, 0, totalSize, 0, &pData);
 
-	result = vkCreateFramebuffer(pDevice->m_vkLogicalDevice, &fbCreateInfo, nullptr, &brdfLUTFramebuffer);
-	if (result != VK_SUCCESS)
+	for (uint32_t m = 0; m < nMipmaps; ++m)
 	{
-		LOG_ERROR("Failed to create offscreen framebuffer for BRDF LUT!");
+		memcpy(outImage.vecLevels[m].data(), static_cast<uint8_t*>(pData) + vecRegions[m].bufferOffset, outImage.vecLevels[m].size());
 	}
 
-	// Create Descriptor Set layout & Descriptor Set!
-	std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> tupleDescriptor = CreateBrdfLUTDescriptorSet(pDevice);
+	vkUnmapMemory(pDevice->m_vkLogicalDevice, stagingMemory);
 
-	// Create Graphics Pipeline!
-	CreateBrdfLUTPipeline(pDevice, pSwapchain, std::get<1>(tupleDescriptor), brdfLUTRenderPass);
-
-	// Render
-	RenderBrdfLUT(pDevice, brdfLUTRenderPass, brdfLUTFramebuffer, std::get<2>(tupleDescriptor), dim);
-
-	// Cleanup!
-	vkDestroyRenderPass(pDevice->m_vkLogicalDevice, brdfLUTRenderPass, nullptr);
-	vkDestroyFramebuffer(pDevice->m_vkLogicalDevice, brdfLUTFramebuffer, nullptr);
-	//vkDestroyImageView(pDevice->m_vkLogicalDevice, std::get<1>(tupleOffscreen), nullptr);
-	//vkDestroyImage(pDevice->m_vkLogicalDevice, std::get<0>(tupleOffscreen), nullptr);
-	vkDestroyDescriptorPool(pDevice->m_vkLogicalDevice, std::get<0>(tupleDescriptor), nullptr);
-	vkDestroyDescriptorSetLayout(pDevice->m_vkLogicalDevice, std::get<1>(tupleDescriptor), nullptr);
-
-	m_pGraphicsPipelineBrdfLUT->Cleanup(pDevice);
-	SAFE_DELETE(m_pGraphicsPipelineBrdfLUT);
+	vkDestroyBuffer(pDevice->m_vkLogicalDevice, stagingBuffer, nullptr);
+	vkFreeMemory(pDevice->m_vkLogicalDevice, stagingMemory, nullptr);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -1220,7 +616,6 @@ void VulkanTextureCUBE::CleanupOnWindowResize(VulkanDevice* pDevice)
 {
 }
 
-//---------------------------------------------------------------------------------------------------------------------
 void VulkanTextureCUBE::CreateTextureImage(VulkanDevice* pDevice, std::string fileName)
 {
 	// *** Load pixel data
@@ -1342,6 +737,3 @@ VkSampler VulkanTextureCUBE::CreateTextureSampler(VulkanDevice* pDevice, uint32_
 
 	return sampler;
 }
-
-
-
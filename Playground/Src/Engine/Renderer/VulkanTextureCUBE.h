@@ -7,49 +7,54 @@
 #include "glm/gtc/matrix_transform.hpp"
 
 class VulkanDevice;
-class VulkanSwapChain;
-class VulkanGraphicsPipeline;
 class VulkanTexture2D;
-class DummySkybox;
+class VulkanComputePipeline;
+struct KTX2Image;
 
 //---------------------------------------------------------------------------------------------------------------------
-struct IrradShaderPushData
+namespace IBLConfig
 {
-	IrradShaderPushData()
-	{
-		mvp = glm::mat4(1);
-	}
+	constexpr VkFormat					FORMAT = VK_FORMAT_R16G16B16A16_SFLOAT;		// storage image capable on every device
+	constexpr uint32_t					ENVIRONMENT_DIM = 512;
+	constexpr uint32_t					IRRADIANCE_DIM = 64;
+	constexpr uint32_t					PREFILTER_DIM = 256;
+	constexpr uint32_t					PREFILTER_SAMPLES = 512;
+	constexpr uint32_t					BRDF_LUT_DIM = 512;
 
-	// Data Specific
-	alignas(64) glm::mat4		mvp;
-};
+	// Part of the cache key, bump whenever IBL shaders or sizes change so stale caches get regenerated!
+	constexpr uint32_t					CACHE_VERSION = 1;
+}
 
-//-------------------------------------------------------------------------------------------------------------------
-struct HDRIShaderPushData
+//---------------------------------------------------------------------------------------------------------------------
+struct IBLComputePushData
 {
-	HDRIShaderPushData()
+	IBLComputePushData()
 	{
-		mvp = glm::mat4(1);
+		roughness = 0.0f;
+		numSamples = IBLConfig::PREFILTER_SAMPLES;
 	}
 
 	// Data Specific
-	alignas(64) glm::mat4		mvp;
+	alignas(4)  float					roughness;
+	alignas(4)	uint32_t				numSamples;
 };
 
-//-------------------------------------------------------------------------------------------------------------------
-struct PrefilterShaderPushData
+//---------------------------------------------------------------------------------------------------------------------
+// Transient resources of one IBL map, must outlive the submit that generates it
+struct IBLComputeJob
 {
-	PrefilterShaderPushData()
+	IBLComputeJob()
 	{
-		mvp = glm::mat4(1);
-		roughness = 1.0f;
-		numSamples = 32;
+		vkDescriptorSetLayout = VK_NULL_HANDLE;
+		vkDescriptorPool = VK_NULL_HANDLE;
+		vecOutputViews.clear();
+		pPipeline = nullptr;
 	}
 
-	// Data Specific
-	alignas(64) glm::mat4		mvp;
-	alignas(4)  float			roughness;
-	alignas(4)	uint32_t		numSamples;
+	VkDescriptorSetLayout				vkDescriptorSetLayout;
+	VkDescriptorPool					vkDescriptorPool;
+	std::vector<VkImageView>			vecOutputViews;					// one storage view per output mip
+	VulkanComputePipeline*				pPipeline;
 };
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -59,82 +64,61 @@ public:
 	VulkanTextureCUBE();
 	~VulkanTextureCUBE();
 
-	void																 CreateTextureCUBE(VulkanDevice* pDevice, std::string fileName);
-	void																 CreateTextureCubeFromHDRI(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, std::string fileName);
-	void																 CreateIrradianceCUBE(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, uint32_t dimension);
-	void																 CreatePrefilteredSpecMap(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, uint32_t dimension);
-	void																 CreateBrdfLUTMap(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, uint32_t dimension);
-	void																 Cleanup(VulkanDevice* pDevice);
-	void																 CleanupOnWindowResize(VulkanDevice* pDevice);
-																		 
-private:															
-	void																 CreateTextureImage(VulkanDevice* pDevice, std::string fileName);
-	VkSampler															 CreateTextureSampler(VulkanDevice* pDevice, uint32_t nMipmaps);
-
-	// Generic, HDRI->Cubemap, CubeMap->IrradMap
-	VkRenderPass														 CreateOffscreenRenderPass(VulkanDevice* pDevice, VkFormat format);
-	std::tuple<VkImage, VkImageView, VkDeviceMemory, VkFramebuffer>		 CreateOffscreenFramebuffer(VulkanDevice* pDevice, VkRenderPass renderPass, VkFormat format, uint32_t dimension);
-
-	// HDRI->Cubemap Generation Pass!
-	std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> CreateHDRI2CubeDescriptorSet(VulkanDevice* pDevice);
-	void																 CreateHDRI2CubePipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, VkDescriptorSetLayout descSetLayout, VkRenderPass	renderPass);
-	void																 RenderHDRI2CUBE(VulkanDevice* pDevice, VkRenderPass renderPass, VkFramebuffer framebuffer,
-																						 VkImage irradImage, VkImage offscreenImage, VkDescriptorSet irradDescSet, uint32_t dimension);
-
-	// Cubemap->Irradiance Map Generation Pass!
-	std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> CreateIrradianceDescriptorSet(VulkanDevice* pDevice);
-	void																 CreateIrradiancePipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, VkDescriptorSetLayout descSetLayout, VkRenderPass renderPass);
-	void																 RenderIrrandianceCUBE(VulkanDevice* pDevice, VkRenderPass renderPass, VkFramebuffer framebuffer,
-																							   VkImage irradImage, VkImage offscreenImage, VkDescriptorSet irradDescSet, uint32_t dimension);
-
-	// Cubemap->Prefiltered Map Generation Pass!
-	std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> CreatePrefilteredSpecDescriptorSet(VulkanDevice* pDevice);
-	void																 CreatePrefilteredSpecPipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, VkDescriptorSetLayout descSetLayout, VkRenderPass renderPass);
-	void																 RenderPrefilteredSpec(VulkanDevice* pDevice, VkRenderPass renderPass, VkFramebuffer framebuffer,
-																								VkImage irradImage, VkImage offscreenImage, VkDescriptorSet irradDescSet, uint32_t dimension, uint32_t												nMipmaps);
-
-	// BRDF LUT Map Generation Pass!
-	std::tuple<VkDescriptorPool, VkDescriptorSetLayout, VkDescriptorSet> CreateBrdfLUTDescriptorSet(VulkanDevice* pDevice);
-	void																 CreateBrdfLUTPipeline(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, VkDescriptorSetLayout descSetLayout, VkRenderPass renderPass);
-	void																 RenderBrdfLUT(VulkanDevice* pDevice, VkRenderPass renderPass, VkFramebuffer framebuffer,
-																						VkDescriptorSet irradDescSet, uint32_t dimension);
-
-public:	
-	// HDRI Image
-	VulkanTexture2D*													 m_pTextureHDRI;
-	VulkanGraphicsPipeline*												 m_pGraphicsPipelineHDRI2Cube;
-
-	// Cubemap															 
-	VkImage																 m_vkImageCUBE;
-	VkImageView															 m_vkImageViewCUBE;
-	VkImageLayout														 m_vkImageLayoutCUBE;
-	VkDeviceMemory														 m_vkImageMemoryCUBE;
-	VkSampler															 m_vkSamplerCUBE;
-																		 
-	// Irradiance Map													 
-	VkImage																 m_vkImageIRRAD;
-	VkImageView															 m_vkImageViewIRRAD;
-	VkImageLayout														 m_vkImageLayoutIRRAD;
-	VkDeviceMemory														 m_vkImageMemoryIRRAD;
-	VkSampler															 m_vkSamplerIRRAD;
-	VulkanGraphicsPipeline*												 m_pGraphicsPipelineIrradiance;
-
-	// Prefiltered Specular Cubemap
-	VkImage																 m_vkImagePrefilterSpec;
-	VkImageView															 m_vkImageViewPrefilterSpec;
-	VkImageLayout														 m_vkImageLayoutPrefilterSpec;
-	VkDeviceMemory														 m_vkImageMemoryPrefilterSpec;
-	VkSampler															 m_vkSamplerPrefilterSpec;
-	VulkanGraphicsPipeline*												 m_pGraphicsPipelinePrefilterSpec;
+	void								CreateTextureCUBE(VulkanDevice* pDevice, std::string fileName);
+
+	// Environment cubemap, irradiance, prefiltered specular & BRDF LUT from an equirect HDRI. Loaded from KTX2 cache keyed
+	// by HDRI file hash when present, otherwise generated by compute shaders & written to the cache!
+	void								CreateIBLFromHDRI(VulkanDevice* pDevice, VulkanTexture2D* pHDRI, const std::string& fileName);
+
+	void								Cleanup(VulkanDevice* pDevice);
+	void								CleanupOnWindowResize(VulkanDevice* pDevice);
+
+private:
+	void								CreateTextureImage(VulkanDevice* pDevice, std::string fileName);
+	VkSampler							CreateTextureSampler(VulkanDevice* pDevice, uint32_t nMipmaps);
+
+	// IBL images are storage images for compute & transfer src/dst for cache readback/upload
+	void								CreateIBLImages(VulkanDevice* pDevice);
+	VkImageView							CreateStorageView(VulkanDevice* pDevice, VkImage image, uint32_t mipLevel, uint32_t nLayers);
+
+	// Compute generation, one dispatch per output mip covering all faces, single submit for all maps
+	void								RecordIBLCompute(VulkanDevice* pDevice, VkCommandBuffer cmdBuffer, const std::string& computeShader, 
+														 VkImageView inputView, VkSampler inputSampler, VkImage outputImage, uint32_t dimension, 
+														 uint32_t nMipmaps, uint32_t nLayers, const std::vector<IBLComputePushData>& vecPushData,
+														 IBLComputeJob& outJob);
+	void								CleanupIBLComputeJob(VulkanDevice* pDevice, IBLComputeJob& job);
+	void								GenerateIBL(VulkanDevice* pDevice, VulkanTexture2D* pHDRI);
+
+	// KTX2 cache
+	std::string							GetCacheKey(const std::string& fileName);
+	bool								LoadFromCache(VulkanDevice* pDevice, const std::string& cacheKey);
+	void								WriteToCache(VulkanDevice* pDevice, const std::string& cacheKey);
+	void								UploadImage(VulkanDevice* pDevice, VkImage image, const KTX2Image& ktxImage);
+	void								ReadbackImage(VulkanDevice* pDevice, VkImage image, uint32_t dimension, uint32_t nMipmaps, uint32_t nLayers, KTX2Image& outImage);
+
+public:
+	// Cubemap
+	VkImage								m_vkImageCUBE;
+	VkImageView							m_vkImageViewCUBE;
+	VkDeviceMemory						m_vkImageMemoryCUBE;
+	VkSampler							m_vkSamplerCUBE;
+
+	// Irradiance Map
+	VkImage								m_vkImageIRRAD;
+	VkImageView							m_vkImageViewIRRAD;
+	VkDeviceMemory						m_vkImageMemoryIRRAD;
+	VkSampler							m_vkSamplerIRRAD;
+
+	// Prefiltered Specular Cubemap, roughness = mip / (mip count - 1)
+	VkImage								m_vkImagePrefilterSpec;
+	VkImageView							m_vkImageViewPrefilterSpec;
+	VkDeviceMemory						m_vkImageMemoryPrefilterSpec;
+	VkSampler							m_vkSamplerPrefilterSpec;
+	uint32_t							m_uiPrefilterMipCount;
 
 	// BRDF LUT map
-	VkImage																 m_vkImageBRDF;
-	VkImageView															 m_vkImageViewBRDF;
-	VkImageLayout														 m_vkImageLayoutBRDF;
-	VkDeviceMemory														 m_vkImageMemoryBRDF;
-	VkSampler															 m_vkSamplerBRDF;
-	VulkanGraphicsPipeline*												 m_pGraphicsPipelineBrdfLUT;
-																		 
-	DummySkybox*														 m_pDummySkybox;																	
+	VkImage								m_vkImageBRDF;
+	VkImageView							m_vkImageViewBRDF;
+	VkDeviceMemory						m_vkImageMemoryBRDF;
+	VkSampler							m_vkSamplerBRDF;
 };
-
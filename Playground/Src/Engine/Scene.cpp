@@ -1,25 +1,43 @@
 #include "PlaygroundPCH.h"
 #include "Scene.h"
 
+#include <random>
+
 #include "glm/gtc/matrix_access.hpp"
 
 #include "Renderer/VulkanDevice.h"
 #include "Renderer/VulkanSwapChain.h"
 #include "Renderer/VulkanGraphicsPipeline.h"
+#include "Renderer/FrameGlobals.h"
+
+#include "Engine/Helpers/Camera.h"
 
-#include "Engine/RenderObjects/HDRISkydome.h"
 #include "Engine/RenderObjects/Model.h"
 
 //---------------------------------------------------------------------------------------------------------------------
 Scene::Scene()
 {
 	m_vecModels.clear();
+	m_vecInstancedModels.clear();
+	m_bDirty = true;
+
+	m_bEnableCulling = true;
+	m_bGPUCulling = false;
+	m_bSortDraws = true;
+	m_bAnimateLights = true;
+	m_bEnableLOD = true;
+	m_fLODErrorPixels = 1.0f;
+	m_uiStructureVersion = 0;
+	m_fLODProjScale = 0.0f;
+	m_uiVisibleMeshes = 0;
+	m_uiCulledMeshes = 0;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 Scene::~Scene()
 {
 	m_vecModels.clear();
+	m_vecInstancedModels.clear();
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -33,6 +51,8 @@ void Scene::LoadScene(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
 	SetLightDirection(m_LightAngleEuler);
 	
 	m_LightIntensity = 1.0f;
+
+	m_bDirty = true;
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -54,7 +74,7 @@ void Scene::LoadModels(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
 	pModelAnt->SetScale(glm::vec3(1.0f));
 	pModelAnt->SetupDescriptors(pDevice, pSwapchain);
 	
-	m_vecModels.push_back(pModelAnt);
+	AddModel(pModelAnt);
 
 	// Load Leather Sphere
 	//Model* pModelSphereLeather = new Model(ModelType::STATIC_OPAQUE);
@@ -90,58 +110,539 @@ void Scene::LoadModels(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
 	pWoodenFloor->SetScale(glm::vec3(4));
 	pWoodenFloor->SetupDescriptors(pDevice, pSwapchain);
 	
-	m_vecModels.push_back(pWoodenFloor);
+	AddModel(pWoodenFloor);
+
+	// Forest of props around the floor, 10k instances drawn with one draw call per sub mesh
+	Model* pPropForest = new Model(ModelType::STATIC_OPAQUE_INSTANCED);
+	pPropForest->LoadModel(pDevice, "Models/Sphere.fbx");
+	pPropForest->SetPosition(glm::vec3(0, -2, 0));
+	pPropForest->SetScale(glm::vec3(1.0f));
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> distScale(0.05f, 0.2f);
+	std::uniform_real_distribution<float> distJitter(-0.4f, 0.4f);
+
+	const int iGridSize = 100;
+	for (int x = 0; x < iGridSize; ++x)
+	{
+		for (int z = 0; z < iGridSize; ++z)
+		{
+			float fScale = distScale(rng);
+			glm::vec3 pos = glm::vec3(x - iGridSize / 2 + distJitter(rng), fScale, z - iGridSize / 2 + distJitter(rng));
+
+			glm::mat4 matInstance = glm::translate(glm::mat4(1), pos);
+			matInstance = glm::scale(matInstance, glm::vec3(fScale));
+			pPropForest->AddInstance(matInstance);
+		}
+	}
+
+	pPropForest->SetupDescriptors(pDevice, pSwapchain);
+
+	AddModel(pPropForest);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Wall between default camera & a grid of separate models, every model is one indirect draw of the GPU driven path
+// that only Hi-Z can reject. Static models can't be rotated, so the wall is a sphere squashed flat facing +Z!
+void Scene::LoadOcclusionBenchmark(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain)
+{
+	Model* pWall = new Model(ModelType::STATIC_OPAQUE);
+	pWall->LoadModel(pDevice, "Models/Sphere.fbx");
+	pWall->SetPosition(glm::vec3(0, 3, 10));
+	pWall->SetScale(glm::vec3(3.0f, 1.4f, 0.08f));
+	pWall->SetupDescriptors(pDevice, pSwapchain);
+
+	AddModel(pWall);
+
+	const int iGridSize = 12;
+	for (int x = 0; x < iGridSize; ++x)
+	{
+		for (int z = 0; z < iGridSize; ++z)
+		{
+			Model* pHidden = new Model(ModelType::STATIC_OPAQUE);
+			pHidden->LoadModel(pDevice, "Models/Sphere.fbx");
+			pHidden->SetPosition(glm::vec3((x - iGridSize / 2) * 1.6f, -1.5f, 7.6f - z * 1.6f));
+			pHidden->SetScale(glm::vec3(0.1f));
+			pHidden->SetupDescriptors(pDevice, pSwapchain);
+
+			AddModel(pHidden);
+		}
+	}
+
+	LOG_INFO("Occlusion benchmark: {0} models behind wall", iGridSize * iGridSize);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
 void Scene::Update(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, float dt)
 {
-	// Update each model's uniform data
+	// Update each model's transform, copied into FrameGlobals object buffer so moves don't touch command buffers
 	for (Model* element : m_vecModels)
 	{
 		if (element != nullptr)
 		{
 			element->Update(pDevice, pSwapchain, dt);
+
+			// Keep BVH in sync, one leaf per mesh & only moved models touch the tree
+			for (MeshProxy& proxy : element->m_vecMeshProxies)
+			{
+				const BoundingBox& box = element->m_vecWorldAABB[proxy.uiMesh];
+				if (proxy.iProxy == -1)
+				{
+					proxy.iProxy = m_BVH.CreateProxy(box, &proxy);
+				}
+				else if (element->m_bBoundsDirty)
+				{
+					m_BVH.MoveProxy(proxy.iProxy, box);
+				}
+			}
+
+			element->m_bBoundsDirty = false;
+		}
+	}
+
+	// Instanced groups aren't in BVH, bounds are refreshed by the model itself
+	for (Model* element : m_vecInstancedModels)
+	{
+		if (element != nullptr)
+		{
+			element->Update(pDevice, pSwapchain, dt);
+			element->m_bBoundsDirty = false;
 		}
 	}
 
-	// Update Skydome data!
-	HDRISkydome::getInstance().Update(pDevice, pSwapchain, dt);
+	// Local lights only move, light lists are rebuilt on GPU every frame anyway
+	if (m_bAnimateLights)
+	{
+		for (Light& light : m_vecLights)
+		{
+			glm::mat4 matOrbit = glm::rotate(glm::mat4(1), glm::radians(light.fOrbitSpeed * dt), glm::vec3(0, 1, 0));
+			light.vecPosition = glm::vec3(matOrbit * glm::vec4(light.vecPosition, 1.0f));
+			light.vecDirection = glm::vec3(matOrbit * glm::vec4(light.vecDirection, 0.0f));
+		}
+	}
+
+	// Model bounds are up to date now, cull against camera
+	CullModels(Camera::getInstance().m_matView, Camera::getInstance().m_matProjection);
+
+	// World units to pixels at distance 1, from vertical FOV of projection & swapchain height
+	float fProjScale = Camera::getInstance().m_matProjection[1][1] * 0.5f * pSwapchain->m_vkSwapchainExtent.height;
+	m_fLODProjScale = std::abs(fProjScale);
+	SelectLODs(Camera::getInstance().m_vecCameraPosition, m_fLODProjScale);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void Scene::UpdateUniforms(VulkanDevice* pDevice, uint32_t imageIndex)
+// BVH over mesh bounds finds candidates, their tight bounds are then tested in one SIMD batch since leaves are fattened.
+// Results only reach the GPU through this frame's draw arguments (see WriteDrawArgs), command buffers stay as recorded.
+void Scene::CullModels(const glm::mat4& matView, const glm::mat4& matProjection)
 {
-	// Update all models!
-	for (Model* element :m_vecModels)
+	m_Frustum.ExtractPlanes(matProjection * matView);
+
+	// Instanced groups are drawn by CPU recorded commands in either path
+	CullInstancedModels();
+
+	// Planes are consumed by GPU culling, recorded command buffers don't depend on visibility!
+	if (m_bGPUCulling)
+	{
+		for (Model* element : m_vecModels)
+		{
+			if (element != nullptr)
+				std::fill(element->m_vecMeshVisible.begin(), element->m_vecMeshVisible.end(), 1);
+		}
+
+		return;
+	}
+
+	// Everything culled unless BVH says otherwise
+	for (Model* element : m_vecModels)
 	{
 		if (element != nullptr)
+			std::fill(element->m_vecMeshVisible.begin(), element->m_vecMeshVisible.end(), m_bEnableCulling ? 0 : 1);
+	}
+
+	if (m_bEnableCulling)
+	{
+		m_vecQueryResults.clear();
+		m_BVH.QueryFrustum(m_Frustum, m_vecQueryResults);
+
+		// Gather tight bounds of candidate meshes into one stream
+		m_CullBoxes.Clear();
+		for (void* pUserData : m_vecQueryResults)
+		{
+			const MeshProxy* pProxy = static_cast<const MeshProxy*>(pUserData);
+			m_CullBoxes.Add(pProxy->pModel->m_vecWorldAABB[pProxy->uiMesh]);
+		}
+
+		m_vecCullResults.resize(m_CullBoxes.GetCount());
+		m_Frustum.CullBoxes(m_CullBoxes, m_vecCullResults.data());
+
+		// Scatter results back to models
+		for (size_t i = 0; i < m_vecQueryResults.size(); ++i)
 		{
-			element->UpdateUniformBuffers(pDevice, imageIndex);
+			const MeshProxy* pProxy = static_cast<const MeshProxy*>(m_vecQueryResults[i]);
+			pProxy->pModel->m_vecMeshVisible[pProxy->uiMesh] = m_vecCullResults[i];
 		}
 	}
 
-	// Update Skydome uniforms!
-	HDRISkydome::getInstance().UpdateUniformBUffers(pDevice, imageIndex);
+	m_uiVisibleMeshes = 0;
+	m_uiCulledMeshes = 0;
+
+	for (Model* element : m_vecModels)
+	{
+		if (element == nullptr)
+			continue;
+
+		for (uint8_t bVisible : element->m_vecMeshVisible)
+		{
+			bVisible ? ++m_uiVisibleMeshes : ++m_uiCulledMeshes;
+		}
+	}
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void Scene::RenderOpaque(VulkanDevice* pDevice, VulkanGraphicsPipeline* pPipline, uint32_t imageIndex)
+// Few instanced groups with few meshes each, their bounds cover all instances & are tested directly
+void Scene::CullInstancedModels()
 {
-	// Draw Scene!
-	for (Model* element : m_vecModels)
+	for (Model* element : m_vecInstancedModels)
+	{
+		if (element == nullptr)
+			continue;
+
+		for (uint32_t i = 0; i < element->m_vecMeshVisible.size(); ++i)
+		{
+			element->m_vecMeshVisible[i] = (!m_bEnableCulling || m_Frustum.IsVisible(element->m_vecWorldAABB[i])) ? 1 : 0;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Picks coarsest LOD of each visible mesh whose error, projected from its closest bounds point, stays below threshold.
+// Going back to a finer LOD is delayed by a hysteresis band so meshes near a switch distance don't flicker every frame.
+// Chosen index range only reaches the GPU through this frame's draw arguments (see WriteDrawArgs), no re-recording.
+void Scene::SelectLODs(const glm::vec3& cameraPos, float fProjScale)
+{
+	float fNearClip = std::max(Camera::getInstance().m_fNearClip, 0.001f);
+
+	auto SelectModels = [&](const std::vector<Model*>& vecModels)
+	{
+		for (Model* element : vecModels)
+		{
+			if (element == nullptr)
+				continue;
+
+			for (uint32_t i = 0; i < element->m_vecMeshLOD.size(); ++i)
+			{
+				if (!element->m_vecMeshVisible[i])
+					continue;
+
+				const Mesh& mesh = element->GetMeshes()[i];
+				uint32_t uiCurrent = element->m_vecMeshLOD[i];
+				uint32_t uiLOD = 0;
+
+				if (m_bEnableLOD && mesh.GetLODCount() > 1)
+				{
+					float fDistance = std::max(element->m_vecWorldAABB[i].Distance(cameraPos), fNearClip);
+					float fPixelsPerUnit = element->m_fWorldScale * fProjScale / fDistance;
+
+					for (uint32_t uiLevel = mesh.GetLODCount() - 1; uiLevel > 0; --uiLevel)
+					{
+						float fThreshold = m_fLODErrorPixels * ((uiLevel <= uiCurrent) ? 1.0f + MeshLODConfig::HYSTERESIS : 1.0f);
+						if (mesh.m_vecLODs[uiLevel].fError * fPixelsPerUnit <= fThreshold)
+						{
+							uiLOD = uiLevel;
+							break;
+						}
+					}
+				}
+
+				element->m_vecMeshLOD[i] = static_cast<uint8_t>(uiLOD);
+			}
+		}
+	};
+
+	// GPU driven path selects same way in GBufferCull.comp, only instanced groups are drawn from CPU arguments then
+	if (!m_bGPUCulling)
+		SelectModels(m_vecModels);
+
+	SelectModels(m_vecInstancedModels);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Standalone BVH filled with nInstances random boxes, compares build, refit & query timings against brute force.
+// Scene's own BVH is not touched!
+void Scene::RunBVHBenchmark(uint32_t nInstances)
+{
+	LOG_INFO("---- BVH benchmark : {0} instances ----", nInstances);
+
+	std::mt19937 rng(1337);
+	std::uniform_real_distribution<float> distPosition(-1000.0f, 1000.0f);
+	std::uniform_real_distribution<float> distSize(0.5f, 5.0f);
+	std::uniform_real_distribution<float> distDirection(-1.0f, 1.0f);
+	std::uniform_real_distribution<float> distMove(-2.0f, 2.0f);
+
+	std::vector<BoundingBox> vecBoxes(nInstances);
+	for (BoundingBox& box : vecBoxes)
+	{
+		glm::vec3 center = glm::vec3(distPosition(rng), distPosition(rng) * 0.1f, distPosition(rng));
+		glm::vec3 extent = glm::vec3(distSize(rng), distSize(rng), distSize(rng));
+
+		box.vecMin = center - extent;
+		box.vecMax = center + extent;
+	}
+
+	auto Now = []() { return std::chrono::high_resolution_clock::now(); };
+	auto Ms = [](auto start, auto end) { return std::chrono::duration<float, std::milli>(end - start).count(); };
+
+	//--- Build
+	BVH bvh;
+	std::vector<int32_t> vecProxies(nInstances);
+
+	auto timeStart = Now();
+	for (uint32_t i = 0; i < nInstances; ++i)
+	{
+		vecProxies[i] = bvh.CreateProxy(vecBoxes[i], reinterpret_cast<void*>(static_cast<uintptr_t>(i)));
+	}
+	LOG_INFO("Build        : {0:.3f} ms, height {1}", Ms(timeStart, Now()), bvh.GetHeight());
+
+	//--- Refit, move 10% of instances
+	timeStart = Now();
+	uint32_t nReinserted = 0;
+	for (uint32_t i = 0; i < nInstances; i += 10)
+	{
+		glm::vec3 offset = glm::vec3(distMove(rng), 0.0f, distMove(rng));
+		vecBoxes[i].vecMin += offset;
+		vecBoxes[i].vecMax += offset;
+
+		nReinserted += bvh.MoveProxy(vecProxies[i], vecBoxes[i]) ? 1 : 0;
+	}
+	LOG_INFO("Refit 10%    : {0:.3f} ms, {1} reinserted", Ms(timeStart, Now()), nReinserted);
+
+	const uint32_t nIterations = 20;
+	std::vector<void*> vecResults;
+	vecResults.reserve(nInstances);
+
+	//--- Frustum, BVH vs brute force SIMD over all boxes
+	BoundingBoxStream stream;
+	for (const BoundingBox& box : vecBoxes)
+	{
+		stream.Add(box);
+	}
+	std::vector<uint8_t> vecVisible(stream.GetCount());
+
+	timeStart = Now();
+	for (uint32_t i = 0; i < nIterations; ++i)
+	{
+		vecResults.clear();
+		bvh.QueryFrustum(m_Frustum, vecResults);
+	}
+	float fBVHMs = Ms(timeStart, Now()) / nIterations;
+
+	timeStart = Now();
+	for (uint32_t i = 0; i < nIterations; ++i)
+	{
+		m_Frustum.CullBoxes(stream, vecVisible.data());
+	}
+	float fBruteMs = Ms(timeStart, Now()) / nIterations;
+
+	LOG_INFO("Frustum      : BVH {0:.3f} ms | brute force {1:.3f} ms | {2} hits", fBVHMs, fBruteMs, vecResults.size());
+
+	//--- Rays, from camera through random directions
+	const uint32_t nRays = 1000;
+	std::vector<glm::vec3> vecDirections(nRays);
+	for (glm::vec3& dir : vecDirections)
+	{
+		dir = glm::normalize(glm::vec3(distDirection(rng), distDirection(rng), distDirection(rng)) + glm::vec3(0, 0, 0.001f));
+	}
+
+	glm::vec3 origin = Camera::getInstance().m_vecCameraPosition;
+	size_t nRayHits = 0;
+
+	timeStart = Now();
+	for (const glm::vec3& dir : vecDirections)
+	{
+		vecResults.clear();
+		bvh.QueryRay(origin, dir, 2000.0f, vecResults);
+		nRayHits += vecResults.size();
+	}
+	LOG_INFO("{0} rays   : BVH {1:.3f} ms | {2} hits", nRays, Ms(timeStart, Now()), nRayHits);
+
+	//--- Spheres
+	const uint32_t nSpheres = 1000;
+	size_t nSphereHits = 0;
+
+	timeStart = Now();
+	for (uint32_t i = 0; i < nSpheres; ++i)
+	{
+		vecResults.clear();
+		bvh.QuerySphere(vecBoxes[i * (nInstances / nSpheres)].GetCenter(), 25.0f, vecResults);
+		nSphereHits += vecResults.size();
+	}
+	LOG_INFO("{0} spheres: BVH {1:.3f} ms | {2} hits", nSpheres, Ms(timeStart, Now()), nSphereHits);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Gathers every mesh into render queue, culled ones included since visibility & LOD are only known through draw arguments.
+// Material is the model's MaterialRegistry index so models sharing one end up adjacent, geometry is a running model index.
+// Depth is taken along camera direction at record time, order doesn't follow the camera until command buffers are
+// re-recorded!
+void Scene::BuildRenderQueue()
+{
+	m_RenderQueue.Clear();
+
+	const glm::vec3& cameraPos = Camera::getInstance().m_vecCameraPosition;
+	const glm::vec3& cameraDir = Camera::getInstance().m_vecCameraDirection;
+	float fInvFar = 1.0f / Camera::getInstance().m_fFarClip;
+
+	uint32_t uiGeometry = 0;
+
+	auto PushModels = [&](const std::vector<Model*>& vecModels, RenderPipelineID ePipeline)
+	{
+		for (Model* element : vecModels)
+		{
+			if (element == nullptr)
+				continue;
+
+			for (uint32_t i = 0; i < element->GetMeshCount(); ++i)
+			{
+				float fDepth = (i < element->m_vecWorldAABB.size()) ? glm::dot(element->m_vecWorldAABB[i].GetCenter() - cameraPos, cameraDir) : 0.0f;
+				m_RenderQueue.Push(RenderQueue::MakeSortKey(ePipeline, element->GetMaterialFeatures(), element->m_ObjectData.materialIndex,
+															fDepth * fInvFar, uiGeometry), element, i);
+			}
+
+			++uiGeometry;
+		}
+	};
+
+	PushModels(m_vecModels, RenderPipelineID::GBUFFER_OPAQUE);
+	PushModels(m_vecInstancedModels, RenderPipelineID::GBUFFER_OPAQUE_INSTANCED);
+
+	if (m_bSortDraws)
+		m_RenderQueue.Sort();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Records render queue items [uiFirstItem, uiFirstItem + uiItemCount) so that G-Buffer pass can be split across threads!
+void Scene::RenderOpaque(VkCommandBuffer cmdBuffer, const std::vector<VulkanGraphicsPipeline*>& vecPipelines, VkBuffer vkDrawArgs,
+						 uint32_t uiFirstItem, uint32_t uiItemCount, RenderQueueStats& outStats)
+{
+	m_RenderQueue.Submit(cmdBuffer, vecPipelines, vkDrawArgs, uiFirstItem, uiItemCount, outStats);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Lays down depth of opaque queue items, must be recorded before any RenderOpaque() using GBUFFER_OPAQUE_DEPTH_EQUAL!
+void Scene::RenderDepthPrepass(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipline, VkBuffer vkDrawArgs)
+{
+	m_RenderQueue.SubmitDepthOnly(cmdBuffer, pPipline, vkDrawArgs);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// All instanced groups, each model binds its permutation of instanced G-Buffer pipeline
+void Scene::RenderInstanced(VulkanDevice* pDevice, VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipline, VkBuffer vkDrawArgs)
+{
+	for (Model* element : m_vecInstancedModels)
 	{
 		if (element != nullptr)
 		{
-			element->Render(pDevice, pPipline, imageIndex);
+			element->Render(pDevice, cmdBuffer, pPipline, vkDrawArgs);
 		}
 	}
 }
 
 //---------------------------------------------------------------------------------------------------------------------
-void Scene::RenderSkydome(VulkanDevice* pDevice, VulkanGraphicsPipeline* pPipline, uint32_t imageIndex)
+// Copies transform & material index of every model into its object slot, recorded draws only push the slot
+void Scene::WriteObjectData(ObjectShaderData* pObjects, uint32_t uiCapacity)
+{
+	auto WriteModels = [&](const std::vector<Model*>& vecModels)
+	{
+		for (Model* element : vecModels)
+		{
+			if (element != nullptr && element->m_PushConstantData.objectIndex < uiCapacity)
+				pObjects[element->m_PushConstantData.objectIndex] = element->m_ObjectData;
+		}
+	};
+
+	WriteModels(m_vecModels);
+	WriteModels(m_vecInstancedModels);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Writes draw slot of every mesh from this frame's culling & LOD selection. Culled meshes keep their recorded draw with
+// zero instances, so camera movement never invalidates command buffers!
+void Scene::WriteDrawArgs(VkDrawIndexedIndirectCommand* pArgs, uint32_t uiCapacity)
+{
+	uint32_t uiTriangles = 0;
+
+	auto WriteModels = [&](const std::vector<Model*>& vecModels)
+	{
+		for (Model* element : vecModels)
+		{
+			if (element == nullptr)
+				continue;
+
+			for (uint32_t i = 0; i < element->GetMeshCount(); ++i)
+			{
+				uint32_t uiSlot = element->m_uiFirstDrawSlot + i;
+				if (uiSlot >= uiCapacity)
+					continue;
+
+				// Models added after this frame's update haven't been culled yet
+				bool bVisible = (i >= element->m_vecMeshVisible.size()) || element->m_vecMeshVisible[i];
+				uint32_t uiLOD = (i < element->m_vecMeshLOD.size()) ? element->m_vecMeshLOD[i] : 0;
+
+				element->FillDrawArgs(i, uiLOD, bVisible, pArgs[uiSlot]);
+				if (bVisible)
+					uiTriangles += element->GetDrawTriangleCount(i, uiLOD);
+			}
+		}
+	};
+
+	WriteModels(m_vecModels);
+	WriteModels(m_vecInstancedModels);
+
+	m_RenderStats.uiTriangles = uiTriangles;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Scene::AddLight(const Light& light)
+{
+	m_vecLights.push_back(light);
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+void Scene::ClearLights()
 {
-	HDRISkydome::getInstance().Render(pDevice, pPipline, imageIndex);
+	m_vecLights.clear();
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Replaces local lights with nLights random point & spot lights scattered over the prop forest, each orbiting the
+// scene at its own speed. Lights are small so cost should track lights per cluster, not total count!
+void Scene::SpawnStressTestLights(uint32_t nLights)
+{
+	ClearLights();
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> distPosition(-50.0f, 50.0f);
+	std::uniform_real_distribution<float> distHeight(-1.5f, 1.0f);
+	std::uniform_real_distribution<float> distRange(1.0f, 4.0f);
+	std::uniform_real_distribution<float> distColor(0.2f, 1.0f);
+	std::uniform_real_distribution<float> distSpeed(-20.0f, 20.0f);
+	std::uniform_real_distribution<float> distChance(0.0f, 1.0f);
+
+	for (uint32_t i = 0; i < nLights; ++i)
+	{
+		Light light;
+		light.eType = (distChance(rng) < 0.25f) ? LightType::SPOT : LightType::POINT;
+		light.vecPosition = glm::vec3(distPosition(rng), distHeight(rng), distPosition(rng));
+		light.fRange = distRange(rng);
+		light.vecColor = glm::vec3(distColor(rng), distColor(rng), distColor(rng));
+		light.fIntensity = 4.0f;
+		light.vecDirection = glm::vec3(0, -1, 0);
+		light.fOrbitSpeed = distSpeed(rng);
+
+		AddLight(light);
+	}
+
+	LOG_INFO("Spawned {0} stress test lights", nLights);
 }
 
 //---------------------------------------------------------------------------------------------------------------------
@@ -157,13 +658,99 @@ void Scene::SetLightDirection(const glm::vec3& eulerAngles)
 	m_LightDirection = glm::column(rotateXYZ, 1);
 }
 
+//---------------------------------------------------------------------------------------------------------------------
+void Scene::AddModel(Model* pModel)
+{
+	if (pModel == nullptr)
+		return;
+
+	if (pModel->IsInstanced())
+	{
+		m_vecInstancedModels.push_back(pModel);
+		AssignSlots();
+		m_bDirty = true;
+		return;
+	}
+
+	m_vecModels.push_back(pModel);
+	AssignSlots();
+	m_bDirty = true;
+	++m_uiStructureVersion;
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Only detaches model from the scene, caller is responsible for cleanup once GPU is done with it!
+void Scene::RemoveModel(Model* pModel)
+{
+	auto it = std::find(m_vecModels.begin(), m_vecModels.end(), pModel);
+	if (it != m_vecModels.end())
+	{
+		for (MeshProxy& proxy : pModel->m_vecMeshProxies)
+		{
+			if (proxy.iProxy != -1)
+			{
+				m_BVH.DestroyProxy(proxy.iProxy);
+				proxy.iProxy = -1;
+			}
+		}
+
+		m_vecModels.erase(it);
+		AssignSlots();
+		m_bDirty = true;
+		++m_uiStructureVersion;
+	}
+
+	auto itInstanced = std::find(m_vecInstancedModels.begin(), m_vecInstancedModels.end(), pModel);
+	if (itInstanced != m_vecInstancedModels.end())
+	{
+		m_vecInstancedModels.erase(itInstanced);
+		AssignSlots();
+		m_bDirty = true;
+	}
+}
+
+//---------------------------------------------------------------------------------------------------------------------
+// Every model gets its own slot in FrameGlobals object buffer & every mesh its own slot in draw arguments, packed in
+// model order. Only changes with scene structure, which re-records command buffers anyway!
+void Scene::AssignSlots()
+{
+	uint32_t uiObject = 0;
+	uint32_t uiSlot = 0;
+
+	auto AssignModels = [&](const std::vector<Model*>& vecModels)
+	{
+		for (Model* element : vecModels)
+		{
+			element->m_PushConstantData.objectIndex = uiObject++;
+			element->m_uiFirstDrawSlot = uiSlot;
+			uiSlot += element->GetMeshCount();
+		}
+	};
+
+	AssignModels(m_vecModels);
+	AssignModels(m_vecInstancedModels);
+
+	if (uiObject > SceneSetConfig::MAX_OBJECTS)
+		LOG_ERROR("Scene has {0} models, only first {1} get object slots!", uiObject, SceneSetConfig::MAX_OBJECTS);
+
+	if (uiSlot > SceneSetConfig::MAX_DRAWS)
+		LOG_ERROR("Scene has {0} meshes, only first {1} get draw slots!", uiSlot, SceneSetConfig::MAX_DRAWS);
+}
+
 //---------------------------------------------------------------------------------------------------------------------
 void Scene::Cleanup(VulkanDevice* pDevice)
 {
 	for (Model* element : m_vecModels)
 	{
 		element->Cleanup(pDevice);
-	}	
+	}
+
+	for (Model* element : m_vecInstancedModels)
+	{
+		element->Cleanup(pDevice);
+	}
+
+	m_BVH.Clear();
 }
 
 
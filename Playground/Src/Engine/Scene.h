@@ -1,11 +1,17 @@
 #pragma once
 
 #include "glm/glm.hpp"
+#include "vulkan/vulkan.h"
+
+#include "Engine/Helpers/BVH.h"
+#include "Engine/Renderer/RenderQueue.h"
+#include "Engine/RenderObjects/Light.h"
 
 class VulkanDevice;
 class VulkanSwapChain;
 class VulkanGraphicsPipeline;
 class Model;
+struct ObjectShaderData;
 
 class Scene
 {
@@ -17,25 +23,91 @@ public:
 	void						Cleanup(VulkanDevice* pDevice);
 
 	void						Update(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain, float dt);
-	void						UpdateUniforms(VulkanDevice* pDevice, uint32_t imageIndex);
-	void						RenderOpaque(VulkanDevice* pDevice, VulkanGraphicsPipeline* pPipline, uint32_t imageIndex);
-	void						RenderSkybox(VulkanDevice* pDevice, VulkanGraphicsPipeline* pPipline, uint32_t imageIndex);
-	void						RenderSkydome(VulkanDevice* pDevice, VulkanGraphicsPipeline* pPipline, uint32_t imageIndex);
+	void						BuildRenderQueue();
+	void						RenderOpaque(VkCommandBuffer cmdBuffer, const std::vector<VulkanGraphicsPipeline*>& vecPipelines, VkBuffer vkDrawArgs,
+											 uint32_t uiFirstItem, uint32_t uiItemCount, RenderQueueStats& outStats);
+	void						RenderDepthPrepass(VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipline, VkBuffer vkDrawArgs);
+	void						RenderInstanced(VulkanDevice* pDevice, VkCommandBuffer cmdBuffer, VulkanGraphicsPipeline* pPipline, VkBuffer vkDrawArgs);
+	void						WriteObjectData(ObjectShaderData* pObjects, uint32_t uiCapacity);
+	void						WriteDrawArgs(VkDrawIndexedIndirectCommand* pArgs, uint32_t uiCapacity);
+	void						RenderSkybox(VulkanDevice* pDevice, VulkanGraphicsPipeline* pPipline, uint32_t frameIndex);
 
 	void						SetLightDirection(const glm::vec3& eulerAngles);
+	void						CullModels(const glm::mat4& matView, const glm::mat4& matProjection);
+	void						SelectLODs(const glm::vec3& cameraPos, float fProjScale);
+	void						RunBVHBenchmark(uint32_t nInstances);
+	void						LoadOcclusionBenchmark(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+
+	void						AddModel(Model* pModel);
+	void						RemoveModel(Model* pModel);
+
+	// Local lights, binned into clusters by the renderer
+	void						AddLight(const Light& light);
+	void						ClearLights();
+	void						SpawnStressTestLights(uint32_t nLights);
 	
 	inline glm::vec3			GetLightEulerAngles()	{ return m_LightAngleEuler; }
 	inline std::vector<Model*>	GetModelList()			{ return m_vecModels; }
+	inline uint32_t				GetModelCount()			{ return static_cast<uint32_t>(m_vecModels.size()); }
+	inline std::vector<Model*>	GetInstancedModelList()	{ return m_vecInstancedModels; }
+	inline uint32_t				GetVisibleMeshCount()	{ return m_uiVisibleMeshes; }
+	inline uint32_t				GetCulledMeshCount()	{ return m_uiCulledMeshes; }
+	inline const Frustum&		GetFrustum()			{ return m_Frustum; }
+	inline float				GetLODProjScale()		{ return m_fLODProjScale; }
+	inline const BVH&			GetBVH()				{ return m_BVH; }
+	inline uint32_t				GetStructureVersion()	{ return m_uiStructureVersion; }
+	inline uint32_t				GetRenderItemCount()	{ return m_RenderQueue.GetCount(); }
+	inline const RenderQueueStats&	GetRenderStats()	{ return m_RenderStats; }
+	inline const std::vector<Light>&	GetLights()		{ return m_vecLights; }
+
+	inline void					SetCullStats(uint32_t uiVisible, uint32_t uiCulled)	{ m_uiVisibleMeshes = uiVisible; m_uiCulledMeshes = uiCulled; }
+	inline void					SetRenderStats(const RenderQueueStats& stats)		{ m_RenderStats = stats; }
+
+	// Structural changes (models added/removed) invalidate recorded command buffers! Transforms, visibility & LOD are
+	// per frame data (see WriteObjectData & WriteDrawArgs)
+	inline bool					IsDirty()				{ return m_bDirty; }
+	inline void					ClearDirty()			{ m_bDirty = false; }
+	inline void					MarkDirty()				{ m_bDirty = true; }
 
 public:
 	glm::vec3					m_LightDirection;
 	float						m_LightIntensity;
+	bool						m_bEnableCulling;
+	bool						m_bGPUCulling;				// culling done by GPU driven pass, CPU only extracts planes
+	bool						m_bSortDraws;				// sort render queue by state key, off = insertion order
+	bool						m_bAnimateLights;			// orbit local lights around world Y axis
+	bool						m_bEnableLOD;				// off = always full resolution meshes
+	float						m_fLODErrorPixels;			// max projected simplification error on screen
 
 private:
 	void						LoadModels(VulkanDevice* pDevice, VulkanSwapChain* pSwapchain);
+	void						CullInstancedModels();
+	void						AssignSlots();
 
 private:
 	glm::vec3					m_LightAngleEuler;
 	std::vector<Model*>			m_vecModels;
+	std::vector<Model*>			m_vecInstancedModels;		// need instanced pipeline, kept out of BVH & GPU driven path
+	bool						m_bDirty;
+	uint32_t					m_uiStructureVersion;		// bumped on every add/remove of models
+	float						m_fLODProjScale;			// pixels per world unit at distance 1, GPU driven path selects LODs with it
+
+	// Spatial index over mesh bounds, user data is the model's MeshProxy*
+	BVH							m_BVH;
+	std::vector<void*>			m_vecQueryResults;
+
+	// Frustum culling scratch, tight bounds of all BVH candidates tested in one go
+	Frustum						m_Frustum;
+	BoundingBoxStream			m_CullBoxes;
+	std::vector<uint8_t>		m_vecCullResults;
+	uint32_t					m_uiVisibleMeshes;
+	uint32_t					m_uiCulledMeshes;
+
+	// Local point & spot lights
+	std::vector<Light>			m_vecLights;
+
+	// All meshes of all models, rebuilt whenever command buffers are re-recorded
+	RenderQueue					m_RenderQueue;
+	RenderQueueStats			m_RenderStats;
 };
 
@@ -8,6 +8,7 @@
 #include <algorithm>
 #include <functional>
 #include <optional>
+#include <chrono>
 
 #include <cstring>
 #include <string>